@@ -29,9 +29,14 @@
 #include <ns3/global-value.h>
 #include <ns3/string.h>
 #include <ns3/log.h>
+#include <ns3/simulator.h>
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
+#include "distributed-simulator-impl.h"
+#include "null-message-simulator-impl.h"
+#include "remote-channel-bundle.h"
+#include "remote-channel-bundle-manager.h"
 
 namespace ns3 {
 
@@ -134,6 +139,29 @@ MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint
   g_parallelCommunicationInterface->SendPacket (p, rxTime, node, dev);
 }
 
+void
+MpiInterface::AddRemoteChannel (Ptr<Channel> channel, uint32_t systemId, Time delay)
+{
+  NS_LOG_FUNCTION (channel << systemId << delay);
+  NS_ASSERT (delay > Time (0));
+  Ptr<SimulatorImpl> impl = Simulator::GetImplementation ();
+  Ptr<DistributedSimulatorImpl> distributed = DynamicCast<DistributedSimulatorImpl> (impl);
+  if (distributed != 0)
+    {
+      // One window for all ranks
+      distributed->BoundLookAhead (delay);
+    }
+  else if (DynamicCast<NullMessageSimulatorImpl> (impl) != 0)
+    {
+      Ptr<RemoteChannelBundle> remoteChannelBundle = RemoteChannelBundleManager::Find (systemId);
+      if (!remoteChannelBundle)
+        {
+          remoteChannelBundle = RemoteChannelBundleManager::Add (systemId);
+        }
+      remoteChannelBundle->AddChannel (channel, delay);
+    }
+}
+
 MPI_Comm 
 MpiInterface::GetCommunicator()
 {
@@ -29,6 +29,7 @@
 
 #include <ns3/nstime.h>
 #include <ns3/packet.h>
+#include <ns3/channel.h>
 
 #include "mpi.h"
 
@@ -139,6 +140,22 @@ public:
    */
   static void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
 
+  /**
+   * \brief Declare a channel that sends packets to another rank.
+   *
+   * The parallel simulators find the point to point channels between
+   * ranks themselves and take their lookahead from the delays.  Other
+   * channels that send packets to a remote node declare here the
+   * smallest delay of those packets, after the parallel simulator is
+   * enabled and before Simulator::Run.  May be invoked more than once,
+   * the smallest delay per rank is used.
+   *
+   * \param channel channel sending the packets
+   * \param systemId rank of the receiving nodes
+   * \param delay smallest delay of a packet to that rank; must be > 0
+   */
+  static void AddRemoteChannel (Ptr<Channel> channel, uint32_t systemId, Time delay);
+
   /**
    * \brief Return the communicator used to run ns-3.
    *
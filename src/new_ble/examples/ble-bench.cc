@@ -0,0 +1,431 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// Scalability benchmark for the BLE module.
+//
+// Runs the cartesian product of the swept parameters and prints one
+// record per run with the simulator cost of that run:
+//
+//   ./waf --run "ble-bench --nodes=10,100,1000 --topologies=star,broadcast"
+//   ./waf --run "ble-bench --connIntervals=80,800,3200 --format=json"
+//
+// Every list option takes comma separated values. Peak RSS is the high
+// water mark of the whole process, so it only describes a single
+// configuration when one configuration is run per process.
+//
+// With scheduled TX windows each link of a node occupies 6 slots of
+// 1.25 ms, so the connection interval has to grow with the node degree
+// (mesh: nodes - 1, star: the hub has nodes - 1 links) or windows overlap.
+// The scheduled broadcast link only starts after n(n+1)/2 window offsets
+// and rotates the advertiser every interval; use --scheduled=0 or a
+// longer --duration for large broadcast runs.
+//
+// The range and nearest topologies only link nodes within --range meter
+// of each other or each node to its --neighbours nearest nodes, and only
+// set up a link when its first packet is sent. Every node sends to its
+// nearest node, if that node has a higher index. The flood topology
+// sends BLE Mesh PDUs for all nodes over the broadcast link, relayed by
+// every node.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/system-wall-clock-ms.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleBench");
+
+  /*****************
+   * Configuration *
+   *****************/
+
+  std::string nodesList = "10,50,100"; //!< Node counts to sweep
+  std::string connIntervalList = "3200";
+      //!< nbConnInterval values to sweep, in units of 1.25 ms
+  std::string intervalList = "4"; //!< Inter-packet times (s) to sweep
+  std::string topologyList = "star,mesh,broadcast"; //!< Topologies to sweep
+  double range = 10; //!< Link range of the range topology, in meter
+  uint32_t neighbours = 4; //!< Links per node of the nearest topology
+  double length = 30; //<! Square room with length as distance
+  int pktsize = 20; //!< Size of packets, in bytes
+  double duration = 20; //<! Simulated time per run, in seconds
+  bool scheduled = true; // Schedule the TX windows
+  std::string format = "csv"; //!< csv or json
+  std::string outputFile = ""; //!< Empty writes to stdout
+  std::string binaryTrace = ""; //!< Prefix of the binary traces, if any
+
+  uint64_t nbTx = 0;
+  uint64_t nbRx = 0;
+  uint64_t nbRxBroadcast = 0;
+  uint64_t nbRxError = 0;
+  uint64_t nbWindowsSkipped = 0;
+
+  /************************
+   * End of configuration *
+   ************************/
+
+// The trace sinks only count; they never copy the packet.
+void
+Transmitted (const Ptr<const Packet> packet)
+{
+  nbTx++;
+}
+
+void
+Received (const Ptr<const Packet> packet)
+{
+  nbRx++;
+}
+
+void
+ReceivedBroadcast (const Ptr<const Packet> packet,
+    const Ptr<const BleNetDevice> netdevice)
+{
+  nbRxBroadcast++;
+}
+
+void
+ReceivedError (const Ptr<const Packet> packet)
+{
+  nbRxError++;
+}
+
+void
+TXWindowSkipped (const Ptr<const BleNetDevice> nd)
+{
+  nbWindowsSkipped++;
+}
+
+template <typename T>
+std::vector<T>
+ParseList (std::string list)
+{
+  std::vector<T> values;
+  std::stringstream ss (list);
+  std::string item;
+  while (std::getline (ss, item, ','))
+    {
+      if (item.empty ())
+        continue;
+      std::stringstream is (item);
+      T value;
+      is >> value;
+      values.push_back (value);
+    }
+  return values;
+}
+
+// Peak resident set size of this process, in kilobytes
+long
+GetPeakRss (void)
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return -1;
+  return usage.ru_maxrss;
+}
+
+struct BenchResult
+{
+  std::string topology;
+  uint32_t nodes;
+  uint32_t connInterval;
+  double interval;
+  uint64_t links;
+  uint64_t events;
+  int64_t setupMs;
+  int64_t runMs;
+  long peakRssKb;
+};
+
+BenchResult
+RunOnce (std::string topology, uint32_t nNodes, uint32_t nbConnInterval,
+    double interval)
+{
+  nbTx = nbRx = nbRxBroadcast = nbRxError = nbWindowsSkipped = 0;
+
+  SystemWallClockMs setupClock;
+  setupClock.Start ();
+
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+
+  MobilityHelper mobility;
+  std::stringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0.0|Max=" << length << "]";
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+      "X", StringValue (bound.str ()), "Y", StringValue (bound.str ()),
+      "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (bleDeviceNodes);
+
+  NetDeviceContainer bleNetDevices = helper.Install (bleDeviceNodes);
+
+  // Number the devices 00:01, 00:02, ... so every run uses the same
+  // addresses, independent of how many runs came before.
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      uint8_t buffer[2];
+      buffer[0] = ((nodeI + 1) >> 8) & 0xff;
+      buffer[1] = (nodeI + 1) & 0xff;
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+        ->SetAddress (address);
+    }
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (interval));
+  uint64_t links = 0;
+  ApplicationContainer apps;
+  if (topology == "mesh")
+    {
+      helper.CreateAllLinks (bleNetDevices, scheduled, nbConnInterval);
+      links = (uint64_t) nNodes * (nNodes - 1) / 2;
+      apps = helper.GenerateTraffic (
+          randT, bleDeviceNodes, pktsize, 0, duration, interval);
+    }
+  else if (topology == "broadcast")
+    {
+      helper.CreateBroadcastLink (
+          bleNetDevices, scheduled, nbConnInterval, true);
+      links = 1;
+      apps = helper.GenerateBroadcastTraffic (
+          randT, bleDeviceNodes, pktsize, 0, duration, interval);
+    }
+  else if (topology == "flood")
+    {
+      // Every node floods mesh PDUs to all nodes, every node relays
+      helper.CreateBroadcastLink (
+          bleNetDevices, scheduled, nbConnInterval, true);
+      helper.InstallMesh (bleNetDevices);
+      links = 1;
+      for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+        apps.Add (helper.GenerateMeshTraffic (randT,
+              bleDeviceNodes.Get (nodeI), pktsize, 0, duration, interval,
+              Mac16Address ("FF:FF")));
+    }
+  else if (topology == "range" || topology == "nearest")
+    {
+      if (topology == "range")
+        helper.CreateLinksInRange (bleNetDevices, range, scheduled,
+            nbConnInterval, true);
+      else
+        helper.CreateLinksToNearest (bleNetDevices, neighbours, scheduled,
+            nbConnInterval, true);
+      for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+        {
+          links += DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+            ->GetBBManager ()->CountPotentialLinks ();
+          // The first sender of a lazy link becomes its master, so only
+          // send towards higher indices to keep one master per link.
+          Ptr<MobilityModel> mobility =
+            bleDeviceNodes.Get (nodeI)->GetObject<MobilityModel> ();
+          uint32_t nearest = nodeI;
+          double nearestDistance = 0;
+          for (uint32_t nodeJ = 0; nodeJ < nNodes; nodeJ++)
+            {
+              if (nodeJ == nodeI)
+                continue;
+              double distance = mobility->GetDistanceFrom (
+                  bleDeviceNodes.Get (nodeJ)->GetObject<MobilityModel> ());
+              if (nearest == nodeI || distance < nearestDistance)
+                {
+                  nearest = nodeJ;
+                  nearestDistance = distance;
+                }
+            }
+          if (nearest > nodeI
+              && (topology == "nearest" || nearestDistance <= range))
+            apps.Add (helper.GenerateTraffic (randT,
+                  bleDeviceNodes.Get (nodeI), pktsize, 0, duration, interval,
+                  bleDeviceNodes.Get (nearest)));
+        }
+      links /= 2;
+    }
+  else
+    {
+      NS_ABORT_MSG_UNLESS (topology == "star",
+          "Unknown topology " << topology);
+      // Node 0 is the hub; every leaf is master of its link to the hub
+      // and sends to it (data only flows from master to slave).
+      Ptr<BleBBManager> hub = DynamicCast<BleNetDevice> (
+          bleNetDevices.Get (0))->GetBBManager ();
+      for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+        {
+          DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+            ->GetBBManager ()->CreateLinkScheduled (hub,
+                BleLinkManager::Role::MASTER_ROLE, scheduled, nodeI - 1,
+                nbConnInterval);
+          apps.Add (helper.GenerateTraffic (randT, bleDeviceNodes.Get (nodeI),
+                pktsize, 0, duration, interval, bleDeviceNodes.Get (0)));
+          links++;
+        }
+    }
+
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    {
+      Ptr<BleNetDevice> nd = DynamicCast<BleNetDevice> (bleNetDevices.Get (i));
+      nd->TraceConnectWithoutContext ("MacTx", MakeCallback (&Transmitted));
+      nd->TraceConnectWithoutContext ("MacRx", MakeCallback (&Received));
+      nd->TraceConnectWithoutContext ("MacRxBroadcast",
+          MakeCallback (&ReceivedBroadcast));
+      nd->TraceConnectWithoutContext ("MacRxError",
+          MakeCallback (&ReceivedError));
+      nd->TraceConnectWithoutContext ("TXWindowSkipped",
+          MakeCallback (&TXWindowSkipped));
+    }
+
+  if (!binaryTrace.empty ())
+    {
+      std::ostringstream filename;
+      filename << binaryTrace << "-" << topology << "-" << nNodes << "-"
+        << nbConnInterval << ".bin";
+      helper.EnableBinaryTrace (filename.str (), bleNetDevices);
+    }
+
+  BenchResult result;
+  result.setupMs = setupClock.End ();
+
+  SystemWallClockMs runClock;
+  runClock.Start ();
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  result.runMs = runClock.End ();
+  result.events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  result.topology = topology;
+  result.nodes = nNodes;
+  result.connInterval = nbConnInterval;
+  result.interval = interval;
+  result.links = links;
+  result.peakRssKb = GetPeakRss ();
+  return result;
+}
+
+void
+PrintHeader (std::ostream &os)
+{
+  if (format == "csv")
+    {
+      os << "topology,nodes,links,connInterval,interval,simTime,"
+        "setupMs,runMs,events,eventsPerWallSecond,eventsPerSimSecond,"
+        "peakRssKb,tx,rx,rxBroadcast,rxError,txWindowsSkipped" << std::endl;
+    }
+}
+
+void
+PrintResult (std::ostream &os, const BenchResult &r)
+{
+  double eventsPerWallSecond =
+    r.runMs > 0 ? r.events * 1000.0 / r.runMs : 0;
+  double eventsPerSimSecond = r.events / duration;
+  if (format == "json")
+    {
+      // One object per line so partial sweeps stay parseable.
+      os << "{\"topology\":\"" << r.topology << "\""
+        << ",\"nodes\":" << r.nodes
+        << ",\"links\":" << r.links
+        << ",\"connInterval\":" << r.connInterval
+        << ",\"interval\":" << r.interval
+        << ",\"simTime\":" << duration
+        << ",\"setupMs\":" << r.setupMs
+        << ",\"runMs\":" << r.runMs
+        << ",\"events\":" << r.events
+        << ",\"eventsPerWallSecond\":" << eventsPerWallSecond
+        << ",\"eventsPerSimSecond\":" << eventsPerSimSecond
+        << ",\"peakRssKb\":" << r.peakRssKb
+        << ",\"tx\":" << nbTx
+        << ",\"rx\":" << nbRx
+        << ",\"rxBroadcast\":" << nbRxBroadcast
+        << ",\"rxError\":" << nbRxError
+        << ",\"txWindowsSkipped\":" << nbWindowsSkipped
+        << "}" << std::endl;
+    }
+  else
+    {
+      os << r.topology << "," << r.nodes << "," << r.links << ","
+        << r.connInterval << "," << r.interval << "," << duration << ","
+        << r.setupMs << "," << r.runMs << "," << r.events << ","
+        << eventsPerWallSecond << "," << eventsPerSimSecond << ","
+        << r.peakRssKb << "," << nbTx << "," << nbRx << ","
+        << nbRxBroadcast << "," << nbRxError << "," << nbWindowsSkipped
+        << std::endl;
+    }
+}
+
+int main (int argc, char** argv)
+{
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Comma separated node counts", nodesList);
+  cmd.AddValue ("connIntervals",
+      "Comma separated connection intervals, in units of 1.25 ms",
+      connIntervalList);
+  cmd.AddValue ("intervals",
+      "Comma separated inter-packet times per node, in seconds",
+      intervalList);
+  cmd.AddValue ("topologies",
+      "Comma separated list of star, mesh, broadcast, range, nearest, flood",
+      topologyList);
+  cmd.AddValue ("range", "Link range of the range topology, in meter",
+      range);
+  cmd.AddValue ("neighbours", "Links per node of the nearest topology",
+      neighbours);
+  cmd.AddValue ("length", "Side of the square field, in meter", length);
+  cmd.AddValue ("pktSize", "Application payload size, in bytes", pktsize);
+  cmd.AddValue ("duration", "Simulated time per run, in seconds", duration);
+  cmd.AddValue ("scheduled", "Schedule the TX windows", scheduled);
+  cmd.AddValue ("format", "Output format: csv or json", format);
+  cmd.AddValue ("output", "Output file, stdout if empty", outputFile);
+  cmd.AddValue ("binaryTrace",
+      "Write a binary trace per run with this file name prefix", binaryTrace);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (format == "csv" || format == "json",
+      "Unknown format " << format);
+
+  std::ofstream file;
+  if (!outputFile.empty ())
+    file.open (outputFile.c_str ());
+  std::ostream &os = outputFile.empty () ? std::cout : file;
+
+  PrintHeader (os);
+  for (std::string topology : ParseList<std::string> (topologyList))
+    for (uint32_t nNodes : ParseList<uint32_t> (nodesList))
+      for (uint32_t nbConnInterval : ParseList<uint32_t> (connIntervalList))
+        for (double interval : ParseList<double> (intervalList))
+          {
+            NS_LOG_INFO ("Running " << topology << " with " << nNodes
+                << " nodes");
+            BenchResult r = RunOnce (topology, nNodes, nbConnInterval,
+                interval);
+            PrintResult (os, r);
+          }
+  return 0;
+}
@@ -76,98 +76,12 @@ NS_LOG_COMPONENT_DEFINE ("BleBroadcastExample");
   Ptr<OutputStreamWrapper> m_stream = 0; // Stream for waterfallcurve
   Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
 
-  std::unordered_map<uint32_t,std::tuple<uint32_t,uint32_t,uint32_t,
-    uint32_t,uint32_t,uint32_t,uint32_t,uint32_t> > errorMap;
   std::unordered_map<uint32_t,Ptr<BleNetDevice> > deviceMap;
 
   /************************
    * End of configuration *
    ************************/
 
-/// Save that the message has been transmitted
-	void
-Transmitted (const Ptr<const Packet> packet)
-{
-	Ptr<Packet> copy = packet->Copy();
-	BleMacHeader header;
-	copy->RemoveHeader(header);
-    uint8_t buffer[2];
-    header.GetSrcAddr().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-
-    //NS_LOG (LOG_DEBUG, "Packet transmitted  " << packet << " src addr = " << addr);
-	std::get<0>(errorMap[addr-1])++;
-}
-
-// save that a message has been received
-	void
-Received (const Ptr<const Packet> packet)
-{
-  //NS_LOG (LOG_DEBUG, "Packet received  " << packet);
-	Ptr<Packet> copy = packet->Copy();
-	BleMacHeader header;
-	copy->RemoveHeader(header);
-	uint8_t buffer[2];
-    header.GetDestAddr().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-    std::get<1>(errorMap[addr-1])++;
-}
-
-  void
-ReceivedError (const Ptr<const Packet> packet)
-{
-  //NS_LOG (LOG_DEBUG, "Packet received  " << packet);
-	Ptr<Packet> copy = packet->Copy();
-	BleMacHeader header;
-	copy->RemoveHeader(header);
-	uint8_t buffer[2];
-    header.GetDestAddr().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-    std::get<3>(errorMap[addr-1])++;
-}
-
-
-// save that a message has been uniquely received
-	void
-ReceivedUnique (const Ptr<const Packet> packet)
-{
-	Ptr<Packet> copy = packet->Copy();
-	BleMacHeader header;
-	copy->RemoveHeader(header);
-	uint8_t buffer[2];
-    header.GetDestAddr().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-    //NS_LOG (LOG_DEBUG, "Packet unique received  " 
-    //<< packet << " dest addr = " << addr);
-	std::get<2>(errorMap[addr-1])++;
-}
-
-	void
-ReceivedBroadcast (const Ptr<const Packet> packet, 
-    const Ptr<const BleNetDevice>  netdevice)
-{
-	Ptr<Packet> copy = packet->Copy();
-	BleMacHeader header;
-	copy->RemoveHeader(header);
-	uint8_t buffer[2];
-    netdevice->GetAddress16().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-    //NS_LOG (LOG_DEBUG, "Packet unique received  " 
-    //<< packet << " dest addr = " << addr);
-	std::get<4>(errorMap[addr-1])++;
-}
-
-  void
-TXWindowSkipped (const Ptr<const BleNetDevice> nd)
-{
-  //NS_LOG (LOG_DEBUG, "Packet received  " << packet);
-	uint8_t buffer[2];
-    nd->GetAddress16().CopyTo(buffer);
-    uint32_t addr = buffer[1];
-    std::get<5>(errorMap[addr-1])++;
-}
-
-
 int main (int argc, char** argv)
 {
   bool verbose = false;
@@ -275,6 +189,7 @@ int main (int argc, char** argv)
     
      // Hookup functions to measure performance
 
+    Ptr<BleStatsCollector> stats = helper.EnableStatistics (bleNetDevices);
     for (uint32_t i=0; i< bleNetDevices.GetN(); i++)
     {
       uint8_t buffer[2];
@@ -282,29 +197,6 @@ int main (int argc, char** argv)
           bleNetDevices.Get(i)->GetAddress()).CopyTo(buffer);
       uint32_t addr = buffer[1];  
       deviceMap[addr ]=DynamicCast<BleNetDevice>(bleNetDevices.Get(i));
-      uint32_t x  = bleNetDevices.Get(i)->GetNode()
-        ->GetObject<MobilityModel>()->GetPosition ().x;
-      uint32_t y  = bleNetDevices.Get(i)
-        ->GetNode()->GetObject<MobilityModel>()->GetPosition ().y;
-      errorMap[addr-1] = std::make_tuple (0,0,0,0,0,0,x,y);
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "MacTx",MakeCallback(&Transmitted));
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "MacRx",MakeCallback(&ReceivedUnique));
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "MacRxBroadcast",MakeCallback(&ReceivedBroadcast));
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "MacPromiscRx",MakeCallback(&Received));
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "MacRxError",MakeCallback(&ReceivedError));
-      DynamicCast<BleNetDevice>(
-          bleNetDevices.Get(i))->TraceConnectWithoutContext (
-          "TXWindowSkipped",MakeCallback(&TXWindowSkipped));
     }
 
     NS_LOG (LOG_INFO, "Simulator will run now");
@@ -321,19 +213,20 @@ int main (int argc, char** argv)
             Ptr<BleNetDevice> netdevice =
               DynamicCast<BleNetDevice>(bleNetDevices.Get(i));
             NS_LOG (LOG_DEBUG, "nd = " << netdevice << " addr = " << addr);
-			std::tuple<uint32_t,uint32_t,uint32_t,uint32_t,uint32_t,
-              uint32_t,uint32_t,uint32_t> tuple = errorMap[i];
+			BleNodeStats nodeStats =
+              stats->GetNodeStats (netdevice->GetNode ()->GetId ());
+            Vector position = netdevice->GetNode ()
+              ->GetObject<MobilityModel> ()->GetPosition ();
 			// print iteration, ID, transmitted, received, 
             // received unique, x coords, y coords.
 			*m_stream->GetStream() << (int)iterationI << "," 
-              << netdevice->GetAddress16() << "," << std::get<0>(tuple)
-              << "," << std::get<1>(tuple) << "," <<   std::get<2>(tuple) 
-              <<  "," << std::get<3>(tuple) << "," << std::get<4>(tuple) 
-              << "," << std::get<5>(tuple)  << "," << std::get<6>(tuple) 
-              << "," << std::get<7>(tuple) << std::endl;
+              << netdevice->GetAddress16() << "," << nodeStats.tx
+              << "," << nodeStats.promiscRx << "," << nodeStats.rx
+              << "," << nodeStats.rxError << "," << nodeStats.rxBroadcast
+              << "," << nodeStats.txWindowsSkipped << "," << (uint32_t) position.x 
+              << "," << (uint32_t) position.y << std::endl;
 		
     }
-    errorMap.clear();
     Simulator::Destroy ();
 
   }
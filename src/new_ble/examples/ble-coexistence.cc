@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+// BLE connections next to 2.4 GHz Wi-Fi networks.
+//
+// Node 0 is a central with a connection to every peripheral, the
+// peripherals send to it. The Wi-Fi access points are spread over the
+// same disc and use channels 1, 6 and 11 in turn:
+//
+//   ./waf --run "ble-coexistence --peripherals=8 --wifi=3 --dutyCycle=0.3"
+//   ./waf --run "ble-coexistence --wifi=20 --wifiPower=20"
+//
+// Prints the receptions and bit errors per BLE channel, the channels
+// under a Wi-Fi channel lose most packets, the ones next to it only
+// when the interferer is close.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleCoexistence");
+
+int main (int argc, char** argv)
+{
+  uint32_t nPeripherals = 8;
+  uint32_t nWifi = 3;
+  double wifiPower = 15; // dBm
+  double dutyCycle = 0.3;
+  double rho = 10;
+  uint32_t packetSize = 20;
+  double interval = 0.05; // Seconds between two packets of a peripheral
+  uint32_t nbConnInterval = 40; // 50 ms
+  double duration = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("peripherals", "Number of BLE peripherals", nPeripherals);
+  cmd.AddValue ("wifi", "Number of Wi-Fi interferers", nWifi);
+  cmd.AddValue ("wifiPower", "Transmit power of the Wi-Fi interferers (dBm)",
+      wifiPower);
+  cmd.AddValue ("dutyCycle", "Airtime share of every Wi-Fi interferer",
+      dutyCycle);
+  cmd.AddValue ("rho", "Radius of the disc with all nodes in meter", rho);
+  cmd.AddValue ("packetSize", "Size of a packet in bytes", packetSize);
+  cmd.AddValue ("interval", "Seconds between two packets", interval);
+  cmd.AddValue ("connInterval",
+      "Connection interval in units of 1.25 ms", nbConnInterval);
+  cmd.AddValue ("duration", "Duration in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  uint32_t nNodes = nPeripherals + 1;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  NodeContainer wifiNodes;
+  wifiNodes.Create (nWifi);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+      "rho", DoubleValue (rho), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+  mobility.Install (wifiNodes);
+
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    pairs.push_back (std::make_pair (0, nodeI));
+  helper.CreateLinks (bleNetDevices, pairs, true, nbConnInterval, false);
+
+  uint8_t wifiChannels[] = {1, 6, 11};
+  for (uint32_t i = 0; i < nWifi; i++)
+    {
+      helper.AddWifiInterferers (NodeContainer (wifiNodes.Get (i)),
+          wifiChannels[i % 3], wifiPower, dutyCycle);
+    }
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (interval));
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    {
+      helper.GenerateTraffic (randT, nodes.Get (nodeI), packetSize, 1,
+          duration, interval, nodes.Get (0));
+    }
+  Ptr<BleStatsCollector> stats = helper.EnableStatistics (bleNetDevices);
+
+  Simulator::Stop (Seconds (duration + 2));
+  Simulator::Run ();
+
+  std::cout << "channel,phyRx,phyRxError,errorRatio" << std::endl;
+  for (uint8_t channel = 0; channel < BleStatsCollector::NB_CHANNELS;
+      channel++)
+    {
+      const BleChannelStats &s = stats->GetChannelStats (channel);
+      uint64_t total = s.phyRx + s.phyRxError;
+      std::cout << (uint32_t) channel << "," << s.phyRx
+        << "," << s.phyRxError
+        << "," << (total ? (double) s.phyRxError / total : 0) << std::endl;
+    }
+  BleNodeStats total = stats->GetTotal ();
+  std::cout << "Packets sent: " << total.tx << ", received: " << total.rx
+    << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
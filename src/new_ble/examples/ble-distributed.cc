@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// A grid of BLE nodes simulated by several MPI ranks, each rank owns a
+// strip of columns. The devices are on a BleRemoteLinkChannel, which
+// sends the transmissions to the nodes of other ranks over MPI:
+//
+//   mpirun -np 2 ./waf --run "ble-distributed --nodes=64"
+//   mpirun -np 2 ./waf --run "ble-distributed --nodes=64 --nullmsg=1"
+//
+// Every node has a link to its right and lower neighbour and the nodes
+// of the first row send to their right neighbour, across the strips.
+// The lookahead is the smallest propagation delay between two nodes of
+// different ranks in range, so the further apart the strips are (see
+// --gap), the larger the time windows of the ranks. With a lookahead of
+// a few nanoseconds the null message synchronisation sends a message per
+// lookahead to every neighbouring rank and is only practical for short
+// runs, the granted time window one waits for all ranks instead.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/mpi-interface.h>
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleDistributed");
+
+static void
+IncrementCounter (uint64_t *counter, Ptr<const Packet> packet)
+{
+  (*counter)++;
+}
+
+int main (int argc, char** argv)
+{
+  uint32_t nNodes = 64;
+  double distance = 5.0;
+  double gap = 0.0;
+  double duration = 5;
+  bool nullmsg = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nNodes);
+  cmd.AddValue ("distance", "Distance between the nodes of the grid in meter",
+      distance);
+  cmd.AddValue ("gap", "Extra distance between two strips in meter", gap);
+  cmd.AddValue ("duration", "Duration of the traffic in seconds", duration);
+  cmd.AddValue ("nullmsg", "Use the null message synchronisation", nullmsg);
+  cmd.Parse (argc, argv);
+
+  if (nullmsg)
+    GlobalValue::Bind ("SimulatorImplementationType",
+        StringValue ("ns3::NullMessageSimulatorImpl"));
+  else
+    GlobalValue::Bind ("SimulatorImplementationType",
+        StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+  uint32_t rank = MpiInterface::GetSystemId ();
+  uint32_t nRanks = MpiInterface::GetSize ();
+
+  // Every rank creates all nodes, a node belongs to the rank of its strip
+  uint32_t width = std::ceil (std::sqrt (nNodes));
+  NodeContainer nodes;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t column = i % width;
+      uint32_t strip = column * nRanks / width;
+      nodes.Add (CreateObject<Node> (strip));
+      positions->Add (Vector (column * distance + strip * gap,
+            (i / width) * distance, 1.0));
+    }
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (positions);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  BleHelper helper;
+  helper.SetLinkAbstraction (true);
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  // The same streams on every rank
+  helper.AssignStreams (bleNetDevices, 0);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      if ((i + 1) % width != 0 && i + 1 < nNodes)
+        pairs.push_back (std::make_pair (i, i + 1));
+      if (i + width < nNodes)
+        pairs.push_back (std::make_pair (i, i + width));
+    }
+  helper.CreateLinks (bleNetDevices, pairs, true, 80, false);
+
+  // Only the nodes of this rank send and count
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  uint64_t rx = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      if (nodes.Get (i)->GetSystemId () != rank)
+        continue;
+      bleNetDevices.Get (i)->TraceConnectWithoutContext ("MacRx",
+          MakeBoundCallback (&IncrementCounter, &rx));
+      if (i + 1 < width)
+        helper.GenerateTraffic (randT, nodes.Get (i), 20, 1, duration, 0.5,
+            nodes.Get (i + 1));
+    }
+
+  Ptr<BleRemoteLinkChannel> channel =
+    DynamicCast<BleRemoteLinkChannel> (helper.GetLinkChannel ());
+  Time lookAhead = channel->BoundLookAhead ();
+  std::cout << "Rank " << rank << " of " << nRanks << ": lookahead "
+    << lookAhead.GetSeconds () * 1e9 << " ns" << std::endl;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (duration + 2));
+  Simulator::Run ();
+  std::cout << "Rank " << rank << ": packets received: " << rx
+    << ", simulated in " << clock.End () << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+}
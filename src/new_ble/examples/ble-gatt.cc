@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// GATT goodput and latency of sensors that report to one collector.
+//
+// Node 0 is the collector, every other node a sensor with a connection
+// to it. The sensors send their samples as notifications, indications
+// or write commands, optionally coalesced into fewer PDUs:
+//
+//   ./waf --run "ble-gatt --sensors=4 --mode=Notify --coalesce=1"
+//   ./waf --run "ble-gatt --sensors=4 --mode=Indicate --coalesce=8"
+//
+// Prints one line per sensor with the samples and PDUs sent, the samples
+// received by the collector, the goodput (attribute value bytes per
+// second) and the mean and maximum delay of the oldest sample of a PDU.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleGatt");
+
+struct SensorStats
+{
+  uint64_t pdus = 0;
+  Time totalDelay;
+  Time maxDelay;
+};
+
+static void
+SamplesRx (SensorStats *stats, Ptr<const Packet> packet, uint32_t samples,
+    Time delay)
+{
+  stats->pdus++;
+  stats->totalDelay += delay;
+  stats->maxDelay = Max (stats->maxDelay, delay);
+}
+
+int main (int argc, char** argv)
+{
+  uint32_t nSensors = 4;
+  std::string mode = "Notify";
+  uint32_t coalesce = 1;
+  double coalesceTimeout = 1.0; // Seconds
+  uint32_t sampleSize = 8;
+  double interval = 0.05; // Seconds between two samples
+  uint32_t mtu = 247;
+  uint32_t nbConnInterval = 40; // 50 ms
+  double duration = 20;
+
+  CommandLine cmd;
+  cmd.AddValue ("sensors", "Number of sensors", nSensors);
+  cmd.AddValue ("mode", "Notify, Indicate or WriteWithoutResponse", mode);
+  cmd.AddValue ("coalesce", "Maximum samples per PDU", coalesce);
+  cmd.AddValue ("coalesceTimeout",
+      "Maximum time in seconds a sample waits for a PDU to fill",
+      coalesceTimeout);
+  cmd.AddValue ("sampleSize", "Size of a sample in bytes", sampleSize);
+  cmd.AddValue ("interval", "Seconds between two samples", interval);
+  cmd.AddValue ("mtu", "ATT_MTU of every device", mtu);
+  cmd.AddValue ("connInterval",
+      "Connection interval in units of 1.25 ms", nbConnInterval);
+  cmd.AddValue ("duration", "Duration in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  uint32_t nNodes = nSensors + 1;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+      "rho", DoubleValue (5.0), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    pairs.push_back (std::make_pair (0, nodeI));
+  helper.CreateLinks (bleNetDevices, pairs, true, nbConnInterval, false);
+
+  helper.SetGattAttribute ("Mode", StringValue (mode));
+  helper.SetGattAttribute ("Mtu", UintegerValue (mtu));
+  helper.SetGattAttribute ("CoalesceSamples", UintegerValue (coalesce));
+  helper.SetGattAttribute ("CoalesceTimeout",
+      TimeValue (Seconds (coalesceTimeout)));
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (interval));
+  std::vector<SensorStats> stats (nNodes);
+  std::vector<Ptr<BleGattApplication> > sensors, sinks;
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    {
+      ApplicationContainer apps = helper.GenerateGattTraffic (randT,
+          nodes.Get (nodeI), nodes.Get (0), sampleSize, 1, duration, interval);
+      sensors.push_back (DynamicCast<BleGattApplication> (apps.Get (0)));
+      sinks.push_back (DynamicCast<BleGattApplication> (apps.Get (1)));
+      sinks.back ()->TraceConnectWithoutContext ("SamplesRx",
+          MakeBoundCallback (&SamplesRx, &stats[nodeI]));
+    }
+
+  Simulator::Stop (Seconds (duration + 2));
+  Simulator::Run ();
+
+  std::cout << "sensor,mtu,txSamples,txPdus,rxSamples,goodputBps,"
+    "delayMeanMs,delayMaxMs" << std::endl;
+  for (uint32_t i = 0; i < nSensors; i++)
+    {
+      const SensorStats &s = stats[i + 1];
+      double meanMs = s.pdus ? s.totalDelay.GetSeconds () * 1000 / s.pdus : 0;
+      std::cout << i + 1 << "," << sensors[i]->GetMtu ()
+        << "," << sensors[i]->GetTxSamples ()
+        << "," << sensors[i]->GetTxPdus ()
+        << "," << sinks[i]->GetRxSamples ()
+        << "," << sinks[i]->GetRxBytes () / duration
+        << "," << meanMs
+        << "," << s.maxDelay.GetSeconds () * 1000 << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+// Delivery before the deadline of connected isochronous streams.
+//
+// Node 0 is the central with a CIS to every other node. Both sides send
+// an SDU every ISO interval; a payload that is not acknowledged within
+// FlushTimeout ISO intervals is flushed:
+//
+//   ./waf --run "ble-iso --peripherals=4 --nse=2 --ft=1 --rho=25"
+//   ./waf --run "ble-iso --peripherals=4 --nse=4 --ft=2 --rho=25"
+//
+// Prints one line per stream with the payloads taken from the queue,
+// acknowledged and flushed, the fraction delivered before the flush point
+// and the largest latency. The ISO interval is the connection interval
+// and every link gets 6 slots of 1.25 ms in it, so use at least 8 units
+// per peripheral.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleIso");
+
+static void
+Acked (Time *maxLatency, Ptr<const Packet> packet, Time delay)
+{
+  *maxLatency = Max (*maxLatency, delay);
+}
+
+int main (int argc, char** argv)
+{
+  uint32_t nPeripherals = 4;
+  uint32_t nse = 2;
+  uint32_t bn = 1;
+  uint32_t ft = 1;
+  uint32_t sduSize = 40;
+  uint32_t nbConnInterval = 32; // 40 ms
+  double rho = 10.0; // Radius of the disc with the peripherals in meter
+  double duration = 20;
+
+  CommandLine cmd;
+  cmd.AddValue ("peripherals", "Number of peripherals", nPeripherals);
+  cmd.AddValue ("nse", "Sub-events per ISO event", nse);
+  cmd.AddValue ("bn", "Burst number, new payloads per ISO event", bn);
+  cmd.AddValue ("ft", "Flush timeout in ISO intervals", ft);
+  cmd.AddValue ("sduSize", "Size of an SDU in bytes", sduSize);
+  cmd.AddValue ("connInterval",
+      "ISO interval in units of 1.25 ms", nbConnInterval);
+  cmd.AddValue ("rho", "Radius of the disc with the peripherals in meter",
+      rho);
+  cmd.AddValue ("duration", "Duration in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  uint32_t nNodes = nPeripherals + 1;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+      "rho", DoubleValue (rho), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    pairs.push_back (std::make_pair (0, nodeI));
+  helper.CreateLinks (bleNetDevices, pairs, true, nbConnInterval, false);
+
+  helper.SetIsoAttribute ("SubEvents", UintegerValue (nse));
+  helper.SetIsoAttribute ("BurstNumber", UintegerValue (bn));
+  helper.SetIsoAttribute ("FlushTimeout", UintegerValue (ft));
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0));
+  double isoInterval = nbConnInterval * 0.00125;
+  Ptr<BleNetDevice> central = DynamicCast<BleNetDevice> (bleNetDevices.Get (0));
+  std::vector<Ptr<BleIsoStream> > streams;
+  std::vector<std::string> names;
+  for (uint32_t nodeI = 1; nodeI < nNodes; nodeI++)
+    {
+      Ptr<BleNetDevice> peripheral =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI));
+      helper.EnableCis (central, peripheral);
+      streams.push_back (
+          helper.GetIsoStream (central, peripheral->GetAddress16 ()));
+      names.push_back ("0->" + std::to_string (nodeI));
+      streams.push_back (
+          helper.GetIsoStream (peripheral, central->GetAddress16 ()));
+      names.push_back (std::to_string (nodeI) + "->0");
+      helper.GenerateTraffic (randT, nodes.Get (0), sduSize, 1, duration,
+          isoInterval, nodes.Get (nodeI));
+      helper.GenerateTraffic (randT, nodes.Get (nodeI), sduSize, 1, duration,
+          isoInterval, nodes.Get (0));
+    }
+  std::vector<Time> maxLatency (streams.size ());
+  for (uint32_t i = 0; i < streams.size (); i++)
+    {
+      streams[i]->TraceConnectWithoutContext ("Ack",
+          MakeBoundCallback (&Acked, &maxLatency[i]));
+    }
+
+  Simulator::Stop (Seconds (duration + 2));
+  Simulator::Run ();
+
+  std::cout << "stream,txPayloads,acked,flushed,transmissions,"
+    "deliveredRatio,latencyMaxMs" << std::endl;
+  for (uint32_t i = 0; i < streams.size (); i++)
+    {
+      Ptr<BleIsoStream> s = streams[i];
+      uint64_t done = s->GetAckedPayloads () + s->GetFlushedPayloads ();
+      std::cout << names[i] << "," << s->GetTxPayloads ()
+        << "," << s->GetAckedPayloads ()
+        << "," << s->GetFlushedPayloads ()
+        << "," << s->GetTransmissions ()
+        << "," << (done ? double (s->GetAckedPayloads ()) / done : 0)
+        << "," << maxLatency[i].GetSeconds () * 1000 << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
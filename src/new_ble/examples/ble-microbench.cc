@@ -0,0 +1,516 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// Microbenchmarks of the per-packet paths of the BLE PHY and MAC.
+//
+// Every benchmark repeats one operation, growing the number of iterations
+// until a run takes at least --minTime seconds, and reports the wall clock
+// and CPU time per iteration:
+//
+//   ./waf --run "ble-microbench"
+//   ./waf --run "ble-microbench --filter=BlePhy --format=json --output=phy.json"
+//
+// The JSON output has the layout of Google Benchmark (a context and a
+// list of benchmarks with real_time and cpu_time in ns), so the tools that
+// compare two of its result files work on these too. Only compare runs of
+// the same build profile; the profile and --enable-ble-fast-path are in
+// the context.
+//
+// The PHY benchmarks need simulated time: their iterations are scheduled
+// receptions (BlePhy/Reception, with StartRx, EndRx and the UpdateBer of
+// every signal start and end) or BER updates during one long reception
+// (BlePhy/UpdateBer, the argument is the number of bits since the last
+// update). Their time includes the scheduling of the events.
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleMicrobench");
+
+// Results that nothing reads would let the compiler drop the operation
+static volatile double g_sink = 0;
+
+// Measures the timed part of a benchmark, the set up is not counted
+class BenchTimer
+{
+public:
+  BenchTimer ();
+  void Start (void);
+  void Stop (void);
+  double GetRealSeconds (void) const;
+  double GetCpuSeconds (void) const;
+
+private:
+  std::chrono::steady_clock::time_point m_realStart;
+  std::clock_t m_cpuStart;
+  double m_real;
+  double m_cpu;
+};
+
+BenchTimer::BenchTimer ()
+  : m_cpuStart (0),
+    m_real (0),
+    m_cpu (0)
+{
+}
+
+void
+BenchTimer::Start (void)
+{
+  m_cpuStart = std::clock ();
+  m_realStart = std::chrono::steady_clock::now ();
+}
+
+void
+BenchTimer::Stop (void)
+{
+  m_real += std::chrono::duration<double> (
+      std::chrono::steady_clock::now () - m_realStart).count ();
+  m_cpu += double (std::clock () - m_cpuStart) / CLOCKS_PER_SEC;
+}
+
+double
+BenchTimer::GetRealSeconds (void) const
+{
+  return m_real;
+}
+
+double
+BenchTimer::GetCpuSeconds (void) const
+{
+  return m_cpu;
+}
+
+// Runs iterations times the operation of a benchmark with argument arg
+typedef void (*BenchFunction) (BenchTimer &timer, uint64_t iterations,
+    uint32_t arg);
+
+struct Benchmark
+{
+  std::string name;
+  BenchFunction function;
+  uint32_t arg;
+};
+
+struct BenchResult
+{
+  std::string name;
+  uint64_t iterations;
+  double realNs; // Per iteration
+  double cpuNs;
+};
+
+  /*****************
+   * Configuration *
+   *****************/
+
+  std::string filter = ""; //!< Only run the benchmarks whose name has this
+  double minTime = 0.5; //!< Minimum time of the measured run, in seconds
+  std::string format = "console"; //!< console or json
+  std::string outputFile = ""; //!< Empty writes to stdout
+
+  /************************
+   * End of configuration *
+   ************************/
+
+/*
+ * BleErrorModel and BleMacHeader
+ */
+
+void
+BenchGetBer (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  Ptr<BleErrorModel> model = CreateObject<BleErrorModel> ();
+  // SNRs from well below to well above the waterfall of the BER curve
+  std::vector<double> snrs;
+  for (uint32_t i = 0; i < 64; i++)
+    snrs.push_back (std::pow (10.0, (i - 16) / 16.0));
+  long double sum = 0;
+  timer.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    sum += model->GetBER (snrs[i % 64]);
+  timer.Stop ();
+  g_sink = sum;
+}
+
+BleMacHeader
+MakeHeader (void)
+{
+  BleMacHeader header;
+  header.SetLLID (0b10);
+  header.SetNESN (1);
+  header.SetSN (0);
+  header.SetMD (1);
+  header.SetLength (27);
+  header.SetSrcAddr (Mac16Address ("00:01"));
+  header.SetDestAddr (Mac16Address ("00:02"));
+  header.SetProtocol (0x86DD);
+  return header;
+}
+
+void
+BenchSerialize (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  BleMacHeader header = MakeHeader ();
+  Buffer buffer;
+  buffer.AddAtStart (header.GetSerializedSize ());
+  timer.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    header.Serialize (buffer.Begin ());
+  timer.Stop ();
+  g_sink = buffer.Begin ().ReadU8 ();
+}
+
+void
+BenchDeserialize (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  Buffer buffer;
+  buffer.AddAtStart (MakeHeader ().GetSerializedSize ());
+  MakeHeader ().Serialize (buffer.Begin ());
+  BleMacHeader header;
+  uint64_t sum = 0;
+  timer.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    sum += header.Deserialize (buffer.Begin ());
+  timer.Stop ();
+  g_sink = sum + header.GetLength ();
+}
+
+/*
+ * BlePhy
+ */
+
+void
+ReceptionEnd (Ptr<Packet> packet, bool error)
+{
+  g_sink = error;
+}
+
+// A BLE signal of size bytes on channel, received with power dBm
+Ptr<BleSpectrumSignalParameters>
+MakeSignal (Ptr<BlePhy> phy, uint8_t channel, double dBm, uint32_t size,
+    Time duration)
+{
+  Ptr<BleSpectrumSignalParameters> params =
+    Create<BleSpectrumSignalParameters> ();
+  params->psd = Create<SpectrumValue> (phy->GetRxSpectrumModel ());
+  (*params->psd)[channel + 3] = std::pow (10.0, dBm / 10) / 1000 / BANDWIDTH;
+  params->duration = duration;
+  params->packet = Create<Packet> (size);
+  params->SetChannel (channel);
+  return params;
+}
+
+Ptr<BlePhy>
+MakeReceiver (void)
+{
+  Ptr<BlePhy> phy = CreateObject<BlePhy> ();
+  phy->SetReceptionEndCallback (MakeCallback (&ReceptionEnd));
+  return phy;
+}
+
+void
+StartReception (Ptr<BlePhy> phy, Ptr<BleSpectrumSignalParameters> signal,
+    std::vector<Ptr<BleSpectrumSignalParameters> > *interferers)
+{
+  phy->ChangeState (BlePhy::State::RX);
+  phy->ChangeState (BlePhy::State::RX_BUSY);
+  phy->StartRx (signal);
+  for (uint32_t i = 0; i < interferers->size (); i++)
+    phy->StartRx ((*interferers)[i]);
+}
+
+// A packet received with arg interferers on the adjacent channel
+void
+BenchReception (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  Ptr<BlePhy> phy = MakeReceiver ();
+  uint8_t channel = 20;
+  phy->SetChannelIndex (channel);
+  uint32_t size = 27 + BleMacHeader ().GetSerializedSize ();
+  Time duration = phy->GetTxDuration (size);
+  Ptr<BleSpectrumSignalParameters> signal =
+    MakeSignal (phy, channel, -60, size, duration);
+  std::vector<Ptr<BleSpectrumSignalParameters> > interferers;
+  for (uint32_t i = 0; i < arg; i++)
+    interferers.push_back (MakeSignal (phy, channel + 1, -70, size,
+          duration));
+  Time period = duration + MicroSeconds (10);
+  for (uint64_t i = 0; i < iterations; i++)
+    Simulator::Schedule (period * i, &StartReception, phy, signal,
+        &interferers);
+  timer.Start ();
+  Simulator::Run ();
+  timer.Stop ();
+  Simulator::Destroy ();
+}
+
+// BER updates every arg bits (at LE 1M) during one reception
+void
+BenchUpdateBer (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  Ptr<BlePhy> phy = MakeReceiver ();
+  uint8_t channel = 20;
+  phy->SetChannelIndex (channel);
+  Time step = MicroSeconds (arg * 1000000 / LE_1M_BITRATE);
+  Ptr<BleSpectrumSignalParameters> signal = MakeSignal (phy, channel, -60,
+      27, step * (iterations + 1));
+  std::vector<Ptr<BleSpectrumSignalParameters> > interferers;
+  Simulator::ScheduleNow (&StartReception, phy, signal, &interferers);
+  // The end of a signal of no power only updates the BER
+  Ptr<SpectrumValue> none = Create<SpectrumValue> (phy->GetRxSpectrumModel ());
+  for (uint64_t i = 1; i <= iterations; i++)
+    Simulator::Schedule (step * i, &BlePhy::EndNoise, phy, none);
+  timer.Start ();
+  Simulator::Run ();
+  timer.Stop ();
+  Simulator::Destroy ();
+}
+
+/*
+ * BleBBManager and BleLinkManager
+ */
+
+// A hub with links to leaves devices, node 0 is the hub
+NetDeviceContainer
+MakeStar (uint32_t leaves)
+{
+  NodeContainer nodes;
+  nodes.Create (leaves + 1);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+      "DeltaX", DoubleValue (1.0), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t i = 1; i <= leaves; i++)
+    pairs.push_back (std::make_pair (0, i));
+  helper.CreateLinks (bleNetDevices, pairs, true, 3200, false);
+  return bleNetDevices;
+}
+
+// Hand a packet for the last of arg links to its link queue
+void
+BenchHandlePacket (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  NetDeviceContainer bleNetDevices = MakeStar (arg);
+  Ptr<BleNetDevice> hub = DynamicCast<BleNetDevice> (bleNetDevices.Get (0));
+  Ptr<BleNetDevice> leaf = DynamicCast<BleNetDevice> (bleNetDevices.Get (arg));
+  BleMacHeader header = MakeHeader ();
+  header.SetSrcAddr (hub->GetAddress16 ());
+  header.SetDestAddr (leaf->GetAddress16 ());
+  Ptr<BleMacQueueItem> item = Create<BleMacQueueItem> (Create<Packet> (27),
+      header);
+  Ptr<BleBBManager> bbManager = hub->GetBBManager ();
+  Ptr<BleRingQueue> linkQueue =
+    bbManager->GetLinkManager (leaf->GetAddress16 ())->GetQueue ();
+  timer.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    {
+      hub->GetQueue ()->Enqueue (item);
+      bbManager->HandlePacket ();
+      linkQueue->Dequeue ();
+    }
+  timer.Stop ();
+  Simulator::Destroy ();
+}
+
+// One hop of a link, arg 1 also tunes the PHY of an active link
+void
+BenchChannelSelection (BenchTimer &timer, uint64_t iterations, uint32_t arg)
+{
+  NetDeviceContainer bleNetDevices = MakeStar (1);
+  Ptr<BleNetDevice> hub = DynamicCast<BleNetDevice> (bleNetDevices.Get (0));
+  Ptr<BleLinkManager> linkManager = hub->GetBBManager ()->GetLinkManager (
+      DynamicCast<BleNetDevice> (bleNetDevices.Get (1))->GetAddress16 ());
+  if (arg)
+    hub->GetBBManager ()->SetActiveLinkManager (linkManager);
+  timer.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    linkManager->ManageChannelSelection ();
+  timer.Stop ();
+  Simulator::Destroy ();
+}
+
+/*
+ * Harness
+ */
+
+BenchResult
+RunBenchmark (const Benchmark &benchmark)
+{
+  // Like Google Benchmark: aim past minTime from the last run, but grow
+  // at most tenfold so a noisy first run cannot overshoot by much
+  uint64_t iterations = 1;
+  while (true)
+    {
+      BenchTimer timer;
+      benchmark.function (timer, iterations, benchmark.arg);
+      double real = timer.GetRealSeconds ();
+      if (real >= minTime || iterations >= 1000000000)
+        {
+          BenchResult result;
+          result.name = benchmark.name;
+          result.iterations = iterations;
+          result.realNs = real * 1e9 / iterations;
+          result.cpuNs = timer.GetCpuSeconds () * 1e9 / iterations;
+          return result;
+        }
+      double multiplier = real > 0 ? std::min (10.0, minTime * 1.4 / real)
+        : 10.0;
+      iterations = std::max (iterations + 1,
+          uint64_t (iterations * multiplier));
+    }
+}
+
+std::string
+GetBuildType (void)
+{
+#if defined (NS3_BUILD_PROFILE_DEBUG)
+  return "debug";
+#elif defined (NS3_BUILD_PROFILE_RELEASE)
+  return "release";
+#else
+  return "optimized";
+#endif
+}
+
+bool
+IsFastPath (void)
+{
+#ifdef NS3_BLE_FAST_PATH
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+PrintResults (std::ostream &os, const std::vector<BenchResult> &results)
+{
+  if (format == "json")
+    {
+      std::time_t now = std::time (0);
+      char date[32];
+      std::strftime (date, sizeof (date), "%Y-%m-%dT%H:%M:%S",
+          std::localtime (&now));
+      os << "{" << std::endl
+        << "  \"context\": {" << std::endl
+        << "    \"date\": \"" << date << "\"," << std::endl
+        << "    \"executable\": \"ble-microbench\"," << std::endl
+        << "    \"library_build_type\": \"" << GetBuildType () << "\","
+        << std::endl
+        << "    \"ble_fast_path\": " << (IsFastPath () ? "true" : "false")
+        << "," << std::endl
+        << "    \"min_time\": " << minTime << std::endl
+        << "  }," << std::endl
+        << "  \"benchmarks\": [" << std::endl;
+      for (uint32_t i = 0; i < results.size (); i++)
+        {
+          const BenchResult &r = results[i];
+          os << "    {\"name\": \"" << r.name << "\""
+            << ", \"run_type\": \"iteration\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << r.realNs
+            << ", \"cpu_time\": " << r.cpuNs
+            << ", \"time_unit\": \"ns\"}"
+            << (i + 1 < results.size () ? "," : "") << std::endl;
+        }
+      os << "  ]" << std::endl << "}" << std::endl;
+    }
+  else
+    {
+      os << std::left << std::setw (44) << "Benchmark" << std::right
+        << std::setw (14) << "Time (ns)" << std::setw (14) << "CPU (ns)"
+        << std::setw (14) << "Iterations" << std::endl;
+      for (uint32_t i = 0; i < results.size (); i++)
+        {
+          const BenchResult &r = results[i];
+          os << std::left << std::setw (44) << r.name << std::right
+            << std::fixed << std::setprecision (1)
+            << std::setw (14) << r.realNs << std::setw (14) << r.cpuNs
+            << std::setw (14) << r.iterations << std::endl;
+        }
+    }
+}
+
+int main (int argc, char** argv)
+{
+  CommandLine cmd;
+  cmd.AddValue ("filter",
+      "Only run the benchmarks whose name contains this text", filter);
+  cmd.AddValue ("minTime",
+      "Minimum measured time of a benchmark in seconds", minTime);
+  cmd.AddValue ("format", "Output format: console or json", format);
+  cmd.AddValue ("output", "Output file, stdout if empty", outputFile);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_UNLESS (format == "console" || format == "json",
+      "Unknown format " << format);
+
+  std::vector<Benchmark> benchmarks;
+  benchmarks.push_back ({"BleErrorModel/GetBER", &BenchGetBer, 0});
+  benchmarks.push_back ({"BleMacHeader/Serialize", &BenchSerialize, 0});
+  benchmarks.push_back ({"BleMacHeader/Deserialize", &BenchDeserialize, 0});
+  benchmarks.push_back ({"BlePhy/Reception/0", &BenchReception, 0});
+  benchmarks.push_back ({"BlePhy/Reception/4", &BenchReception, 4});
+  benchmarks.push_back ({"BlePhy/UpdateBer/8", &BenchUpdateBer, 8});
+  benchmarks.push_back ({"BlePhy/UpdateBer/280", &BenchUpdateBer, 280});
+  benchmarks.push_back ({"BleBBManager/HandlePacket/1",
+      &BenchHandlePacket, 1});
+  benchmarks.push_back ({"BleBBManager/HandlePacket/16",
+      &BenchHandlePacket, 16});
+  benchmarks.push_back ({"BleLinkManager/ManageChannelSelection/0",
+      &BenchChannelSelection, 0});
+  benchmarks.push_back ({"BleLinkManager/ManageChannelSelection/1",
+      &BenchChannelSelection, 1});
+
+  std::vector<BenchResult> results;
+  for (uint32_t i = 0; i < benchmarks.size (); i++)
+    {
+      if (benchmarks[i].name.find (filter) == std::string::npos)
+        continue;
+      results.push_back (RunBenchmark (benchmarks[i]));
+    }
+
+  if (outputFile.empty ())
+    {
+      PrintResults (std::cout, results);
+    }
+  else
+    {
+      std::ofstream os (outputFile.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << outputFile);
+      PrintResults (os, results);
+    }
+  return 0;
+}
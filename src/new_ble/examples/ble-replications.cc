@@ -0,0 +1,396 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// Independent replications of the multiple-nodes scenario.
+//
+// Instead of looping over nbIterations in one process, the parent forks
+// up to --jobs worker processes. Worker i runs the scenario with
+// RngRun = --firstRun + i and writes its per-node counters back over a
+// pipe. The parent merges them and prints, per node and for the network
+// total, the mean over the replications with a confidence interval.
+//
+//   ./waf --run "ble-replications --replications=64 --jobs=64"
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleReplications");
+
+  /*****************
+   * Configuration *
+   *****************/
+
+  uint32_t nbReplications = 10; //!< Number of independent runs
+  uint32_t nbJobs = 4; //!< Worker processes running at the same time
+  uint32_t firstRun = 1; //!< RngRun of the first replication
+  double length = 30; //<! Square room with length as distance
+  int pktsize = 20; //!< Size of packets, in bytes
+  int duration = 110; //<! Duration of the simulation in seconds
+  int packetSendDuration = 100;
+      //<! Time during which new packets should be queued
+  bool scheduled = true; // Schedule the TX windows
+  uint32_t nNodes = 25; // Number of nodes
+  uint32_t nbConnInterval = 3200;
+      // [MAX 3200]  nbConnInterval*1,25ms = size of connection interval.
+  int interval = 4; //!< Time between two packets from the same node
+  double confidence = 0.95; //!< 0.90, 0.95 or 0.99
+  std::string outputFile = "ble-replications.csv";
+
+  // Columns of the per node output of the other examples, without the
+  // coordinates: transmitted, received, received unique, received error,
+  // broadcast received, TX windows skipped.
+  const uint32_t nbCounters = 6;
+  const char *counterNames[nbCounters] = {"transmitted", "received",
+    "receivedUnique", "receivedError", "receivedBroadcast",
+    "txWindowsSkipped"};
+
+  // Per address: counters of the replication running in this process.
+  std::map<uint16_t, std::vector<uint64_t> > errorMap;
+
+  /************************
+   * End of configuration *
+   ************************/
+
+// Run one replication in this process; fills errorMap.
+void
+RunReplication (uint32_t run)
+{
+  RngSeedManager::SetRun (run);
+  errorMap.clear ();
+
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> nodePositionList =
+    CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      double x = randT->GetInteger (0, length);
+      double y = randT->GetInteger (0, length);
+      nodePositionList->Add (Vector (x, y, 1.0));
+    }
+  mobility.SetPositionAllocator (nodePositionList);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (bleDeviceNodes);
+
+  NetDeviceContainer bleNetDevices = helper.Install (bleDeviceNodes);
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      uint8_t buffer[2];
+      buffer[0] = ((nodeI + 1) >> 8) & 0xff;
+      buffer[1] = (nodeI + 1) & 0xff;
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      Ptr<BleNetDevice> nd =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI));
+      nd->SetAddress (address);
+    }
+
+  Ptr<BleStatsCollector> stats = helper.EnableStatistics (bleNetDevices);
+  helper.CreateAllLinks (bleNetDevices, scheduled, nbConnInterval);
+  randT->SetAttribute ("Max", DoubleValue (interval));
+  helper.GenerateTraffic (
+      randT, bleDeviceNodes, pktsize, 0, packetSendDuration, interval);
+
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      BleNodeStats nodeStats = stats->GetNodeStats (
+          bleDeviceNodes.Get (nodeI)->GetId ());
+      uint64_t counters[nbCounters] = {nodeStats.tx, nodeStats.promiscRx,
+        nodeStats.rx, nodeStats.rxError, nodeStats.rxBroadcast,
+        nodeStats.txWindowsSkipped};
+      errorMap[nodeI + 1].assign (counters, counters + nbCounters);
+    }
+  Simulator::Destroy ();
+}
+
+bool
+WriteAll (int fd, const void *data, size_t size)
+{
+  const char *p = static_cast<const char *> (data);
+  while (size > 0)
+    {
+      ssize_t n = write (fd, p, size);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      size -= n;
+    }
+  return true;
+}
+
+bool
+ReadAll (int fd, void *data, size_t size)
+{
+  char *p = static_cast<char *> (data);
+  while (size > 0)
+    {
+      ssize_t n = read (fd, p, size);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      size -= n;
+    }
+  return true;
+}
+
+// Worker side: one record per node, address followed by the counters.
+void
+SendResults (int fd)
+{
+  uint32_t nbEntries = errorMap.size ();
+  WriteAll (fd, &nbEntries, sizeof (nbEntries));
+  for (auto &entry : errorMap)
+    {
+      uint16_t addr = entry.first;
+      WriteAll (fd, &addr, sizeof (addr));
+      WriteAll (fd, entry.second.data (), nbCounters * sizeof (uint64_t));
+    }
+}
+
+bool
+ReceiveResults (int fd, std::map<uint16_t, std::vector<uint64_t> > &result)
+{
+  uint32_t nbEntries;
+  if (!ReadAll (fd, &nbEntries, sizeof (nbEntries)))
+    return false;
+  for (uint32_t i = 0; i < nbEntries; i++)
+    {
+      uint16_t addr;
+      std::vector<uint64_t> counters (nbCounters);
+      if (!ReadAll (fd, &addr, sizeof (addr))
+          || !ReadAll (fd, counters.data (), nbCounters * sizeof (uint64_t)))
+        return false;
+      result[addr] = counters;
+    }
+  return true;
+}
+
+// Two-sided Student t quantile for the given degrees of freedom.
+double
+StudentT (uint32_t df)
+{
+  static const double t90[] = {6.314, 2.920, 2.353, 2.132, 2.015, 1.943,
+    1.895, 1.860, 1.833, 1.812, 1.796, 1.782, 1.771, 1.761, 1.753, 1.746,
+    1.740, 1.734, 1.729, 1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706,
+    1.703, 1.701, 1.699, 1.697};
+  static const double t95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447,
+    2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+    2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056,
+    2.052, 2.048, 2.045, 2.042};
+  static const double t99[] = {63.657, 9.925, 5.841, 4.604, 4.032, 3.707,
+    3.499, 3.355, 3.250, 3.169, 3.106, 3.055, 3.012, 2.977, 2.947, 2.921,
+    2.898, 2.878, 2.861, 2.845, 2.831, 2.819, 2.807, 2.797, 2.787, 2.779,
+    2.771, 2.763, 2.756, 2.750};
+  const double *table = t95;
+  double limit = 1.960;
+  if (confidence == 0.90)
+    {
+      table = t90;
+      limit = 1.645;
+    }
+  else if (confidence == 0.99)
+    {
+      table = t99;
+      limit = 2.576;
+    }
+  if (df == 0)
+    return 0;
+  if (df <= 30)
+    return table[df - 1];
+  return limit;
+}
+
+void
+PrintStatistics (std::ostream &os, std::string id,
+    const std::vector<std::vector<double> > &samples)
+{
+  for (uint32_t c = 0; c < nbCounters; c++)
+    {
+      uint32_t n = samples.size ();
+      double sum = 0;
+      for (uint32_t r = 0; r < n; r++)
+        sum += samples[r][c];
+      double mean = n > 0 ? sum / n : 0;
+      double sq = 0;
+      for (uint32_t r = 0; r < n; r++)
+        sq += (samples[r][c] - mean) * (samples[r][c] - mean);
+      double stddev = n > 1 ? std::sqrt (sq / (n - 1)) : 0;
+      double halfWidth = n > 1 ? StudentT (n - 1) * stddev / std::sqrt (n) : 0;
+      os << id << "," << counterNames[c] << "," << n << "," << mean << ","
+        << stddev << "," << mean - halfWidth << "," << mean + halfWidth
+        << std::endl;
+    }
+}
+
+int main (int argc, char** argv)
+{
+  CommandLine cmd;
+  cmd.AddValue ("replications", "Number of independent replications",
+      nbReplications);
+  cmd.AddValue ("jobs", "Number of worker processes", nbJobs);
+  cmd.AddValue ("firstRun", "RngRun of the first replication", firstRun);
+  cmd.AddValue ("nodes", "Number of nodes", nNodes);
+  cmd.AddValue ("length", "Side of the square field, in meter", length);
+  cmd.AddValue ("duration", "Simulated time per replication, in seconds",
+      duration);
+  cmd.AddValue ("sendDuration", "Time during which packets are generated",
+      packetSendDuration);
+  cmd.AddValue ("interval", "Time between two packets of a node", interval);
+  cmd.AddValue ("connInterval",
+      "Connection interval, in units of 1.25 ms", nbConnInterval);
+  cmd.AddValue ("confidence", "Confidence level: 0.90, 0.95 or 0.99",
+      confidence);
+  cmd.AddValue ("output", "Output file", outputFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (nbJobs > 0, "At least one job is needed");
+  NS_ABORT_MSG_UNLESS (confidence == 0.90 || confidence == 0.95
+      || confidence == 0.99, "Unsupported confidence level " << confidence);
+
+  // Replication index -> per address counters
+  std::vector<std::map<uint16_t, std::vector<uint64_t> > >
+    results (nbReplications);
+  std::map<pid_t, std::pair<uint32_t, int> > workers; // pid -> (index, fd)
+  uint32_t next = 0;
+  uint32_t failed = 0;
+  std::vector<bool> done (nbReplications, false);
+
+  // Keep nbJobs workers running and merge their output as they finish.
+  while (next < nbReplications || !workers.empty ())
+    {
+      while (next < nbReplications && workers.size () < nbJobs)
+        {
+          int fds[2];
+          NS_ABORT_MSG_IF (pipe (fds) != 0, "pipe () failed");
+          std::cout << std::flush;
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "fork () failed");
+          if (pid == 0)
+            {
+              close (fds[0]);
+              RunReplication (firstRun + next);
+              SendResults (fds[1]);
+              close (fds[1]);
+              _exit (0);
+            }
+          close (fds[1]);
+          workers[pid] = std::make_pair (next, fds[0]);
+          NS_LOG_INFO ("Started replication " << next << " (RngRun "
+              << firstRun + next << ") as pid " << pid);
+          next++;
+        }
+
+      // Collect whichever worker has output first; reading before
+      // waitpid keeps a worker with a full pipe from blocking forever.
+      std::vector<struct pollfd> fds;
+      for (auto &w : workers)
+        {
+          struct pollfd pfd;
+          pfd.fd = w.second.second;
+          pfd.events = POLLIN;
+          pfd.revents = 0;
+          fds.push_back (pfd);
+        }
+      while (poll (fds.data (), fds.size (), -1) < 0 && errno == EINTR)
+        ;
+      auto it = workers.begin ();
+      for (auto &pfd : fds)
+        {
+          if (pfd.revents != 0)
+            break;
+          ++it;
+        }
+      NS_ASSERT (it != workers.end ());
+      std::pair<uint32_t, int> worker = it->second;
+      bool ok = ReceiveResults (worker.second, results[worker.first]);
+      close (worker.second);
+      int status;
+      waitpid (it->first, &status, 0);
+      if (!ok || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          std::cerr << "Replication " << worker.first << " failed"
+            << std::endl;
+          failed++;
+        }
+      else
+        done[worker.first] = true;
+      workers.erase (it);
+    }
+
+  // Merge: samples[address][replication][counter]
+  std::map<uint16_t, std::vector<std::vector<double> > > samples;
+  std::vector<std::vector<double> > totals;
+  for (uint32_t r = 0; r < nbReplications; r++)
+    {
+      if (!done[r])
+        continue;
+      std::vector<double> total (nbCounters, 0);
+      for (auto &entry : results[r])
+        {
+          std::vector<double> values (entry.second.begin (),
+              entry.second.end ());
+          samples[entry.first].push_back (values);
+          for (uint32_t c = 0; c < nbCounters; c++)
+            total[c] += values[c];
+        }
+      totals.push_back (total);
+    }
+
+  std::ofstream os (outputFile.c_str ());
+  os << "#Scenario " << nNodes << " nodes on a square field with side "
+    << length << " meter, " << totals.size () << " replications from RngRun "
+    << firstRun << ", confidence " << confidence << std::endl;
+  os << "ID,metric,replications,mean,stddev,ciLow,ciHigh" << std::endl;
+  for (auto &entry : samples)
+    {
+      std::ostringstream id;
+      id << entry.first;
+      PrintStatistics (os, id.str (), entry.second);
+    }
+  PrintStatistics (os, "total", totals);
+
+  NS_LOG_INFO ("Done.");
+  return failed == 0 ? 0 : 1;
+}
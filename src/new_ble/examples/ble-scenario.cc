@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+// Builds a scenario from a file instead of code and reports how long the
+// build takes. The format is described at BleHelper::LoadScenario:
+//
+//   ./waf --run "ble-scenario --file=src/ble/examples/ble-scenario.csv"
+//
+// With --nodes the program first writes a scenario of that many nodes on
+// a grid to --file, with a link from every node to its right and lower
+// neighbour and traffic along the first row:
+//
+//   ./waf --run "ble-scenario --nodes=10000 --file=grid.csv --simulate=0"
+//
+// With --compare the same nodes are also built the way the other
+// examples do it, with a MobilityHelper and per node attributes. Every
+// device receives every transmission, so simulate large grids only with
+// a short --duration, or with --abstraction on the link-level channel
+// that only reaches the devices in range:
+//
+//   ./waf --run "ble-scenario --nodes=400 --file=grid.csv --abstraction=1"
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleScenario");
+
+static void
+IncrementCounter (uint64_t *counter, Ptr<const Packet> packet)
+{
+  (*counter)++;
+}
+
+static void
+WriteGrid (std::string filename, uint32_t nNodes, double distance,
+    double duration)
+{
+  uint32_t width = std::ceil (std::sqrt (nNodes));
+  std::ofstream file (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot write " << filename);
+  file << "# " << nNodes << " nodes on a grid of " << distance << " m"
+    << std::endl << "conn,80" << std::endl;
+  for (uint32_t i = 0; i < nNodes; i++)
+    file << "node," << (i % width) * distance << ","
+      << (i / width) * distance << ",1" << std::endl;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      if ((i + 1) % width != 0 && i + 1 < nNodes)
+        file << "link," << i << "," << i + 1 << std::endl;
+      if (i + width < nNodes)
+        file << "link," << i << "," << i + width << std::endl;
+    }
+  for (uint32_t i = 0; i + 1 < std::min (width, nNodes); i++)
+    file << "traffic," << i << "," << i + 1 << ",20,1," << duration
+      << ",0.5" << std::endl;
+}
+
+int main (int argc, char** argv)
+{
+  std::string filename = "ble-scenario.csv";
+  uint32_t nNodes = 0;
+  double distance = 5.0;
+  double duration = 5;
+  bool compare = false;
+  bool simulate = true;
+  bool abstraction = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("file", "Scenario file", filename);
+  cmd.AddValue ("nodes", "Write a grid scenario of this many nodes first",
+      nNodes);
+  cmd.AddValue ("distance", "Distance between the nodes of the grid in meter",
+      distance);
+  cmd.AddValue ("duration", "Duration of the traffic of the grid in seconds",
+      duration);
+  cmd.AddValue ("compare", "Also build the nodes with attributes", compare);
+  cmd.AddValue ("simulate", "Run the scenario after building it", simulate);
+  cmd.AddValue ("abstraction", "Use the link-level abstraction of the PHY",
+      abstraction);
+  cmd.Parse (argc, argv);
+
+  if (nNodes > 0)
+    WriteGrid (filename, nNodes, distance, duration);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  BleHelper helper;
+  helper.SetLinkAbstraction (abstraction);
+  SystemWallClockMs clock;
+  clock.Start ();
+  NetDeviceContainer bleNetDevices = helper.LoadScenario (filename, randT);
+  int64_t buildMs = clock.End ();
+  std::cout << "Built " << bleNetDevices.GetN () << " devices of "
+    << filename << " in " << buildMs << " ms" << std::endl;
+
+  if (compare)
+    {
+      // Positions through a position allocator, the data rate as a
+      // string attribute of every PHY
+      BleHelper otherHelper;
+      clock.Start ();
+      NodeContainer nodes;
+      nodes.Create (bleNetDevices.GetN ());
+      Ptr<ListPositionAllocator> positions =
+        CreateObject<ListPositionAllocator> ();
+      for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+        positions->Add (bleNetDevices.Get (i)->GetNode ()
+            ->GetObject<MobilityModel> ()->GetPosition ());
+      MobilityHelper mobility;
+      mobility.SetPositionAllocator (positions);
+      mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+      mobility.Install (nodes);
+      NetDeviceContainer devices = otherHelper.Install (nodes);
+      for (uint32_t i = 0; i < devices.GetN (); i++)
+        DynamicCast<BleNetDevice> (devices.Get (i))->GetPhy ()
+          ->SetAttribute ("DataRate", DoubleValue (LE_1M_BITRATE));
+      std::cout << "Built " << devices.GetN ()
+        << " devices with attributes in " << clock.End () << " ms"
+        << std::endl;
+    }
+
+  if (simulate)
+    {
+      uint64_t rx = 0;
+      for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+        bleNetDevices.Get (i)->TraceConnectWithoutContext ("MacRx",
+            MakeBoundCallback (&IncrementCounter, &rx));
+
+      Simulator::Stop (Seconds (duration + 2));
+      clock.Start ();
+      Simulator::Run ();
+      std::cout << "Packets received: " << rx << ", simulated in "
+        << clock.End () << " ms" << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
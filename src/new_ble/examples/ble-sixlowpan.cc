@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+// IPv6 over BLE (RFC 7668) with 6LoWPAN header compression.
+//
+// Every pair of nodes has a connection and a UDP echo client on the
+// last node sends to the echo server on node 0:
+//
+//   ./waf --run "ble-sixlowpan --nodes=3 --packetSize=20"
+//
+// The PHY runs at the LE 1M rate, so the air time of the compressed
+// packets is realistic (ble-internetstack needs a 4 Mbps PHY to fit full
+// IPv4 headers). The interface identifiers are derived from the
+// Mac16Address of each device, so the neighbour caches are filled by
+// the helper instead of Neighbor Discovery, and with the 6LoWPAN context
+// for the global prefix the IPv6 and UDP headers shrink from 48 to about
+// 10 bytes. Use --context=0 to compare with stateless compression only.
+//
+// Each link occupies 6 slots of 1.25 ms per connection interval, so use
+// a longer --connInterval for more than 5 nodes (n(n+1)/2 offsets).
+
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/sixlowpan-module.h>
+#include <ns3/applications-module.h>
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BleSixLowPan");
+
+static uint64_t g_macTxBytes = 0;
+
+static void
+IncrementCounter (uint64_t *counter, Ptr<const Packet> packet)
+{
+  (*counter)++;
+}
+
+static void
+MacTx (Ptr<const Packet> packet)
+{
+  g_macTxBytes += packet->GetSize ();
+}
+
+int main (int argc, char** argv)
+{
+  uint32_t nNodes = 3;
+  uint32_t packetSize = 20;
+  uint32_t nbPackets = 10;
+  double interval = 1.0; // Seconds between echo requests
+  uint32_t nbConnInterval = 80; // 100 ms
+  double internodedistance = 10.0;
+  bool context = true;
+  bool verbose = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nNodes);
+  cmd.AddValue ("packetSize", "UDP payload size in bytes", packetSize);
+  cmd.AddValue ("packets", "Number of echo requests", nbPackets);
+  cmd.AddValue ("interval", "Seconds between echo requests", interval);
+  cmd.AddValue ("connInterval",
+      "Connection interval in units of 1.25 ms", nbConnInterval);
+  cmd.AddValue ("distance", "Distance between the nodes of the grid in meter",
+      internodedistance);
+  cmd.AddValue ("context", "Compress the global prefix with a context",
+      context);
+  cmd.AddValue ("verbose", "Enable the 6LoWPAN and echo logging", verbose);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (nNodes < 2, "At least 2 nodes are needed");
+
+  if (verbose)
+    {
+      LogComponentEnable ("SixLowPanNetDevice", LOG_LEVEL_INFO);
+      LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_INFO);
+      LogComponentEnable ("UdpEchoServerApplication", LOG_LEVEL_INFO);
+    }
+
+  // Realistic air time and no Duplicate Address Detection, the
+  // addresses are unique as the Mac16Addresses are
+  Config::SetDefault ("ns3::BlePhy::DataRate", DoubleValue (LE_1M_BITRATE));
+  Config::SetDefault ("ns3::Icmpv6L4Protocol::DAD", BooleanValue (false));
+
+  Time stopTime = Seconds (3.0 + nbPackets * interval);
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+      "MinX", DoubleValue (0.0), "MinY", DoubleValue (0.0),
+      "DeltaX", DoubleValue (internodedistance),
+      "DeltaY", DoubleValue (internodedistance),
+      "GridWidth", UintegerValue (std::ceil (std::sqrt (nNodes))),
+      "LayoutType", StringValue ("RowFirst"), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.Install (nodes);
+  helper.CreateAllLinks (bleNetDevices, true, nbConnInterval);
+  // Multicast packets (router solicitations, MLD reports) go to FF:FF
+  helper.CreateBroadcastLink (bleNetDevices, true, nbConnInterval, true);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (nodes);
+
+  NetDeviceContainer devices = helper.InstallSixLowPan (bleNetDevices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (devices);
+  if (context)
+    {
+      SixLowPanHelper sixLowPan;
+      sixLowPan.AddContext (devices, 0, Ipv6Prefix ("2001:db8::", 64),
+          stopTime);
+    }
+  helper.PopulateNeighbourCaches (devices);
+
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      std::cout << "Node " << nodeI << ": "
+        << DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+        ->GetAddress16 ()
+        << " " << interfaces.GetAddress (nodeI, 0)
+        << " " << interfaces.GetAddress (nodeI, 1) << std::endl;
+    }
+
+  uint16_t port = 9;
+  UdpEchoServerHelper server (port);
+  ApplicationContainer serverApps = server.Install (nodes.Get (0));
+  serverApps.Start (Seconds (1.0));
+
+  UdpEchoClientHelper client (interfaces.GetAddress (0, 1), port);
+  client.SetAttribute ("MaxPackets", UintegerValue (nbPackets));
+  client.SetAttribute ("Interval", TimeValue (Seconds (interval)));
+  client.SetAttribute ("PacketSize", UintegerValue (packetSize));
+  ApplicationContainer clientApps = client.Install (nodes.Get (nNodes - 1));
+  clientApps.Start (Seconds (2.0));
+
+  uint64_t echoTx = 0;
+  uint64_t echoRx = 0;
+  clientApps.Get (0)->TraceConnectWithoutContext ("Tx",
+      MakeBoundCallback (&IncrementCounter, &echoTx));
+  clientApps.Get (0)->TraceConnectWithoutContext ("Rx",
+      MakeBoundCallback (&IncrementCounter, &echoRx));
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacTx",
+          MakeCallback (&MacTx));
+    }
+  Ptr<BleStatsCollector> stats = helper.EnableStatistics (bleNetDevices);
+
+  Simulator::Stop (stopTime);
+  Simulator::Run ();
+
+  std::cout << "Echo requests sent: " << echoTx
+    << ", replies received: " << echoRx << std::endl;
+  std::cout << "Bytes handed to the BLE devices: " << g_macTxBytes
+    << std::endl;
+  stats->Print (std::cout);
+
+  Simulator::Destroy ();
+  return 0;
+}
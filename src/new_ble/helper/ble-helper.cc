@@ -23,13 +23,42 @@
  *https://github.com/networkedsystems/lora-ns3/blob/master/model/lora-mac-header.h
  */
 #include "ble-helper.h"
+#include <ns3/ble-trace-sink.h>
+#include <ns3/ble-stats-collector.h>
+#include <ns3/ble-mesh-network.h>
+#include <ns3/ble-gatt-application.h>
+#include <ns3/ble-iso-stream.h>
+#include <ns3/ble-traffic-model.h>
+#include <ns3/ble-link-channel.h>
+#include <ns3/sixlowpan-helper.h>
+#include <ns3/sixlowpan-net-device.h>
+#include <ns3/ipv6-l3-protocol.h>
+#include <ns3/ipv6-interface.h>
+#include <ns3/ndisc-cache.h>
+#include <ns3/boolean.h>
+#include <ns3/pointer.h>
+#include <ns3/integer.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
 #include <ns3/ble-module.h>
 #include <ns3/packet.h>
 #include <ns3/mobility-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/system-wall-clock-ms.h>
 #include <ns3/single-model-spectrum-channel.h>
 #include <ns3/multi-model-spectrum-channel.h>
 #include <ns3/propagation-loss-model.h>
+#include <ns3/okumura-hata-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#ifdef NS3_MPI
+#include <ns3/mpi-interface.h>
+#include <ns3/ble-remote-link-channel.h>
+#endif
 #include <ns3/isotropic-antenna-model.h>
 #include <ns3/drop-tail-queue.h>
 #include <ns3/log.h>
@@ -38,9 +67,14 @@
 #include <ns3/onoff-application.h>
 #include "ns3/applications-module.h"
 #include <ns3/propagation-loss-model.h>
+#include <ns3/okumura-hata-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
 #include <ns3/single-model-spectrum-channel.h>
 #include <ns3/spectrum-helper.h>
+#include <ns3/waveform-generator-helper.h>
+#include <ns3/waveform-generator.h>
+#include <ns3/non-communicating-net-device.h>
+#include <ns3/wifi-spectrum-value-helper.h>
 #include "ns3/ipv4-global-routing-helper.h"
 namespace ns3 {
 
@@ -83,23 +117,36 @@ BleHelper::BleHelper (void)
 {
   m_channel = CreateObject<MultiModelSpectrumChannel> ();//支持多频谱模型的信道
 
-  Ptr<LogDistancePropagationLossModel> lossModel = 
-    CreateObject<LogDistancePropagationLossModel> ();//基于距离的对数衰减模型，模拟 2.4GHz BLE 信号衰减
-  //lossModel->SetReference(1.0, 46.6777); // d_0 = 1m, L_0 = 40 dB
-  lossModel->SetPathLossExponent(5.0); // 数据信道 n=4.0
+  // The propagation of the 40 data channels, every transmission of a
+  // connection event is on one of them
+  Ptr<OkumuraHataPropagationLossModel> lossModel =
+    CreateObject<OkumuraHataPropagationLossModel> ();
+  lossModel->SetAttribute ("Frequency", DoubleValue (2400e6));
   m_channel->AddPropagationLossModel (lossModel);
+  m_lossModel = lossModel;
 
   Ptr<ConstantSpeedPropagationDelayModel> delayModel = 
     CreateObject<ConstantSpeedPropagationDelayModel> ();//恒定速度传播延迟，基于光速
   m_channel->SetPropagationDelayModel (delayModel);
+  m_delayModel = delayModel;
 	m_spectrumModel = 0;//后续由 BlePhy 设置
   ConstructAllChannels();//创建 40 个信道
+  m_meshFactory.SetTypeId ("ns3::BleMeshNetwork");
+  m_gattFactory.SetTypeId ("ns3::BleGattApplication");
+  m_isoFactory.SetTypeId ("ns3::BleIsoStream");
+  m_trafficFactory.SetTypeId ("ns3::BlePeriodicTraffic");
 }
 
 BleHelper::~BleHelper (void)
 {
   m_channel->Dispose ();
   m_channel = 0;
+  m_linkChannel = 0;
+  m_lossModel = 0;
+  m_delayModel = 0;
+  m_destination = 0;
+  m_interfererStart = 0;
+  m_allChannels.clear ();
 	m_spectrumModel = 0;
 }
 
@@ -168,40 +215,13 @@ BleHelper::AddMobility (Ptr<BlePhy> phy, Ptr<MobilityModel> m)
 void
 BleHelper::ConstructAllChannels()
 {
-    SpectrumChannelHelper channelHelper;
-    channelHelper.SetChannel ("ns3::MultiModelSpectrumChannel");
-    bool nakagami = false;
-    if (nakagami)
-    {
-      //用于宏蜂窝和城市环境的路径损耗模型，适用于 150MHz~1000MHz，此处频率设为 2.4GHz
-    	channelHelper.AddPropagationLoss ("ns3::OkumuraHataPropagationLossModel",
-            "Frequency",DoubleValue(2400e6));
-      //用于模拟小尺度衰落（如多径效应），参数 m0, m1, m2 均设为 1，表示衰落严重（接近瑞利衰落）
-     	channelHelper.AddPropagationLoss ("ns3::NakagamiPropagationLossModel",
-            "m0",DoubleValue(1),"m1",DoubleValue(1),"m2",DoubleValue(1));
-    }
-    else
-    {
-      channelHelper.AddPropagationLoss ("ns3::OkumuraHataPropagationLossModel",
-          "Frequency",DoubleValue(2400e6));
-    }
-    channelHelper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-    
-  for (int i=0; i<40; i++)
-  {
-    /*Ptr<LogDistancePropagationLossModel> lossModel = 
-      CreateObject<LogDistancePropagationLossModel> ();
-    lossModel->SetReference(1.0, 46.6777); // d_0 = 1m, L_0 = 40 dB
-    lossModel->SetPathLossExponent(i >= 37 ? 3.0 : 4.0); // 广播信道 n=3.0，数据信道 n=4.0
-    channelHelper.AddPropagationLoss(lossModel);
-    channelHelper.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
-    Ptr<SpectrumChannel> c = channelHelper.Create();
-    m_allChannels.push_back(c);
-    NS_LOG_INFO("Created channel " << i << " with PathLossExponent=" << (i >= 37 ? 3.0 : 4.0));*/
-    Ptr<SpectrumChannel> c = channelHelper.Create ();
-    m_allChannels.push_back(c);
-  }
-    
+  // The PHYs tag every signal with its channel index
+  // (BleSpectrumSignalParameters) and StartRx only receives the ones on
+  // the channel listened to, so the 40 BLE channels are logical channels
+  // of one medium. They share m_channel and its propagation models
+  // instead of recomputing the same path loss on 40 separate
+  // SpectrumChannels.
+  m_allChannels.assign (40, m_channel);
 }
 
 NetDeviceContainer
@@ -214,7 +234,7 @@ BleHelper::Install (NodeContainer c)
 		Ptr<Node> nodeI = *i;
 		Ptr<BleNetDevice> anandi = CreateObject<BleNetDevice> ();
 		devices.Add(anandi);
-		Ptr<BlePhy> sfp = Create<BlePhy> ();
+		Ptr<BlePhy> sfp = CreateObject<BlePhy> ();
         Ptr<BleLinkController> blc = CreateObject<BleLinkController> ();
 		if (m_spectrumModel == 0)
 			m_spectrumModel = sfp->GetRxSpectrumModel();
@@ -227,8 +247,11 @@ BleHelper::Install (NodeContainer c)
         blc->SetAllChannels (m_allChannels);
 		sfp->SetDevice(anandi);
 		sfp->SetMobility (nodeI->GetObject<MobilityModel> ());
-		sfp->SetChannel (m_channel);
-		sfp->SetRxAntenna (Create<IsotropicAntennaModel> ());
+		if (m_linkChannel != 0)
+			sfp->SetLinkChannel (m_linkChannel);
+		else
+			sfp->SetChannel (m_channel);
+		sfp->SetRxAntenna (CreateObject<IsotropicAntennaModel> ());
 		nodeI->AddDevice(anandi);
 		anandi->SetGenericPhyTxStartCallback (MakeCallback(&BlePhy::StartTx,sfp));
 		sfp->SetTransmissionEndCallback( 
@@ -256,6 +279,153 @@ BleHelper::AddCallbacks (std::string traceSource, CallbackBase callback)
 	m_callbacks.push_back(std::make_tuple(traceSource,callback));
 }
 
+Ptr<BleTraceSink>
+BleHelper::EnableBinaryTrace (std::string filename, NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Ptr<BleTraceSink> sink = CreateObject<BleTraceSink> ();
+  sink->Open (filename);
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<BleNetDevice> device = DynamicCast<BleNetDevice> (*i);
+      if (device)
+        sink->Connect (device);
+    }
+  // Flush the remaining records when the simulation is torn down
+  Simulator::ScheduleDestroy (&BleTraceSink::Close, sink);
+  return sink;
+}
+
+Ptr<BleStatsCollector>
+BleHelper::EnableStatistics (NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<BleStatsCollector> collector = CreateObject<BleStatsCollector> ();
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<BleNetDevice> device = DynamicCast<BleNetDevice> (*i);
+      if (device)
+        collector->Connect (device);
+    }
+  // The traces hold raw pointers, keep the collector alive until then
+  Simulator::ScheduleDestroy (&BleStatsCollector::Dispose, collector);
+  return collector;
+}
+
+void
+BleHelper::SetMeshAttribute (std::string n, const AttributeValue &v)
+{
+  m_meshFactory.Set (n, v);
+}
+
+void
+BleHelper::SetGattAttribute (std::string n, const AttributeValue &v)
+{
+  m_gattFactory.Set (n, v);
+}
+
+void
+BleHelper::SetIsoAttribute (std::string n, const AttributeValue &v)
+{
+  m_isoFactory.Set (n, v);
+}
+
+void
+BleHelper::InstallMesh (NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<BleNetDevice> device = DynamicCast<BleNetDevice> (*i);
+      NS_ASSERT_MSG (!device->GetNode ()->GetObject<BleMeshNetwork> (),
+          "Node " << device->GetNode ()->GetId () << " already has a mesh");
+      Ptr<BleMeshNetwork> mesh = m_meshFactory.Create<BleMeshNetwork> ();
+      mesh->SetNetDevice (device);
+      device->GetNode ()->AggregateObject (mesh);
+    }
+}
+
+NetDeviceContainer
+BleHelper::InstallSixLowPan (NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      (*i)->SetAttribute ("NeedsArp", BooleanValue (true));
+    }
+  SixLowPanHelper sixLowPan;
+  return sixLowPan.Install (c);
+}
+
+void
+BleHelper::PopulateNeighbourCaches (NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<Ipv6Interface> > interfaces;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Ipv6L3Protocol> ipv6 =
+        (*i)->GetNode ()->GetObject<Ipv6L3Protocol> ();
+      NS_ASSERT_MSG (ipv6, "Node " << (*i)->GetNode ()->GetId ()
+          << " has no IPv6 stack");
+      int32_t index = ipv6->GetInterfaceForDevice (*i);
+      NS_ASSERT_MSG (index >= 0, "Device has no IPv6 interface");
+      interfaces.push_back (ipv6->GetInterface (index));
+    }
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<NdiscCache> cache = interfaces[i]->GetNdiscCache ();
+      for (uint32_t j = 0; j < c.GetN (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          // The 6LoWPAN device reports the Mac16Address of the BLE device
+          Address mac = c.Get (j)->GetAddress ();
+          for (uint32_t k = 0; k < interfaces[j]->GetNAddresses (); k++)
+            {
+              Ipv6Address addr = interfaces[j]->GetAddress (k).GetAddress ();
+              NdiscCache::Entry *entry = cache->Lookup (addr);
+              if (!entry)
+                {
+                  entry = cache->Add (addr);
+                }
+              entry->SetMacAddress (mac);
+              entry->MarkPermanent ();
+            }
+        }
+    }
+}
+
+void
+BleHelper::SetLinkAbstraction (bool enable)
+{
+  if (!enable)
+    {
+      m_linkChannel = 0;
+      return;
+    }
+  if (m_linkChannel == 0)
+    {
+#ifdef NS3_MPI
+      // The ranks exchange the transmissions to each other's nodes
+      if (MpiInterface::IsEnabled ())
+        m_linkChannel = CreateObject<BleRemoteLinkChannel> ();
+      else
+#endif
+      m_linkChannel = CreateObject<BleLinkChannel> ();
+      m_linkChannel->SetPropagationLossModel (m_lossModel);
+      m_linkChannel->SetPropagationDelayModel (m_delayModel);
+    }
+}
+
+Ptr<BleLinkChannel>
+BleHelper::GetLinkChannel (void)
+{
+  return m_linkChannel;
+}
+
 Ptr<SpectrumChannel>
 BleHelper::GetChannel (void)
 {
@@ -266,6 +436,7 @@ void
 BleHelper::SetChannel (Ptr<SpectrumChannel> channel)
 {
   m_channel = channel;
+  ConstructAllChannels ();
 }
 
 void
@@ -273,6 +444,7 @@ BleHelper::SetChannel (std::string channelName)
 {
   Ptr<SpectrumChannel> channel = Names::Find<SpectrumChannel> (channelName);
   m_channel = channel;
+  ConstructAllChannels ();
 }
 
 
@@ -287,7 +459,34 @@ BleHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
       Ptr<BleNetDevice> Ble = DynamicCast<BleNetDevice> (netDevice);
       if (Ble)
         {
-          //currentStream += Ble->AssignStreams (currentStream);
+          currentStream += Ble->AssignStreams (currentStream);
+          Ptr<BleMeshNetwork> mesh =
+            Ble->GetNode ()->GetObject<BleMeshNetwork> ();
+          if (mesh)
+            {
+              currentStream += mesh->AssignStreams (currentStream);
+            }
+        }
+    }
+  // Created here with a fixed stream, so that they never take an
+  // automatic stream of the scenario
+  m_destination = CreateObjectWithAttributes<UniformRandomVariable> (
+      "Stream", IntegerValue (currentStream++));
+  m_interfererStart = CreateObjectWithAttributes<UniformRandomVariable> (
+      "Stream", IntegerValue (currentStream++));
+  return (currentStream - stream);
+}
+
+int64_t
+BleHelper::AssignStreams (ApplicationContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (ApplicationContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<BleApplication> app = DynamicCast<BleApplication> (*i);
+      if (app)
+        {
+          currentStream += app->AssignStreams (currentStream);
         }
     }
   return (currentStream - stream);
@@ -544,6 +743,79 @@ BleHelper::GenerateTraffic(Ptr<RandomVariableStream> var, Ptr<Node> node,
   return app;
 }
 
+ApplicationContainer
+BleHelper::GenerateTraffic(Ptr<RandomVariableStream> var,
+    NodeContainer nodes, TrafficPattern pattern, int packet_size,
+    double start, double duration)
+{
+  NS_LOG_FUNCTION (this << pattern);
+  uint32_t n = nodes.GetN ();
+  NS_ABORT_MSG_IF (n < 2, "Traffic needs at least 2 nodes");
+  std::vector<std::pair<uint32_t, uint32_t> > flows;
+  switch (pattern)
+    {
+    case CHAIN_PATTERN:
+      for (uint32_t i = 0; i + 1 < n; i++)
+        flows.push_back (std::make_pair (i, i + 1));
+      break;
+    case STAR_PATTERN:
+      for (uint32_t i = 1; i < n; i++)
+        {
+          flows.push_back (std::make_pair (i, 0));
+          flows.push_back (std::make_pair (0, i));
+        }
+      break;
+    case MANY_TO_ONE_PATTERN:
+      for (uint32_t i = 1; i < n; i++)
+        flows.push_back (std::make_pair (i, 0));
+      break;
+    case RANDOM_PATTERN:
+      if (m_destination == 0)
+        {
+          m_destination = CreateObject<UniformRandomVariable> ();
+        }
+      for (uint32_t i = 0; i < n; i++)
+        {
+          // Any node but i
+          uint32_t j = m_destination->GetInteger (0, n - 2);
+          flows.push_back (std::make_pair (i, j < i ? j : j + 1));
+        }
+      break;
+    }
+
+  ApplicationContainer apps;
+  for (auto &flow : flows)
+    {
+      Ptr<BleApplication> app = CreateObject<BleApplication> ();
+      app->SetAttribute ("TrafficModel",
+          PointerValue (m_trafficFactory.Create<BleTrafficModel> ()));
+      app->SetAttribute ("DataSize", UintegerValue (packet_size));
+      app->SetAttribute ("StartTime",
+          TimeValue (Seconds (start + var->GetValue ())));
+      app->SetAttribute ("StopTime", TimeValue (Seconds (start + duration)));
+      Ptr<BleNetDevice> dest = DynamicCast<BleNetDevice> (
+          nodes.Get (flow.second)->GetDevice (0));
+      app->SetAttribute ("Destination",
+          Mac16AddressValue (dest->GetAddress16 ()));
+      nodes.Get (flow.first)->AddApplication (app);
+      apps.Add (app);
+    }
+  return apps;
+}
+
+void
+BleHelper::SetTrafficModel (std::string type)
+{
+  m_trafficFactory = ObjectFactory ();
+  m_trafficFactory.SetTypeId (type);
+}
+
+void
+BleHelper::SetTrafficModelAttribute (std::string n, const AttributeValue &v)
+{
+  m_trafficFactory.Set (n, v);
+}
+
 Ptr<Application>
 BleHelper::GenerateBroadcastTraffic(Ptr<RandomVariableStream> var, Ptr<Node> node, int packet_size, double start, double duration, double interval, double offset)
 {
@@ -586,6 +858,55 @@ BleHelper::InstallNetworkApplication (std::string type,
   m_netApp.push_back(factory);
 }
 
+Ptr<Application>
+BleHelper::GenerateMeshTraffic(Ptr<RandomVariableStream> var, Ptr<Node> node,
+    int packet_size, double start, double duration, double interval,
+    Mac16Address destination)
+{
+  Ptr<BleApplication> app = CreateObject<BleApplication>();
+
+  app->SetAttribute ("InterPacketTime",TimeValue( Seconds (interval)));
+  app->SetAttribute ("DataSize",UintegerValue (packet_size));
+  app->SetAttribute ("StartTime", TimeValue( Seconds (start + var-> GetValue ())));
+  app->SetAttribute ("StopTime", TimeValue( Seconds (start + duration )));
+  app->SetAttribute ("Destination", Mac16AddressValue(destination));
+  app->SetAttribute ("Mesh", BooleanValue (true));
+  node->AddApplication (app);
+  return app;
+}
+
+ApplicationContainer
+BleHelper::GenerateGattTraffic(Ptr<RandomVariableStream> var, Ptr<Node> node,
+    Ptr<Node> collector, int sample_size, double start, double duration,
+    double interval)
+{
+  Ptr<BleNetDevice> sensorDevice = DynamicCast<BleNetDevice>(node->GetDevice(0));
+  Ptr<BleNetDevice> collectorDevice =
+    DynamicCast<BleNetDevice>(collector->GetDevice(0));
+
+  Ptr<BleGattApplication> sensor = m_gattFactory.Create<BleGattApplication> ();
+  sensor->SetAttribute ("SampleInterval", TimeValue (Seconds (interval)));
+  sensor->SetAttribute ("SampleSize", UintegerValue (sample_size));
+  sensor->SetAttribute ("Peer", Mac16AddressValue (collectorDevice->GetAddress16()));
+  sensor->SetAttribute ("StartTime", TimeValue( Seconds (start + var-> GetValue ())));
+  node->AddApplication (sensor);
+  sensor->SetNetDevice (sensorDevice);
+
+  Ptr<BleGattApplication> sink = m_gattFactory.Create<BleGattApplication> ();
+  sink->SetAttribute ("SampleInterval", TimeValue (Seconds (0)));
+  sink->SetAttribute ("SampleSize", UintegerValue (sample_size));
+  sink->SetAttribute ("Peer", Mac16AddressValue (sensorDevice->GetAddress16()));
+  sink->SetAttribute ("StartTime", TimeValue( Seconds (start)));
+  collector->AddApplication (sink);
+  sink->SetNetDevice (collectorDevice);
+
+  ApplicationContainer apps;
+  apps.Add (sensor);
+  apps.Add (sink);
+  apps.Stop (Seconds(start+duration));
+  return apps;
+}
+
 void
 BleHelper::CreateBroadcastLink (NetDeviceContainer c, 
     bool scheduled, uint32_t nbConnInterval, bool collAvoid)
@@ -609,6 +930,94 @@ BleHelper::CreateBroadcastLink (NetDeviceContainer c,
           scheduled, nbOffset, nbConnInterval, collAvoid);
 }
 
+void
+BleHelper::EnableCis (Ptr<NetDevice> a, Ptr<NetDevice> b)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<BleNetDevice> bleA = DynamicCast<BleNetDevice> (a);
+  Ptr<BleNetDevice> bleB = DynamicCast<BleNetDevice> (b);
+  Ptr<BleLinkManager> lmA =
+    bleA->GetBBManager ()->GetLinkManager (bleB->GetAddress16 ());
+  Ptr<BleLinkManager> lmB =
+    bleB->GetBBManager ()->GetLinkManager (bleA->GetAddress16 ());
+  NS_ABORT_MSG_IF (lmA->GetAssociatedLink () == 0
+      || lmB->GetAssociatedLink () == 0,
+      "No link between " << bleA->GetAddress16 () << " and "
+      << bleB->GetAddress16 () << ", create it with lazy false");
+  lmA->SetIsoStream (m_isoFactory.Create<BleIsoStream> ());
+  lmB->SetIsoStream (m_isoFactory.Create<BleIsoStream> ());
+}
+
+void
+BleHelper::EnableBis (NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<BleLinkManager> lm = DynamicCast<BleNetDevice> (*i)
+        ->GetBBManager ()->GetLinkManager (Mac16Address ("FF:FF"));
+      NS_ABORT_MSG_IF (lm->GetAssociatedLink () == 0,
+          "Call CreateBroadcastLink before EnableBis");
+      lm->SetIsoStream (m_isoFactory.Create<BleIsoStream> ());
+    }
+}
+
+Ptr<BleIsoStream>
+BleHelper::GetIsoStream (Ptr<NetDevice> device, Mac16Address peer)
+{
+  Ptr<BleLinkManager> lm = DynamicCast<BleNetDevice> (device)
+    ->GetBBManager ()->GetLinkManager (peer);
+  return lm->GetIsoStream ();
+}
+
+NetDeviceContainer
+BleHelper::AddInterferers (NodeContainer c, Ptr<SpectrumValue> psd,
+    Time period, double dutyCycle)
+{
+  NS_LOG_FUNCTION (this << period << dutyCycle);
+  NS_ABORT_MSG_IF (dutyCycle <= 0 || dutyCycle > 1,
+      "The duty cycle must be in (0, 1]");
+  WaveformGeneratorHelper waveformGeneratorHelper;
+  waveformGeneratorHelper.SetChannel (m_channel);
+  waveformGeneratorHelper.SetTxPowerSpectralDensity (psd);
+  waveformGeneratorHelper.SetPhyAttribute ("Period", TimeValue (period));
+  waveformGeneratorHelper.SetPhyAttribute ("DutyCycle",
+      DoubleValue (dutyCycle));
+  NetDeviceContainer devices = waveformGeneratorHelper.Install (c);
+
+  // Random phases, interferers that all start at 0 would hit the same
+  // BLE packets
+  if (m_interfererStart == 0)
+    {
+      m_interfererStart = CreateObject<UniformRandomVariable> ();
+    }
+  for (NetDeviceContainer::Iterator i = devices.Begin ();
+      i != devices.End (); ++i)
+    {
+      Ptr<WaveformGenerator> generator = DynamicCast<WaveformGenerator> (
+          DynamicCast<NonCommunicatingNetDevice> (*i)->GetPhy ());
+      Simulator::Schedule (
+          Seconds (m_interfererStart->GetValue (0, period.GetSeconds ())),
+          &WaveformGenerator::Start, generator);
+    }
+  return devices;
+}
+
+NetDeviceContainer
+BleHelper::AddWifiInterferers (NodeContainer c, uint8_t wifiChannel,
+    double txPowerDbm, double dutyCycle, Time period)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) wifiChannel << txPowerDbm);
+  NS_ABORT_MSG_IF (wifiChannel < 1 || wifiChannel > 13,
+      "2.4 GHz Wi-Fi channels are 1 to 13");
+  uint32_t centerFrequency = 2407 + 5 * wifiChannel;
+  Ptr<SpectrumValue> psd =
+    WifiSpectrumValueHelper::CreateOfdmTxPowerSpectralDensity (
+        centerFrequency, 20, WifiSpectrumValueHelper::DbmToW (txPowerDbm),
+        20, -20, -28, -40);
+  return AddInterferers (c, psd, period, dutyCycle);
+}
+
 void
 BleHelper::CreateAllLinks (NetDeviceContainer c, 
     bool scheduled, uint32_t nbConnInterval)
@@ -632,6 +1041,304 @@ BleHelper::CreateAllLinks (NetDeviceContainer c,
  
     }
 }
+
+void
+BleHelper::CreateLinks (NetDeviceContainer c,
+    const std::vector<std::pair<uint32_t, uint32_t> > &pairs,
+    bool scheduled, uint32_t nbConnInterval, bool lazy)
+{
+  NS_LOG_FUNCTION (this << pairs.size () << lazy);
+  // usedOffsets[i][o]: device i already has a link with offset o
+  std::vector<std::vector<bool> > usedOffsets (c.GetN ());
+  std::set<std::pair<uint32_t, uint32_t> > done;
+  uint32_t nbOffsets = 0;
+  for (const auto &pair : pairs)
+    {
+      uint32_t i = pair.first;
+      uint32_t j = pair.second;
+      NS_ASSERT_MSG (i < c.GetN () && j < c.GetN (),
+          "Link " << i << "-" << j << " refers to an unknown device");
+      if (i == j
+          || !done.insert (std::make_pair (std::min (i, j), std::max (i, j)))
+          .second)
+        continue;
+      uint32_t offset = 0;
+      while ((offset < usedOffsets[i].size () && usedOffsets[i][offset])
+          || (offset < usedOffsets[j].size () && usedOffsets[j][offset]))
+        offset++;
+      for (uint32_t k : {i, j})
+        {
+          if (usedOffsets[k].size () <= offset)
+            usedOffsets[k].resize (offset + 1, false);
+          usedOffsets[k][offset] = true;
+        }
+      nbOffsets = std::max (nbOffsets, offset + 1);
+
+      // In a distributed simulation the rank of a node runs its links,
+      // the offsets are still assigned the same way on every rank
+      if (c.Get (i)->GetNode ()->GetSystemId () != Simulator::GetSystemId ()
+          && c.Get (j)->GetNode ()->GetSystemId () != Simulator::GetSystemId ())
+        continue;
+
+      Ptr<BleBBManager> master =
+        DynamicCast<BleNetDevice> (c.Get (i))->GetBBManager ();
+      Ptr<BleBBManager> slave =
+        DynamicCast<BleNetDevice> (c.Get (j))->GetBBManager ();
+      if (lazy)
+        {
+          master->AddPotentialLink (slave, scheduled, offset, nbConnInterval);
+        }
+      else
+        master->CreateLinkScheduled (slave, BleLinkManager::Role::MASTER_ROLE,
+            scheduled, offset, nbConnInterval);
+    }
+  // A TX window takes 6 slots of 1.25 ms (see BleLinkManager::SetupLink)
+  if (scheduled && nbOffsets * 6 > nbConnInterval)
+    NS_LOG_WARN ("Connection interval " << nbConnInterval
+        << " is too short for " << nbOffsets
+        << " TX window offsets, windows will overlap");
+  NS_LOG_INFO ("Created " << done.size () << " links using " << nbOffsets
+      << " TX window offsets");
+}
+
+void
+BleHelper::CreateLinksInRange (NetDeviceContainer c, double range,
+    bool scheduled, uint32_t nbConnInterval, bool lazy)
+{
+  NS_LOG_FUNCTION (this << range);
+  NS_ASSERT (range > 0);
+  // Bucket the devices in a grid of range x range cells, so only the
+  // devices in the 9 surrounding cells need to be compared.
+  typedef std::pair<int64_t, int64_t> Cell;
+  std::map<Cell, std::vector<uint32_t> > grid;
+  std::vector<Vector> positions (c.GetN ());
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility =
+        c.Get (i)->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (mobility, "Device " << i << " has no mobility model");
+      positions[i] = mobility->GetPosition ();
+      grid[Cell (std::floor (positions[i].x / range),
+          std::floor (positions[i].y / range))].push_back (i);
+    }
+
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      int64_t cx = std::floor (positions[i].x / range);
+      int64_t cy = std::floor (positions[i].y / range);
+      for (int64_t dx = -1; dx <= 1; dx++)
+        for (int64_t dy = -1; dy <= 1; dy++)
+          {
+            auto cell = grid.find (Cell (cx + dx, cy + dy));
+            if (cell == grid.end ())
+              continue;
+            for (uint32_t j : cell->second)
+              {
+                if (j > i
+                    && CalculateDistance (positions[i], positions[j]) <= range)
+                  pairs.push_back (std::make_pair (i, j));
+              }
+          }
+    }
+  CreateLinks (c, pairs, scheduled, nbConnInterval, lazy);
+}
+
+void
+BleHelper::CreateLinksToNearest (NetDeviceContainer c, uint32_t k,
+    bool scheduled, uint32_t nbConnInterval, bool lazy)
+{
+  NS_LOG_FUNCTION (this << k);
+  std::vector<Vector> positions (c.GetN ());
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility =
+        c.Get (i)->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (mobility, "Device " << i << " has no mobility model");
+      positions[i] = mobility->GetPosition ();
+    }
+
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  std::vector<std::pair<double, uint32_t> > distances;
+  uint32_t nbNeighbours = std::min (k, c.GetN () - 1);
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      distances.clear ();
+      for (uint32_t j = 0; j < c.GetN (); j++)
+        {
+          if (j != i)
+            distances.push_back (std::make_pair (
+                  CalculateDistance (positions[i], positions[j]), j));
+        }
+      std::partial_sort (distances.begin (),
+          distances.begin () + nbNeighbours, distances.end ());
+      for (uint32_t n = 0; n < nbNeighbours; n++)
+        pairs.push_back (std::make_pair (i, distances[n].second));
+    }
+  CreateLinks (c, pairs, scheduled, nbConnInterval, lazy);
+}
+
+void
+BleHelper::CreateLinksFromFile (NetDeviceContainer c, std::string filename,
+    bool scheduled, uint32_t nbConnInterval, bool lazy)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open " << filename);
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (file, line))
+    {
+      lineNumber++;
+      if (line.empty () || line[0] == '#' || line[0] == '\r')
+        continue;
+      std::replace (line.begin (), line.end (), ',', ' ');
+      std::istringstream fields (line);
+      uint32_t i, j;
+      NS_ABORT_MSG_UNLESS (fields >> i >> j,
+          filename << ":" << lineNumber << ": expected \"master,slave\"");
+      pairs.push_back (std::make_pair (i, j));
+    }
+  CreateLinks (c, pairs, scheduled, nbConnInterval, lazy);
+}
+
+NetDeviceContainer
+BleHelper::LoadScenario (std::string filename, Ptr<RandomVariableStream> var)
+{
+  NS_LOG_FUNCTION (this << filename);
+  SystemWallClockMs clock;
+  clock.Start ();
+  std::ifstream file (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open " << filename);
+
+  struct NodeRecord
+  {
+    Vector position;
+    double txPowerDbm;
+    bool txPower;
+  };
+  struct TrafficRecord
+  {
+    uint32_t source;
+    uint32_t destination;
+    int packetSize;
+    double start;
+    double duration;
+    double interval;
+  };
+  std::vector<NodeRecord> nodeRecords;
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  std::vector<TrafficRecord> trafficRecords;
+  uint32_t nbConnInterval = 80;
+  bool lazy = false;
+  double dataRate = 0;
+
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (file, line))
+    {
+      lineNumber++;
+      if (line.empty () || line[0] == '#' || line[0] == '\r')
+        continue;
+      std::replace (line.begin (), line.end (), ',', ' ');
+      std::istringstream fields (line);
+      std::string type;
+      fields >> type;
+      if (type == "node")
+        {
+          NodeRecord node;
+          NS_ABORT_MSG_UNLESS (fields >> node.position.x >> node.position.y
+              >> node.position.z, filename << ":" << lineNumber
+              << ": expected \"node,x,y,z[,txPowerDbm]\"");
+          node.txPower = static_cast<bool> (fields >> node.txPowerDbm);
+          nodeRecords.push_back (node);
+        }
+      else if (type == "link")
+        {
+          uint32_t i, j;
+          NS_ABORT_MSG_UNLESS (fields >> i >> j, filename << ":"
+              << lineNumber << ": expected \"link,master,slave\"");
+          pairs.push_back (std::make_pair (i, j));
+        }
+      else if (type == "traffic")
+        {
+          TrafficRecord traffic;
+          NS_ABORT_MSG_UNLESS (fields >> traffic.source
+              >> traffic.destination >> traffic.packetSize >> traffic.start
+              >> traffic.duration >> traffic.interval,
+              filename << ":" << lineNumber << ": expected \"traffic,"
+              "source,destination,packetSize,start,duration,interval\"");
+          trafficRecords.push_back (traffic);
+        }
+      else if (type == "conn")
+        {
+          NS_ABORT_MSG_UNLESS (fields >> nbConnInterval, filename << ":"
+              << lineNumber << ": expected \"conn,nbConnInterval[,lazy]\"");
+          std::string lazyField;
+          if (fields >> lazyField)
+            {
+              NS_ABORT_MSG_UNLESS (lazyField == "0" || lazyField == "1",
+                  filename << ":" << lineNumber << ": lazy must be 0 or 1");
+              lazy = lazyField == "1";
+            }
+        }
+      else if (type == "phy")
+        {
+          NS_ABORT_MSG_UNLESS (fields >> dataRate && dataRate > 0,
+              filename << ":" << lineNumber << ": expected \"phy,dataRate\"");
+        }
+      else
+        {
+          NS_ABORT_MSG (filename << ":" << lineNumber
+              << ": unknown record \"" << type << "\"");
+        }
+    }
+  uint32_t nNodes = nodeRecords.size ();
+  for (auto &pair : pairs)
+    NS_ABORT_MSG_UNLESS (pair.first < nNodes && pair.second < nNodes,
+        filename << ": link " << pair.first << "," << pair.second
+        << " to a node that does not exist");
+  for (auto &traffic : trafficRecords)
+    NS_ABORT_MSG_UNLESS (traffic.source < nNodes
+        && traffic.destination < nNodes, filename << ": traffic "
+        << traffic.source << "," << traffic.destination
+        << " of a node that does not exist");
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility =
+        CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (nodeRecords[nodeI].position);
+      nodes.Get (nodeI)->AggregateObject (mobility);
+    }
+  NetDeviceContainer devices = Install (nodes);
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<BlePhy> phy =
+        DynamicCast<BleNetDevice> (devices.Get (nodeI))->GetPhy ();
+      if (nodeRecords[nodeI].txPower)
+        phy->SetPower (std::pow (10.0, nodeRecords[nodeI].txPowerDbm / 10)
+            / 1000);
+      if (dataRate > 0)
+        phy->SetDataRate (dataRate);
+    }
+  if (! pairs.empty ())
+    CreateLinks (devices, pairs, true, nbConnInterval, lazy);
+  for (auto &traffic : trafficRecords)
+    {
+      GenerateTraffic (var, nodes.Get (traffic.source), traffic.packetSize,
+          traffic.start, traffic.duration, traffic.interval,
+          nodes.Get (traffic.destination));
+    }
+
+  NS_LOG_INFO ("Built " << nNodes << " nodes, " << pairs.size ()
+      << " links and " << trafficRecords.size () << " flows of "
+      << filename << " in " << clock.End () << " ms");
+  return devices;
+}
 	
 } // namespace ns3
 
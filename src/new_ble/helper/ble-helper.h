@@ -36,11 +36,19 @@
 
 #include "ns3/attribute.h"
 #include "ns3/object-factory.h"
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
   class SpectrumChannel;
+  class BleLinkChannel;
+  class PropagationLossModel;
+  class PropagationDelayModel;
   class MobilityModel;
+  class BleTraceSink;
+  class BleStatsCollector;
+  class BleIsoStream;
   class RandomVariableStream;
   /**
    * \ingroup ble
@@ -61,6 +69,15 @@ namespace ns3 {
   public AsciiTraceHelperForDevice
   {
   public:
+    // Destinations of GenerateTraffic with a traffic model
+    enum TrafficPattern
+    {
+      CHAIN_PATTERN, // Node i sends to node i+1
+      STAR_PATTERN, // Node 0 is a gateway that exchanges with every node
+      MANY_TO_ONE_PATTERN, // Every node sends to node 0
+      RANDOM_PATTERN // Every node sends to a random other node
+    };
+
 
     /**
      * \brief Generate constant traffic from dev
@@ -94,6 +111,42 @@ namespace ns3 {
         Ptr<Node> node, int packet_size, double start, 
         double duration, double interval, double offset);
 
+    // Traffic from node to destination as mesh network PDUs, see InstallMesh
+    Ptr<Application> GenerateMeshTraffic(Ptr<RandomVariableStream> var,
+        Ptr<Node> node, int packet_size, double start,
+        double duration, double interval, Mac16Address destination);
+
+    /*
+     * Sensor samples of sample_size bytes from node to collector over
+     * GATT, every interval seconds. Installs a BleGattApplication on both
+     * nodes, made with the SetGattAttribute values; the sensor is the
+     * first application of the container.
+     */
+    ApplicationContainer GenerateGattTraffic(Ptr<RandomVariableStream> var,
+        Ptr<Node> node, Ptr<Node> collector, int sample_size, double start,
+        double duration, double interval);
+
+    /*
+     * Traffic between the nodes in the given pattern, every application
+     * with its own traffic model made with SetTrafficModel. The
+     * applications start at start plus a value of var. The links between
+     * the senders and destinations must exist or be lazy; with
+     * RANDOM_PATTERN use CreateAllLinks.
+     */
+    ApplicationContainer GenerateTraffic(Ptr<RandomVariableStream> var,
+        NodeContainer nodes, TrafficPattern pattern, int packet_size,
+        double start, double duration);
+
+    /*
+     * The traffic model of GenerateTraffic with a pattern, e.g.
+     * ns3::BlePoissonTraffic, ns3::BleOnOffTraffic or
+     * ns3::BleTraceTraffic (default ns3::BlePeriodicTraffic)
+     */
+    void SetTrafficModel (std::string type);
+
+    // Set an attribute of the traffic models made by GenerateTraffic
+    void SetTrafficModelAttribute (std::string n, const AttributeValue &v);
+
     /**
      * \brief Create a BLE helper in an empty state.
      */
@@ -124,6 +177,24 @@ namespace ns3 {
      */
     Ptr<SpectrumChannel> GetChannel (void);
 
+    /**
+     * \brief Install the next devices on a BleLinkChannel
+     *
+     * The PHYs exchange powers per channel and look up the packet error
+     * rate in a table instead of computing power spectral densities and
+     * sampling bits on the SpectrumChannel, with the propagation models
+     * of the helper. Much faster for network layer studies, the rest of
+     * the stack is the same. Signals of the Wi-Fi interferers and
+     * waveform generators on the SpectrumChannel do not reach these
+     * PHYs.
+     *
+     * With MPI enabled the channel is a BleRemoteLinkChannel: create the
+     * nodes with their rank as system id and call its BoundLookAhead
+     * before Simulator::Run.
+     */
+    void SetLinkAbstraction (bool enable);
+    Ptr<BleLinkChannel> GetLinkChannel (void);
+
     /**
      * \brief Add mobility model to a physical device
      * \param phy the physical device
@@ -138,6 +209,77 @@ namespace ns3 {
     NetDeviceContainer Install (NodeContainer c);//为节点安装 BLE 网络设备
 
     void AddCallbacks (std::string traceSource, CallbackBase callback);
+
+    /**
+     * \brief Trace the PHY/MAC events of the devices to a binary file
+     *
+     * Much cheaper than the ascii and pcap traces: packets are not
+     * printed or copied, and records are buffered before being written.
+     * Convert the file offline with the ble-trace-convert program.
+     *
+     * \param filename the trace file, truncated if it exists
+     * \param c the devices to trace
+     * \returns the sink; it flushes and closes the file when disposed
+     */
+    Ptr<BleTraceSink> EnableBinaryTrace (std::string filename,
+        NetDeviceContainer c);
+
+    /**
+     * \brief Collect per node, per link and per channel statistics
+     *
+     * \param c the devices to follow
+     * \returns the collector, see BleStatsCollector::EnableSnapshots for
+     *          periodic output
+     */
+    Ptr<BleStatsCollector> EnableStatistics (NetDeviceContainer c);
+
+    // Set an attribute of the BleMeshNetwork objects made by InstallMesh
+    void SetMeshAttribute (std::string n, const AttributeValue &v);
+
+    // Set an attribute of the applications made by GenerateGattTraffic
+    void SetGattAttribute (std::string n, const AttributeValue &v);
+
+    // Set an attribute of the streams made by EnableCis and EnableBis
+    void SetIsoAttribute (std::string n, const AttributeValue &v);
+
+    /**
+     * \brief Add a BLE Mesh network layer to the devices
+     *
+     * Aggregates a BleMeshNetwork to the node of every device. The PDUs
+     * are sent on the broadcast link, so call CreateBroadcastLink on the
+     * same devices. Get the layer with node->GetObject<BleMeshNetwork> ().
+     *
+     * \param c the devices, at most one per node
+     */
+    void InstallMesh (NetDeviceContainer c);
+
+    /**
+     * \brief Put 6LoWPAN on top of the devices (IPv6 over BLE, RFC 7668)
+     *
+     * Enables NeedsArp on the BLE devices, so IPv6 sends unicast packets
+     * to the link address of the neighbour instead of FF:FF, and installs
+     * a SixLowPanNetDevice on each of them for header compression and
+     * fragmentation. Install the IPv6 stack on the nodes first and assign
+     * the addresses to the returned devices; the link-local addresses are
+     * derived from the Mac16Address of the BLE device. Multicast packets
+     * are sent to FF:FF, so also call CreateBroadcastLink.
+     *
+     * \param c the BLE devices
+     * \returns the 6LoWPAN devices
+     */
+    NetDeviceContainer InstallSixLowPan (NetDeviceContainer c);
+
+    /**
+     * \brief Fill the IPv6 neighbour caches from the link addresses
+     *
+     * As the interface identifiers are derived from the link addresses
+     * (RFC 7668 section 3.2.3), every address of a neighbour is mapped to
+     * its Mac16Address in a permanent cache entry and no Neighbor
+     * Discovery packets are sent. Call it after the addresses are assigned.
+     *
+     * \param c the 6LoWPAN devices returned by InstallSixLowPan
+     */
+    void PopulateNeighbourCaches (NetDeviceContainer c);
     
     /**
      * Helper to enable all Ble log components with one statement
@@ -146,17 +288,33 @@ namespace ns3 {
 
     /**
      * Assign a fixed random variable stream number to the random variables
-     * used by this model. Return the number of streams that have been
-     * assigned. The Install() method should have previously been
-     * called by the user.
+     * used by this model: the bit errors of the PHY, the channel maps and
+     * random connection parameters of new links and the relay delay of
+     * the mesh network of the node, and the destinations and interferer
+     * start phases this helper draws in GenerateTraffic and
+     * AddInterferers. Return the number of streams that have been
+     * assigned. Call it after Install() (and InstallMesh()) and before
+     * the links are created and the traffic and interferers added, so
+     * every process or MPI rank that builds the same scenario draws the
+     * same numbers.
      *
      * \param c NetDeviceContainer of the set of net devices for which the 
-     *          CsmaNetDevice should be modified to use a fixed stream
-     * \param stream first streaem index to use
+     *          BleNetDevice should be modified to use a fixed stream
+     * \param stream first stream index to use
      * \return the number of stream indices assigned by this helper
      */
     int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
 
+    /**
+     * Same for the traffic models of the BleApplications in the
+     * container, e.g. those of GenerateTraffic.
+     *
+     * \param c the applications
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams (ApplicationContainer c, int64_t stream);
+
 
     /*
      * Creates all possible links between the devices in the container
@@ -166,12 +324,114 @@ namespace ns3 {
     void CreateAllLinks (NetDeviceContainer c, 
         bool scheduled, uint32_t nbConnInterval);
 
+    /*
+     * Creates links between the devices in the given pairs of indices
+     * in c, the first device of a pair is the master. The TX window
+     * offsets are assigned per device (greedy edge colouring), so the
+     * links of one device never share an offset and far fewer offsets
+     * are needed than with CreateAllLinks.
+     * If lazy, the link managers of a pair are only created when the
+     * first packet for the link is handled; whichever device sends
+     * first becomes the master, instead of the first one of the pair.
+     */
+    void CreateLinks (NetDeviceContainer c,
+        const std::vector<std::pair<uint32_t, uint32_t> > &pairs,
+        bool scheduled, uint32_t nbConnInterval, bool lazy = false);
+
+    /*
+     * Creates links between all devices within range (meter) of each
+     * other, see CreateLinks
+     */
+    void CreateLinksInRange (NetDeviceContainer c, double range,
+        bool scheduled, uint32_t nbConnInterval, bool lazy = false);
+
+    /*
+     * Creates links from every device to its k nearest devices,
+     * see CreateLinks
+     */
+    void CreateLinksToNearest (NetDeviceContainer c, uint32_t k,
+        bool scheduled, uint32_t nbConnInterval, bool lazy = false);
+
+    /*
+     * Creates the links of an adjacency CSV file, one "master,slave"
+     * pair of indices in c per line; empty lines and lines starting
+     * with # are skipped. See CreateLinks
+     */
+    void CreateLinksFromFile (NetDeviceContainer c, std::string filename,
+        bool scheduled, uint32_t nbConnInterval, bool lazy = false);
+
+    /*
+     * Builds the scenario of a CSV file with one record per line, the
+     * first field is the type of the record; empty lines and lines
+     * starting with # are skipped:
+     *
+     *   conn,<nbConnInterval>[,<lazy>]   links, default 80 and lazy 0;
+     *                                    lazy is 0 or 1
+     *   phy,<dataRate>                   air time bit rate of every PHY
+     *   node,<x>,<y>,<z>[,<txPowerDbm>]  nodes are numbered in file order
+     *   link,<master>,<slave>            see CreateLinks
+     *   traffic,<source>,<destination>,<packetSize>,<start>,<duration>,
+     *     <interval>                     see GenerateTraffic, in seconds;
+     *                                    the start is delayed by var
+     *
+     * The roles are not stored per node: a node is master of the links
+     * that list it first and slave of the others, so it may be both.
+     * With lazy 1 the first of both to send becomes the master instead.
+     *
+     * The file is parsed before anything is built. Every node gets a
+     * ConstantPositionMobilityModel and the devices are configured with
+     * the typed setters of BlePhy instead of attribute lookups per node.
+     *
+     * \returns the devices, in the order of the node records
+     */
+    NetDeviceContainer LoadScenario (std::string filename,
+        Ptr<RandomVariableStream> var);
+
     /*
      * Setups a broadcast link
      */
     void CreateBroadcastLink (NetDeviceContainer c, 
         bool scheduled, uint32_t nbConnInterval, bool collAvoid);
 
+    /*
+     * Turns the connection between a and b into a connected isochronous
+     * stream (CIS), made with the SetIsoAttribute values. The ISO
+     * interval is the connection interval. The link must exist, so
+     * create it with CreateAllLinks or with lazy false.
+     */
+    void EnableCis (Ptr<NetDevice> a, Ptr<NetDevice> b);
+
+    /*
+     * Turns the broadcast link of the devices into broadcast
+     * isochronous streams (BIS), see EnableCis. All broadcasters send
+     * in the same sub-events, so use one broadcaster per group.
+     */
+    void EnableBis (NetDeviceContainer c);
+
+    // The stream of device towards peer, FF:FF for the BIS
+    Ptr<BleIsoStream> GetIsoStream (Ptr<NetDevice> device,
+        Mac16Address peer);
+
+    /*
+     * Installs a WaveformGenerator on every node of c that transmits psd
+     * on the BLE channel for dutyCycle of every period, each starting at
+     * a random moment of the first period. The nodes need a mobility
+     * model. Use it for microwave ovens
+     * (MicrowaveOvenSpectrumValueHelper) or other 2.4 GHz sources.
+     */
+    NetDeviceContainer AddInterferers (NodeContainer c,
+        Ptr<SpectrumValue> psd, Time period, double dutyCycle);
+
+    /*
+     * Adds a 20 MHz OFDM Wi-Fi transmitter on 2.4 GHz channel wifiChannel
+     * (1 to 13, centre 2407 + 5 * wifiChannel MHz) on every node of c,
+     * see AddInterferers. The duty cycle is the airtime share of the
+     * Wi-Fi network and period the length of a frame and its gap.
+     */
+    NetDeviceContainer AddWifiInterferers (NodeContainer c,
+        uint8_t wifiChannel, double txPowerDbm, double dutyCycle,
+        Time period = MicroSeconds (2000));
+
 /**
    * \param type the type of the model to set
    * \param n0 the name of the attribute to set
@@ -246,9 +506,18 @@ private:
 			Ptr<NetDevice> nd,
 			bool explicitFilename);
 
+    // Points the 40 logical BLE channels to the shared m_channel
     void ConstructAllChannels ();
 
   Ptr<SpectrumChannel> m_channel; //!< channel to be used for the devices
+  Ptr<BleLinkChannel> m_linkChannel; //!< used instead of m_channel if set
+  Ptr<PropagationLossModel> m_lossModel;
+  Ptr<PropagationDelayModel> m_delayModel;
+  // Destinations of the RANDOM_PATTERN of GenerateTraffic, created by
+  // AssignStreams or on first use
+  Ptr<UniformRandomVariable> m_destination;
+  // Start phases of the interferers of AddInterferers
+  Ptr<UniformRandomVariable> m_interfererStart;
 	
   typedef std::tuple<std::string,CallbackBase> callbacktuple;
   std::list<callbacktuple > m_callbacks;
@@ -262,6 +531,10 @@ private:
   ObjectFactory m_queueFactory;
   ObjectFactory m_deviceFactory;
   ObjectFactory m_channelFactory;
+  ObjectFactory m_meshFactory;
+  ObjectFactory m_gattFactory;
+  ObjectFactory m_isoFactory;
+  ObjectFactory m_trafficFactory;
 
 };
 
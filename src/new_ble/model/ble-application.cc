@@ -34,6 +34,7 @@
 #include "ble-application.h"
 #include "ble-net-device.h"
 #include "ble-mac-header.h"
+#include "ble-mesh-network.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
@@ -44,6 +45,10 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "ns3/abort.h"
 #include "ns3/packet.h"
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
@@ -85,6 +90,31 @@ namespace ns3 {
                         Mac16AddressValue (Mac16Address ("00:00")),
                         MakeMac16AddressAccessor (&BleApplication::m_destination),
                         MakeMac16AddressChecker ())
+				.AddAttribute ("Mesh",
+						"Send the packets as mesh network PDUs through the "
+						"BleMeshNetwork aggregated to the node",
+						BooleanValue (false),
+						MakeBooleanAccessor (&BleApplication::m_mesh),
+						MakeBooleanChecker ())
+				.AddAttribute ("TrafficModel",
+						"Arrival process of the packets, replaces "
+						"InterPacketTime when set",
+						PointerValue (),
+						MakePointerAccessor (&BleApplication::m_traffic),
+						MakePointerChecker<BleTrafficModel> ())
+				.AddAttribute ("Priority",
+						"Priority class of the packets in the queue of the link",
+						EnumValue (BleMacQueueItem::BULK),
+						MakeEnumAccessor (&BleApplication::m_priority),
+						MakeEnumChecker (BleMacQueueItem::CONTROL, "Control",
+							BleMacQueueItem::ALARM, "Alarm",
+							BleMacQueueItem::BULK, "Bulk"))
+				.AddAttribute ("Deadline",
+						"A packet still in the queue of the link this long "
+						"after it was sent is flushed, 0 for no deadline",
+						TimeValue (Seconds (0)),
+						MakeTimeAccessor (&BleApplication::m_deadline),
+						MakeTimeChecker ())
 				;
 			return tid;
 		}
@@ -95,6 +125,9 @@ namespace ns3 {
 		NS_LOG_FUNCTION (this);
 		m_socket = 0;
         m_destination = Mac16Address("00:00");
+        m_mesh = false;
+        m_nextArrival = 0;
+        m_priority = BleMacQueueItem::BULK;
 	}
 
 	// \brief BleApplication Destructor
@@ -108,6 +141,8 @@ namespace ns3 {
 		{
 			NS_LOG_FUNCTION (this);
 			m_socket = 0;
+			m_traffic = 0;
+			m_arrivals.clear ();
 		}
 
 	void
@@ -139,6 +174,19 @@ namespace ns3 {
 		
 		// Start sensing as a sensor
         NS_LOG_INFO (" Time Offset for this node = " << m_timeOffset);
+		if (m_traffic != 0)
+		{
+			NS_ABORT_MSG_UNLESS (m_stopTime.IsStrictlyPositive (),
+					"A TrafficModel needs a StopTime");
+			m_arrivals = m_traffic->GetArrivals (
+					Simulator::Now () + m_timeOffset, m_stopTime);
+			m_nextArrival = 0;
+			if (! m_arrivals.empty ())
+				m_SenseEvent = Simulator::Schedule (
+						m_arrivals[0].time - Simulator::Now (),
+						&BleApplication::SendArrival, this);
+			return;
+		}
 		m_SenseEvent = Simulator::Schedule (m_timeOffset, &BleApplication::Sense, this);
 	}
 
@@ -148,6 +196,14 @@ namespace ns3 {
       m_device = device;
     }
 
+    int64_t BleApplication::AssignStreams (int64_t stream)
+    {
+      NS_LOG_FUNCTION (this << stream);
+      if (m_traffic == 0)
+        return 0;
+      return m_traffic->AssignStreams (stream);
+    }
+
     void BleApplication::HandleBle (Ptr<Socket> socket)
     {
       NS_LOG_FUNCTION (this << socket);
@@ -177,13 +233,46 @@ namespace ns3 {
 		// Create a sensor reading of some size ...
 		Ptr<Packet> packet = Create<Packet> (m_dataSize);
 		// ... and send it.
-		m_socket->Send (packet,0);
+		SendPacket (packet);
 
 		// Schedule a new event
 		m_SenseEvent = Simulator::Schedule(
             m_interPacketTime,&BleApplication::Sense,this);
 	}
 
+	void BleApplication::SendPacket (Ptr<Packet> packet)
+	{
+		if (m_priority != BleMacQueueItem::BULK || m_deadline.IsStrictlyPositive ())
+		{
+			Time deadline = m_deadline.IsStrictlyPositive ()
+				? Simulator::Now () + m_deadline : Time::Max ();
+			packet->AddPacketTag (BlePriorityTag (m_priority, deadline));
+		}
+		if (m_mesh)
+		{
+			Ptr<BleMeshNetwork> mesh = m_node->GetObject<BleMeshNetwork> ();
+			NS_ASSERT_MSG (mesh, "No BleMeshNetwork on node " << m_node->GetId ());
+			mesh->Send (packet, m_destination);
+		}
+		else
+			m_socket->Send (packet,0);
+	}
+
+	void BleApplication::SendArrival (void)
+	{
+		NS_LOG_FUNCTION (this);
+		const BleArrival &arrival = m_arrivals[m_nextArrival++];
+		Ptr<Packet> packet = Create<Packet> (
+				arrival.size > 0 ? arrival.size : m_dataSize);
+		SendPacket (packet);
+
+		// Arrivals at the same time are sent one after the other
+		if (m_nextArrival < m_arrivals.size ())
+			m_SenseEvent = Simulator::Schedule (
+					m_arrivals[m_nextArrival].time - Simulator::Now (),
+					&BleApplication::SendArrival, this);
+	}
+
 } // namespace ns3
 
 
@@ -35,6 +35,9 @@
 #include "ns3/callback.h"
 #include "ns3/application.h"
 #include <ns3/mac16-address.h>
+#include <ns3/ble-traffic-model.h>
+#include <ns3/ble-mac-queue-item.h>
+#include <vector>
 
 namespace ns3 {
 
@@ -47,6 +50,10 @@ namespace ns3 {
 	 *
 	 * This application generates empty packets every X seconds.  
 	 * This application mimics a sensor. 
+	 *
+	 * With a TrafficModel the packets follow its arrivals instead of
+	 * InterPacketTime. They are computed when the application starts,
+	 * so the application needs a StopTime.
 	 */
 	class BleApplication : public Application
 	{
@@ -62,6 +69,14 @@ namespace ns3 {
             void HandleBle (Ptr<Socket> socket);//处理接收到的数据包
             void SetNetDevice (Ptr<NetDevice> device);//设置关联的网络设备
 
+            /**
+             * Assign a fixed random variable stream to the TrafficModel.
+             *
+             * \param stream first stream index to use
+             * \return the number of stream indices assigned
+             */
+            int64_t AssignStreams (int64_t stream);
+
 		private:
 			/**
 			 * This function is the function to schedule a sensing event. 
@@ -69,6 +84,12 @@ namespace ns3 {
 			 */
 			void Sense (void);//生成并发送数据包，模拟传感器行为
 
+			// Sends the packet of the next arrival of the traffic model
+			void SendArrival (void);
+
+			// To the destination, through the mesh network if m_mesh
+			void SendPacket (Ptr<Packet> packet);
+
             Mac16Address m_destination;
             Ptr<NetDevice> m_device;
 
@@ -82,6 +103,12 @@ namespace ns3 {
               //!< The port to use (this is equal to the port MAC field in Ble)
 			Time m_interPacketTime;	//!< The time between two packets 数据包发送间隔
             Time m_timeOffset; //!< Time before first packet is send 首次发送的延迟
+            bool m_mesh; //!< Send through the BleMeshNetwork of the node
+            Ptr<BleTrafficModel> m_traffic; //!< Arrivals, 0 for periodic
+            BleMacQueueItem::Priority m_priority; //!< Class of the packets
+            Time m_deadline; //!< Lifetime of a packet in the link queue, 0 for none
+            std::vector<BleArrival> m_arrivals;
+            uint32_t m_nextArrival; //!< Index in m_arrivals
 		protected:
 			virtual void DoDispose (void);
 			virtual void DoInitialize (void);
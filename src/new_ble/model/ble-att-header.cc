@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#include "ble-att-header.h"
+#include <ns3/log.h>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (BleAttHeader);
+NS_OBJECT_ENSURE_REGISTERED (BleAttTimestampTag);
+NS_LOG_COMPONENT_DEFINE ("BleAttHeader");
+
+BleAttHeader::BleAttHeader ()
+  : m_opcode (0),
+    m_handle (0),
+    m_mtu (DEFAULT_MTU)
+{
+}
+
+BleAttHeader::~BleAttHeader ()
+{
+}
+
+/*
+ * Getters And Setters
+ */
+uint8_t
+BleAttHeader::GetOpcode (void) const
+{
+  return m_opcode;
+}
+
+uint16_t
+BleAttHeader::GetHandle (void) const
+{
+  return m_handle;
+}
+
+uint16_t
+BleAttHeader::GetMtu (void) const
+{
+  return m_mtu;
+}
+
+void
+BleAttHeader::SetOpcode (uint8_t opcode)
+{
+  m_opcode = opcode;
+}
+
+void
+BleAttHeader::SetHandle (uint16_t handle)
+{
+  NS_ASSERT (handle != 0);
+  m_handle = handle;
+}
+
+void
+BleAttHeader::SetMtu (uint16_t mtu)
+{
+  NS_ASSERT (mtu >= DEFAULT_MTU);
+  m_mtu = mtu;
+}
+
+/*
+ * Header functions
+ */
+std::string
+BleAttHeader::GetName (void) const
+{
+  return "BleAttHeader";
+}
+
+TypeId
+BleAttHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BleAttHeader")
+    .SetParent<Header> ()
+    .AddConstructor<BleAttHeader> ()
+    ;
+  return tid;
+}
+
+TypeId
+BleAttHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+BleAttHeader::Print (std::ostream &os) const
+{
+  os << "Opcode = 0x" << std::hex << (int) m_opcode << std::dec;
+  switch (m_opcode)
+    {
+    case EXCHANGE_MTU_REQ:
+    case EXCHANGE_MTU_RSP:
+      os << ", MTU = " << m_mtu;
+      break;
+    case WRITE_REQ:
+    case WRITE_CMD:
+    case HANDLE_VALUE_NTF:
+    case HANDLE_VALUE_IND:
+      os << ", Handle = " << m_handle;
+      break;
+    default:
+      break;
+    }
+}
+
+uint32_t
+BleAttHeader::GetSerializedSize (void) const
+{
+  switch (m_opcode)
+    {
+    case EXCHANGE_MTU_REQ:
+    case EXCHANGE_MTU_RSP:
+    case WRITE_REQ:
+    case WRITE_CMD:
+    case HANDLE_VALUE_NTF:
+    case HANDLE_VALUE_IND:
+      return 1+2;
+    default:
+      return 1;
+    }
+}
+
+void
+BleAttHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_opcode);
+  switch (m_opcode)
+    {
+    case EXCHANGE_MTU_REQ:
+    case EXCHANGE_MTU_RSP:
+      i.WriteHtolsbU16 (m_mtu);
+      break;
+    case WRITE_REQ:
+    case WRITE_CMD:
+    case HANDLE_VALUE_NTF:
+    case HANDLE_VALUE_IND:
+      i.WriteHtolsbU16 (m_handle);
+      break;
+    default:
+      break;
+    }
+}
+
+uint32_t
+BleAttHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_opcode = i.ReadU8 ();
+  switch (m_opcode)
+    {
+    case EXCHANGE_MTU_REQ:
+    case EXCHANGE_MTU_RSP:
+      m_mtu = i.ReadLsbtohU16 ();
+      break;
+    case WRITE_REQ:
+    case WRITE_CMD:
+    case HANDLE_VALUE_NTF:
+    case HANDLE_VALUE_IND:
+      m_handle = i.ReadLsbtohU16 ();
+      break;
+    default:
+      break;
+    }
+  return i.GetDistanceFrom (start);
+}
+
+/*
+ * BleAttTimestampTag
+ */
+BleAttTimestampTag::BleAttTimestampTag ()
+{
+}
+
+BleAttTimestampTag::BleAttTimestampTag (Time timestamp)
+  : m_timestamp (timestamp)
+{
+}
+
+Time
+BleAttTimestampTag::GetTimestamp (void) const
+{
+  return m_timestamp;
+}
+
+TypeId
+BleAttTimestampTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BleAttTimestampTag")
+    .SetParent<Tag> ()
+    .AddConstructor<BleAttTimestampTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+BleAttTimestampTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+BleAttTimestampTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+BleAttTimestampTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_timestamp.GetTimeStep ());
+}
+
+void
+BleAttTimestampTag::Deserialize (TagBuffer i)
+{
+  m_timestamp = TimeStep (i.ReadU64 ());
+}
+
+void
+BleAttTimestampTag::Print (std::ostream &os) const
+{
+  os << "Timestamp = " << m_timestamp;
+}
+
+} //namespace ns3
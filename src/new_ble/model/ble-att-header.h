@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#ifndef BLE_ATT_HEADER_H
+#define BLE_ATT_HEADER_H
+
+#include <ns3/header.h>
+#include <ns3/tag.h>
+#include <ns3/nstime.h>
+
+namespace ns3 {
+
+/*
+ * \ingroup ble
+ * Represent the header of an ATT PDU
+ *
+ * The opcode, followed by the MTU for the MTU exchange or by the
+ * attribute handle for writes, notifications and indications. The
+ * attribute value is the payload of the packet. Write responses and
+ * confirmations only have the opcode.
+ * */
+class BleAttHeader : public Header
+{
+
+public:
+
+  enum Opcode
+  {
+    ERROR_RSP = 0x01,
+    EXCHANGE_MTU_REQ = 0x02,
+    EXCHANGE_MTU_RSP = 0x03,
+    WRITE_REQ = 0x12,
+    WRITE_RSP = 0x13,
+    HANDLE_VALUE_NTF = 0x1b,
+    HANDLE_VALUE_IND = 0x1d,
+    HANDLE_VALUE_CFM = 0x1e,
+    WRITE_CMD = 0x52
+  };
+
+  BleAttHeader (void);
+
+  ~BleAttHeader (void);
+
+  uint8_t GetOpcode (void) const;
+  uint16_t GetHandle (void) const;
+  uint16_t GetMtu (void) const;
+
+  void SetOpcode (uint8_t opcode);
+  void SetHandle (uint16_t handle);
+  void SetMtu (uint16_t mtu);
+
+  std::string GetName (void) const;
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  void Print (std::ostream &os) const;
+  uint32_t GetSerializedSize (void) const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+
+  // ATT_MTU every device supports, and the largest one that fits in a
+  // single LE data PDU (251 bytes minus the 4 byte L2CAP header)
+  static const uint16_t DEFAULT_MTU = 23;
+  static const uint16_t MAX_MTU = 247;
+
+private:
+  uint8_t m_opcode;
+  uint16_t m_handle; // Attribute handle, 0 is invalid
+  uint16_t m_mtu; // Client Rx MTU or Server Rx MTU
+}; //BleAttHeader
+
+/*
+ * \ingroup ble
+ * Creation time of the oldest sensor sample in an ATT PDU
+ *
+ * Simulation metadata only, it is not serialized, so the latency of
+ * coalesced samples can be measured at the receiver.
+ * */
+class BleAttTimestampTag : public Tag
+{
+public:
+  BleAttTimestampTag (void);
+  BleAttTimestampTag (Time timestamp);
+
+  Time GetTimestamp (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  Time m_timestamp;
+}; //BleAttTimestampTag
+
+}; // namespace ns-3
+
+#endif /* BLE_ATT_HEADER_H */
@@ -31,12 +31,15 @@
 #include <ns3/ble-link-controller.h>
 #include <ns3/ble-link.h>
 #include <ns3/ble-mac-header.h>
+#include <ns3/ble-mac-queue-item.h>
 #include <ns3/simulator.h>
-#include <ns3/drop-tail-queue.h>
+#include <ns3/ble-ring-queue.h>
 #include <ns3/queue-item.h>
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 #include <ns3/multi-model-spectrum-channel.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -55,28 +58,44 @@ namespace ns3 {
             PointerValue (),
             MakePointerAccessor (&BleBBManager::m_netDevice),
             MakePointerChecker<Object> ())
+        .AddAttribute ("EarliestDeadlineFirst",
+            "Give the radio to the transmit window with the earliest "
+            "deadline and let it preempt a link manager that only listens. "
+            "If false, the window of the link that was set up first wins "
+            "and the active link manager keeps the radio",
+            BooleanValue (true),
+            MakeBooleanAccessor (&BleBBManager::m_earliestDeadlineFirst),
+            MakeBooleanChecker ())
         // Add attributes and tracesources
         ;
       return tid;
     }
 
   BleBBManager::BleBBManager ()
+    : m_earliestDeadlineFirst (true),
+      m_preemptions (0),
+      m_deadlineMisses (0)
   {
     NS_LOG_FUNCTION (this);
+    m_random = CreateObject<UniformRandomVariable> ();
   }
 
   BleBBManager::~BleBBManager ()
   {
     NS_LOG_FUNCTION (this);
+    // Also when never disposed, the peers must not keep a dangling pointer
+    ClearPotentialLinks ();
   }
 
   void
     BleBBManager::DoDispose ()
     {
       NS_LOG_FUNCTION (this);
+      ClearPotentialLinks ();
     }
 
   BleBBManager::BleBBManager (Ptr<BleNetDevice> bleNetDevice)
+    : BleBBManager ()
   {
     NS_LOG_FUNCTION (this);
 
@@ -90,29 +109,29 @@ namespace ns3 {
   BlePhy::State
     BleBBManager::GetPhyState()
     {
-      NS_LOG_FUNCTION (this);
-      return this->GetPhy()->GetState();
+      BLE_LOG_FUNCTION (this);
+      return m_netDevice->GetPhy()->GetState();
     }
 
   Ptr<BlePhy>
     BleBBManager::GetPhy () 
     {
-      NS_LOG_FUNCTION (this);
-      return this->GetNetDevice()->GetPhy();
+      BLE_LOG_FUNCTION (this);
+      return m_netDevice->GetPhy();
     }
 
-  Ptr<DropTailQueue<QueueItem>>
+  Ptr<BleRingQueue>
     BleBBManager::GetQueue (void)
     {
-      NS_LOG_FUNCTION (this);
-      return this->GetNetDevice()->GetQueue();
+      BLE_LOG_FUNCTION (this);
+      return m_netDevice->GetQueue();
     }
 
   Ptr<BleLinkController>
     BleBBManager::GetLinkController()
     {
-      NS_LOG_FUNCTION (this);
-      return this->GetNetDevice()->GetLinkController();
+      BLE_LOG_FUNCTION (this);
+      return m_netDevice->GetLinkController();
     }
 
   Ptr<Packet>
@@ -139,6 +158,11 @@ namespace ns3 {
       else
         NS_ASSERT (this->m_activeLinkManager == 0);
       this->m_activeLinkManager = lm;
+      // The radio is only on for the events of a link manager
+      if (lm == 0)
+        GetPhy ()->Sleep ();
+      else
+        GetPhy ()->WakeUp ();
     }
 
   Ptr<BleLinkManager>
@@ -147,6 +171,101 @@ namespace ns3 {
       return m_activeLinkManager;
     }
 
+  void
+    BleBBManager::RequestRadio (Ptr<BleLinkManager> lm)
+    {
+      NS_LOG_FUNCTION (this << lm);
+      // Windows that start at the same time are scheduled in the order
+      // their links were set up, decide after the last one
+      if (m_radioRequests.empty ())
+      {
+        Simulator::ScheduleNow (&BleBBManager::ArbitrateRadio, this);
+      }
+      m_radioRequests.push_back (lm);
+    }
+
+  static bool
+    EarlierDeadline (Ptr<BleLinkManager> a, Ptr<BleLinkManager> b)
+    {
+      return a->GetDeadline () < b->GetDeadline ();
+    }
+
+  void
+    BleBBManager::ArbitrateRadio (void)
+    {
+      NS_LOG_FUNCTION (this);
+      std::vector<Ptr<BleLinkManager> > requests;
+      requests.swap (m_radioRequests);
+      if (m_earliestDeadlineFirst)
+      {
+        std::stable_sort (requests.begin (), requests.end (),
+            EarlierDeadline);
+      }
+
+      for (auto lm : requests)
+      {
+        if (m_activeLinkManager != 0 && m_earliestDeadlineFirst
+            && m_activeLinkManager->IsPreemptible ()
+            && lm->GetDeadline () < m_activeLinkManager->GetDeadline ())
+        {
+          NS_LOG_INFO ("Link manager " << lm << " (deadline "
+              << lm->GetDeadline () << ") preempts " << m_activeLinkManager
+              << " (deadline " << m_activeLinkManager->GetDeadline () << ")");
+          m_activeLinkManager->Preempt ();
+          m_preemptions++;
+        }
+
+        if (m_activeLinkManager == 0)
+        {
+          SetActiveLinkManager (lm);
+          lm->OpenTransmitWindow ();
+          continue;
+        }
+        // Advertising and scanning have no supervision timeout
+        if (lm->GetRole () != BleLinkManager::Role::CONNECTIONLESS_ROLE
+            && Simulator::Now () + lm->GetConnInterval () > lm->GetDeadline ())
+        {
+          m_deadlineMisses++;
+        }
+        lm->SkipTransmitWindow ();
+      }
+    }
+
+  uint32_t
+    BleBBManager::GetPreemptions (void) const
+    {
+      return m_preemptions;
+    }
+
+  uint32_t
+    BleBBManager::GetDeadlineMisses (void) const
+    {
+      return m_deadlineMisses;
+    }
+
+  uint64_t
+    BleBBManager::GetExpiredPackets (void) const
+    {
+      uint64_t expired = 0;
+      for (const Ptr<BleLinkManager> &lm : m_linkManagers)
+        expired += lm->GetExpiredPackets ();
+      return expired;
+    }
+
+  Ptr<UniformRandomVariable>
+    BleBBManager::GetRandom (void) const
+    {
+      return m_random;
+    }
+
+  int64_t
+    BleBBManager::AssignStreams (int64_t stream)
+    {
+      NS_LOG_FUNCTION (this << stream);
+      m_random->SetStream (stream);
+      return 1;
+    }
+
  /******************************
   * END OF GETTERS AND SETTERS *
   ******************************/
@@ -256,13 +375,12 @@ namespace ns3 {
       );
       NS_LOG_INFO("Callbacks set: " << otherLinkManager << " -> " << myLinkManager);
 
-      Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
       int mapSize = 15;
       std::vector<uint8_t> chmap;//存储信道映射，用于 BLE 的跳频机制
       //信道映射重复，chmap 的随机生成可能包含重复信道，降低跳频效率
       for (int i=0; i< mapSize; i++)
       {
-        chmap.push_back(randT->GetInteger(0,36));
+        chmap.push_back(m_random->GetInteger(0,36));
       }
       //std::vector<uint8_t> chmap = {1,4,7,9,11}; 
       uint8_t hopIncr = 2;
@@ -301,12 +419,11 @@ namespace ns3 {
       myLinkManager->SetBBManager(Ptr<BleBBManager> (this));
       otherLinkManager->SetBBManager(otherBBManager);
 
-      Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
       int mapSize = 15;
       std::vector<uint8_t> chmap;
       for (int i=0; i< mapSize; i++)
       {
-        chmap.push_back(randT->GetInteger(1,37));
+        chmap.push_back(m_random->GetInteger(1,37));
       }
       //std::vector<uint8_t> chmap = {1,4,7,9,11}; 
       uint8_t hopIncr = 2;
@@ -327,7 +444,7 @@ namespace ns3 {
   bool
     BleBBManager::LinkManagerExists (Ptr<BleLinkManager> linkManager)
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
       std::list<Ptr<BleLinkManager>>::iterator it;
       for (it = m_linkManagers.begin(); it != m_linkManagers.end(); ++it)
       {
@@ -342,7 +459,7 @@ namespace ns3 {
   bool
     BleBBManager::LinkExists (Ptr<BleLink> link)
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
       std::list<Ptr<BleLinkManager>>::iterator it;
       for (it = m_linkManagers.begin(); it != m_linkManagers.end(); ++it)
       {
@@ -381,7 +498,7 @@ namespace ns3 {
   bool
     BleBBManager::LinkExists (Mac16Address address)
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
       std::list<Ptr<BleLinkManager>>::iterator it;
       for (it = m_linkManagers.begin(); it != m_linkManagers.end(); ++it)
       {
@@ -389,7 +506,7 @@ namespace ns3 {
         Ptr<BleLinkManager> lm = *it;
         Ptr<BleLink> temp = lm->GetAssociatedLink();
         if (temp->GetLinkType() == BleLink::LinkType::BROADCAST 
-            && address == Mac16Address("FF:FF"))
+            && address == BleMacHeader::GetBroadcastAddress())
           return true;
         std::list<Ptr<BleBBManager>> all_devices = temp->GetLinkedDevices();
         for (it2 = all_devices.begin(); it2 != all_devices.end(); ++it2)
@@ -412,7 +529,7 @@ namespace ns3 {
   Ptr<BleLinkManager>
     BleBBManager::GetLinkManager (Mac16Address address)
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
       std::list<Ptr<BleLinkManager>>::iterator it;
       for (it = m_linkManagers.begin(); it != m_linkManagers.end(); ++it)
       {
@@ -420,7 +537,7 @@ namespace ns3 {
         Ptr<BleLinkManager> lm = *it;
         Ptr<BleLink> temp = lm->GetAssociatedLink();
         if (temp->GetLinkType() == BleLink::LinkType::BROADCAST 
-            && address == Mac16Address("FF:FF"))
+            && address == BleMacHeader::GetBroadcastAddress())
           return lm;
         std::list<Ptr<BleBBManager>> all_devices = temp->GetLinkedDevices();
         for (it2 = all_devices.begin(); it2 != all_devices.end(); ++it2)
@@ -453,7 +570,7 @@ namespace ns3 {
         Ptr<BleLinkManager> lm = *it;
         Ptr<BleLink> temp = lm->GetAssociatedLink();
         if (temp->GetLinkType() == BleLink::LinkType::BROADCAST 
-            && address == Mac16Address("FF:FF"))
+            && address == BleMacHeader::GetBroadcastAddress())
           return temp;
         std::list<Ptr<BleBBManager>> all_devices = temp->GetLinkedDevices();
         for (it2 = all_devices.begin(); it2 != all_devices.end(); ++it2)
@@ -481,6 +598,93 @@ namespace ns3 {
       return m_linkManagers.size();
     }
 
+  void
+    BleBBManager::AddPotentialLink (Ptr<BleBBManager> otherBBManager,
+        bool scheduled, uint32_t nbTxWindowOffset,
+        uint32_t nbConnectionInterval)
+    {
+      NS_LOG_FUNCTION (this << otherBBManager << nbTxWindowOffset);
+      PotentialLink potentialLink;
+      potentialLink.peer = PeekPointer (otherBBManager);
+      potentialLink.scheduled = scheduled;
+      potentialLink.nbTxWindowOffset = nbTxWindowOffset;
+      potentialLink.nbConnectionInterval = nbConnectionInterval;
+      m_potentialLinks.push_back (potentialLink);
+      potentialLink.peer = this;
+      otherBBManager->m_potentialLinks.push_back (potentialLink);
+    }
+
+  uint32_t
+    BleBBManager::CountPotentialLinks ()
+    {
+      return m_potentialLinks.size ();
+    }
+
+  void
+    BleBBManager::RemovePotentialLink (BleBBManager *peer)
+    {
+      for (auto it = m_potentialLinks.begin ();
+          it != m_potentialLinks.end (); ++it)
+      {
+        if (it->peer == peer)
+        {
+          m_potentialLinks.erase (it);
+          return;
+        }
+      }
+    }
+
+  void
+    BleBBManager::ClearPotentialLinks (void)
+    {
+      for (auto &potentialLink : m_potentialLinks)
+        potentialLink.peer->RemovePotentialLink (this);
+      m_potentialLinks.clear ();
+    }
+
+  bool
+    BleBBManager::CreatePotentialLink (Mac16Address address)
+    {
+      NS_LOG_FUNCTION (this << address);
+      for (auto it = m_potentialLinks.begin ();
+          it != m_potentialLinks.end (); ++it)
+      {
+        if (it->peer->GetNetDevice ()->GetAddress16 () != address)
+          continue;
+        PotentialLink potentialLink = *it;
+        m_potentialLinks.erase (it);
+        potentialLink.peer->RemovePotentialLink (this);
+
+        NS_LOG_INFO ("Setting up link to " << address << " on first use");
+        CreateLinkScheduled (Ptr<BleBBManager> (potentialLink.peer),
+            BleLinkManager::Role::MASTER_ROLE, potentialLink.scheduled,
+            potentialLink.nbTxWindowOffset,
+            potentialLink.nbConnectionInterval);
+        if (potentialLink.scheduled)
+        {
+          // SetupLink counts the offset from now; move the first window so
+          // the link keeps the phase it would have had when set up at
+          // time 0, and stays clear of the windows of the other links.
+          Ptr<BleLinkManager> myLinkManager = GetLinkManager (address);
+          Ptr<BleLinkManager> otherLinkManager =
+            potentialLink.peer->GetLinkManager (
+                GetNetDevice ()->GetAddress16 ());
+          int64_t interval = myLinkManager->GetConnInterval ().GetTimeStep ();
+          int64_t phase = (MicroSeconds (1250)
+              + myLinkManager->GetTransmitWindowOffset ()).GetTimeStep ();
+          int64_t wait = (phase - Simulator::Now ().GetTimeStep ()) % interval;
+          wait = (wait + interval) % interval;
+          Time offset = TimeStep (wait) - MicroSeconds (1250);
+          if (offset.IsNegative ())
+            offset += TimeStep (interval);
+          myLinkManager->SetTransmitWindowOffset (offset);
+          otherLinkManager->SetTransmitWindowOffset (offset);
+        }
+        return true;
+      }
+      return false;
+    }
+
    void
     BleBBManager::TryAgain()
     {
@@ -492,30 +696,34 @@ namespace ns3 {
      BleBBManager::HandlePacket()
      {
        NS_LOG_FUNCTION (this);
-       while (this->GetNetDevice()->GetQueue()->IsEmpty () == false)
+       Ptr<BleRingQueue> queue = this->GetNetDevice()->GetQueue();
+       while (queue->IsEmpty () == false)
        {
          NS_LOG_INFO ("Queue is not empty");
-         Ptr<QueueItem> item = this->GetNetDevice()->GetQueue()->Dequeue ();
+         Ptr<const BleMacQueueItem> item =
+           DynamicCast<const BleMacQueueItem> (queue->Peek ());
          NS_ASSERT (item);
-         Ptr<Packet> packet = item->GetPacket ();
         
          // Check dest address in header and get a link to the address
-         BleMacHeader macheader;
-         packet->PeekHeader(macheader);
-         Mac16Address destAddr = macheader.GetDestAddr();
+         Mac16Address destAddr = item->GetHeader ().GetDestAddr();
          NS_LOG_INFO ("Destination addr of current packet: " << destAddr); 
          bool linkExists = LinkExists (destAddr);
+         if (!linkExists)
+           linkExists = CreatePotentialLink (destAddr);
          if (!linkExists)
          {
            NS_LOG_ERROR (" No link exists to destination address " << destAddr);
           // (if time allows: implement:) setup a link to the destination address
           NS_ASSERT(linkExists);
+          queue->Dequeue ();
          }
          else
          {
            NS_LOG_INFO (" Link to destination of current packet exists ");
            Ptr<BleLinkManager> activeLinkManager = GetLinkManager (destAddr);
-           activeLinkManager->GetQueue ()->Enqueue (item);
+           activeLinkManager->MakeRoomFor (item);
+           // The item itself moves to the queue of the link
+           queue->MoveFrontTo (activeLinkManager->GetQueue ());
            
          }
        } // Queue was not empty
@@ -38,12 +38,13 @@
 #include <ns3/simulator.h>
 
 #include <ns3/constants.h>
+#include <vector>
 
 namespace ns3 {
 
   // Classes
 
-  template <typename Item> class DropTailQueue;
+  class BleRingQueue;
   class QueueItem;
   class BleLinkController;
   class BleLink;
@@ -73,7 +74,7 @@ namespace ns3 {
       Ptr<BleNetDevice> GetNetDevice ();
       void SetNetDevice (Ptr<BleNetDevice> netDevice);
       void SetPhy (Ptr<BlePhy> phy);
-      Ptr<DropTailQueue<QueueItem>> GetQueue (void);
+      Ptr<BleRingQueue> GetQueue (void);
 
       Ptr<Packet> GetCurrentPacket();
       void SetCurrentPacket(Ptr<Packet> packet);
@@ -110,6 +111,17 @@ namespace ns3 {
 
       uint32_t CountLinks ();//返回链路数量
 
+      /*
+       * Register a link to another device that is only set up when the
+       * first packet for one of both devices is handled; the first one
+       * that has data sets up the link, as its master. Registers the
+       * link on both devices.
+       */
+      void AddPotentialLink (Ptr<BleBBManager> otherBBManager,
+          bool scheduled, uint32_t nbTxWindowOffset,
+          uint32_t nbConnectionInterval);
+      uint32_t CountPotentialLinks ();
+
       void TryAgain();//尝试重新处理
 
       /*
@@ -128,13 +140,66 @@ namespace ns3 {
       void SetActiveLinkManager(Ptr<BleLinkManager> lm);
       Ptr<BleLinkManager> GetActiveLinkManager();
 
+      /*
+       * Radio arbiter for the transmit windows of the link managers of a
+       * device that is master, slave and advertiser at the same time.
+       * Every window that starts asks for the radio; once all windows of
+       * that instant asked, ArbitrateRadio gives it to the one with the
+       * earliest deadline (BleLinkManager::GetDeadline), the others are
+       * skipped. The window also takes the radio from an
+       * active link manager that only listens and has a later deadline.
+       * The link that waited longest relative to its supervision timeout
+       * wins, so overlapping windows of links with different connection
+       * intervals take turns instead of the first one starving the
+       * others. Without EarliestDeadlineFirst the first window wins.
+       */
+      void RequestRadio (Ptr<BleLinkManager> lm);
+      void ArbitrateRadio (void);
+
+      // Windows taken from a listening link manager by ArbitrateRadio
+      uint32_t GetPreemptions (void) const;
+      // Skipped windows of connections that pass their deadline by it
+      uint32_t GetDeadlineMisses (void) const;
+      // Packets flushed by the link managers because their deadline passed
+      uint64_t GetExpiredPackets (void) const;
+
+      /*
+       * Random channel maps and connection parameters of the links set up
+       * by this device, also drawn by its link managers. Fixed with
+       * AssignStreams, which returns the number of streams used.
+       */
+      Ptr<UniformRandomVariable> GetRandom (void) const;
+      int64_t AssignStreams (int64_t stream);
+
     private:
+      struct PotentialLink
+      {
+        // Not a Ptr, the peer holds the same link back to this device.
+        // Whichever goes first removes the link on both sides.
+        BleBBManager *peer;
+        bool scheduled;
+        uint32_t nbTxWindowOffset;
+        uint32_t nbConnectionInterval;
+      };
+
+      // Set up the potential link to this address, if there is one
+      bool CreatePotentialLink (Mac16Address address);
+      void RemovePotentialLink (BleBBManager *peer);
+      // Remove the potential links of this device on both sides
+      void ClearPotentialLinks (void);
+
       Ptr<BleNetDevice> m_netDevice;
       std::list<Ptr<BleLinkManager>> m_linkManagers; //存储所有链路管理器
 
       // The LinkManager that has control over the device
       // at this moment
       Ptr<BleLinkManager> m_activeLinkManager;//当前控制物理层的链路管理器
+      std::vector<PotentialLink> m_potentialLinks; // Not set up yet
+      std::vector<Ptr<BleLinkManager> > m_radioRequests; // This instant
+      bool m_earliestDeadlineFirst;
+      uint32_t m_preemptions;
+      uint32_t m_deadlineMisses;
+      Ptr<UniformRandomVariable> m_random;
  };
 
 }
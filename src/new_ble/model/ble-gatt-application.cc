@@ -0,0 +1,453 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#include "ble-gatt-application.h"
+#include "ble-att-header.h"
+#include <ns3/ble-net-device.h>
+#include <ns3/node.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/enum.h>
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <algorithm>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleGattApplication");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleGattApplication);
+
+  // Attribute types (16 bit UUIDs)
+  static const uint16_t PRIMARY_SERVICE = 0x2800;
+  static const uint16_t CHARACTERISTIC = 0x2803;
+  static const uint16_t CCCD = 0x2902;
+  static const uint16_t ENVIRONMENTAL_SENSING = 0x181a;
+  static const uint16_t SENSOR_DATA = 0x2a58; // Analog
+
+  // Bits of the CCCD value
+  static const uint16_t CCCD_NOTIFY = 0x0001;
+  static const uint16_t CCCD_INDICATE = 0x0002;
+
+  TypeId
+    BleGattApplication::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleGattApplication")
+        .SetParent<Application> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleGattApplication> ()
+        .AddAttribute ("Peer",
+            "Address of the other device, the collector of a sensor or "
+            "the sensor of a collector",
+            Mac16AddressValue (Mac16Address ("00:00")),
+            MakeMac16AddressAccessor (&BleGattApplication::m_peer),
+            MakeMac16AddressChecker ())
+        .AddAttribute ("Mode",
+            "How the sensor samples reach the collector",
+            EnumValue (BleGattApplication::NOTIFY),
+            MakeEnumAccessor (&BleGattApplication::m_mode),
+            MakeEnumChecker (BleGattApplication::NOTIFY, "Notify",
+              BleGattApplication::INDICATE, "Indicate",
+              BleGattApplication::WRITE_CMD, "WriteWithoutResponse"))
+        .AddAttribute ("Mtu",
+            "ATT_MTU this device can receive, proposed in the MTU exchange",
+            UintegerValue (BleAttHeader::MAX_MTU),
+            MakeUintegerAccessor (&BleGattApplication::m_maxMtu),
+            MakeUintegerChecker<uint16_t> (BleAttHeader::DEFAULT_MTU,
+              BleAttHeader::MAX_MTU))
+        .AddAttribute ("SampleInterval",
+            "Time between two sensor samples, 0 for a collector",
+            TimeValue (Seconds (0)),
+            MakeTimeAccessor (&BleGattApplication::m_sampleInterval),
+            MakeTimeChecker ())
+        .AddAttribute ("SampleSize",
+            "Size of a sensor sample in bytes",
+            UintegerValue (8),
+            MakeUintegerAccessor (&BleGattApplication::m_sampleSize),
+            MakeUintegerChecker<uint32_t> (1,
+              BleAttHeader::MAX_MTU - 3))
+        .AddAttribute ("CoalesceSamples",
+            "Maximum number of samples packed into one PDU",
+            UintegerValue (1),
+            MakeUintegerAccessor (&BleGattApplication::m_coalesceSamples),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("CoalesceTimeout",
+            "Maximum time a sample waits for a PDU to fill up",
+            TimeValue (Seconds (1)),
+            MakeTimeAccessor (&BleGattApplication::m_coalesceTimeout),
+            MakeTimeChecker ())
+        .AddTraceSource ("Tx",
+            "An ATT PDU sent to the peer, with the ATT header",
+            MakeTraceSourceAccessor (&BleGattApplication::m_txTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Rx",
+            "An ATT PDU received from the peer, without the ATT header",
+            MakeTraceSourceAccessor (&BleGattApplication::m_rxTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("SamplesRx",
+            "Sensor samples received in a notification, indication or "
+            "write command, with the delay of the oldest one",
+            MakeTraceSourceAccessor (&BleGattApplication::m_samplesRxTrace),
+            "ns3::BleGattApplication::SamplesTracedCallback")
+        ;
+      return tid;
+    }
+
+  BleGattApplication::BleGattApplication ()
+    : m_mtu (BleAttHeader::DEFAULT_MTU),
+      m_mtuExchanged (false),
+      m_waitingConfirmation (false),
+      m_txSamples (0),
+      m_txPdus (0),
+      m_rxSamples (0),
+      m_rxBytes (0)
+  {
+    NS_LOG_FUNCTION (this);
+    std::vector<uint8_t> service = {ENVIRONMENTAL_SENSING & 0xff,
+      ENVIRONMENTAL_SENSING >> 8};
+    AppendAttribute (PRIMARY_SERVICE, service);
+    uint16_t handle = AddCharacteristic (SENSOR_DATA,
+        PROP_WRITE_CMD | PROP_NOTIFY | PROP_INDICATE);
+    NS_ASSERT (handle == SENSOR_VALUE_HANDLE);
+  }
+
+  BleGattApplication::~BleGattApplication ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleGattApplication::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_device = 0;
+      Application::DoDispose ();
+    }
+
+  void
+    BleGattApplication::SetNetDevice (Ptr<BleNetDevice> device)
+    {
+      NS_LOG_FUNCTION (this << device);
+      NS_ASSERT_MSG (device->GetNode (), "Add the device to a node first");
+      m_device = device;
+      device->GetNode ()->RegisterProtocolHandler (
+          MakeCallback (&BleGattApplication::Receive, this),
+          PROT_NUMBER, device);
+    }
+
+  /*
+   * Attribute table
+   */
+  uint16_t
+    BleGattApplication::AppendAttribute (uint16_t type,
+        const std::vector<uint8_t> &value)
+    {
+      Attribute attribute;
+      attribute.type = type;
+      attribute.value = value;
+      m_attributes.push_back (attribute);
+      return m_attributes.size ();
+    }
+
+  uint16_t
+    BleGattApplication::AddCharacteristic (uint16_t uuid, uint8_t properties)
+    {
+      NS_LOG_FUNCTION (this << uuid << (int) properties);
+      // Declaration: properties, value handle and UUID
+      uint16_t valueHandle = m_attributes.size () + 2;
+      std::vector<uint8_t> declaration = {properties,
+        (uint8_t) (valueHandle & 0xff), (uint8_t) (valueHandle >> 8),
+        (uint8_t) (uuid & 0xff), (uint8_t) (uuid >> 8)};
+      AppendAttribute (CHARACTERISTIC, declaration);
+      AppendAttribute (uuid, std::vector<uint8_t> ());
+      if (properties & (PROP_NOTIFY | PROP_INDICATE))
+        AppendAttribute (CCCD, std::vector<uint8_t> (2, 0));
+      return valueHandle;
+    }
+
+  uint16_t
+    BleGattApplication::GetNAttributes (void) const
+    {
+      return m_attributes.size ();
+    }
+
+  uint16_t
+    BleGattApplication::GetAttributeType (uint16_t handle) const
+    {
+      NS_ASSERT (handle > 0 && handle <= m_attributes.size ());
+      return m_attributes[handle - 1].type;
+    }
+
+  const std::vector<uint8_t> &
+    BleGattApplication::GetAttributeValue (uint16_t handle) const
+    {
+      NS_ASSERT (handle > 0 && handle <= m_attributes.size ());
+      return m_attributes[handle - 1].value;
+    }
+
+  void
+    BleGattApplication::SetAttributeValue (uint16_t handle,
+        Ptr<const Packet> value)
+    {
+      if (handle == 0 || handle > m_attributes.size ())
+      {
+        NS_LOG_WARN ("Write to unknown handle " << handle);
+        return;
+      }
+      std::vector<uint8_t> &stored = m_attributes[handle - 1].value;
+      stored.resize (value->GetSize ());
+      if (!stored.empty ())
+        value->CopyData (stored.data (), stored.size ());
+    }
+
+  /*
+   * Statistics
+   */
+  uint16_t
+    BleGattApplication::GetMtu (void) const
+    {
+      return m_mtu;
+    }
+
+  uint64_t
+    BleGattApplication::GetTxSamples (void) const
+    {
+      return m_txSamples;
+    }
+
+  uint64_t
+    BleGattApplication::GetTxPdus (void) const
+    {
+      return m_txPdus;
+    }
+
+  uint64_t
+    BleGattApplication::GetRxSamples (void) const
+    {
+      return m_rxSamples;
+    }
+
+  uint64_t
+    BleGattApplication::GetRxBytes (void) const
+    {
+      return m_rxBytes;
+    }
+
+  /*
+   * Application
+   */
+  void
+    BleGattApplication::StartApplication (void)
+    {
+      NS_LOG_FUNCTION (this);
+      NS_ASSERT_MSG (m_device, "Call SetNetDevice first");
+      if (IsClient ())
+      {
+        Send (Create<Packet> (), BleAttHeader::EXCHANGE_MTU_REQ, m_maxMtu);
+      }
+      if (!m_sampleInterval.IsZero ())
+      {
+        m_sampleEvent = Simulator::ScheduleNow (
+            &BleGattApplication::Sample, this);
+      }
+    }
+
+  void
+    BleGattApplication::StopApplication (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_sampleEvent.Cancel ();
+      m_flushEvent.Cancel ();
+    }
+
+  bool
+    BleGattApplication::IsClient (void) const
+    {
+      // The sensor writes to the collector, or the collector subscribes
+      bool sensor = !m_sampleInterval.IsZero ();
+      return sensor == (m_mode == WRITE_CMD);
+    }
+
+  bool
+    BleGattApplication::CanSend (void) const
+    {
+      if (m_mode == WRITE_CMD)
+        return m_mtuExchanged;
+      const std::vector<uint8_t> &cccd =
+        GetAttributeValue (SENSOR_CCCD_HANDLE);
+      uint16_t config = cccd[0] | (cccd[1] << 8);
+      if (m_mode == NOTIFY)
+        return config & CCCD_NOTIFY;
+      return (config & CCCD_INDICATE) && !m_waitingConfirmation;
+    }
+
+  void
+    BleGattApplication::Sample (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_pending.push_back (Simulator::Now ());
+      m_txSamples++;
+      TrySend ();
+      m_sampleEvent = Simulator::Schedule (m_sampleInterval,
+          &BleGattApplication::Sample, this);
+    }
+
+  void
+    BleGattApplication::TrySend (void)
+    {
+      if (m_pending.empty () || !CanSend ())
+        return;
+      uint32_t perPdu =
+        std::min (m_coalesceSamples, (m_mtu - 3u) / m_sampleSize);
+      NS_ABORT_MSG_IF (perPdu == 0, "SampleSize " << m_sampleSize
+          << " does not fit in an ATT_MTU of " << m_mtu);
+      while (m_pending.size () >= perPdu && CanSend ())
+        SendSamples (perPdu);
+      if (!m_pending.empty () && CanSend () && !m_flushEvent.IsRunning ())
+      {
+        Time wait = m_pending.front () + m_coalesceTimeout
+          - Simulator::Now ();
+        m_flushEvent = Simulator::Schedule (Max (wait, Seconds (0)),
+            &BleGattApplication::Flush, this);
+      }
+    }
+
+  void
+    BleGattApplication::Flush (void)
+    {
+      NS_LOG_FUNCTION (this);
+      if (m_pending.empty () || !CanSend ())
+        return;
+      uint32_t perPdu =
+        std::min (m_coalesceSamples, (m_mtu - 3u) / m_sampleSize);
+      SendSamples (std::min<uint32_t> (m_pending.size (), perPdu));
+      TrySend ();
+    }
+
+  void
+    BleGattApplication::SendSamples (uint32_t n)
+    {
+      NS_LOG_FUNCTION (this << n);
+      m_flushEvent.Cancel ();
+      Ptr<Packet> value = Create<Packet> (n * m_sampleSize);
+      value->AddPacketTag (BleAttTimestampTag (m_pending.front ()));
+      m_pending.erase (m_pending.begin (), m_pending.begin () + n);
+      uint8_t opcode = BleAttHeader::HANDLE_VALUE_NTF;
+      if (m_mode == INDICATE)
+      {
+        opcode = BleAttHeader::HANDLE_VALUE_IND;
+        m_waitingConfirmation = true;
+      }
+      else if (m_mode == WRITE_CMD)
+        opcode = BleAttHeader::WRITE_CMD;
+      m_txPdus++;
+      Send (value, opcode, SENSOR_VALUE_HANDLE);
+    }
+
+  void
+    BleGattApplication::Send (Ptr<Packet> packet, uint8_t opcode,
+        uint16_t value)
+    {
+      NS_LOG_FUNCTION (this << packet << (int) opcode << value);
+      BleAttHeader header;
+      header.SetOpcode (opcode);
+      if (opcode == BleAttHeader::EXCHANGE_MTU_REQ
+          || opcode == BleAttHeader::EXCHANGE_MTU_RSP)
+        header.SetMtu (value);
+      else if (value != 0)
+        header.SetHandle (value);
+      packet->AddHeader (header);
+      m_txTrace (packet);
+      m_device->Send (packet, m_peer, PROT_NUMBER);
+    }
+
+  void
+    BleGattApplication::Receive (Ptr<NetDevice> device,
+        Ptr<const Packet> packet, uint16_t protocol, const Address &from,
+        const Address &to, NetDevice::PacketType packetType)
+    {
+      NS_LOG_FUNCTION (this << packet << from);
+      if (Mac16Address::ConvertFrom (from) != m_peer)
+        return;
+      Ptr<Packet> value = packet->Copy ();
+      BleAttHeader header;
+      value->RemoveHeader (header);
+      m_rxTrace (value);
+      switch (header.GetOpcode ())
+      {
+        case BleAttHeader::EXCHANGE_MTU_REQ:
+          m_mtu = std::min (m_maxMtu, header.GetMtu ());
+          m_mtuExchanged = true;
+          Send (Create<Packet> (), BleAttHeader::EXCHANGE_MTU_RSP, m_maxMtu);
+          TrySend ();
+          break;
+        case BleAttHeader::EXCHANGE_MTU_RSP:
+          m_mtu = std::min (m_maxMtu, header.GetMtu ());
+          m_mtuExchanged = true;
+          if (m_mode != WRITE_CMD)
+          {
+            // Subscribe to the sensor
+            uint8_t config[2] = {(uint8_t) (m_mode == NOTIFY ?
+                CCCD_NOTIFY : CCCD_INDICATE), 0};
+            Send (Create<Packet> (config, 2), BleAttHeader::WRITE_REQ,
+                SENSOR_CCCD_HANDLE);
+          }
+          TrySend ();
+          break;
+        case BleAttHeader::WRITE_REQ:
+          SetAttributeValue (header.GetHandle (), value);
+          Send (Create<Packet> (), BleAttHeader::WRITE_RSP, 0);
+          TrySend ();
+          break;
+        case BleAttHeader::WRITE_CMD:
+          SetAttributeValue (header.GetHandle (), value);
+          DeliverSamples (value);
+          break;
+        case BleAttHeader::HANDLE_VALUE_NTF:
+          DeliverSamples (value);
+          break;
+        case BleAttHeader::HANDLE_VALUE_IND:
+          DeliverSamples (value);
+          Send (Create<Packet> (), BleAttHeader::HANDLE_VALUE_CFM, 0);
+          break;
+        case BleAttHeader::HANDLE_VALUE_CFM:
+          m_waitingConfirmation = false;
+          TrySend ();
+          break;
+        default:
+          break;
+      }
+    }
+
+  void
+    BleGattApplication::DeliverSamples (Ptr<const Packet> value)
+    {
+      uint32_t samples = value->GetSize () / m_sampleSize;
+      BleAttTimestampTag tag;
+      Time delay;
+      if (value->PeekPacketTag (tag))
+        delay = Simulator::Now () - tag.GetTimestamp ();
+      m_rxSamples += samples;
+      m_rxBytes += value->GetSize ();
+      m_samplesRxTrace (value, samples, delay);
+    }
+
+}
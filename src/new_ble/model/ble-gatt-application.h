@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#ifndef BLE_GATT_APPLICATION_H
+#define BLE_GATT_APPLICATION_H
+
+// Includes
+#include <ns3/application.h>
+#include <ns3/event-id.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <ns3/net-device.h>
+#include <ns3/mac16-address.h>
+#include <ns3/traced-callback.h>
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+  // Classes
+
+  class BleNetDevice;
+
+/**
+ * \ingroup ble
+ * \brief ATT/GATT model between a sensor and its collector
+ *
+ * Every device holds a GATT server with one service of one sensor
+ * characteristic (handles 1 to 4: service, characteristic declaration,
+ * value and client characteristic configuration). Install one
+ * application on the sensor and one on the collector, each with the
+ * other device as Peer; ATT PDUs from other devices are ignored.
+ *
+ * The sensor takes a sample of SampleSize bytes every SampleInterval.
+ * In the Notify and Indicate modes the collector is the GATT client: it
+ * exchanges the MTU and enables notifications or indications in the
+ * CCCD, then the sensor sends the samples as handle value PDUs, one
+ * indication at a time. In the WriteWithoutResponse mode the sensor is
+ * the client, exchanges the MTU and writes the samples to the value of
+ * the collector.
+ *
+ * With CoalesceSamples above 1 the samples are packed into one PDU until
+ * CoalesceSamples samples or ATT_MTU - 3 bytes are pending, or until the
+ * oldest sample waited CoalesceTimeout.
+ */
+  class BleGattApplication : public Application
+  {
+    public:
+      // L2CAP channel identifier of ATT, used as protocol number
+      static const uint16_t PROT_NUMBER = 0x0004;
+      // Handle of the value of the sensor characteristic
+      static const uint16_t SENSOR_VALUE_HANDLE = 3;
+      static const uint16_t SENSOR_CCCD_HANDLE = 4;
+
+      enum Mode
+      {
+        NOTIFY,
+        INDICATE,
+        WRITE_CMD
+      };
+
+      // Characteristic properties
+      enum Property
+      {
+        PROP_WRITE_CMD = 0x04,
+        PROP_WRITE = 0x08,
+        PROP_NOTIFY = 0x10,
+        PROP_INDICATE = 0x20
+      };
+
+      /**
+       * \param packet the attribute value
+       * \param samples number of samples in the value
+       * \param delay time since the oldest of these samples was taken
+       */
+      typedef void (* SamplesTracedCallback)(Ptr<const Packet> packet,
+          uint32_t samples, Time delay);
+
+      BleGattApplication ();
+      ~BleGattApplication ();
+
+      static TypeId GetTypeId (void);
+
+      // Bind to the device and register the protocol handler on its node
+      void SetNetDevice (Ptr<BleNetDevice> device);
+
+      /*
+       * Adds a characteristic to the attribute table, with a CCCD if it
+       * can notify or indicate. Returns the handle of its value.
+       */
+      uint16_t AddCharacteristic (uint16_t uuid, uint8_t properties);
+      uint16_t GetNAttributes (void) const;
+      uint16_t GetAttributeType (uint16_t handle) const;
+      const std::vector<uint8_t> &GetAttributeValue (uint16_t handle) const;
+
+      // Negotiated ATT_MTU, DEFAULT_MTU before the exchange
+      uint16_t GetMtu (void) const;
+      uint64_t GetTxSamples (void) const;
+      uint64_t GetTxPdus (void) const;
+      uint64_t GetRxSamples (void) const;
+      uint64_t GetRxBytes (void) const; // Attribute value bytes
+
+    protected:
+      virtual void DoDispose (void);
+      virtual void StartApplication (void);
+      virtual void StopApplication (void);
+
+    private:
+      struct Attribute
+      {
+        uint16_t type;
+        std::vector<uint8_t> value;
+      };
+
+      uint16_t AppendAttribute (uint16_t type,
+          const std::vector<uint8_t> &value);
+      void SetAttributeValue (uint16_t handle, Ptr<const Packet> value);
+      bool IsClient (void) const;
+      bool CanSend (void) const;
+
+      void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+          uint16_t protocol, const Address &from, const Address &to,
+          NetDevice::PacketType packetType);
+      void Send (Ptr<Packet> packet, uint8_t opcode, uint16_t value);
+      void DeliverSamples (Ptr<const Packet> value);
+
+      void Sample (void);
+      // Send every full PDU and start the timer of a partial one
+      void TrySend (void);
+      // Send the pending samples, even if the PDU is not full
+      void Flush (void);
+      void SendSamples (uint32_t n);
+
+      Ptr<BleNetDevice> m_device;
+      Mac16Address m_peer;
+      Mode m_mode;
+      uint16_t m_maxMtu; // ATT_MTU this device can receive
+      uint16_t m_mtu;
+      bool m_mtuExchanged;
+      bool m_waitingConfirmation;
+      std::vector<Attribute> m_attributes; // Handle i is at i - 1
+
+      Time m_sampleInterval;
+      uint32_t m_sampleSize;
+      uint32_t m_coalesceSamples;
+      Time m_coalesceTimeout;
+      std::deque<Time> m_pending; // Creation times of the pending samples
+      EventId m_sampleEvent;
+      EventId m_flushEvent;
+
+      uint64_t m_txSamples;
+      uint64_t m_txPdus;
+      uint64_t m_rxSamples;
+      uint64_t m_rxBytes;
+
+      TracedCallback<Ptr<const Packet> > m_txTrace; // ATT PDU sent
+      TracedCallback<Ptr<const Packet> > m_rxTrace; // ATT PDU from the peer
+      TracedCallback<Ptr<const Packet>, uint32_t, Time> m_samplesRxTrace;
+  };
+
+}
+
+#endif /* BLE_GATT_APPLICATION_H */
@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-iso-stream.h"
+#include <ns3/log.h>
+#include <ns3/uinteger.h>
+#include <ns3/simulator.h>
+#include <ns3/queue-item.h>
+#include <ns3/ble-ring-queue.h>
+#include <ns3/ble-mac-header.h>
+#include <ns3/ble-mac-queue-item.h>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleIsoStream");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleIsoStream);
+  NS_OBJECT_ENSURE_REGISTERED (BleIsoTag);
+
+  TypeId
+    BleIsoStream::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleIsoStream")
+        .SetParent<Object> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleIsoStream> ()
+        .AddAttribute ("SubEvents",
+            "Number of sub-events per ISO event (NSE)",
+            UintegerValue (2),
+            MakeUintegerAccessor (&BleIsoStream::m_subEvents),
+            MakeUintegerChecker<uint8_t> (1, 31))
+        .AddAttribute ("BurstNumber",
+            "New payloads per ISO event (BN), at most SubEvents",
+            UintegerValue (1),
+            MakeUintegerAccessor (&BleIsoStream::m_burstNumber),
+            MakeUintegerChecker<uint8_t> (1, 15))
+        .AddAttribute ("FlushTimeout",
+            "Number of ISO events in which a payload can be sent (FT)",
+            UintegerValue (1),
+            MakeUintegerAccessor (&BleIsoStream::m_flushTimeout),
+            MakeUintegerChecker<uint8_t> (1))
+        .AddTraceSource ("Ack",
+            "A payload acknowledged by the peer before its flush point",
+            MakeTraceSourceAccessor (&BleIsoStream::m_ackTrace),
+            "ns3::BleIsoStream::AckTracedCallback")
+        .AddTraceSource ("Flush",
+            "A payload of a CIS that was not acknowledged in time",
+            MakeTraceSourceAccessor (&BleIsoStream::m_flushTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Rx",
+            "A payload received for the first time",
+            MakeTraceSourceAccessor (&BleIsoStream::m_rxTrace),
+            "ns3::Packet::TracedCallback")
+        ;
+      return tid;
+    }
+
+  BleIsoStream::BleIsoStream ()
+    : m_subEvents (2),
+      m_burstNumber (1),
+      m_flushTimeout (1),
+      m_broadcast (false),
+      m_nextPayloadNumber (1),
+      m_nextBroadcast (0),
+      m_ack (0),
+      m_txPayloads (0),
+      m_transmissions (0),
+      m_ackedPayloads (0),
+      m_flushedPayloads (0),
+      m_rxPayloads (0)
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleIsoStream::~BleIsoStream ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  uint8_t
+    BleIsoStream::GetSubEvents (void) const
+    {
+      return m_subEvents;
+    }
+
+  uint8_t
+    BleIsoStream::GetBurstNumber (void) const
+    {
+      return m_burstNumber;
+    }
+
+  uint8_t
+    BleIsoStream::GetFlushTimeout (void) const
+    {
+      return m_flushTimeout;
+    }
+
+  void
+    BleIsoStream::SetBroadcast (bool broadcast)
+    {
+      m_broadcast = broadcast;
+    }
+
+  bool
+    BleIsoStream::IsBroadcast (void) const
+    {
+      return m_broadcast;
+    }
+
+  void
+    BleIsoStream::StartEvent (Ptr<BleRingQueue> queue,
+        Time isoInterval)
+    {
+      NS_LOG_FUNCTION (this);
+      Time now = Simulator::Now ();
+      // Payloads are taken in order, so the oldest flush point is first
+      while (! m_pending.empty () && m_pending.front ().flushPoint <= now)
+      {
+        if (! m_broadcast)
+        {
+          NS_LOG_INFO ("Flushing payload " << m_pending.front ().number);
+          m_flushedPayloads++;
+          m_flushTrace (m_pending.front ().packet);
+        }
+        m_pending.pop_front ();
+      }
+
+      for (uint8_t i = 0; i < m_burstNumber && ! queue->IsEmpty (); i++)
+      {
+        Payload payload;
+        Ptr<BleMacQueueItem> item =
+          DynamicCast<BleMacQueueItem> (queue->Dequeue ());
+        NS_ASSERT (item);
+        payload.packet = item->GetPacket ();
+        payload.header = item->GetHeader ();
+        payload.number = m_nextPayloadNumber++;
+        payload.admitted = now;
+        payload.flushPoint = now + isoInterval * m_flushTimeout;
+        m_pending.push_back (payload);
+        m_txPayloads++;
+      }
+      m_nextBroadcast = 0;
+    }
+
+  bool
+    BleIsoStream::HasPendingPayloads (void) const
+    {
+      return ! m_pending.empty ();
+    }
+
+  Ptr<Packet>
+    BleIsoStream::GetNextPdu (Mac16Address src)
+    {
+      NS_LOG_FUNCTION (this);
+      BleMacHeader bmh;
+      Ptr<Packet> pdu;
+      uint64_t payloadNumber = 0;
+      if (m_pending.empty ())
+      {
+        // Null PDU, only to acknowledge the payloads of the peer
+        pdu = Create<Packet> ();
+        bmh.SetLLID (0b01);
+        bmh.SetLength (0);
+        bmh.SetMD (0);
+        bmh.SetSrcAddr (src);
+        bmh.SetDestAddr (BleMacHeader::GetBroadcastAddress ());
+      }
+      else
+      {
+        uint32_t index = 0;
+        if (m_broadcast)
+        {
+          index = m_nextBroadcast++ % m_pending.size ();
+        }
+        pdu = m_pending[index].packet->Copy ();
+        payloadNumber = m_pending[index].number;
+        bmh = m_pending[index].header;
+        bmh.SetLLID (0b10);
+        bmh.SetLength (1);
+        // Keep the master sending until this payload is acknowledged
+        bmh.SetMD (1);
+      }
+      pdu->AddHeader (bmh);
+      pdu->AddPacketTag (BleIsoTag (payloadNumber, m_ack));
+      m_transmissions++;
+      return pdu;
+    }
+
+  bool
+    BleIsoStream::Receive (Ptr<Packet> packet, const BleMacHeader &bmh)
+    {
+      NS_LOG_FUNCTION (this);
+      BleIsoTag tag;
+      if (! packet->RemovePacketTag (tag))
+      {
+        return true;
+      }
+
+      if (! m_broadcast)
+      {
+        while (! m_pending.empty ()
+            && m_pending.front ().number <= tag.GetAck ())
+        {
+          m_ackedPayloads++;
+          m_ackTrace (m_pending.front ().packet,
+              Simulator::Now () - m_pending.front ().admitted);
+          m_pending.pop_front ();
+        }
+      }
+
+      if (tag.GetPayloadNumber () == 0)
+      {
+        return false;
+      }
+      uint64_t &lastRx = m_lastRx[bmh.GetSrcAddr ()];
+      if (tag.GetPayloadNumber () <= lastRx)
+      {
+        NS_LOG_INFO ("Payload " << tag.GetPayloadNumber ()
+            << " was already received");
+        return false;
+      }
+      // Payloads in between were flushed by the peer
+      lastRx = tag.GetPayloadNumber ();
+      m_ack = lastRx;
+      m_rxPayloads++;
+      m_rxTrace (packet);
+      return true;
+    }
+
+  uint64_t
+    BleIsoStream::GetTxPayloads (void) const
+    {
+      return m_txPayloads;
+    }
+
+  uint64_t
+    BleIsoStream::GetTransmissions (void) const
+    {
+      return m_transmissions;
+    }
+
+  uint64_t
+    BleIsoStream::GetAckedPayloads (void) const
+    {
+      return m_ackedPayloads;
+    }
+
+  uint64_t
+    BleIsoStream::GetFlushedPayloads (void) const
+    {
+      return m_flushedPayloads;
+    }
+
+  uint64_t
+    BleIsoStream::GetRxPayloads (void) const
+    {
+      return m_rxPayloads;
+    }
+
+/*
+ * BleIsoTag
+ */
+BleIsoTag::BleIsoTag ()
+  : m_payloadNumber (0),
+    m_ack (0)
+{
+}
+
+BleIsoTag::BleIsoTag (uint64_t payloadNumber, uint64_t ack)
+  : m_payloadNumber (payloadNumber),
+    m_ack (ack)
+{
+}
+
+uint64_t
+BleIsoTag::GetPayloadNumber (void) const
+{
+  return m_payloadNumber;
+}
+
+uint64_t
+BleIsoTag::GetAck (void) const
+{
+  return m_ack;
+}
+
+TypeId
+BleIsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BleIsoTag")
+    .SetParent<Tag> ()
+    .AddConstructor<BleIsoTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+BleIsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+BleIsoTag::GetSerializedSize (void) const
+{
+  return 8+8;
+}
+
+void
+BleIsoTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_payloadNumber);
+  i.WriteU64 (m_ack);
+}
+
+void
+BleIsoTag::Deserialize (TagBuffer i)
+{
+  m_payloadNumber = i.ReadU64 ();
+  m_ack = i.ReadU64 ();
+}
+
+void
+BleIsoTag::Print (std::ostream &os) const
+{
+  os << "Payload = " << m_payloadNumber << ", Ack = " << m_ack;
+}
+
+}
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_ISO_STREAM_H
+#define BLE_ISO_STREAM_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <ns3/tag.h>
+#include <ns3/mac16-address.h>
+#include <ns3/traced-callback.h>
+#include <ns3/ble-mac-header.h>
+#include <deque>
+#include <map>
+
+namespace ns3 {
+
+  // Classes
+
+  class BleRingQueue;
+  class QueueItem;
+
+/**
+ * \ingroup ble
+ * \brief Isochronous stream of a link (CIS or BIS)
+ *
+ * Replaces the SN/NESN acknowledgements of a link by the scheduling of
+ * the LE isochronous channels. The ISO interval is the connection
+ * interval of the link and every ISO event is divided into SubEvents
+ * sub-events of equal length inside the transmit window, in which the
+ * master (CIS) or the broadcaster (BIS) transmits without waiting for
+ * the previous exchange to finish.
+ *
+ * At the anchor of every event up to BurstNumber SDUs of the queue of
+ * the link become payloads. A payload that is not delivered within
+ * FlushTimeout ISO intervals is flushed, so the latency of a payload is
+ * bounded by FlushTimeout times the ISO interval.
+ *
+ * On a connected link (CIS) every sub-event is a master PDU and the
+ * answer of the slave, both carry the oldest pending payload of the
+ * sender (or a null PDU) and acknowledge the payloads received from the
+ * peer, so a lost PDU is retransmitted in the next sub-event. On the
+ * broadcast link (BIS) nothing is acknowledged: the sub-events are
+ * divided over the pending payloads, so each one is repeated about
+ * SubEvents / BurstNumber times per event, and the receivers drop the
+ * copies they already have.
+ */
+  class BleIsoStream : public Object
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleIsoStream ();
+      virtual ~BleIsoStream ();
+
+      /**
+       * TracedCallback signature for acknowledged payloads
+       *
+       * \param [in] packet the payload, without the MAC header
+       * \param [in] delay time since the payload was taken from the queue
+       */
+      typedef void (* AckTracedCallback)(Ptr<const Packet> packet,
+          Time delay);
+
+      uint8_t GetSubEvents (void) const;
+      uint8_t GetBurstNumber (void) const;
+      uint8_t GetFlushTimeout (void) const;
+
+      // Broadcast streams (BIS) do not expect acknowledgements
+      void SetBroadcast (bool broadcast);
+      bool IsBroadcast (void) const;
+
+      /*
+       * Start of an ISO event: flush the payloads that passed their
+       * flush point and take at most BurstNumber new ones from queue.
+       */
+      void StartEvent (Ptr<BleRingQueue> queue,
+          Time isoInterval);
+
+      bool HasPendingPayloads (void) const;
+
+      /*
+       * The PDU for the next sub-event, from src: the oldest pending
+       * payload (CIS) or the next one in turn (BIS), or a null PDU
+       * when there is no payload. The PDU carries the payload number
+       * and the acknowledgement in a BleIsoTag.
+       */
+      Ptr<Packet> GetNextPdu (Mac16Address src);
+
+      /*
+       * Handle a PDU of the peer with MAC header bmh: remove the
+       * acknowledged payloads and the BleIsoTag. Returns true if the PDU
+       * holds a payload that was not received before; PDUs without tag
+       * are never dropped.
+       */
+      bool Receive (Ptr<Packet> packet, const BleMacHeader &bmh);
+
+      // Payloads taken from the queue
+      uint64_t GetTxPayloads (void) const;
+      // PDUs sent, retransmissions and null PDUs included
+      uint64_t GetTransmissions (void) const;
+      // Payloads acknowledged before their flush point (CIS only)
+      uint64_t GetAckedPayloads (void) const;
+      // Payloads that were not acknowledged in time (CIS only)
+      uint64_t GetFlushedPayloads (void) const;
+      // New payloads received from the peers
+      uint64_t GetRxPayloads (void) const;
+
+    private:
+      struct Payload
+      {
+        Ptr<Packet> packet; // Without the MAC header
+        BleMacHeader header;
+        uint64_t number;
+        Time admitted;
+        Time flushPoint;
+      };
+
+      uint8_t m_subEvents; // NSE
+      uint8_t m_burstNumber; // BN
+      uint8_t m_flushTimeout; // FT
+      bool m_broadcast;
+
+      std::deque<Payload> m_pending;
+      uint64_t m_nextPayloadNumber; // 0 is a null PDU
+      uint32_t m_nextBroadcast; // Pending payload of the next BIS sub-event
+      // Highest payload number received per source
+      std::map<Mac16Address, uint64_t> m_lastRx;
+      uint64_t m_ack; // Acknowledgement sent to the peer (CIS)
+
+      uint64_t m_txPayloads;
+      uint64_t m_transmissions;
+      uint64_t m_ackedPayloads;
+      uint64_t m_flushedPayloads;
+      uint64_t m_rxPayloads;
+
+      TracedCallback<Ptr<const Packet>, Time> m_ackTrace;
+      TracedCallback<Ptr<const Packet> > m_flushTrace;
+      TracedCallback<Ptr<const Packet> > m_rxTrace;
+  };
+
+/*
+ * \ingroup ble
+ * Payload number and acknowledgement of an isochronous PDU
+ *
+ * Simulation metadata only: the SN and NESN bits in the header can not
+ * tell the receiver that the peer flushed a payload, the payload
+ * counters of both sides can. The acknowledgement is the highest
+ * payload number received from the peer.
+ * */
+class BleIsoTag : public Tag
+{
+public:
+  BleIsoTag (void);
+  BleIsoTag (uint64_t payloadNumber, uint64_t ack);
+
+  uint64_t GetPayloadNumber (void) const;
+  uint64_t GetAck (void) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint64_t m_payloadNumber;
+  uint64_t m_ack;
+}; //BleIsoTag
+
+}
+
+#endif /* BLE_ISO_STREAM_H */
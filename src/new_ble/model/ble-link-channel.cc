@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-link-channel.h"
+#include "ble-phy.h"
+#include "ble-error-model.h"
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/pointer.h>
+#include <ns3/simulator.h>
+#include <ns3/packet.h>
+#include <ns3/node.h>
+#include <ns3/net-device.h>
+#include <ns3/mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleLinkChannel");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleLinkChannel);
+
+  // SINR range (dB) of the table, below it the first entry is used and
+  // above it no bit is lost
+  static const double PER_TABLE_MIN = -10;
+  static const double PER_TABLE_MAX = 20;
+  static const double PER_TABLE_STEP = 0.1;
+
+  TypeId
+    BleLinkChannel::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleLinkChannel")
+        .SetParent<Channel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleLinkChannel> ()
+        .AddAttribute ("MaxLoss",
+            "Path loss (dB) above which a receiver is not reached at all, "
+            "also not as interference",
+            DoubleValue (150),
+            MakeDoubleAccessor (&BleLinkChannel::m_maxLossDb),
+            MakeDoubleChecker<double> ())
+        .AddAttribute ("PropagationLossModel",
+            "The loss model of the gains between the PHYs",
+            PointerValue (),
+            MakePointerAccessor (&BleLinkChannel::m_loss),
+            MakePointerChecker<PropagationLossModel> ())
+        .AddAttribute ("PropagationDelayModel",
+            "The delay model of the transmissions, none if not set",
+            PointerValue (),
+            MakePointerAccessor (&BleLinkChannel::m_delay),
+            MakePointerChecker<PropagationDelayModel> ())
+        ;
+      return tid;
+    }
+
+  BleLinkChannel::BleLinkChannel ()
+    : m_maxLossDb (150)
+  {
+    NS_LOG_FUNCTION (this);
+    Ptr<BleErrorModel> errorModel = CreateObject<BleErrorModel> ();
+    uint32_t size = (PER_TABLE_MAX - PER_TABLE_MIN) / PER_TABLE_STEP + 1;
+    m_logSuccess.resize (size);
+    for (uint32_t i = 0; i < size; i++)
+      {
+        double sinr = std::pow (10.0, (PER_TABLE_MIN + i*PER_TABLE_STEP) / 10);
+        m_logSuccess[i] = std::log1p (-(double) errorModel->GetBER (sinr));
+      }
+  }
+
+  BleLinkChannel::~BleLinkChannel ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleLinkChannel::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_phys.clear ();
+      m_neighbours.clear ();
+      m_neighboursValid.clear ();
+      m_loss = 0;
+      m_delay = 0;
+      Channel::DoDispose ();
+    }
+
+  void
+    BleLinkChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+    {
+      NS_LOG_FUNCTION (this << loss);
+      m_loss = loss;
+      ClearGains ();
+    }
+
+  void
+    BleLinkChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+    {
+      NS_LOG_FUNCTION (this << delay);
+      m_delay = delay;
+      ClearGains ();
+    }
+
+  uint32_t
+    BleLinkChannel::Add (Ptr<BlePhy> phy)
+    {
+      NS_LOG_FUNCTION (this << phy);
+      NS_ASSERT (phy->GetMobility () != 0);
+      m_phys.push_back (phy);
+      m_neighbours.push_back (std::vector<Neighbour> ());
+      m_neighboursValid.push_back (false);
+      // The new PHY may be a neighbour of the ones that already transmitted
+      ClearGains ();
+      phy->GetMobility ()->TraceConnectWithoutContext ("CourseChange",
+          MakeCallback (&BleLinkChannel::CourseChanged, this));
+      return m_phys.size () - 1;
+    }
+
+  void
+    BleLinkChannel::ClearGains (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_neighboursValid.assign (m_neighboursValid.size (), false);
+    }
+
+  void
+    BleLinkChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+    {
+      ClearGains ();
+    }
+
+  void
+    BleLinkChannel::ComputeNeighbours (uint32_t txIndex)
+    {
+      NS_LOG_FUNCTION (this << txIndex);
+      NS_ASSERT_MSG (m_loss != 0, "No PropagationLossModel on the channel");
+      Ptr<MobilityModel> txMobility = m_phys[txIndex]->GetMobility ();
+      std::vector<Neighbour> &neighbours = m_neighbours[txIndex];
+      neighbours.clear ();
+      for (uint32_t rxIndex = 0; rxIndex < m_phys.size (); rxIndex++)
+        {
+          if (rxIndex == txIndex)
+            {
+              continue;
+            }
+          Ptr<MobilityModel> rxMobility = m_phys[rxIndex]->GetMobility ();
+          double gainDb = m_loss->CalcRxPower (0, txMobility, rxMobility);
+          if (-gainDb > m_maxLossDb)
+            {
+              continue;
+            }
+          Neighbour neighbour;
+          neighbour.index = rxIndex;
+          Ptr<NetDevice> device = m_phys[rxIndex]->GetDevice ();
+          Ptr<Node> node = device != 0 ? device->GetNode () : 0;
+          neighbour.nodeId = node != 0 ? node->GetId () : Simulator::NO_CONTEXT;
+          neighbour.systemId = node != 0 ? node->GetSystemId () : 0;
+          neighbour.gain = std::pow (10.0, gainDb / 10);
+          neighbour.delay = m_delay != 0 ?
+            m_delay->GetDelay (txMobility, rxMobility) : Seconds (0);
+          neighbours.push_back (neighbour);
+        }
+      m_neighboursValid[txIndex] = true;
+      NS_LOG_LOGIC ("PHY " << txIndex << " reaches " << neighbours.size ()
+          << " of " << m_phys.size () - 1 << " PHYs");
+    }
+
+  void
+    BleLinkChannel::StartTx (uint32_t txIndex, Ptr<const Packet> packet,
+        uint8_t channel, double power, Time duration)
+    {
+      NS_LOG_FUNCTION (this << txIndex << packet << (int) channel << power);
+      // One copy for all receivers, they only read it until one of them
+      // receives it without errors and copies it again
+      Ptr<const Packet> copy = packet->Copy ();
+      for (const Neighbour &neighbour : GetNeighbours (txIndex))
+        {
+          Deliver (neighbour, copy, channel, power, duration);
+        }
+    }
+
+  void
+    BleLinkChannel::Deliver (const Neighbour &neighbour,
+        Ptr<const Packet> packet, uint8_t channel, double power,
+        Time duration)
+    {
+      Ptr<BlePhy> phy = m_phys[neighbour.index];
+      if (phy->IsAsleep ())
+        {
+          // No event for a radio that is off
+          return;
+        }
+      Simulator::ScheduleWithContext (neighbour.nodeId, neighbour.delay,
+          &BlePhy::StartLinkRx, phy, packet, channel,
+          power * neighbour.gain, duration);
+    }
+
+  const std::vector<BleLinkChannel::Neighbour> &
+    BleLinkChannel::GetNeighbours (uint32_t txIndex)
+    {
+      NS_ASSERT (txIndex < m_phys.size ());
+      if (!m_neighboursValid[txIndex])
+        {
+          ComputeNeighbours (txIndex);
+        }
+      return m_neighbours[txIndex];
+    }
+
+  Ptr<BlePhy>
+    BleLinkChannel::GetPhy (uint32_t index) const
+    {
+      return m_phys[index];
+    }
+
+  uint32_t
+    BleLinkChannel::GetSystemId (uint32_t index) const
+    {
+      Ptr<NetDevice> device = m_phys[index]->GetDevice ();
+      Ptr<Node> node = device != 0 ? device->GetNode () : 0;
+      return node != 0 ? node->GetSystemId () : 0;
+    }
+
+  std::map<uint32_t, Time>
+    BleLinkChannel::GetLookAhead (uint32_t systemId)
+    {
+      NS_LOG_FUNCTION (this << systemId);
+      std::map<uint32_t, Time> lookAhead;
+      for (uint32_t txIndex = 0; txIndex < m_phys.size (); txIndex++)
+        {
+          if (GetSystemId (txIndex) != systemId)
+            {
+              continue;
+            }
+          Ptr<MobilityModel> txMobility = m_phys[txIndex]->GetMobility ();
+          // Out of range too: the nodes may move closer
+          for (uint32_t rxIndex = 0; rxIndex < m_phys.size (); rxIndex++)
+            {
+              uint32_t rxSystemId = GetSystemId (rxIndex);
+              if (rxSystemId == systemId)
+                {
+                  continue;
+                }
+              Time delay = m_delay != 0 ? m_delay->GetDelay (txMobility,
+                  m_phys[rxIndex]->GetMobility ()) : Seconds (0);
+              std::map<uint32_t, Time>::iterator it =
+                lookAhead.find (rxSystemId);
+              if (it == lookAhead.end ())
+                {
+                  lookAhead[rxSystemId] = delay;
+                }
+              else
+                {
+                  it->second = Min (it->second, delay);
+                }
+            }
+        }
+      return lookAhead;
+    }
+
+  double
+    BleLinkChannel::GetPer (double sinr, double bits) const
+    {
+      double sinrDb = 10*std::log10 (sinr);
+      if (sinrDb >= PER_TABLE_MAX)
+        {
+          return 0;
+        }
+      uint32_t i = 0;
+      if (sinrDb > PER_TABLE_MIN)
+        {
+          i = (sinrDb - PER_TABLE_MIN) / PER_TABLE_STEP;
+        }
+      return -std::expm1 (bits * m_logSuccess[i]);
+    }
+
+  std::size_t
+    BleLinkChannel::GetNDevices (void) const
+    {
+      return m_phys.size ();
+    }
+
+  Ptr<NetDevice>
+    BleLinkChannel::GetDevice (std::size_t i) const
+    {
+      return m_phys[i]->GetDevice ();
+    }
+
+}
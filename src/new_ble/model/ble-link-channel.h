@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_LINK_CHANNEL_H
+#define BLE_LINK_CHANNEL_H
+
+// Includes
+#include <ns3/channel.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class BlePhy;
+class BleErrorModel;
+class MobilityModel;
+class Packet;
+class PropagationLossModel;
+class PropagationDelayModel;
+
+/**
+ * \ingroup ble
+ * \brief Link-level abstraction of the medium of the BLE PHYs
+ *
+ * A BlePhy attached with BlePhy::SetLinkChannel transmits here instead
+ * of on a SpectrumChannel. A transmission is a packet, a channel index
+ * and a power, without SpectrumValue: the receivers add the power to a
+ * sum per channel and compute the SINR of the packet they receive from
+ * those sums, with the same leakage and adjacent channel selectivity as
+ * the spectrum model. The packet error rate of every chunk of constant
+ * SINR comes from a table of the BleErrorModel, no bit is sampled.
+ *
+ * The gain and delay from a PHY to every other one are computed once,
+ * the first time it transmits, and kept for the receivers with less
+ * than MaxLoss of path loss. A CourseChange of a mobility model clears
+ * them, a random loss model is drawn once per pair. Antenna gains are
+ * not taken into account, the BLE devices have isotropic antennas.
+ * No event is scheduled for a PHY with its radio off, it only records
+ * the transmission until it wakes up (see BlePhy::Sleep).
+ */
+  class BleLinkChannel : public Channel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleLinkChannel ();
+      virtual ~BleLinkChannel ();
+
+      void SetPropagationLossModel (Ptr<PropagationLossModel> loss);
+      void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+
+      // Attach phy, returns its index on the channel
+      virtual uint32_t Add (Ptr<BlePhy> phy);
+
+      /*
+       * Start the transmission of packet on channel by the PHY with
+       * index txIndex, with a power in W during duration
+       */
+      virtual void StartTx (uint32_t txIndex, Ptr<const Packet> packet,
+          uint8_t channel, double power, Time duration);
+
+      /*
+       * Packet error rate of bits received with a SINR (power ratio),
+       * from the table
+       */
+      double GetPer (double sinr, double bits) const;
+
+      // Forget the gains and delays, e.g. after the nodes moved
+      void ClearGains (void);
+
+      /*
+       * Lookahead of the PHYs of the nodes with system id systemId to
+       * every other system with a PHY, see BleRemoteLinkChannel: the
+       * smallest propagation delay to a PHY of that system, in range or
+       * not, at the current positions of the nodes.
+       */
+      std::map<uint32_t, Time> GetLookAhead (uint32_t systemId);
+
+      virtual std::size_t GetNDevices (void) const;
+      virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
+
+    protected:
+      virtual void DoDispose (void);
+
+      // A receiver close enough to a transmitter
+      struct Neighbour
+      {
+        uint32_t index;
+        uint32_t nodeId;
+        uint32_t systemId; // MPI rank of the node
+        double gain; // Power ratio
+        Time delay;
+      };
+
+      // The receivers of the PHY with index txIndex
+      const std::vector<Neighbour> &GetNeighbours (uint32_t txIndex);
+      /*
+       * Hand a transmission with power to neighbour, a sleeping PHY only
+       * records it (see BlePhy::Sleep)
+       */
+      void Deliver (const Neighbour &neighbour, Ptr<const Packet> packet,
+          uint8_t channel, double power, Time duration);
+      Ptr<BlePhy> GetPhy (uint32_t index) const;
+      // System id of the node of the PHY with index, 0 without node
+      uint32_t GetSystemId (uint32_t index) const;
+
+    private:
+      // Gains and delays from the PHY with index txIndex
+      void ComputeNeighbours (uint32_t txIndex);
+      void CourseChanged (Ptr<const MobilityModel> mobility);
+
+      double m_maxLossDb;
+      Ptr<PropagationLossModel> m_loss;
+      Ptr<PropagationDelayModel> m_delay;
+      std::vector<Ptr<BlePhy> > m_phys;
+      std::vector<std::vector<Neighbour> > m_neighbours;
+      std::vector<bool> m_neighboursValid;
+      // log (1 - BER) per PER_TABLE_STEP dB of SINR from PER_TABLE_MIN
+      std::vector<double> m_logSuccess;
+  };
+
+}
+
+#endif /* BLE_LINK_CHANNEL_H */
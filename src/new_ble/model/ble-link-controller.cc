@@ -31,6 +31,8 @@
 #include "ns3/ble-phy.h"
 #include "ns3/log.h"
 #include "ns3/ble-mac-header.h"
+#include "ns3/ble-iso-stream.h"
+#include "ns3/ble-ring-queue.h"
 
 namespace ns3 {
 
@@ -157,7 +159,7 @@ namespace ns3 {
 
   void
     BleLinkController::SetCheckedAckCallback (Callback<void, 
-        Ptr<Packet> > callback)
+        Ptr<Packet>, const BleMacHeader &> callback)
     {
       NS_LOG_FUNCTION (this);
       m_ackChecked = callback;
@@ -248,7 +250,13 @@ namespace ns3 {
     BleLinkController::PrepareForReception (Ptr<BleLinkManager> lm)
     {
       NS_LOG_FUNCTION (this);
-      if (! this->GetBBManager()->GetActiveLinkManager() == 0)
+      Ptr<BleLinkManager> active = this->GetBBManager()->GetActiveLinkManager();
+      if (active != 0 && active != lm)
+      {
+        // Preempted meanwhile, the radio belongs to another link manager
+        NS_LOG_INFO ("Link manager " << lm << " lost the radio");
+      }
+      else if (active != 0)
       {
         if (this->GetPhy()->GetState() == BlePhy::State::IDLE)
           this->GetPhy()->PrepareRX();
@@ -268,6 +276,11 @@ namespace ns3 {
     {
       NS_LOG_FUNCTION(this);
       NS_ASSERT (lm->GetCurrentPacket() != 0);
+      if (this->GetBBManager()->GetActiveLinkManager() != lm)
+      {
+        NS_LOG_INFO ("Link manager " << lm << " lost the radio");
+        return;
+      }
       
       if (StartTransmission (lm->GetCurrentPacket()->Copy(), false)) 
       {
@@ -279,6 +292,20 @@ namespace ns3 {
       }
     }
 
+  void
+    BleLinkController::ListenForNextIsoSubEvent (Ptr<BleLinkManager> lm)
+    {
+      // The PHY goes to IDLE after this reception
+      if (lm->GetIsoStream() != 0
+          && (lm->GetState() == BleLinkManager::State::SCANNER
+            || lm->GetState() == BleLinkManager::State::SLAVE)
+          && lm->IsInsideLastTransmitWindow (Simulator::Now()))
+      {
+        Simulator::ScheduleNow(
+            &BleLinkController::PrepareForReception, this, lm);
+      }
+    }
+
   // Checks if a received packet is arrived correctly or 
   // needs an acknowledgement and also sends this acknowledgement
   void
@@ -288,15 +315,16 @@ namespace ns3 {
       NS_LOG_FUNCTION (this);
       if (this->GetBBManager()->GetActiveLinkManager() != 0)
       {
+      // The only deserialization of the header on the receive side
+      BleMacHeader bmh;
+      packet->PeekHeader(bmh); 
       if (receptionError) // Error during packet reception,
       {
         // Ber was too high
-        BleMacHeader bmh;
-        packet->PeekHeader(bmh); 
         
         // Ignore broadcast for error callback
         //非广播（FF:FF）或状态为 SCANNER，触发错误回调（m_ackCheckedError）
-        if (bmh.GetDestAddr() != Mac16Address("FF:FF") || this->GetBBManager()->GetActiveLinkManager()->GetState() == BleLinkManager::State::SCANNER)
+        if (! bmh.IsBroadcast() || this->GetBBManager()->GetActiveLinkManager()->GetState() == BleLinkManager::State::SCANNER)
         {
           NS_LOG_INFO (this->GetBBManager()->GetActiveLinkManager()->GetState());
           NS_LOG_ERROR("Reception ERROR: packet for " << bmh.GetDestAddr() 
@@ -307,26 +335,54 @@ namespace ns3 {
               ->GetCurrentChannelIndex());
           m_ackCheckedError (packet);
         }
+        ListenForNextIsoSubEvent (
+            this->GetBBManager()->GetActiveLinkManager());
       }
       else
       {
-        BleMacHeader bmh;
         Ptr<BleLinkManager> lm = this->GetBBManager()->GetActiveLinkManager();
         NS_ASSERT (lm != 0);
-        packet->PeekHeader(bmh);
         NS_LOG_DEBUG ("Header received. LLID = " <<
             int(bmh.GetLLID()) << " MD = " << bmh.GetMD() <<
             " SN = " << bmh.GetSN() << " NESN = " <<
             bmh.GetNESN() ); //<< " length = " << int(bmh.GetLength()));
         //若为本设备地址或广播地址，处理包
         if (bmh.GetDestAddr() == this->GetNetDevice()->GetAddress16() ||
-            bmh.GetDestAddr() == Mac16Address("FF:FF") )
+            bmh.IsBroadcast() )
         {
           if (lm->GetState() == BleLinkManager::State::SCANNER )
           {
             NS_LOG_INFO ("Received an ADVERTISING packet, length = " 
                 << int(bmh.GetLength()));
-            m_ackChecked (packet);
+            if (lm->GetIsoStream() == 0)
+            {
+              m_ackChecked (packet, bmh);
+            }
+            else
+            {
+              // Every payload of a BIS is sent more than once
+              if (lm->GetIsoStream()->Receive (packet, bmh))
+                m_ackChecked (packet, bmh);
+              ListenForNextIsoSubEvent (lm);
+            }
+          }
+          else if (lm->GetIsoStream() != 0)
+          {
+            // The SN and NESN bits are not used on an isochronous link
+            lm->SetPeerHasMoreData(bmh.GetMD());
+            if (lm->GetIsoStream()->Receive (packet, bmh))
+              m_ackChecked (packet, bmh);
+            this->GetPhy()->ChangeState(BlePhy::State::IDLE);
+            if (lm->GetState() == BleLinkManager::State::SLAVE)
+            {
+              // The master schedules its sub-events itself
+              Simulator::Schedule(
+                  MicroSeconds(T_IFS),&BleLinkManager::SendNextPacket, lm);
+            }
+            else if (! lm->IsInsideLastTransmitWindow (Simulator::Now()))
+            {
+              this->GetBBManager()->SetActiveLinkManager(0);
+            }
           }
           else
           {
@@ -350,7 +406,7 @@ namespace ns3 {
                 //NS_ASSERT (bmh.GetLength() > 0);
                 NS_LOG_INFO ("Received a data packet, length = " 
                     << int(bmh.GetLength()));
-                m_ackChecked (packet);
+                m_ackChecked (packet, bmh);
               }
             }
             else
@@ -372,6 +428,10 @@ namespace ns3 {
               }*/
               //mhl修改
               if(lm->GetState() == BleLinkManager::State::MASTER || lm->GetState() == BleLinkManager::State::SLAVE){
+                // Let the master open its receiver in time for the reply
+                if (lm->GetState() == BleLinkManager::State::SLAVE &&
+                    ! lm->GetQueue()->IsEmpty())
+                  lm->ChangePeerHasMoreData(true);
                 Simulator::Schedule(
                     MicroSeconds(T_IFS),&BleLinkManager::SendNextPacket, lm);
               }
@@ -390,6 +450,8 @@ namespace ns3 {
         else // packet was not for me
         {
           NS_LOG_INFO ("Received a packet that was not for me");
+          ListenForNextIsoSubEvent (
+              this->GetBBManager()->GetActiveLinkManager());
         }
       }
       }
@@ -36,6 +36,7 @@
 
 #include <ns3/constants.h>
 #include <ns3/spectrum-channel.h>
+#include <ns3/ble-mac-header.h>
 
 namespace ns3 {
 
@@ -88,7 +89,9 @@ namespace ns3 {
       void CheckReceivedAckPacket (Ptr<Packet> packet, bool receptionError);//
 
 
-      void SetCheckedAckCallback (Callback<void, Ptr<Packet> > callback);//ACK 确认回调
+      // The header is the one CheckReceivedAckPacket parsed
+      void SetCheckedAckCallback (Callback<void, Ptr<Packet>,
+          const BleMacHeader &> callback);//ACK 确认回调
       void SetCheckedAckErrorCallback (Callback<void, Ptr<Packet> > callback);//错误回调
 
       void SetAllChannels (std::vector<Ptr<SpectrumChannel>> allChannels);//设置所有可用信道列表
@@ -103,7 +106,7 @@ namespace ns3 {
       Time startTimePacket; //!< time that device tried to send a 
                             //   packet for the first time
       Time lastSend; //!< time at which was last transmission 
-      Callback<void, Ptr<Packet> > m_ackChecked;
+      Callback<void, Ptr<Packet>, const BleMacHeader &> m_ackChecked;
       Callback<void, Ptr<Packet> > m_ackCheckedError;
       // Traceback functions:
       TracedCallback<Ptr<const Packet> > m_macTxTrace;//跟踪发送数据包
@@ -114,6 +117,8 @@ namespace ns3 {
       // Functions:
       
       bool StartTransmission (Ptr<Packet> packet, bool ackPacket);
+      // Keep a BIS receiver or CIS slave listening after a reception
+      void ListenForNextIsoSubEvent (Ptr<BleLinkManager> lm);
       
       std::vector<Ptr<SpectrumChannel>> m_allChannels;
   };
@@ -31,9 +31,11 @@
 #include <ns3/ble-net-device.h>
 #include <ns3/ble-link-controller.h>
 #include <ns3/ble-mac-header.h>
+#include <ns3/ble-iso-stream.h>
 #include <ns3/mac16-address.h>
 #include <ns3/queue.h>
-#include <ns3/drop-tail-queue.h>
+#include <ns3/ble-ring-queue.h>
+#include <ns3/ble-mac-queue-item.h>
 #include <ns3/queue-item.h>
 #include <ns3/multi-model-spectrum-channel.h>
 
@@ -64,7 +66,10 @@ namespace ns3 {
     m_sequenceNumber = false;
     m_peerHasMoreData = false;
     m_onePacketSend = false;
+    m_nExpired = 0;
     m_lastUnmappedChannelIndex = 0;
+    m_phy = 0;
+    m_linkController = 0;
 
     m_broadcastCollisionAvoidance = true;
     //广播休眠计数器，最大值
@@ -89,15 +94,14 @@ namespace ns3 {
     SetTransmitWindowSize (MilliSeconds (5));
     SetTransmitWindowOffset (MicroSeconds (2500));
 
-    Ptr<DropTailQueue<QueueItem>> buffer = Create<DropTailQueue<QueueItem>> ();
-    buffer->SetMaxSize ( QueueSize(QUEUE_SIZE_PACKETS));
-    this->m_queue = buffer;
+    this->m_queue = CreateObject<BleRingQueue> ();
   }
 
   void
     BleLinkManager::DoDispose () {
       NS_LOG_FUNCTION (this);
       m_queue = 0;
+      m_iso = 0;
     }
 
   BleLinkManager::~BleLinkManager ()
@@ -117,15 +121,21 @@ namespace ns3 {
   BleLinkManager::State
     BleLinkManager::GetState()
     {
-      NS_LOG_FUNCTION (this<<this->currentState);
+      BLE_LOG_FUNCTION (this << this->currentState);
       return this->currentState;
     }
 
+  BleLinkManager::Role
+    BleLinkManager::GetRole()
+    {
+      return this->expectedRole;
+    }
+
   //主从连接
   bool
     BleLinkManager::IsConnected()
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
      
       if (currentState == SLAVE || currentState == MASTER)
       {
@@ -296,7 +306,7 @@ MASTER：
         link->SetLinkType(BleLink::LinkType::UNCONNECTED);
       }
       link->SetChannel (
-          this->GetBBManager()->GetLinkController()
+          m_linkController
           ->GetChannelBasedOnChannelIndex (0));
      
       int connInterval = nbConnectionInterval; //3200
@@ -316,8 +326,7 @@ MASTER：
       else
       // Random connection parameters
       {
-        Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
-        randT->SetAttribute("Max", DoubleValue (3200));
+        Ptr<UniformRandomVariable> randT = GetBBManager ()->GetRandom ();
         if (connInterval == 0)
           connInterval = randT->GetInteger(6, 3200);
         txWindowOffset = randT->GetInteger(0, connInterval);
@@ -365,9 +374,7 @@ MASTER：
      
       if (! scheduled)
       {
-        Ptr<UniformRandomVariable> randT = 
-          CreateObject<UniformRandomVariable> ();
-        randT->SetAttribute("Max", DoubleValue (3200));
+        Ptr<UniformRandomVariable> randT = GetBBManager ()->GetRandom ();
         if (connInterval == 0)
           connInterval = randT->GetInteger(6, 3200);
         txWindowOffset = randT->GetInteger(0, connInterval);
@@ -382,7 +389,7 @@ MASTER：
       link->SetMaster(this->GetBBManager());
       link->SetLinkType(BleLink::LinkType::BROADCAST);
       link->SetChannel (
-          this->GetBBManager()->GetLinkController()
+          m_linkController
           ->GetChannelBasedOnChannelIndex (0));
       this->SetAssociatedLink(link);
       this->m_nextExpectedSequenceNumber = false;
@@ -457,7 +464,7 @@ MASTER：
   uint8_t 
     BleLinkManager::GetCurrentChannelIndex()
     {
-      NS_LOG_FUNCTION (this);
+      BLE_LOG_FUNCTION (this);
       return m_dataChannelIndex;
     }
 
@@ -662,14 +669,148 @@ MASTER：
       m_notifyPeerChangeState = cb;
   }
 
-  Ptr<DropTailQueue<QueueItem>> 
-    BleLinkManager::GetQueue (void)
+  void
+    BleLinkManager::SetIsoStream (Ptr<BleIsoStream> iso)
+    {
+      NS_LOG_FUNCTION (this << iso);
+      NS_ASSERT_MSG (expectedRole != STANDBY_ROLE,
+          "Set up the link before making it isochronous");
+      NS_ABORT_MSG_IF (iso->GetBurstNumber () > iso->GetSubEvents (),
+          "The burst number of an ISO stream exceeds its sub-events");
+      iso->SetBroadcast (expectedRole == CONNECTIONLESS_ROLE);
+      m_iso = iso;
+    }
+
+  Ptr<BleIsoStream>
+    BleLinkManager::GetIsoStream (void)
+    {
+      return m_iso;
+    }
+
+  Time
+    BleLinkManager::GetDeadline (void)
+    {
+      return m_lastServedTime + m_connSupervisionTimeout;
+    }
+
+  bool
+    BleLinkManager::IsPreemptible (void)
+    {
+      return m_iso == 0
+        && m_phy->GetState () == BlePhy::State::RX_BUSY
+        && ! m_phy->IsReceiving ();
+    }
+
+  void
+    BleLinkManager::Preempt (void)
     {
       NS_LOG_FUNCTION (this);
+      NS_ASSERT (m_bbManager->GetActiveLinkManager () == this);
+      NS_ASSERT (IsPreemptible ());
+      // The events the link controller scheduled for this link manager
+      // check that it still holds the radio
+      m_endOfCurrentWindow.Cancel ();
+      m_phy->ChangeState (BlePhy::State::IDLE);
+      m_bbManager->SetActiveLinkManager (0);
+      if (expectedRole == CONNECTIONLESS_ROLE)
+      {
+        this->SetState (SCANNER);
+      }
+    }
+
+  Ptr<BleRingQueue> 
+    BleLinkManager::GetQueue (void)
+    {
+      BLE_LOG_FUNCTION (this);
       NS_ASSERT(m_queue != 0);
       return m_queue;
     }
 
+  uint64_t
+    BleLinkManager::GetExpiredPackets (void) const
+    {
+      return m_nExpired;
+    }
+
+  void
+    BleLinkManager::FlushExpired (void)
+    {
+      uint32_t i = 0;
+      while (i < m_queue->GetNPackets ())
+        {
+          Ptr<const BleMacQueueItem> item =
+            DynamicCast<const BleMacQueueItem> (m_queue->Peek (i));
+          NS_ASSERT (item);
+          if (item->IsExpired ())
+            {
+              NS_LOG_INFO ("Deadline " << item->GetDeadline ()
+                  << " passed, flushing " << *item);
+              // Not sent, so the Drop trace rather than Dequeue
+              m_queue->Drop (i);
+              m_nExpired++;
+            }
+          else
+            i++;
+        }
+    }
+
+  bool
+    BleLinkManager::MakeRoomFor (Ptr<const BleMacQueueItem> item)
+    {
+      NS_LOG_FUNCTION (this << item);
+      if (m_queue->GetNPackets () < m_queue->GetCapacity ())
+        return true;
+      FlushExpired ();
+      if (m_queue->GetNPackets () < m_queue->GetCapacity ())
+        return true;
+      uint32_t worst = 0;
+      BleMacQueueItem::Priority worstPriority = item->GetPriority ();
+      for (uint32_t i = 0; i < m_queue->GetNPackets (); i++)
+        {
+          Ptr<const BleMacQueueItem> queued =
+            DynamicCast<const BleMacQueueItem> (m_queue->Peek (i));
+          if (queued->GetPriority () >= worstPriority
+              && queued->GetPriority () > item->GetPriority ())
+            {
+              worst = i;
+              worstPriority = queued->GetPriority ();
+            }
+        }
+      if (worstPriority == item->GetPriority ())
+        return false;
+      m_queue->Drop (worst);
+      return true;
+    }
+
+  Ptr<BleMacQueueItem>
+    BleLinkManager::DequeueNext (Time budget)
+    {
+      NS_LOG_FUNCTION (this << budget);
+      FlushExpired ();
+      uint32_t best = 0;
+      Ptr<const BleMacQueueItem> bestItem;
+      for (uint32_t i = 0; i < m_queue->GetNPackets (); i++)
+        {
+          Ptr<const BleMacQueueItem> item =
+            DynamicCast<const BleMacQueueItem> (m_queue->Peek (i));
+          NS_ASSERT (item);
+          if (m_phy->GetTxDuration (item->GetSize ()) > budget)
+            continue;
+          // Strictly better, so the oldest wins a tie
+          if (bestItem == 0
+              || item->GetPriority () < bestItem->GetPriority ()
+              || (item->GetPriority () == bestItem->GetPriority ()
+                && item->GetDeadline () < bestItem->GetDeadline ()))
+            {
+              best = i;
+              bestItem = item;
+            }
+        }
+      if (bestItem == 0)
+        return 0;
+      return DynamicCast<BleMacQueueItem> (m_queue->Remove (best));
+    }
+
   Ptr<BleBBManager>
     BleLinkManager::GetBBManager (void)
     {
@@ -681,6 +822,16 @@ MASTER：
     {
       NS_LOG_FUNCTION (this);
       m_bbManager = bbm;
+      if (bbm != 0)
+      {
+        m_phy = PeekPointer (bbm->GetPhy ());
+        m_linkController = PeekPointer (bbm->GetLinkController ());
+      }
+      else
+      {
+        m_phy = 0;
+        m_linkController = 0;
+      }
     }
 
   Ptr<Packet>
@@ -696,6 +847,15 @@ MASTER：
       m_currentPacket = packet;
     }
 
+  void
+    BleLinkManager::SetCurrentPacket (Ptr<Packet> packet,
+        const BleMacHeader &header)
+    {
+      NS_LOG_FUNCTION (this);
+      m_currentPacket = packet;
+      m_currentHeader = header;
+    }
+
   void
     BleLinkManager::SetKeepAliveActive (bool keepAliveActive)
     {
@@ -832,6 +992,17 @@ MASTER：
      BleLinkManager::SendNextPacket()
      {
        NS_LOG_FUNCTION (this);
+       if (m_bbManager->GetActiveLinkManager () != this)
+       {
+         // Scheduled before this link manager was preempted
+         NS_LOG_INFO ("Radio taken by another link manager");
+         return;
+       }
+       if (m_iso != 0)
+       {
+         SendIsoPacket ();
+         return;
+       }
        Time currentTime = Simulator::Now();
        NS_ASSERT (this->GetState() != SCANNER ); // A scanner cannot send data. 确保非扫描状态（SCANNER 不发送数据）
        
@@ -843,36 +1014,74 @@ MASTER：
        
        if (IsInsideLastTransmitWindow (currentTime))
        {
+           // Air time left for this packet before the window closes. The
+           // master keeps room for the reply of the slave, at least an
+           // empty PDU after T_IFS, so the slave can always answer.
+           Time budget = GetLastTransmitWindowTime ()
+             + GetTransmitWindowSize () - currentTime;
+           if (this->GetState() == MASTER)
+             budget -= MicroSeconds (T_IFS)
+               + m_phy->GetTxDuration (BleMacHeader ().GetSerializedSize ());
+           bool fits = true;
+
             //重传情况：如果有当前包（m_currentPacket != 0）且非新数据且非广播状态，记录重传日志（不构建新包，直接重用当前包）
-           if (this->GetCurrentPacket () != 0 && (! readyForNewData) 
+           if (((this->GetCurrentPacket () != 0 && (! readyForNewData))
+                 || m_deferredPacket != 0)
                && (! (this->GetState() == ADVERTISER)))
            {
+             if (m_deferredPacket != 0)
+             {
+               // Sent now, with the acknowledgement bits of this event
+               BleMacHeader bmh;
+               Ptr<Packet> packet = m_deferredPacket;
+               m_deferredPacket = 0;
+               packet->RemoveHeader (bmh);
+               bmh.SetNESN (m_nextExpectedSequenceNumber);
+               bmh.SetSN (m_sequenceNumber);
+               packet->AddHeader (bmh);
+               SetCurrentPacket (packet, bmh);
+               m_onePacketSend = true;
+             }
              // Transmission of a packet failed during the last
              // TX slot, resend this packet first.
              NS_LOG_INFO(" Retransmitting previous packet ");
+             fits = m_phy->GetTxDuration (GetCurrentPacket ()->GetSize ())
+               <= budget;
+             if (! fits && this->GetState() == SLAVE)
+             {
+               // The master reserved the time of an empty reply. The
+               // data waits for the next event, the empty PDU does not
+               // take its place.
+               NS_LOG_INFO ("Retransmission does not fit, empty PDU");
+               m_deferredPacket = GetCurrentPacket ();
+               BleMacHeader bmh;
+               Ptr<Packet> emptyPdu = CreateEmptyPdu (bmh);
+               SetCurrentPacket (emptyPdu, bmh);
+               m_onePacketSend = true;
+               fits = true;
+             }
            }
 
            //新包情况
            else // No current packet
            {
              NS_ASSERT(m_queue != 0);
+             Ptr<BleMacQueueItem> item = DequeueNext (budget);
              //队列非空
-             if (! (m_queue->IsEmpty()))
+             if (item != 0)
              {
-               BleMacHeader bmh1;
-               Ptr<QueueItem> item = m_queue->Dequeue ();
-               NS_ASSERT (item);
+               // Parsed when the packet was sent, not serialized yet
+               BleMacHeader bmh1 = item->GetHeader ();
                NS_LOG_DEBUG ("New packet set as current packet. "
                    "This new packet is not a dummy / Keep Alive Packet. "
                    "Packets left in the queue: "
-                   << m_queue->GetCurrentSize());
+                   << m_queue->GetNPackets ());
                Ptr<Packet> packet = item->GetPacket();
-               packet->RemoveHeader(bmh1);
 
                if (this->GetState() == ADVERTISER)
                {
                  // If advertising, dest address needs to be broadcast address
-                 NS_ASSERT (bmh1.GetDestAddr() == Mac16Address("ff:ff"));
+                 NS_ASSERT (bmh1.IsBroadcast());
                }
                /*LLID=0b10（数据 PDU）。
                 NESN/SN：更新序列号。
@@ -885,7 +1094,7 @@ MASTER：
                bmh1.SetMD(! m_queue->IsEmpty ());
                //mhl修改
                if(m_queue->IsEmpty ()==false){
-                 NS_LOG_INFO ("MD = 1 , m_queue_size = "<<m_queue->GetCurrentSize());
+                 NS_LOG_INFO ("MD = 1 , m_queue_size = "<<m_queue->GetNPackets ());
                } 
 
                // 通知对端（设备0）更新 m_peerHasMoreData
@@ -902,7 +1111,7 @@ MASTER：
                //bmh1.SetLength(item->GetPacket ()->GetSize());
                bmh1.SetLength(1);
                packet->AddHeader(bmh1);
-               this->SetCurrentPacket (packet);
+               this->SetCurrentPacket (packet, bmh1);
                m_onePacketSend =true;
              }
              //队列为空
@@ -927,19 +1136,16 @@ MASTER：
                 设置广播地址（FF:FF）*/
                {
                  BleMacHeader bmh2;
-                 Ptr<Packet> dummyPacket = Create<Packet> ();
-                 bmh2.SetLength(0);
-                 bmh2.SetLLID(0b01);
-                 bmh2.SetMD(0);
-                 this->SetMyLastMD(! m_queue->IsEmpty ());
-                 bmh2.SetNESN(m_nextExpectedSequenceNumber);
-                 bmh2.SetSN(m_sequenceNumber);
-                 bmh2.SetSrcAddr(
-                     this->GetBBManager()->GetNetDevice()->GetAddress16());
-                 bmh2.SetDestAddr(Mac16Address("FF:FF"));
-                 dummyPacket->AddHeader(bmh2);
-                 SetCurrentPacket (dummyPacket);
-                 m_onePacketSend = true;
+                 // Queued packets that do not fit wait for the next event
+                 Ptr<Packet> dummyPacket = CreateEmptyPdu (bmh2);
+                 // The master reserved the time of an empty reply
+                 fits = this->GetState() == SLAVE
+                   || m_phy->GetTxDuration (dummyPacket->GetSize ()) <= budget;
+                 if (fits)
+                 {
+                   SetCurrentPacket (dummyPacket, bmh2);
+                   m_onePacketSend = true;
+                 }
                }
                else
                {
@@ -947,21 +1153,28 @@ MASTER：
              }
            }
 
+           if (! fits)
+           {
+             // Starting the exchange would run past the window
+             NS_LOG_INFO ("No time left in this window for the exchange");
+             m_phy->ChangeState(BlePhy::State::IDLE);
+             m_bbManager->SetActiveLinkManager(0);
+             return;
+           }
+
            if (! this->GetCurrentPacket() == 0)
            {
-             BleMacHeader bmh3;
-             this->GetCurrentPacket()->PeekHeader(bmh3);
              NS_LOG_INFO ("Src Addr for current packet: " 
-                 << bmh3.GetSrcAddr() << " Dest address for current packet: " 
-                 << bmh3.GetDestAddr()); 
+                 << m_currentHeader.GetSrcAddr() << " Dest address for current packet: " 
+                 << m_currentHeader.GetDestAddr()); 
               //mhl修改
-             if(bmh3.GetDestAddr()!=Mac16Address("FF:FF")){
+             if(! m_currentHeader.IsBroadcast()){
                 NS_LOG_INFO("Notifying peer of MD=1");
                     m_notifyPeerHasMoreData(true);
              }
              Simulator::ScheduleNow(
                      &BleLinkController::StartPacketTransmission, 
-                     this->GetBBManager()->GetLinkController(),
+                     m_linkController,
                      this);
            }
            if (this->GetState() == ADVERTISER)
@@ -972,17 +1185,33 @@ MASTER：
        else
        {
        //  NS_LOG_INFO("No Time left inside this window");
-          this->GetBBManager()->GetPhy()->ChangeState(BlePhy::State::IDLE);
+          m_phy->ChangeState(BlePhy::State::IDLE);
           
-          this->GetBBManager()->SetActiveLinkManager(0);
+          m_bbManager->SetActiveLinkManager(0);
        }
      }
 
+   Ptr<Packet>
+     BleLinkManager::CreateEmptyPdu (BleMacHeader &header)
+     {
+       Ptr<Packet> packet = Create<Packet> ();
+       header.SetLength(0);
+       header.SetLLID(0b01);
+       header.SetMD(0);
+       this->SetMyLastMD(false);
+       header.SetNESN(m_nextExpectedSequenceNumber);
+       header.SetSN(m_sequenceNumber);
+       header.SetSrcAddr(m_bbManager->GetNetDevice()->GetAddress16());
+       header.SetDestAddr(BleMacHeader::GetBroadcastAddress());
+       packet->AddHeader(header);
+       return packet;
+     }
+
    void
      BleLinkManager::HandleTXDone ()
      {
        NS_LOG_FUNCTION (this);
-       this->GetBBManager()->GetPhy()->ChangeState(BlePhy::State::IDLE);
+       m_phy->ChangeState(BlePhy::State::IDLE);
        this->SetCurrentPacket(0);
        Time currentTime = Simulator::Now();
         NS_LOG_FUNCTION ("RX-MHL");
@@ -991,22 +1220,36 @@ MASTER：
           NS_LOG_INFO ("RX-MHL-new");
          Simulator::Schedule(MicroSeconds(T_IFS),
              &BleLinkController::PrepareForReception,
-             this->GetBBManager()->GetLinkController(),
+             m_linkController,
              this);
        }
        else
        {
-          this->GetBBManager()->SetActiveLinkManager(0);
+          m_bbManager->SetActiveLinkManager(0);
        }*/
         // 延迟检查，确保对端数据包到达
        // 延迟调度辅助函数，而不是lambda
       if(this->GetState()==MASTER)
       {
         NS_LOG_INFO("RX-MHL-new");
-        Simulator::Schedule(NanoSeconds(150310),//MicroSeconds(150.3),
+        // The radio has to be ready when the reply of the slave starts,
+        // T_IFS after this packet. The slave announces a data reply as
+        // soon as it receives this packet (see CheckReceivedAckPacket).
+        Simulator::Schedule(
+          MicroSeconds(T_IFS) - MicroSeconds(RX_PREP_TIME),
           &BleLinkManager::DelayedPrepareForReception,
           this);  // 使用成员函数指针 &BleLinkManager::DelayedPrepareForReception
       } 
+      else if (this->GetState()==SLAVE && m_iso != 0)
+      {
+        // Listen for the next sub-event of the master
+        if (IsInsideLastTransmitWindow(currentTime))
+          Simulator::ScheduleNow(&BleLinkController::PrepareForReception,
+              m_linkController,
+              this);
+        else
+          m_bbManager->SetActiveLinkManager(0);
+      }
       else if(this->GetState()==SLAVE && !m_notifyPeerChangeState.IsNull())
       {
         NS_LOG_INFO("SetState STANDBY");
@@ -1017,19 +1260,101 @@ MASTER：
 
   void BleLinkManager::DelayedPrepareForReception() {
     NS_LOG_FUNCTION(this<<expectedRole<<m_lastMD<<GetPeerHasMoreData());
+    if (m_bbManager->GetActiveLinkManager () != this)
+    {
+      // Preempted meanwhile, do not release the radio of the other one
+      return;
+    }
     Time currentTime = Simulator::Now();
-    if (IsInsideLastTransmitWindow(currentTime) && GetPeerHasMoreData() ) //这里判断的是0的对端，但是0是主节点，对端有好几个，所以这里一直是0
+    // The slave of a CIS answers in every sub-event
+    if (IsInsideLastTransmitWindow(currentTime)
+        && (GetPeerHasMoreData() || m_iso != 0)) //这里判断的是0的对端，但是0是主节点，对端有好几个，所以这里一直是0
     {
       Simulator::ScheduleNow(&BleLinkController::PrepareForReception,
-            this->GetBBManager()->GetLinkController(),
+            m_linkController,
             this);
     } 
     else 
     {
-        this->GetBBManager()->SetActiveLinkManager(0);
+        m_bbManager->SetActiveLinkManager(0);
     }
   }
 
+   void
+     BleLinkManager::StartIsoSubEvent (uint8_t subEvent)
+     {
+       NS_LOG_FUNCTION (this << int(subEvent));
+       if (m_bbManager->GetActiveLinkManager() != this
+           || ! IsInsideLastTransmitWindow (Simulator::Now()))
+       {
+         return;
+       }
+       // The sub-events are scheduled from the anchor, whether or not
+       // the previous exchange succeeded
+       if (subEvent + 1 < m_iso->GetSubEvents ())
+       {
+         Simulator::Schedule (
+             GetTransmitWindowSize () / m_iso->GetSubEvents (),
+             &BleLinkManager::StartIsoSubEvent,
+             this,
+             subEvent + 1);
+       }
+
+       if (m_phy->GetState () == BlePhy::State::RX
+           || (m_phy->GetState () == BlePhy::State::RX_BUSY
+             && ! m_phy->IsReceiving ()))
+       {
+         // The answer of the slave did not arrive
+         m_phy->ChangeState (BlePhy::State::IDLE);
+       }
+       else if (m_phy->GetState () != BlePhy::State::IDLE)
+       {
+         NS_LOG_WARN ("Sub-event " << int(subEvent)
+             << " skipped, PHY state = " << m_phy->GetState ());
+         return;
+       }
+
+       if (expectedRole == CONNECTIONLESS_ROLE)
+       {
+         if (m_iso->HasPendingPayloads ())
+         {
+           this->SetState (ADVERTISER);
+           SendIsoPacket ();
+         }
+       }
+       // The anchor keeps the connection alive, the other sub-events
+       // are only used while one of both sides has payloads
+       else if (subEvent == 0 || m_iso->HasPendingPayloads ()
+           || GetPeerHasMoreData ())
+       {
+         this->SetState (MASTER);
+         SendIsoPacket ();
+       }
+     }
+
+   void
+     BleLinkManager::SendIsoPacket ()
+     {
+       NS_LOG_FUNCTION (this);
+       if (! IsInsideLastTransmitWindow (Simulator::Now()))
+       {
+         m_phy->ChangeState(BlePhy::State::IDLE);
+         m_bbManager->SetActiveLinkManager(0);
+         return;
+       }
+       SetCurrentPacket (
+           m_iso->GetNextPdu (m_bbManager->GetNetDevice()->GetAddress16()));
+       m_onePacketSend = true;
+       Simulator::ScheduleNow(
+           &BleLinkController::StartPacketTransmission,
+           m_linkController,
+           this);
+       if (this->GetState() == ADVERTISER)
+       {
+         this->SetState(SCANNER);
+       }
+     }
+
   //模拟BLE的周期性传输窗口（connection event），主设备发起发送，从设备等待接收。
   //支持广播模式（CONNECTIONLESS_ROLE）的广告发送与扫描切换。
   //管理窗口时间参数（如 m_transmitWindowSize、m_connInterval）和状态（如 m_onePacketSend、m_firstTransmitWindowDone）
@@ -1049,112 +1374,148 @@ MASTER：
        // wait for packet from master to arrive
 
        NS_LOG_FUNCTION (this);
-       if ( this->GetBBManager()->GetActiveLinkManager() == 0)
-       {
-         this->GetBBManager()->SetActiveLinkManager(this);
-
-         NS_LOG_INFO (this << " Start of a TransmitWindow, my Role = " 
-             << expectedRole << " my state = " << GetState() 
-             << " my link = " << this->GetAssociatedLink() << " this BBM = " 
-             << this->GetBBManager());
+       // The BB manager decides once all windows of this instant asked
+       m_bbManager->RequestRadio (this);
+     }
 
-         SetLastTransmitWindowTime(Simulator::Now());
-         m_endOfCurrentWindow = Simulator::Schedule (
-             GetTransmitWindowSize(),
-             &BleLinkManager::EndTransmitWindow,
-             this);
+   void
+     BleLinkManager::OpenTransmitWindow ()
+     {
+       NS_LOG_FUNCTION (this);
+       NS_ASSERT (m_bbManager->GetActiveLinkManager () == this);
+       m_lastServedTime = Simulator::Now ();
+
+       NS_LOG_INFO (this << " Start of a TransmitWindow, my Role = " 
+           << expectedRole << " my state = " << GetState() 
+           << " my link = " << this->GetAssociatedLink() << " this BBM = " 
+           << this->GetBBManager());
+
+       SetLastTransmitWindowTime(Simulator::Now());
+       m_endOfCurrentWindow = Simulator::Schedule (
+           GetTransmitWindowSize(),
+           &BleLinkManager::EndTransmitWindow,
+           this);
 
-         m_firstTransmitWindowDone = true;//标记首次窗口完成
-         m_onePacketSend = false;//重置窗口内发送标志
-         SetMyLastMD(true);
+       m_firstTransmitWindowDone = true;//标记首次窗口完成
+       m_onePacketSend = false;//重置窗口内发送标志
+       SetMyLastMD(true);
 
-         PrepareNextTransmitWindow ();
-         ManageChannelSelection();
+       PrepareNextTransmitWindow ();
+       ManageChannelSelection();
+       if (m_iso != 0)
+       {
+         m_iso->StartEvent (m_queue, GetConnInterval ());
+       }
 
-         if(this->GetCurrentPacket()!=0){
-          NS_LOG_INFO(" 具有数据包 "<<this->GetCurrentPacket());
-         }
+       if(this->GetCurrentPacket()!=0){
+        NS_LOG_INFO(" 具有数据包 "<<this->GetCurrentPacket());
+       }
 
-         if (expectedRole == MASTER_ROLE)
-         {
-           this->SetState(MASTER);
+       if (expectedRole == MASTER_ROLE)
+       {
+         this->SetState(MASTER);
+         if (m_iso != 0)
+           StartIsoSubEvent (0);
+         else
            SendNextPacket();
-           
-         }
          
-         else if (expectedRole == SLAVE_ROLE)
+       }
+       
+       else if (expectedRole == SLAVE_ROLE)
+       {
+         this->SetState(SLAVE);
+         Simulator::ScheduleNow(
+             &BleLinkController::PrepareForReception,
+             m_linkController,
+             this);
+             
+       }
+       else if (expectedRole == CONNECTIONLESS_ROLE )
+       {
+         
+         if (this->GetState () == SCANNER && m_iso != 0)
          {
-           this->SetState(SLAVE);
-           Simulator::ScheduleNow(
-               &BleLinkController::PrepareForReception,
-               this->GetBBManager()->GetLinkController(),
-               this);
-               
+           // The events of a BIS are scheduled, no collision avoidance
+           if (m_iso->HasPendingPayloads ())
+           {
+             StartIsoSubEvent (0);
+           }
+           else
+           {
+             Simulator::ScheduleNow(
+                 &BleLinkController::PrepareForReception,
+                 m_linkController,
+                 this);
+           }
          }
-         else if (expectedRole == CONNECTIONLESS_ROLE )
+         else if (this->GetState () == SCANNER)
          {
-           
-           if (this->GetState () == SCANNER)
+           if ((! m_queue->IsEmpty()) && ((m_advSleepCounter == 0) 
+                 || (m_broadcastCollisionAvoidance == false)))
            {
-             if ((! m_queue->IsEmpty()) && ((m_advSleepCounter == 0) 
-                   || (m_broadcastCollisionAvoidance == false)))
-             {
-               // Data in Queue to advertise 
-               // ==> move to advertiser state, make sure to exit afterwards
-               this->SetState (ADVERTISER);
-               SendNextPacket ();
-             }
-             else 
-             {
-             Simulator::ScheduleNow(
-               &BleLinkController::PrepareForReception,
-               this->GetBBManager()->GetLinkController(),
-               this);
-             }
-             if (m_advSleepCounter == m_advSleepMax)
-             {
-               m_advSleepCounter = 0;
-             }
-             else
-             {
-               m_advSleepCounter++;
-             }
+             // Data in Queue to advertise 
+             // ==> move to advertiser state, make sure to exit afterwards
+             this->SetState (ADVERTISER);
+             SendNextPacket ();
+           }
+           else 
+           {
+           Simulator::ScheduleNow(
+             &BleLinkController::PrepareForReception,
+             m_linkController,
+             this);
+           }
+           if (m_advSleepCounter == m_advSleepMax)
+           {
+             m_advSleepCounter = 0;
            }
            else
            {
-             NS_LOG_ERROR ("The Link Manager is "
-                 "in an impossible Connectionless State!");
-             NS_ASSERT (false);
+             m_advSleepCounter++;
            }
          }
          else
          {
-           NS_LOG_WARN ("The Link Manager is neither in Master or Slave role!");
+           NS_LOG_ERROR ("The Link Manager is "
+               "in an impossible Connectionless State!");
+           NS_ASSERT (false);
          }
        }
        else
        {
-         NS_LOG_INFO (this << " The BB manager " << this->GetBBManager() 
-             << " is busy, this tx window will be skipped,  my link = " 
-             << this->GetAssociatedLink() << " Active LM = " 
-             << this->GetBBManager()->GetActiveLinkManager() 
-             << " current PHY state = " << this->GetBBManager()->GetPhyState());
-         NS_ASSERT (this->GetBBManager()->GetActiveLinkManager() != this);
-         NS_ASSERT (this->GetBBManager()->GetActiveLinkManager()->GetBBManager() 
-             == this->GetBBManager());
-
-         // This can be false only if the active link manager 
-         // is transmitting outside tx window
-         NS_ASSERT (
-             this->GetBBManager()->GetActiveLinkManager()
-             ->IsInsideLastTransmitWindow(Simulator::Now()));
-
-         // Callback management 
-         this->GetBBManager()->GetNetDevice()->NotifyTXWindowSkipped();
-
-         SetLastTransmitWindowTime(Simulator::Now());
-         PrepareNextTransmitWindow ();
-         ManageChannelSelection();
+         NS_LOG_WARN ("The Link Manager is neither in Master or Slave role!");
+       }
+     }
+
+   void
+     BleLinkManager::SkipTransmitWindow ()
+     {
+       NS_LOG_FUNCTION (this);
+       NS_LOG_INFO (this << " The BB manager " << this->GetBBManager() 
+           << " is busy, this tx window will be skipped,  my link = " 
+           << this->GetAssociatedLink() << " Active LM = " 
+           << m_bbManager->GetActiveLinkManager() 
+           << " current PHY state = " << m_phy->GetState());
+       NS_ASSERT (m_bbManager->GetActiveLinkManager() != this);
+       NS_ASSERT (m_bbManager->GetActiveLinkManager()->GetBBManager() 
+           == this->GetBBManager());
+
+       // This can be false only if the active link manager 
+       // is transmitting outside tx window
+       NS_ASSERT (
+           m_bbManager->GetActiveLinkManager()
+           ->IsInsideLastTransmitWindow(Simulator::Now()));
+
+       // Callback management 
+       m_bbManager->GetNetDevice()->NotifyTXWindowSkipped();
+
+       SetLastTransmitWindowTime(Simulator::Now());
+       PrepareNextTransmitWindow ();
+       ManageChannelSelection();
+       // The flush points do not move when an event is skipped
+       if (m_iso != 0)
+       {
+         m_iso->StartEvent (m_queue, GetConnInterval ());
        }
      }
 
@@ -1173,35 +1534,47 @@ MASTER：
        // set phy in standby mode after current TX / RX event is done,
        // deactive activeLinkManager in BBM
        // schedule next tx window
-       if (this->GetBBManager()->GetActiveLinkManager() == 0)
+       if (m_bbManager->GetActiveLinkManager() == 0)
        {
-         this->GetBBManager()->GetPhy()->ChangeState(BlePhy::State::IDLE);
+         m_phy->ChangeState(BlePhy::State::IDLE);
        }
        else if (this->expectedRole == CONNECTIONLESS_ROLE)
        {
-         this->GetBBManager()->GetPhy()->ChangeState(BlePhy::State::IDLE);
-         this->GetBBManager()->SetActiveLinkManager(0);
+         // The radio may be given to another link manager already
+         if (m_bbManager->GetActiveLinkManager() == this)
+         {
+           m_phy->ChangeState(BlePhy::State::IDLE);
+           m_bbManager->SetActiveLinkManager(0);
+         }
          this->SetState (SCANNER);
        }
-       else if (this->GetBBManager()->GetActiveLinkManager() == this)
+       else if (m_bbManager->GetActiveLinkManager() == this)
        {
-         if (this->GetBBManager()->GetPhy()->GetState () == BlePhy::State::RX)
+         if (m_phy->GetState () == BlePhy::State::RX)
          {
            // BB manager is prepared to receive packet, 
            // but no packet will be comming 
-           this->GetBBManager()->GetPhy()->ChangeState(BlePhy::State::IDLE);
-            this->GetBBManager()->SetActiveLinkManager(0);
+           m_phy->ChangeState(BlePhy::State::IDLE);
+            m_bbManager->SetActiveLinkManager(0);
  
            NS_LOG_INFO (" TXWindow closed, I was still in receive mode");
          }
-         else if (this->GetBBManager()->GetPhyState() == BlePhy::State::IDLE)
+         else if (m_phy->GetState() == BlePhy::State::IDLE)
+         {
+            m_bbManager->SetActiveLinkManager(0);
+         }
+         else if (m_phy->GetState () == BlePhy::State::RX_BUSY
+             && ! m_phy->IsReceiving ())
          {
-            this->GetBBManager()->SetActiveLinkManager(0);
+           // Listening for a packet (or ISO sub-event) that will not
+           // come, e.g. after the previous one was lost to interference
+           m_phy->ChangeState(BlePhy::State::IDLE);
+           m_bbManager->SetActiveLinkManager(0);
          }
          else
          {
            NS_LOG_WARN (" End of transmitwindow, but still busy, PHY state = " 
-               << this->GetBBManager()->GetPhyState());
+               << m_phy->GetState());
          }
        }
 
@@ -1246,11 +1619,15 @@ MASTER：
        }
        m_lastUnmappedChannelIndex = m_unmappedChannelIndex;
       
-       // Make sure PHY listens / sends on this channel
-       this->GetBBManager()->GetPhy()->SetChannel(
-           this->GetBBManager()->GetLinkController()->
-           GetChannelBasedOnChannelIndex (m_dataChannelIndex));
-       this->GetBBManager()->GetPhy()->SetChannelIndex(m_dataChannelIndex);
+       // Make sure PHY listens / sends on this channel. A skipped window
+       // only hops, the radio belongs to another link manager.
+       if (m_bbManager->GetActiveLinkManager () == this)
+       {
+         m_phy->SetChannel(
+             m_linkController->
+             GetChannelBasedOnChannelIndex (m_dataChannelIndex));
+         m_phy->SetChannelIndex(m_dataChannelIndex);
+       }
        NS_LOG_INFO (this << " Current Channel Index is : " 
            << int(m_dataChannelIndex) );
      }
@@ -40,15 +40,19 @@
 #include <ns3/packet.h>
 #include <ns3/simulator.h>
 #include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/ble-mac-header.h>
 
 namespace ns3 {
 
   // Classes
-  template <typename Item> class DropTailQueue;
+  class BleRingQueue;
   class BleBBManager;
   class BleLinkController;
   class BleNetDevice;
+  class BlePhy;
+  class BleIsoStream;
   class QueueItem;
+  class BleMacQueueItem;
 /** 
  * \ingroup ble
  * \brief Implementation for the Link Manager of the BLE protocol
@@ -87,6 +91,7 @@ namespace ns3 {
 
       void SetState(State state);
       State GetState();
+      Role GetRole ();
 
       bool IsConnected();
 
@@ -169,13 +174,26 @@ namespace ns3 {
        * Put packet in the queue / buffer, so it can be transmitted
        */
       //管理数据包队列
-      Ptr<DropTailQueue<QueueItem>> GetQueue (void);
+      Ptr<BleRingQueue> GetQueue (void);
+      // Packets flushed from the queue because their deadline passed
+      uint64_t GetExpiredPackets (void) const;
+      /*
+       * Make room in a full queue for item: flush the expired packets
+       * and, if it is still full, drop the youngest packet of the lowest
+       * priority class below that of item. False if it stays full.
+       */
+      bool MakeRoomFor (Ptr<const BleMacQueueItem> item);
 
       //当前发送的数据包
       void SetCurrentPacket (Ptr<Packet> packet);
+      // packet already holds header, which is kept parsed for the link
+      void SetCurrentPacket (Ptr<Packet> packet, const BleMacHeader &header);
       Ptr<Packet> GetCurrentPacket (void);
 
       void StartTransmitWindow (void);
+      // Called by BleBBManager::ArbitrateRadio for the window that starts
+      void OpenTransmitWindow (void);
+      void SkipTransmitWindow (void);
       void EndTransmitWindow (void);
       void PrepareNextTransmitWindow (void);
 
@@ -242,6 +260,33 @@ namespace ns3 {
       //启用/禁用广播冲突避免机制
       void SetAdvCollisionAvoidance (bool collAvoid);
 
+      /*
+       * Turn this link into an isochronous stream, see BleIsoStream.
+       * The link must be set up, and both link managers of a connection
+       * need a stream. The sub-events divide the transmit window.
+       */
+      void SetIsoStream (Ptr<BleIsoStream> iso);
+      Ptr<BleIsoStream> GetIsoStream (void);
+
+      /*
+       * The time before which this link manager needs the radio again:
+       * the start of the last transmit window it got plus the
+       * supervision timeout. The BB manager gives the radio to the
+       * earliest deadline, see BleBBManager::ArbitrateRadio.
+       */
+      Time GetDeadline (void);
+
+      /*
+       * True if the radio can be taken away without breaking an
+       * exchange: the PHY only listens and no packet is on the air.
+       * ISO link managers are never preempted, their sub-events are
+       * already scheduled.
+       */
+      bool IsPreemptible (void);
+
+      // Ends the current transmit window early and releases the radio
+      void Preempt (void);
+
       //mhl修改
       void SetNotifyPeerHasMoreDataCallback(Callback<void, bool> cb);
       void ChangePeerHasMoreData(bool flag);
@@ -249,6 +294,22 @@ namespace ns3 {
 
     private:
 
+      // Sub-event k of an ISO event of the master or broadcaster
+      void StartIsoSubEvent (uint8_t subEvent);
+      // Transmit the next PDU of the isochronous stream
+      void SendIsoPacket (void);
+
+      /*
+       * Flush the expired packets from the queue and take out the one to
+       * send among those with an air time of at most budget: the lowest
+       * BleMacQueueItem::Priority, then the earliest deadline, then the
+       * oldest. 0 if none of them fits.
+       */
+      Ptr<BleMacQueueItem> DequeueNext (Time budget);
+      void FlushExpired (void);
+      // The empty PDU (LLID 0b01, no payload) that acks and keeps the link
+      Ptr<Packet> CreateEmptyPdu (BleMacHeader &header);
+
       Callback<void, bool> m_notifyPeerHasMoreData; // 通知对端更新 MD
       Callback<void, State> m_notifyPeerChangeState; //通知对端更新状态
       // This is false as long as no transmit window has past
@@ -268,6 +329,7 @@ namespace ns3 {
 
       Time m_lastTimeConnectionEstablished;//记录连接时间
       Time m_lastTransmitWindowTime;//传输窗口时间
+      Time m_lastServedTime; // Start of the last window with the radio
 
       // Scheduling parameters 
       Time m_connInterval;
@@ -280,11 +342,23 @@ namespace ns3 {
       Time m_transmitWindowSize;
 
       // Packet buffer
-      Ptr<DropTailQueue<QueueItem>> m_queue;
+      Ptr<BleRingQueue> m_queue;
+      uint64_t m_nExpired;
 
       Ptr<BleBBManager> m_bbManager;
+      // Resolved from m_bbManager in SetBBManager, so the connection-event
+      // code does not walk BBManager -> NetDevice -> PHY on every access.
+      // Both objects are owned by the net device that also owns this
+      // link manager. Links are created after the helper has attached
+      // the final PHY and link controller to the device.
+      BlePhy *m_phy;
+      BleLinkController *m_linkController;
       Ptr<Packet> m_currentPacket;//当前数据包
+      BleMacHeader m_currentHeader; // Header of m_currentPacket
+      // Data that gave way to an empty PDU at the end of the last event
+      Ptr<Packet> m_deferredPacket;
       bool m_currentIsDummy;//是否为占位包
+      Ptr<BleIsoStream> m_iso; // 0 unless the link is isochronous
 
       bool m_nextExpectedSequenceNumber;
       bool m_sequenceNumber;
@@ -44,8 +44,8 @@ BleMacHeader::BleMacHeader ()
     SetMD(0);
     SetLength(0);
     SetLLID(0);
-    SetSrcAddr("00:00");
-    SetDestAddr("00:00");
+    SetSrcAddr(Mac16Address ());
+    SetDestAddr(Mac16Address ());
 }
 
 BleMacHeader::~BleMacHeader ()
@@ -53,6 +53,19 @@ BleMacHeader::~BleMacHeader ()
 	NS_LOG_FUNCTION (this);
 }
 
+Mac16Address
+BleMacHeader::GetBroadcastAddress (void)
+{
+  static const Mac16Address broadcast ("FF:FF");
+  return broadcast;
+}
+
+bool
+BleMacHeader::IsBroadcast (void) const
+{
+  return m_dest_addr == GetBroadcastAddress ();
+}
+
 /*
  * Getters And Setters
  */
@@ -69,6 +69,11 @@ public:
   void SetLLID (uint8_t llid);
   void SetLength (uint8_t length);
 
+  // FF:FF, parsed once
+  static Mac16Address GetBroadcastAddress (void);
+  // The destination is the broadcast address
+  bool IsBroadcast (void) const;
+
   std::string GetName (void) const;
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-mac-queue-item.h"
+#include <ns3/log.h>
+#include <ns3/packet.h>
+#include <ns3/simulator.h>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleMacQueueItem");
+
+  NS_OBJECT_ENSURE_REGISTERED (BlePriorityTag);
+
+  BleMacQueueItem::BleMacQueueItem (Ptr<Packet> packet,
+      const BleMacHeader &header)
+    : QueueItem (packet),
+      m_header (header),
+      m_priority (BULK),
+      m_deadline (Time::Max ())
+  {
+    NS_LOG_FUNCTION (this << packet);
+  }
+
+  BleMacQueueItem::~BleMacQueueItem ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  const BleMacHeader &
+    BleMacQueueItem::GetHeader (void) const
+    {
+      return m_header;
+    }
+
+  BleMacQueueItem::Priority
+    BleMacQueueItem::GetPriority (void) const
+    {
+      return m_priority;
+    }
+
+  void
+    BleMacQueueItem::SetPriority (Priority priority)
+    {
+      m_priority = priority;
+    }
+
+  Time
+    BleMacQueueItem::GetDeadline (void) const
+    {
+      return m_deadline;
+    }
+
+  void
+    BleMacQueueItem::SetDeadline (Time deadline)
+    {
+      m_deadline = deadline;
+    }
+
+  bool
+    BleMacQueueItem::IsExpired (void) const
+    {
+      return m_deadline < Simulator::Now ();
+    }
+
+  uint32_t
+    BleMacQueueItem::GetSize (void) const
+    {
+      return QueueItem::GetSize () + m_header.GetSerializedSize ();
+    }
+
+  Ptr<Packet>
+    BleMacQueueItem::GetProtocolDataUnit (void) const
+    {
+      Ptr<Packet> pdu = GetPacket ()->Copy ();
+      pdu->AddHeader (m_header);
+      return pdu;
+    }
+
+  void
+    BleMacQueueItem::Print (std::ostream &os) const
+    {
+      m_header.Print (os);
+      os << " ";
+      QueueItem::Print (os);
+    }
+
+  BlePriorityTag::BlePriorityTag ()
+    : m_priority (BleMacQueueItem::BULK),
+      m_deadline (Time::Max ())
+  {
+  }
+
+  BlePriorityTag::BlePriorityTag (BleMacQueueItem::Priority priority,
+      Time deadline)
+    : m_priority (priority),
+      m_deadline (deadline)
+  {
+  }
+
+  BleMacQueueItem::Priority
+    BlePriorityTag::GetPriority (void) const
+    {
+      return m_priority;
+    }
+
+  Time
+    BlePriorityTag::GetDeadline (void) const
+    {
+      return m_deadline;
+    }
+
+  TypeId
+    BlePriorityTag::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BlePriorityTag")
+        .SetParent<Tag> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BlePriorityTag> ()
+        ;
+      return tid;
+    }
+
+  TypeId
+    BlePriorityTag::GetInstanceTypeId (void) const
+    {
+      return GetTypeId ();
+    }
+
+  uint32_t
+    BlePriorityTag::GetSerializedSize (void) const
+    {
+      return 1+8;
+    }
+
+  void
+    BlePriorityTag::Serialize (TagBuffer i) const
+    {
+      i.WriteU8 (m_priority);
+      i.WriteU64 (m_deadline.GetTimeStep ());
+    }
+
+  void
+    BlePriorityTag::Deserialize (TagBuffer i)
+    {
+      m_priority = static_cast<BleMacQueueItem::Priority> (i.ReadU8 ());
+      m_deadline = TimeStep (i.ReadU64 ());
+    }
+
+  void
+    BlePriorityTag::Print (std::ostream &os) const
+    {
+      os << "Priority = " << (int) m_priority
+        << ", Deadline = " << m_deadline;
+    }
+
+}
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_MAC_QUEUE_ITEM_H
+#define BLE_MAC_QUEUE_ITEM_H
+
+// Includes
+#include <ns3/queue-item.h>
+#include <ns3/tag.h>
+#include <ns3/nstime.h>
+#include <ns3/ble-mac-header.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup ble
+ * \brief A packet waiting in a BleNetDevice or BleLinkManager queue,
+ * with its MAC header next to it
+ *
+ * The header is set when the packet is sent and completed by the link
+ * manager (SN, NESN, MD, LLID, length) when it becomes the current
+ * packet of a link. Keeping it parsed until then saves a deserialization
+ * at every step: it is only serialized into the packet for transmission
+ * and for the MacTx trace, when a sink is connected to it.
+ */
+  class BleMacQueueItem : public QueueItem
+  {
+    public:
+      /*
+       * Priority class of a packet. A link manager sends the queued
+       * packets of the lowest class first, within a class the one with
+       * the earliest deadline and then the oldest one.
+       */
+      enum Priority
+      {
+        CONTROL = 0,
+        ALARM = 1,
+        BULK = 2
+      };
+
+      // packet without the MAC header, BULK and without deadline
+      BleMacQueueItem (Ptr<Packet> packet, const BleMacHeader &header);
+      virtual ~BleMacQueueItem ();
+
+      const BleMacHeader &GetHeader (void) const;
+
+      Priority GetPriority (void) const;
+      void SetPriority (Priority priority);
+      /*
+       * Absolute time after which the packet is flushed from the queue
+       * of its link instead of being sent, Time::Max () if none
+       */
+      Time GetDeadline (void) const;
+      void SetDeadline (Time deadline);
+      bool IsExpired (void) const;
+
+      // Size of the packet with the MAC header
+      virtual uint32_t GetSize (void) const;
+
+      // A copy of the packet with the header serialized in front of it
+      Ptr<Packet> GetProtocolDataUnit (void) const;
+
+      virtual void Print (std::ostream &os) const;
+
+    private:
+      BleMacQueueItem ();
+      BleMacQueueItem (const BleMacQueueItem &);
+      BleMacQueueItem &operator = (const BleMacQueueItem &);
+
+      BleMacHeader m_header;
+      Priority m_priority;
+      Time m_deadline;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Priority class and deadline of a packet handed to a BleNetDevice
+ *
+ * Simulation metadata only, not serialized. The device removes it and
+ * keeps both in the BleMacQueueItem of the packet, see
+ * BleApplication::Priority and BleApplication::Deadline.
+ */
+  class BlePriorityTag : public Tag
+  {
+    public:
+      BlePriorityTag (void);
+      // deadline is absolute, Time::Max () if none
+      BlePriorityTag (BleMacQueueItem::Priority priority, Time deadline);
+
+      BleMacQueueItem::Priority GetPriority (void) const;
+      Time GetDeadline (void) const;
+
+      static TypeId GetTypeId (void);
+      virtual TypeId GetInstanceTypeId (void) const;
+      virtual uint32_t GetSerializedSize (void) const;
+      virtual void Serialize (TagBuffer i) const;
+      virtual void Deserialize (TagBuffer i);
+      virtual void Print (std::ostream &os) const;
+
+    private:
+      BleMacQueueItem::Priority m_priority;
+      Time m_deadline;
+  };
+
+}
+
+#endif /* BLE_MAC_QUEUE_ITEM_H */
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-mesh-header.h"
+#include <ns3/address-utils.h>
+#include <ns3/log.h>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (BleMeshHeader);
+NS_LOG_COMPONENT_DEFINE ("BleMeshHeader");
+
+BleMeshHeader::BleMeshHeader ()
+  : m_ttl (0),
+    m_seq (0),
+    m_src_addr ("00:00"),
+    m_dest_addr ("00:00")
+{
+}
+
+BleMeshHeader::~BleMeshHeader ()
+{
+}
+
+/*
+ * Getters And Setters
+ */
+uint8_t
+BleMeshHeader::GetTtl (void) const
+{
+  return m_ttl;
+}
+
+uint32_t
+BleMeshHeader::GetSeq (void) const
+{
+  return m_seq;
+}
+
+Mac16Address
+BleMeshHeader::GetSrcAddr (void) const
+{
+  return m_src_addr;
+}
+
+Mac16Address
+BleMeshHeader::GetDestAddr (void) const
+{
+  return m_dest_addr;
+}
+
+void
+BleMeshHeader::SetTtl (uint8_t ttl)
+{
+  NS_ASSERT (ttl <= MAX_TTL);
+  m_ttl = ttl;
+}
+
+void
+BleMeshHeader::SetSeq (uint32_t seq)
+{
+  NS_ASSERT (seq <= MAX_SEQ);
+  m_seq = seq;
+}
+
+void
+BleMeshHeader::SetSrcAddr (Mac16Address addr)
+{
+  m_src_addr = addr;
+}
+
+void
+BleMeshHeader::SetDestAddr (Mac16Address addr)
+{
+  m_dest_addr = addr;
+}
+
+/*
+ * Header functions
+ */
+std::string
+BleMeshHeader::GetName (void) const
+{
+  return "BleMeshHeader";
+}
+
+TypeId
+BleMeshHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BleMeshHeader")
+    .SetParent<Header> ()
+    .AddConstructor<BleMeshHeader> ()
+    ;
+  return tid;
+}
+
+TypeId
+BleMeshHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+BleMeshHeader::Print (std::ostream &os) const
+{
+  os << "TTL = " << (int) m_ttl
+    << ", SEQ = " << m_seq
+    << ", Source Addr = " << m_src_addr
+    << ", Dest Addr = " << m_dest_addr;
+}
+
+uint32_t
+BleMeshHeader::GetSerializedSize (void) const
+{
+  return 1+1+3+2+2;
+}
+
+void
+BleMeshHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (0); // IVI, NID
+  i.WriteU8 (m_ttl & MAX_TTL); // CTL = 0
+  i.WriteU8 ((m_seq >> 16) & 0xff);
+  i.WriteU8 ((m_seq >> 8) & 0xff);
+  i.WriteU8 (m_seq & 0xff);
+  WriteTo (i, m_src_addr);
+  WriteTo (i, m_dest_addr);
+}
+
+uint32_t
+BleMeshHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  i.ReadU8 ();
+  m_ttl = i.ReadU8 () & MAX_TTL;
+  m_seq = i.ReadU8 () << 16;
+  m_seq |= i.ReadU8 () << 8;
+  m_seq |= i.ReadU8 ();
+  ReadFrom (i, m_src_addr);
+  ReadFrom (i, m_dest_addr);
+  return i.GetDistanceFrom (start);
+}
+
+} //namespace ns3
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_MESH_HEADER_H
+#define BLE_MESH_HEADER_H
+
+#include <ns3/header.h>
+#include <ns3/mac16-address.h>
+
+namespace ns3 {
+
+/*
+ * \ingroup ble
+ * Represent the header of a BLE Mesh network PDU
+ *
+ * Same 9 byte layout as the Mesh network PDU: IVI/NID, CTL/TTL, SEQ (24
+ * bits), SRC and DST. There is no network security, so IVI, NID and CTL
+ * are always 0 and the NetMIC is not added.
+ * */
+class BleMeshHeader : public Header
+{
+
+public:
+
+  BleMeshHeader (void);
+
+  ~BleMeshHeader (void);
+
+  uint8_t GetTtl (void) const;
+  uint32_t GetSeq (void) const;
+  Mac16Address GetSrcAddr (void) const;
+  Mac16Address GetDestAddr (void) const;
+
+  void SetTtl (uint8_t ttl);
+  void SetSeq (uint32_t seq);
+  void SetSrcAddr (Mac16Address addr);
+  void SetDestAddr (Mac16Address addr);
+
+  std::string GetName (void) const;
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  void Print (std::ostream &os) const;
+  uint32_t GetSerializedSize (void) const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+
+  static const uint8_t MAX_TTL = 0x7f;
+  static const uint32_t MAX_SEQ = 0xffffff;
+
+private:
+  uint8_t m_ttl; // 7 bits, hops left; 0 and 1 are never relayed
+  uint32_t m_seq; // 24 bits, per source
+  Mac16Address m_src_addr; // Element address of the originator
+  Mac16Address m_dest_addr; // Unicast, group or FF:FF (all nodes)
+}; //BleMeshHeader
+
+}; // namespace ns-3
+
+#endif /* BLE_MESH_HEADER_H */
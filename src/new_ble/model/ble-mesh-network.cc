@@ -0,0 +1,365 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-mesh-network.h"
+#include <ns3/ble-net-device.h>
+#include <ns3/node.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <ns3/abort.h>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleMeshNetwork");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleMeshNetwork);
+
+  static uint16_t
+  ToU16 (Mac16Address address)
+  {
+    uint8_t buffer[2];
+    address.CopyTo (buffer);
+    return (buffer[0] << 8) | buffer[1];
+  }
+
+  // Group addresses start at C0:00, FF:FF is all nodes
+  static const uint16_t FIRST_GROUP_ADDRESS = 0xc000;
+
+  /***********************
+   * BleMeshMessageCache *
+   ***********************/
+
+  BleMeshMessageCache::BleMeshMessageCache ()
+    : m_capacity (0),
+      m_next (0)
+  {
+  }
+
+  void
+    BleMeshMessageCache::SetCapacity (uint32_t capacity)
+    {
+      NS_ASSERT (capacity > 0);
+      Clear ();
+      m_capacity = capacity;
+      m_ring.reserve (capacity);
+      m_keys.reserve (capacity);
+    }
+
+  uint32_t
+    BleMeshMessageCache::GetCapacity (void) const
+    {
+      return m_capacity;
+    }
+
+  uint32_t
+    BleMeshMessageCache::GetSize (void) const
+    {
+      return m_keys.size ();
+    }
+
+  uint64_t
+    BleMeshMessageCache::Key (Mac16Address src, uint32_t seq)
+    {
+      return ((uint64_t) ToU16 (src) << 24) | (seq & BleMeshHeader::MAX_SEQ);
+    }
+
+  bool
+    BleMeshMessageCache::Insert (Mac16Address src, uint32_t seq)
+    {
+      NS_ASSERT (m_capacity > 0);
+      uint64_t key = Key (src, seq);
+      if (!m_keys.insert (key).second)
+        return false;
+      if (m_ring.size () < m_capacity)
+        m_ring.push_back (key);
+      else
+      {
+        // Overwrite the oldest entry
+        m_keys.erase (m_ring[m_next]);
+        m_ring[m_next] = key;
+      }
+      m_next = (m_next + 1) % m_capacity;
+      return true;
+    }
+
+  bool
+    BleMeshMessageCache::Contains (Mac16Address src, uint32_t seq) const
+    {
+      return m_keys.count (Key (src, seq)) > 0;
+    }
+
+  void
+    BleMeshMessageCache::Clear (void)
+    {
+      m_ring.clear ();
+      m_keys.clear ();
+      m_next = 0;
+    }
+
+  /******************
+   * BleMeshNetwork *
+   ******************/
+
+  TypeId
+    BleMeshNetwork::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleMeshNetwork")
+        .SetParent<Object> ()
+        .AddConstructor<BleMeshNetwork> ()
+        .AddAttribute ("Relay",
+            "Relay the network PDUs of other nodes",
+            BooleanValue (true),
+            MakeBooleanAccessor (&BleMeshNetwork::m_relay),
+            MakeBooleanChecker ())
+        .AddAttribute ("DefaultTtl",
+            "TTL of the network PDUs originated by this node",
+            UintegerValue (7),
+            MakeUintegerAccessor (&BleMeshNetwork::m_defaultTtl),
+            MakeUintegerChecker<uint8_t> (0, BleMeshHeader::MAX_TTL))
+        .AddAttribute ("NetworkTransmitCount",
+            "Extra transmissions of an originated network PDU",
+            UintegerValue (0),
+            MakeUintegerAccessor (&BleMeshNetwork::m_networkTransmitCount),
+            MakeUintegerChecker<uint8_t> (0, 7))
+        .AddAttribute ("NetworkTransmitInterval",
+            "Time between the transmissions of an originated network PDU",
+            TimeValue (MilliSeconds (20)),
+            MakeTimeAccessor (&BleMeshNetwork::m_networkTransmitInterval),
+            MakeTimeChecker ())
+        .AddAttribute ("RelayRetransmitCount",
+            "Extra transmissions of a relayed network PDU",
+            UintegerValue (0),
+            MakeUintegerAccessor (&BleMeshNetwork::m_relayRetransmitCount),
+            MakeUintegerChecker<uint8_t> (0, 7))
+        .AddAttribute ("RelayRetransmitInterval",
+            "Time between the transmissions of a relayed network PDU",
+            TimeValue (MilliSeconds (20)),
+            MakeTimeAccessor (&BleMeshNetwork::m_relayRetransmitInterval),
+            MakeTimeChecker ())
+        .AddAttribute ("RelayJitter",
+            "Maximum random delay before a PDU is relayed, so neighbours "
+            "that receive the same PDU do not relay it at the same time",
+            TimeValue (MilliSeconds (10)),
+            MakeTimeAccessor (&BleMeshNetwork::m_relayJitter),
+            MakeTimeChecker ())
+        .AddAttribute ("CacheSize",
+            "Number of network PDUs kept in the message cache",
+            UintegerValue (64),
+            MakeUintegerAccessor (&BleMeshNetwork::SetCacheSize,
+              &BleMeshNetwork::GetCacheSize),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddTraceSource ("Tx",
+            "A network PDU originated by this node, with the mesh header",
+            MakeTraceSourceAccessor (&BleMeshNetwork::m_txTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Rx",
+            "A network PDU for this node, with the mesh header",
+            MakeTraceSourceAccessor (&BleMeshNetwork::m_rxTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Relay",
+            "A network PDU that will be relayed, with the decremented TTL",
+            MakeTraceSourceAccessor (&BleMeshNetwork::m_relayTrace),
+            "ns3::Packet::TracedCallback")
+        .AddTraceSource ("Duplicate",
+            "A network PDU dropped because it is in the message cache",
+            MakeTraceSourceAccessor (&BleMeshNetwork::m_duplicateTrace),
+            "ns3::Packet::TracedCallback")
+        ;
+      return tid;
+    }
+
+  BleMeshNetwork::BleMeshNetwork ()
+    : m_seq (0)
+  {
+    NS_LOG_FUNCTION (this);
+    m_relayDelay = CreateObject<UniformRandomVariable> ();
+    m_cache.SetCapacity (64);
+  }
+
+  BleMeshNetwork::~BleMeshNetwork ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleMeshNetwork::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_device = 0;
+      m_relayDelay = 0;
+      m_receiveCallback = MakeNullCallback<void, Ptr<Packet>,
+                        const BleMeshHeader &> ();
+      m_cache.Clear ();
+      Object::DoDispose ();
+    }
+
+  void
+    BleMeshNetwork::SetNetDevice (Ptr<BleNetDevice> device)
+    {
+      NS_LOG_FUNCTION (this << device);
+      NS_ASSERT_MSG (device->GetNode (), "Add the device to a node first");
+      m_device = device;
+      device->GetNode ()->RegisterProtocolHandler (
+          MakeCallback (&BleMeshNetwork::Receive, this), PROT_NUMBER, device);
+    }
+
+  Ptr<BleNetDevice>
+    BleMeshNetwork::GetNetDevice (void) const
+    {
+      return m_device;
+    }
+
+  Mac16Address
+    BleMeshNetwork::GetAddress (void) const
+    {
+      NS_ASSERT (m_device);
+      return m_device->GetAddress16 ();
+    }
+
+  void
+    BleMeshNetwork::SetReceiveCallback (ReceiveCallback callback)
+    {
+      m_receiveCallback = callback;
+    }
+
+  void
+    BleMeshNetwork::SetCacheSize (uint32_t size)
+    {
+      m_cache.SetCapacity (size);
+    }
+
+  uint32_t
+    BleMeshNetwork::GetCacheSize (void) const
+    {
+      return m_cache.GetCapacity ();
+    }
+
+  const BleMeshMessageCache &
+    BleMeshNetwork::GetMessageCache (void) const
+    {
+      return m_cache;
+    }
+
+  int64_t
+    BleMeshNetwork::AssignStreams (int64_t stream)
+    {
+      m_relayDelay->SetStream (stream);
+      return 1;
+    }
+
+  bool
+    BleMeshNetwork::Send (Ptr<Packet> packet, Mac16Address dest)
+    {
+      return Send (packet, dest, m_defaultTtl);
+    }
+
+  bool
+    BleMeshNetwork::Send (Ptr<Packet> packet, Mac16Address dest, uint8_t ttl)
+    {
+      NS_LOG_FUNCTION (this << packet << dest << (int) ttl);
+      NS_ASSERT (m_device);
+      // TTL 1 is prohibited for originated PDUs
+      NS_ASSERT_MSG (ttl != 1 && ttl <= BleMeshHeader::MAX_TTL,
+          "Invalid TTL " << (int) ttl);
+      NS_ABORT_MSG_IF (m_seq > BleMeshHeader::MAX_SEQ,
+          "Sequence numbers of " << GetAddress () << " exhausted");
+
+      BleMeshHeader header;
+      header.SetTtl (ttl);
+      header.SetSeq (m_seq++);
+      header.SetSrcAddr (GetAddress ());
+      header.SetDestAddr (dest);
+      packet->AddHeader (header);
+      // Do not relay our own PDU when a neighbour relays it back
+      m_cache.Insert (header.GetSrcAddr (), header.GetSeq ());
+      m_txTrace (packet);
+      Transmit (packet, m_networkTransmitCount, m_networkTransmitInterval);
+      return true;
+    }
+
+  void
+    BleMeshNetwork::Transmit (Ptr<const Packet> pdu, uint8_t nbLeft,
+        Time interval)
+    {
+      NS_LOG_FUNCTION (this << pdu << (int) nbLeft);
+      if (!m_device)
+        return;
+      // The device adds its MAC header, so every transmission is a copy
+      m_device->Send (pdu->Copy (), m_device->GetBroadcast (), PROT_NUMBER);
+      if (nbLeft > 0)
+        Simulator::Schedule (interval, &BleMeshNetwork::Transmit, this, pdu,
+            nbLeft - 1, interval);
+    }
+
+  bool
+    BleMeshNetwork::IsForMe (Mac16Address dest) const
+    {
+      return dest == GetAddress () || ToU16 (dest) >= FIRST_GROUP_ADDRESS;
+    }
+
+  void
+    BleMeshNetwork::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+        uint16_t protocol, const Address &from, const Address &to,
+        NetDevice::PacketType packetType)
+    {
+      NS_LOG_FUNCTION (this << packet << from);
+      BleMeshHeader header;
+      if (packet->GetSize () < header.GetSerializedSize ())
+        return;
+      packet->PeekHeader (header);
+      if (!m_cache.Insert (header.GetSrcAddr (), header.GetSeq ()))
+      {
+        m_duplicateTrace (packet);
+        return;
+      }
+
+      bool forMe = IsForMe (header.GetDestAddr ());
+      if (forMe)
+      {
+        m_rxTrace (packet);
+        if (!m_receiveCallback.IsNull ())
+        {
+          Ptr<Packet> payload = packet->Copy ();
+          payload->RemoveHeader (header);
+          m_receiveCallback (payload, header);
+        }
+      }
+
+      // Unicast PDUs for this node end here, group PDUs are relayed too
+      if (m_relay && header.GetTtl () >= 2
+          && header.GetDestAddr () != GetAddress ())
+      {
+        Ptr<Packet> relayed = packet->Copy ();
+        relayed->RemoveHeader (header);
+        header.SetTtl (header.GetTtl () - 1);
+        relayed->AddHeader (header);
+        m_relayTrace (relayed);
+        Time delay = m_relayJitter.IsStrictlyPositive ()
+          ? Seconds (m_relayDelay->GetValue (0, m_relayJitter.GetSeconds ()))
+          : Time (0);
+        Simulator::Schedule (delay, &BleMeshNetwork::Transmit, this,
+            relayed, m_relayRetransmitCount, m_relayRetransmitInterval);
+      }
+    }
+
+}
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_MESH_NETWORK_H
+#define BLE_MESH_NETWORK_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <ns3/nstime.h>
+#include <ns3/callback.h>
+#include <ns3/net-device.h>
+#include <ns3/mac16-address.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/traced-callback.h>
+#include "ble-mesh-header.h"
+#include <unordered_set>
+#include <vector>
+
+namespace ns3 {
+
+  // Classes
+
+  class BleNetDevice;
+
+/**
+ * \ingroup ble
+ * \brief Network message cache of a mesh node
+ *
+ * Remembers the (source, sequence number) of the last capacity network
+ * PDUs. The entries form a ring, so the oldest entry is overwritten when
+ * the cache is full; a hash set of the same entries gives O(1) lookups.
+ */
+  class BleMeshMessageCache
+  {
+    public:
+      BleMeshMessageCache ();
+
+      void SetCapacity (uint32_t capacity);
+      uint32_t GetCapacity (void) const;
+      uint32_t GetSize (void) const;
+
+      // Add the PDU, false if it was already in the cache
+      bool Insert (Mac16Address src, uint32_t seq);
+      bool Contains (Mac16Address src, uint32_t seq) const;
+      void Clear (void);
+
+    private:
+      static uint64_t Key (Mac16Address src, uint32_t seq);
+
+      uint32_t m_capacity;
+      std::vector<uint64_t> m_ring;
+      uint32_t m_next; // Ring position of the next insertion
+      std::unordered_set<uint64_t> m_keys;
+  };
+
+/**
+ * \ingroup ble
+ * \brief BLE Mesh managed flooding bearer
+ *
+ * Sends network PDUs as broadcast packets on the broadcast link of the
+ * device (see BleHelper::CreateBroadcastLink) and receives them through
+ * a protocol handler on the node. Every PDU is transmitted
+ * NetworkTransmitCount + 1 times. Relay nodes forward every new PDU with
+ * a TTL of 2 or more that is not addressed to themselves, with the TTL
+ * decremented, RelayRetransmitCount + 1 times after a random delay of at
+ * most RelayJitter. The message cache drops PDUs that were seen before.
+ *
+ * PDUs for the node's own address, a group address (C0:00 and above) or
+ * FF:FF are passed to the receive callback without the mesh header.
+ */
+  class BleMeshNetwork : public Object
+  {
+    public:
+      // Protocol number of the MAC header, the AD type of Mesh Message
+      static const uint16_t PROT_NUMBER = 0x2a;
+
+      typedef Callback<void, Ptr<Packet>, const BleMeshHeader &>
+        ReceiveCallback;
+
+      BleMeshNetwork ();
+      ~BleMeshNetwork ();
+
+      static TypeId GetTypeId (void);
+
+      // Bind to the device and register the protocol handler on its node
+      void SetNetDevice (Ptr<BleNetDevice> device);
+      Ptr<BleNetDevice> GetNetDevice (void) const;
+      Mac16Address GetAddress (void) const;
+
+      // Originate a network PDU with the default TTL
+      bool Send (Ptr<Packet> packet, Mac16Address dest);
+      bool Send (Ptr<Packet> packet, Mac16Address dest, uint8_t ttl);
+
+      void SetReceiveCallback (ReceiveCallback callback);
+
+      void SetCacheSize (uint32_t size);
+      uint32_t GetCacheSize (void) const;
+      const BleMeshMessageCache &GetMessageCache (void) const;
+
+      int64_t AssignStreams (int64_t stream);
+
+    protected:
+      virtual void DoDispose (void);
+
+    private:
+      void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+          uint16_t protocol, const Address &from, const Address &to,
+          NetDevice::PacketType packetType);
+      // Send the PDU now and nbLeft more times, every interval
+      void Transmit (Ptr<const Packet> pdu, uint8_t nbLeft, Time interval);
+      bool IsForMe (Mac16Address dest) const;
+
+      Ptr<BleNetDevice> m_device;
+      ReceiveCallback m_receiveCallback;
+      BleMeshMessageCache m_cache;
+      uint32_t m_seq; // Next sequence number
+      Ptr<UniformRandomVariable> m_relayDelay;
+
+      bool m_relay;
+      uint8_t m_defaultTtl;
+      uint8_t m_networkTransmitCount;
+      Time m_networkTransmitInterval;
+      uint8_t m_relayRetransmitCount;
+      Time m_relayRetransmitInterval;
+      Time m_relayJitter;
+
+      TracedCallback<Ptr<const Packet> > m_txTrace; // PDU originated
+      TracedCallback<Ptr<const Packet> > m_rxTrace; // PDU for this node
+      TracedCallback<Ptr<const Packet> > m_relayTrace; // PDU to be relayed
+      TracedCallback<Ptr<const Packet> > m_duplicateTrace; // PDU in cache
+  };
+
+}
+
+#endif /* BLE_MESH_NETWORK_H */
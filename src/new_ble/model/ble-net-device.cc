@@ -26,7 +26,8 @@
 #include "ns3/ble-phy.h"
 #include "ns3/log.h"
 #include "ns3/queue.h"
-#include "ns3/drop-tail-queue.h"
+#include "ns3/ble-ring-queue.h"
+#include "ns3/ble-link-channel.h"
 #include "ns3/queue-item.h"
 #include "ns3/simulator.h"
 #include "ns3/enum.h"
@@ -38,6 +39,7 @@
 #include "ns3/generic-phy.h"
 
 #include "ble-mac-header.h"
+#include "ble-mac-queue-item.h"
 #include "ble-bb-manager.h"
 #include "ble-link-manager.h"
 #include "ble-link-controller.h"
@@ -69,6 +71,14 @@ namespace ns3 {
 						MakeUintegerAccessor (&BleNetDevice::SetMtu,
 							&BleNetDevice::GetMtu),
 						MakeUintegerChecker<uint16_t> (1,65535))
+				.AddAttribute ("NeedsArp",
+						"Whether the upper layer resolves link addresses. "
+						"Without it IP sends every packet to FF:FF; "
+						"BleHelper::InstallSixLowPan enables it so unicast "
+						"IPv6 packets use the connection to the neighbour.",
+						BooleanValue (false),
+						MakeBooleanAccessor (&BleNetDevice::m_needsArp),
+						MakeBooleanChecker ())
 				.AddAttribute ("Phy", "The PHY layer attached to this device.",
 						PointerValue (),
 						MakePointerAccessor (&BleNetDevice::GetPhy,
@@ -126,6 +136,7 @@ namespace ns3 {
 	{
 		NS_LOG_FUNCTION (this);
 	    m_node = 0;
+    m_needsArp = false;
 
     Ptr<BleNetDevice> nd_pointer = Ptr<BleNetDevice>(this);
 
@@ -139,10 +150,7 @@ namespace ns3 {
     this->SetLinkController(CreateObject<BleLinkController> ());
     this->GetLinkController()->SetNetDevice(nd_pointer);
 
-    Ptr<DropTailQueue<QueueItem>> packetQueue = 
-      Create<DropTailQueue<QueueItem>> ();
-    packetQueue->SetMaxSize( QueueSize (QUEUE_SIZE_PACKETS));
-    this->SetQueue(packetQueue);
+    this->SetQueue(CreateObject<BleRingQueue> ());
 
     //NS_LOG_INFO ("BleNetDevice constructor done");
 	}
@@ -207,7 +215,7 @@ namespace ns3 {
 
 
 	void
-		BleNetDevice::SetQueue (Ptr<DropTailQueue<QueueItem>> q)
+		BleNetDevice::SetQueue (Ptr<BleRingQueue> q)
 		{
 			NS_LOG_FUNCTION (this);
 			NS_LOG_FUNCTION (q);
@@ -226,14 +234,14 @@ namespace ns3 {
 	Address
 		BleNetDevice::GetAddress (void) const
 		{
-			NS_LOG_FUNCTION (this);
+			BLE_LOG_FUNCTION (this);
 			return m_address;
 		}
 
 	Mac16Address
 		BleNetDevice::GetAddress16 (void) const
 		{
-			NS_LOG_FUNCTION (this);
+			BLE_LOG_FUNCTION (this);
 			return m_address;
 		}
 
@@ -250,7 +258,7 @@ namespace ns3 {
 		BleNetDevice::GetBroadcast (void) const
 		{
 			NS_LOG_FUNCTION (this);
-			return Mac16Address ("FF:FF");
+			return BleMacHeader::GetBroadcastAddress ();
 		}
 
     // Returns tur if this device supports multicast
@@ -272,7 +280,7 @@ namespace ns3 {
 		BleNetDevice::GetMulticast (Ipv4Address addr) const
 		{
 			NS_LOG_FUNCTION (addr);
-			Mac16Address ad = Mac16Address ("FF:FF");
+			Mac16Address ad = BleMacHeader::GetBroadcastAddress ();
 			return ad;
 		}
 
@@ -280,7 +288,7 @@ namespace ns3 {
 	Address BleNetDevice::GetMulticast (Ipv6Address addr) const
 	{
 		NS_LOG_FUNCTION (addr);
-	    Mac16Address ad = Mac16Address ("FF:FF");
+	    Mac16Address ad = BleMacHeader::GetBroadcastAddress ();
 		return ad;
 	}
 
@@ -326,7 +334,7 @@ namespace ns3 {
 	Ptr<BlePhy>
 		BleNetDevice::GetPhy () const
 		{
-			NS_LOG_FUNCTION (this);
+			BLE_LOG_FUNCTION (this);
 			return m_phy;
 		}
 
@@ -347,6 +355,8 @@ namespace ns3 {
 		BleNetDevice::GetChannel (void) const
 		{
 			NS_LOG_FUNCTION (this);
+            if (this->GetPhy()->GetLinkChannel() != 0)
+              return this->GetPhy()->GetLinkChannel();
             return this->GetPhy()->GetChannel();
 		}
 
@@ -356,7 +366,7 @@ namespace ns3 {
 		BleNetDevice::NeedsArp (void) const
 		{
 			NS_LOG_FUNCTION (this);
-			return false;
+			return m_needsArp;
 		}
 
 	bool
@@ -447,7 +457,6 @@ namespace ns3 {
       NS_LOG_INFO (" Destination address for current packet (nd): " << dest16);
       header.SetDestAddr(dest16);
       header.SetProtocol(protocolNumber);
-      packet->AddHeader (header);
 			
       bool sendOk = true;
 			// If the device is idle, transmission starts immediately. Otherwise,
@@ -458,10 +467,17 @@ namespace ns3 {
 	  //确保队列和数据包非空
       NS_ASSERT(m_queue !=0);
       NS_ASSERT(packet !=0);
-      Ptr<QueueItem> item = Create<QueueItem> (packet);
+      // The header stays parsed next to the packet until it is sent
+      Ptr<BleMacQueueItem> item = Create<BleMacQueueItem> (packet, header);
       NS_ASSERT(item !=0);
-      NS_LOG_INFO ("Max size of queue = " << m_queue->GetMaxSize());
-      NS_LOG_INFO ("Current size of queue = " << m_queue->GetCurrentSize());
+      BlePriorityTag priority;
+      if (packet->RemovePacketTag (priority))
+        {
+          item->SetPriority (priority.GetPriority ());
+          item->SetDeadline (priority.GetDeadline ());
+        }
+      NS_LOG_INFO ("Max size of queue = " << m_queue->GetCapacity());
+      NS_LOG_INFO ("Current size of queue = " << m_queue->GetNPackets());
       NS_LOG_INFO ("Size of packet item = " << item->GetSize());
      // std::cout << std::endl;
      // packet->Print(std::cout);
@@ -472,10 +488,11 @@ namespace ns3 {
 	 // 修正：检查队列是否为空，使用 IsEmpty()
 		Ptr<BleLinkManager> linkManager = this->GetBBManager()->GetActiveLinkManager();
 		//bool wasQueueEmpty = m_queue->IsEmpty(); // 记录入队前队列状态
-		if (m_queue->Enqueue(Create<QueueItem>(packet)) == false)
+		if (m_queue->Enqueue(item) == false)
 		{
 			NS_LOG_LOGIC("Enqueueing new packet failed");
-			m_macTxDropTrace(packet);
+			if (m_macTxDropTrace.IsConnected ())
+				m_macTxDropTrace(item->GetProtocolDataUnit ());
 			sendOk = false;
 		}
 	
@@ -485,8 +502,9 @@ namespace ns3 {
 			NS_LOG_INFO("Notifying LinkManager of new packet enqueue");
 			NS_LOG_INFO(linkManager);
 			linkManager->ChangePeerHasMoreData(true); // 设置MD标志
-			m_macTxTrace(packet);
 		}
+		if (sendOk && m_macTxTrace.IsConnected ())
+			m_macTxTrace(item->GetProtocolDataUnit ());
 
       /*if (m_queue->Enqueue (Create<QueueItem> (packet)) == false)
       {
@@ -546,10 +564,20 @@ namespace ns3 {
       this->m_linkController = linkController;
     }
 
-  Ptr<DropTailQueue<QueueItem>>
+  int64_t
+    BleNetDevice::AssignStreams (int64_t stream)
+    {
+      NS_LOG_FUNCTION (this << stream);
+      int64_t currentStream = stream;
+      currentStream += m_phy->AssignStreams (currentStream);
+      currentStream += m_bbManager->AssignStreams (currentStream);
+      return (currentStream - stream);
+    }
+
+  Ptr<BleRingQueue>
   BleNetDevice::GetQueue (void)
   {
-    NS_LOG_FUNCTION_NOARGS ();
+    BLE_LOG_FUNCTION (this);
     return m_queue;
   }
 
@@ -581,13 +609,12 @@ namespace ns3 {
 		}
 
 	void
-		BleNetDevice::NotifyReceptionEndOk (Ptr<Packet> packet)
+		BleNetDevice::NotifyReceptionEndOk (Ptr<Packet> packet,
+            const BleMacHeader &header)
 		{
 			NS_LOG_FUNCTION (this << packet);
 
             NS_ASSERT(packet != 0);
-			BleMacHeader header;
-			packet->PeekHeader (header);
 			NS_LOG_LOGIC ("packet : Source --> " 
                 << header.GetSrcAddr () << " Dest --> " 
                 << header.GetDestAddr()
@@ -616,8 +643,8 @@ namespace ns3 {
             const Address src_addr = Address(header.GetSrcAddr());
             const Address dest_addr = Address(header.GetDestAddr());
 			NS_LOG_LOGIC ("packet size = " << packet_copy1->GetSize() );
-			BleMacHeader rmheader;
-			packet_copy1->RemoveHeader (rmheader);
+			// Already parsed by the link controller
+			packet_copy1->RemoveAtStart (header.GetSerializedSize ());
             Ptr<const Packet> packet_copy = packet_copy1->Copy();
 
             if (packetType == PACKET_BROADCAST )
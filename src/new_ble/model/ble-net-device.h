@@ -33,6 +33,7 @@
 #include <ns3/callback.h>
 #include <ns3/packet.h>
 #include <ns3/traced-callback.h>
+#include <ns3/ble-traced-callback.h>
 #include <ns3/nstime.h>
 #include <ns3/ptr.h>
 #include <ns3/mac16-address.h>
@@ -46,7 +47,7 @@
 
 namespace ns3 {
 
-template <typename Item> class DropTailQueue;
+class BleRingQueue;
 class BlePhy;
 class SpectrumChannel;
 class Channel;
@@ -83,7 +84,7 @@ public:
    * \param queue the wanted queue structure
    */
   //设置设备使用的发送队列
-  virtual void SetQueue (Ptr<DropTailQueue<QueueItem>> queue);
+  virtual void SetQueue (Ptr<BleRingQueue> queue);
 
 
   /**
@@ -111,10 +112,10 @@ public:
    * Notify the MAC that the PHY finished a reception successfully
    *
    * \param p the received packet
-	 * \param rssi the received signal strength of the received packet
+   * \param header the MAC header of p, parsed by the link controller
    */
   //通知接收成功
-  void NotifyReceptionEndOk (Ptr<Packet> p);
+  void NotifyReceptionEndOk (Ptr<Packet> p, const BleMacHeader &header);
 
   //通知传输窗口被跳过
   void NotifyTXWindowSkipped ();
@@ -207,7 +208,7 @@ public:
   Mac16Address GetAddress16 (void) const;
 
  
-  Ptr<DropTailQueue<QueueItem>> GetQueue (void);
+  Ptr<BleRingQueue> GetQueue (void);
   Ptr<BleBBManager> GetBBManager();
   void SetBBManager(Ptr<BleBBManager> bbManager);
 
@@ -217,9 +218,18 @@ public:
   Ptr<BleLinkController> GetLinkController();
   void SetLinkController(Ptr<BleLinkController> linkController);
 
+  /**
+   * Assign fixed random variable streams to the PHY and to the link
+   * setup of the BBManager of this device.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
 protected:
 
-  Ptr<DropTailQueue<QueueItem>> m_queue; //!< queue for packets to send 用于存储待发送的数据包，采用丢尾队列（DropTailQueue）策略
+  Ptr<BleRingQueue> m_queue; //!< queue for packets to send 用于存储待发送的数据包
   Ptr<Node>    m_node; //!< node of this netdevice 表示该设备所属的 ns-3 节点
   Mac16Address m_address; //!< address of this device 表示设备的 MAC 地址，BLE 使用 16 位地址
   Ipv4Address m_ip_address; //!< address of this device 设备的 IPv4 地址
@@ -227,6 +237,7 @@ protected:
   uint32_t m_ifIndex; //!< indexnumber of the interface 接口索引
   uint32_t m_mtu; //!< maximal amount of bytes to transmit
   bool m_linkUp; //!< tells if the link is up 表示链路是否可用
+  bool m_needsArp; //!< link addresses are resolved by the upper layer
   
   Ptr<BlePhy> m_phy; //!< physical layer of this device 关联的物理层对象
 
@@ -239,8 +250,9 @@ protected:
     m_macRxErrorTrace：接收错误。
     m_macTXWindowSkipped：传输窗口跳过。
   */
-  TracedCallback<Ptr<const Packet> > m_macTxTrace;
-  TracedCallback<Ptr<const Packet> > m_macTxDropTrace;
+  // The PDU of a queued packet is only built for connected sinks
+  BleTracedCallback<Ptr<const Packet> > m_macTxTrace;
+  BleTracedCallback<Ptr<const Packet> > m_macTxDropTrace;
   TracedCallback<Ptr<const Packet> > m_macPromiscRxTrace;
   TracedCallback<Ptr<const Packet> > m_macRxTrace;
   TracedCallback<Ptr<const Packet>, 
@@ -26,6 +26,8 @@
 #include "ble-spectrum-signal-parameters.h"
 #include <ns3/ble-net-device.h>
 #include <ns3/ble-bb-manager.h>
+#include <ns3/ble-link-channel.h>
+#include <ns3/constants.h>
 #include <ns3/object.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/net-device.h>
@@ -39,6 +41,11 @@
 #include <ns3/event-id.h>
 #include <ns3/random-variable-stream.h>
 #include <ns3/double.h>
+#include <ns3/packet.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <algorithm>
+#include <cmath>
 
 
 namespace ns3 {
@@ -54,6 +61,82 @@ namespace ns3 {
 			static TypeId tid = TypeId ("ns3::BlePhy")
 				.SetParent<Object> ()
 				.AddConstructor<BlePhy> ()
+				.AddAttribute ("DataRate",
+						"Bit rate (bps) used for the air time of a packet. "
+						"The default of 4 Mbps lets full IPv4 headers fit in "
+						"a connection event; use 1 Mbps (LE 1M) for realistic "
+						"air time, e.g. with 6LoWPAN header compression.",
+						DoubleValue (1000000 * 4),
+						MakeDoubleAccessor (&BlePhy::m_bitrate),
+						MakeDoubleChecker<double> (0.0))
+				// Defaults from the C/I requirements of the core
+				// specification: co-channel 21 dB, 2 MHz -17 dB and
+				// 3 MHz or more -27 dB
+				.AddAttribute ("AdjacentChannelSelectivity1",
+						"Rejection (dB) of interference 2 MHz away from the "
+						"receive channel, relative to co-channel interference",
+						DoubleValue (38),
+						MakeDoubleAccessor (&BlePhy::SetAdjacentChannelSelectivity1,
+							&BlePhy::GetAdjacentChannelSelectivity1),
+						MakeDoubleChecker<double> ())
+				.AddAttribute ("AdjacentChannelSelectivity2",
+						"Rejection (dB) of interference 4 MHz away",
+						DoubleValue (48),
+						MakeDoubleAccessor (&BlePhy::SetAdjacentChannelSelectivity2,
+							&BlePhy::GetAdjacentChannelSelectivity2),
+						MakeDoubleChecker<double> ())
+				.AddAttribute ("AdjacentChannelSelectivity3",
+						"Rejection (dB) of interference 6 MHz away, "
+						"interference further away is ignored",
+						DoubleValue (48),
+						MakeDoubleAccessor (&BlePhy::SetAdjacentChannelSelectivity3,
+							&BlePhy::GetAdjacentChannelSelectivity3),
+						MakeDoubleChecker<double> ())
+				.AddAttribute ("RxSensitivity",
+						"Power (dBm) a packet on the receive channel needs to "
+						"be received, weaker packets are only interference",
+						DoubleValue (-110),
+						MakeDoubleAccessor (&BlePhy::m_rxSensitivityDbm),
+						MakeDoubleChecker<double> ())
+				.AddAttribute ("InterferenceFloor",
+						"Signals of which no band reaches this power (dBm) "
+						"are ignored, also as interference. The default is "
+						"the RxSensitivity: signals too weak to be received "
+						"cost no work",
+						DoubleValue (-110),
+						MakeDoubleAccessor (&BlePhy::m_interferenceFloorDbm),
+						MakeDoubleChecker<double> ())
+				.AddAttribute ("CaptureThreshold",
+						"Power (dB) a packet needs above the one being "
+						"received to take over the receiver",
+						DoubleValue (11),
+						MakeDoubleAccessor (&BlePhy::m_captureThresholdDb),
+						MakeDoubleChecker<double> (0.0))
+				.AddAttribute ("PreambleBits",
+						"Bits of preamble and access address that have to "
+						"be received without error to synchronise",
+						UintegerValue (40),
+						MakeUintegerAccessor (&BlePhy::m_preambleBits),
+						MakeUintegerChecker<uint32_t> ())
+				.AddAttribute ("SleepBetweenEvents",
+						"Turn the radio off while the device has no active "
+						"link manager: the channels do not deliver the "
+						"signals that start meanwhile. The BLE packets are "
+						"ignored by a radio that does not listen anyway, "
+						"the signals of other technologies (AddInterferers) "
+						"are missed",
+						BooleanValue (false),
+						MakeBooleanAccessor (&BlePhy::m_sleepBetweenEvents),
+						MakeBooleanChecker ())
+				.AddTraceSource ("PhyTxBegin",
+						"A packet starts to be transmitted on the channel",
+						MakeTraceSourceAccessor (&BlePhy::m_phyTxBeginTrace),
+						"ns3::BlePhy::TxTracedCallback")
+				.AddTraceSource ("PhyRxEnd",
+						"A packet has been received, with its channel, "
+						"RSSI (dBm) and whether it contains bit errors",
+						MakeTraceSourceAccessor (&BlePhy::m_phyRxEndTrace),
+						"ns3::BlePhy::RxTracedCallback")
 				;
 			return tid;
 		}
@@ -68,11 +151,30 @@ namespace ns3 {
 		m_antenna = 0;
 		m_bitrate = 1000000 * 4; 
                 // times 4 to allow for larger packets 
-                // (necessary for ipv4 routing protocols)  
+                // (necessary for ipv4 routing protocols), see DataRate
 		m_mobility = 0;
 		m_channelIndex = 20;
+		m_acs1Db = 38;
+		m_acs2Db = 48;
+		m_acs3Db = 48;
+		m_rxSensitivityDbm = -110;
+		m_interferenceFloorDbm = -110;
+		m_captureThresholdDb = 11;
+		m_preambleBits = 40;
+		m_sensitivityDrops = 0;
+		m_preambleMisses = 0;
+		m_captures = 0;
 		m_receiver = false;
 		m_channel = 0;
+		m_linkChannel = 0;
+		m_linkIndex = 0;
+		std::fill (m_linkPower, m_linkPower + NB_BANDS, 0.0);
+		std::fill (m_linkCoupling, m_linkCoupling + 4, 0.0);
+		m_linkRx.packet = 0;
+		m_sleepBetweenEvents = false;
+		m_asleep = false;
+		m_sleepPending = false;
+		m_rxSignals = 0;
 		m_netDevice = 0;
 		m_random=CreateObject<UniformRandomVariable> ();
 		m_channelSelector=CreateObject<UniformRandomVariable> ();
@@ -92,6 +194,7 @@ namespace ns3 {
 		m_netDevice = 0;
 		m_mobility = 0;
 		m_channel = 0;
+		m_linkChannel = 0;
 		m_antenna = 0;
 		m_txPsd = 0;
 	}
@@ -106,14 +209,14 @@ namespace ns3 {
 	Ptr<NetDevice>
 		BlePhy::GetDevice () const
 		{
-			NS_LOG_FUNCTION (this);
+			BLE_LOG_FUNCTION (this);
 			return m_netDevice;
 		}
 
     Ptr<BleBBManager>
       BlePhy::GetBBManager ()
       {
-        NS_LOG_FUNCTION (this);
+        BLE_LOG_FUNCTION (this);
         Ptr<BleNetDevice> nd = DynamicCast<BleNetDevice> (this->GetDevice());
         return nd->GetBBManager ();
       }
@@ -134,8 +237,15 @@ namespace ns3 {
 		BlePhy::SetChannel (Ptr<SpectrumChannel> c)
 		{
 			NS_LOG_FUNCTION (this);
-			c->AddRx(this);
-			m_channel = c;
+			// Every hop sets the channel again; the channel indexes share
+			// one SpectrumChannel, so the PHY is only added the first time
+			if (c != m_channel)
+			{
+				// A sleeping PHY is added when it wakes up
+				if (!m_asleep)
+					c->AddRx(this);
+				m_channel = c;
+			}
 		}
 
     Ptr<SpectrumChannel>
@@ -144,6 +254,74 @@ namespace ns3 {
           return m_channel;
         }
 
+	void
+		BlePhy::SetLinkChannel (Ptr<BleLinkChannel> c)
+		{
+			NS_LOG_FUNCTION (this);
+			m_linkChannel = c;
+			m_linkIndex = c->Add (this);
+			UpdateLinkCoupling ();
+		}
+
+	void
+		BlePhy::UpdateLinkCoupling (void)
+		{
+			// The centre band of the transmit spectrum (see
+			// SetTxPowerSpectralDensity), rejected by the adjacent channel
+			// selectivity on the channels next to it, as in StartRx
+			double acsDb[] = {0, m_acs1Db, m_acs2Db, m_acs3Db};
+			for (int offset = 0; offset <= 3; offset++)
+			{
+				m_linkCoupling[offset] = 0.7737
+                  * std::pow (10.0, -acsDb[offset]/10);
+			}
+		}
+
+	void
+		BlePhy::SetAdjacentChannelSelectivity1 (double db)
+		{
+			m_acs1Db = db;
+			UpdateLinkCoupling ();
+		}
+
+	void
+		BlePhy::SetAdjacentChannelSelectivity2 (double db)
+		{
+			m_acs2Db = db;
+			UpdateLinkCoupling ();
+		}
+
+	void
+		BlePhy::SetAdjacentChannelSelectivity3 (double db)
+		{
+			m_acs3Db = db;
+			UpdateLinkCoupling ();
+		}
+
+	double
+		BlePhy::GetAdjacentChannelSelectivity1 (void) const
+		{
+			return m_acs1Db;
+		}
+
+	double
+		BlePhy::GetAdjacentChannelSelectivity2 (void) const
+		{
+			return m_acs2Db;
+		}
+
+	double
+		BlePhy::GetAdjacentChannelSelectivity3 (void) const
+		{
+			return m_acs3Db;
+		}
+
+	Ptr<BleLinkChannel>
+		BlePhy::GetLinkChannel () const
+		{
+			return m_linkChannel;
+		}
+
 //功率分配（0.7737, 0.0787等）模拟GFSK调制的频谱形状，中心集中，边带衰减
 	void
 		BlePhy::InitTxPowerSpectralDensity (uint8_t channeloffset, double power)
@@ -261,22 +439,32 @@ namespace ns3 {
 			if(this->GetState() == BlePhy::State::TX)
 			{
               this->ChangeState(BlePhy::State::TX_BUSY);
-				Ptr<BleSpectrumSignalParameters> txParams = 
-                  Create<BleSpectrumSignalParameters> ();
 				////计算传输时长：duration = Seconds((packet->GetSize()-1)*8 / m_bitrate)。
 				//包大小（字节）减1（可能排除头或CRC），转换为比特（*8），除以比特率（m_bitrate=4Mbps）
-				txParams->duration = Seconds((packet->GetSize()-1)*8/m_bitrate);
-				txParams->packet = packet;
-				txParams->txPhy = GetObject<SpectrumPhy> ();
-                SetTxPowerSpectralDensity(m_channelIndex,m_power);
-				txParams->psd = m_txPsd;
-				txParams->txAntenna = m_antenna;
-				txParams->SetChannel(m_channelIndex);
-                NS_ASSERT(m_channel != 0);
-				m_channel->StartTx (txParams);
-				Simulator::Schedule(txParams->duration,
+				Time duration = GetTxDuration (packet->GetSize ());
+				if (m_linkChannel != 0)
+				{
+					m_linkChannel->StartTx (m_linkIndex, packet,
+                        m_channelIndex, m_power, duration);
+				}
+				else
+				{
+					Ptr<BleSpectrumSignalParameters> txParams = 
+                      Create<BleSpectrumSignalParameters> ();
+					txParams->duration = duration;
+					txParams->packet = packet;
+					txParams->txPhy = GetObject<SpectrumPhy> ();
+					SetTxPowerSpectralDensity(m_channelIndex,m_power);
+					txParams->psd = m_txPsd;
+					txParams->txAntenna = m_antenna;
+					txParams->SetChannel(m_channelIndex);
+					NS_ASSERT(m_channel != 0);
+					m_channel->StartTx (txParams);
+				}
+				m_phyTxBeginTrace (packet, m_channelIndex);
+				Simulator::Schedule(duration,
                     &BlePhy::EndTx,this,packet->Copy());
-                NS_LOG_INFO ("EndTx event scheduled in: " << txParams->duration);
+                NS_LOG_INFO ("EndTx event scheduled in: " << duration);
 				return true;
 			}
 			return false;  
@@ -295,74 +483,101 @@ namespace ns3 {
       m_transmissionEnd (packet);
 	}
 
-	//处理接收到的无线信号开始，更新接收功率、处理同信道干扰（Co-channel rejection, CCR）、初始化BER并调度接收结束。
+	//处理接收到的无线信号开始，更新接收功率，按灵敏度、捕获和前导码同步决定是否接收，并调度接收结束。
 	void
 		BlePhy::StartRx (Ptr<SpectrumSignalParameters> params)
 		{
           NS_LOG_FUNCTION (this->GetState());
+			m_rxSignals++;
+			Ptr<BleSpectrumSignalParameters> sfParams = 
+              DynamicCast<BleSpectrumSignalParameters> (params);
+			// A BLE packet only matters to a radio that listens. The
+			// signals without BLE parameters (WaveformGenerator, microwave
+			// ovens, Wi-Fi) are few and can be much longer than a BLE
+			// packet, they also count when they start before the
+			// receiver is on.
+			if (sfParams != 0 && m_currentState != RX
+                && m_currentState != RX_BUSY)
+			{
+				NS_LOG_LOGIC ("BLE packet while not receiving");
+				return;
+			}
+			// Far away signals change neither the reception nor the
+			// interference, and cost nothing more
+			if (GetMaxRxPowerDbm (*params->psd) < m_interferenceFloorDbm)
+			{
+				NS_LOG_LOGIC ("Signal below the interference floor");
+				// Still a packet too weak for this receiver
+				if (sfParams != 0 && m_currentState == RX_BUSY
+                    && sfParams->GetChannel() == m_channelIndex)
+					m_sensitivityDrops++;
+				return;
+			}
+			if (sfParams != 0)
+			{
+				uint8_t channel = sfParams->GetChannel();
+				// Outside the receive filter, see GetInterference
+				if (std::abs (channel - m_channelIndex) > 3)
+				{
+					NS_LOG_LOGIC ("Signal outside the receive filter");
+					return;
+				}
+				// The adjacent channel selectivity is the rejection of a
+				// whole BLE signal, its side bands included: only its
+				// centre band goes through the filter
+				for (uint32_t band = 0; band < NB_BANDS + 6; band++)
+				{
+					if (band != channel + 3u)
+						(*params->psd)[band] = 0;
+				}
+			}
+			//update BER
+			UpdateBer();
+			Simulator::Schedule(params->duration,
+                &BlePhy::EndNoise,this,params->psd);
+			*m_receivingPower += *params->psd;
 			if (this->GetState() == BlePhy::State::RX_BUSY) //m_receiver)
 			{
-                NS_LOG_INFO ("Receiving starts now");
-				//update BER
-				UpdateBer();
-				NS_LOG_FUNCTION (this);
-				// do something with params
-				
-				Ptr<BleSpectrumSignalParameters> sfParams = 
-                  DynamicCast<BleSpectrumSignalParameters> (params);
-				// add power to received power
-				Simulator::Schedule(params->duration,
-                    &BlePhy::EndNoise,this,params->psd);
-				*m_receivingPower += *params->psd;
-				//m_ReceptionStart();
-				if (sfParams != 0){
+				// All channels share the medium, a packet on another
+				// channel is only interference
+				if (sfParams != 0 && sfParams->GetChannel() != m_channelIndex)
+				{
+					NS_LOG_INFO ("Packet on channel "
+                        << (int) sfParams->GetChannel() << ", listening on "
+                        << (int) m_channelIndex);
+				}
+				else if (sfParams != 0)
+				{
 					uint8_t channel = sfParams->GetChannel();
-					//Choose highest SNR if multiple
-					if (m_params.size()<1){
-						m_params.push_back(sfParams);
-						sfParams->SetBer(0);
-						//generate ending event
-						sfParams->SetEvent(Simulator::Schedule(
-                              sfParams->duration,&BlePhy::EndRx,this,sfParams));
+					double rssi = GetRssiDbm (*sfParams->psd, channel);
+					if (rssi < m_rxSensitivityDbm)
+					{
+						NS_LOG_INFO ("Packet of " << rssi
+                            << " dBm below the sensitivity");
+						m_sensitivityDrops++;
+					}
+					else if (m_params.empty ())
+					{
+						NS_LOG_INFO ("Receiving starts now");
+						Lock (sfParams);
+					}
+					else if (rssi >= GetRssiDbm (*m_params.front ()->psd,
+                          channel) + m_captureThresholdDb)
+					{
+						// The receiver resynchronises on the stronger
+						// packet, the first one is lost
+						NS_LOG_INFO ("Packet of " << rssi
+                            << " dBm captures the receiver");
+						m_captures++;
+						Unlock (m_params.front ());
+						Lock (sfParams);
 					}
-					else {
-						//check if there is a collision
-						sfParams->SetBer(0);
-						sfParams->SetEvent(Simulator::Schedule(
-                              sfParams->duration,&BlePhy::EndRx,this,sfParams));  
-						for (auto &it : m_params)
-						{
-							if (it->GetChannel() == channel){
-                                // Co-channel rejection:
-                                // 6 dB ==> 4.0
-                                // 11 dB ==> 12.6
-                                double ccrejection = 12.6;
-
-								//if there is a collision, 
-                                //  No problem if 6dB power difference, 
-                                //  but other is corrupted;
-								if (Integral(*it->psd)*ccrejection 
-                                    < Integral(*sfParams->psd)){
-									it->SetBer(10);
-								}
-								else{
-									//if 6dB lower power, there is no detection
-									if (Integral(*it->psd) 
-                                        > ccrejection*Integral(*sfParams->psd)){
-										sfParams->SetBer(10);
-									}
-									else
-									{
-										// in all the other cases, 
-                                        // the signal gets not detected, 
-                                        // but the other packet is corrupted.
-										sfParams->SetBer(10);
-										it->SetBer(10);
-									}
-								}
-							}
-						}
-						m_params.push_back(sfParams);
+					else
+					{
+						// Only interference, counted in the SINR of the
+						// packet being received
+						NS_LOG_INFO ("Packet of " << rssi
+                            << " dBm collides with the packet received");
 					}
 				}
 			}
@@ -373,11 +588,275 @@ namespace ns3 {
             }
 		}
 
+	void
+		BlePhy::Lock (Ptr<BleSpectrumSignalParameters> params)
+		{
+			NS_LOG_FUNCTION (this);
+			params->SetBer(0);
+			params->SetEvent(Simulator::Schedule(
+                  params->duration,&BlePhy::EndRx,this,params));
+			m_params.push_back(params);
+			// UpdateBer counts the bits at the LE 1M symbol rate
+			Time preamble = Seconds (double (m_preambleBits) / LE_1M_BITRATE);
+			if (preamble < params->duration)
+			{
+				m_preambleEvent = Simulator::Schedule (preamble,
+                    &BlePhy::EndPreamble, this, params);
+			}
+		}
+
+	void
+		BlePhy::Unlock (Ptr<BleSpectrumSignalParameters> params)
+		{
+			NS_LOG_FUNCTION (this);
+			params->GetEvent().Cancel();
+			m_preambleEvent.Cancel();
+			m_params.erase (std::remove (m_params.begin (), m_params.end (),
+                  params), m_params.end ());
+		}
+
+	void
+		BlePhy::EndPreamble (Ptr<BleSpectrumSignalParameters> params)
+		{
+			NS_LOG_FUNCTION (this);
+			UpdateBer();
+			// A bit error in the access address: the packet is not
+			// detected and the receiver keeps listening
+			if (params->GetBer() > 0)
+			{
+				NS_LOG_INFO ("Access address not detected");
+				m_preambleMisses++;
+				Unlock (params);
+				SleepIfPending ();
+			}
+		}
+
+	void
+		BlePhy::StartLinkRx (Ptr<const Packet> packet, uint8_t channel,
+            double power, Time duration)
+		{
+			NS_LOG_FUNCTION (this << (int) channel << power);
+			NS_ASSERT (channel < NB_BANDS);
+			m_rxSignals++;
+			// Only a radio that listens needs the packet, see StartRx
+			if (GetState () != BlePhy::State::RX
+                && GetState () != BlePhy::State::RX_BUSY)
+			{
+				NS_LOG_LOGIC ("BLE packet while not receiving");
+				return;
+			}
+			if (std::abs (channel - m_channelIndex) > 3)
+			{
+				NS_LOG_LOGIC ("Signal outside the receive filter");
+				return;
+			}
+			double rssi = 10*std::log10 (power*1000);
+			if (rssi < m_interferenceFloorDbm)
+			{
+				NS_LOG_LOGIC ("Signal below the interference floor");
+				// Still a packet too weak for this receiver
+				if (GetState () == BlePhy::State::RX_BUSY
+                    && channel == m_channelIndex)
+					m_sensitivityDrops++;
+				return;
+			}
+			UpdateLinkPer ();
+			Simulator::Schedule (duration, &BlePhy::EndLinkNoise, this,
+                channel, power);
+			m_linkPower[channel] += power;
+			// Same decisions as StartRx, on the power in the centre band
+			rssi += 10*std::log10 (m_linkCoupling[0]);
+			if (GetState () != BlePhy::State::RX_BUSY
+                || channel != m_channelIndex)
+			{
+				return;
+			}
+			if (rssi < m_rxSensitivityDbm)
+			{
+				NS_LOG_INFO ("Packet of " << rssi
+                    << " dBm below the sensitivity");
+				m_sensitivityDrops++;
+			}
+			else if (m_linkRx.packet == 0)
+			{
+				NS_LOG_INFO ("Receiving starts now");
+				LockLink (packet, channel, power, duration);
+			}
+			else if (rssi >= 10*std::log10 (m_linkRx.power*m_linkCoupling[0]*1000)
+                + m_captureThresholdDb)
+			{
+				NS_LOG_INFO ("Packet of " << rssi
+                    << " dBm captures the receiver");
+				m_captures++;
+				UnlockLink ();
+				LockLink (packet, channel, power, duration);
+			}
+		}
+
+	void
+		BlePhy::EndLinkNoise (uint8_t channel, double power)
+		{
+			NS_LOG_FUNCTION (this << (int) channel << power);
+			// Nothing is received while the radio is off
+			if (!m_asleep)
+				UpdateLinkPer ();
+			m_linkPower[channel] = std::max (0.0, m_linkPower[channel] - power);
+		}
+
+	void
+		BlePhy::LockLink (Ptr<const Packet> packet, uint8_t channel,
+            double power, Time duration)
+		{
+			NS_LOG_FUNCTION (this);
+			m_linkRx.packet = packet;
+			m_linkRx.channel = channel;
+			m_linkRx.power = power;
+			m_linkRx.success = 1;
+			m_linkRx.event = Simulator::Schedule (duration, &BlePhy::EndLinkRx,
+                this);
+			m_linkLastCheck = Simulator::Now ();
+			// UpdateLinkPer counts the bits at the LE 1M symbol rate
+			Time preamble = Seconds (double (m_preambleBits) / LE_1M_BITRATE);
+			if (preamble < duration)
+			{
+				m_preambleEvent = Simulator::Schedule (preamble,
+                    &BlePhy::EndLinkPreamble, this);
+			}
+		}
+
+	void
+		BlePhy::UnlockLink (void)
+		{
+			NS_LOG_FUNCTION (this);
+			m_linkRx.event.Cancel ();
+			m_preambleEvent.Cancel ();
+			m_linkRx.packet = 0;
+		}
+
+	void
+		BlePhy::EndLinkPreamble (void)
+		{
+			NS_LOG_FUNCTION (this);
+			UpdateLinkPer ();
+			if (m_random->GetValue () >= m_linkRx.success)
+			{
+				NS_LOG_INFO ("Access address not detected");
+				m_preambleMisses++;
+				UnlockLink ();
+				SleepIfPending ();
+			}
+			else
+			{
+				// The rest of the packet, given a correct access address
+				m_linkRx.success = 1;
+			}
+		}
+
+	void
+		BlePhy::EndLinkRx (void)
+		{
+			NS_LOG_FUNCTION (this->GetState());
+			NS_LOG_INFO ("Receiving stops now");
+			UpdateLinkPer ();
+			bool error = m_random->GetValue () >= m_linkRx.success;
+			Ptr<Packet> packet = m_linkRx.packet->Copy ();
+			uint8_t channel = m_linkRx.channel;
+			double rssi = 10*std::log10 (
+                m_linkRx.power*m_linkCoupling[0]*1000);
+			UnlockLink ();
+			m_phyRxEndTrace (packet, channel, rssi, error);
+			m_ReceptionEnd (packet, error);
+			this->ChangeState(BlePhy::State::IDLE);
+			SleepIfPending ();
+		}
+
+	void
+		BlePhy::UpdateLinkPer (void)
+		{
+			Time now = Simulator::Now ();
+			if (m_linkRx.packet != 0 && m_linkRx.channel == m_channelIndex)
+			{
+				double signal = m_linkRx.power*m_linkCoupling[0];
+				double sinr = signal / (GetLinkInterference (m_linkRx.channel)
+                    + m_k*m_temperature*m_bandWidth);
+				// Bits on the air at the LE 1M symbol rate, as in UpdateBer
+				double bits = (now - m_linkLastCheck).GetSeconds ()*LE_1M_BITRATE;
+				m_linkRx.success *= 1 - m_linkChannel->GetPer (sinr, bits);
+			}
+			m_linkLastCheck = now;
+		}
+
+	double
+		BlePhy::GetLinkInterference (uint8_t channel) const
+		{
+			double interference = 0;
+			int first = std::max (0, channel - 3);
+			int last = std::min (NB_BANDS - 1, channel + 3);
+			for (int other = first; other <= last; other++)
+			{
+				interference += m_linkPower[other]
+                  * m_linkCoupling[std::abs (other - channel)];
+			}
+			if (m_linkRx.packet != 0 && m_linkRx.channel == channel)
+			{
+				interference -= m_linkRx.power*m_linkCoupling[0];
+			}
+			return std::max (0.0, interference);
+		}
+
+	double
+		BlePhy::GetRssiDbm (const SpectrumValue &psd, uint8_t channel) const
+		{
+			// Power in the centre band of the channel, W/Hz -> dBm
+			return 10*std::log10 (psd[channel+3]*m_bandWidth*1000);
+		}
+
+	double
+		BlePhy::GetMaxRxPowerDbm (const SpectrumValue &psd) const
+		{
+			double max = 0;
+			for (Values::const_iterator it = psd.ConstValuesBegin ();
+                it != psd.ConstValuesEnd (); ++it)
+			{
+				max = std::max (max, *it);
+			}
+			return 10*std::log10 (max*m_bandWidth*1000);
+		}
+
+	uint64_t
+		BlePhy::GetSensitivityDrops (void) const
+		{
+			return m_sensitivityDrops;
+		}
+
+	uint64_t
+		BlePhy::GetPreambleMisses (void) const
+		{
+			return m_preambleMisses;
+		}
+
+	uint64_t
+		BlePhy::GetCaptures (void) const
+		{
+			return m_captures;
+		}
+
+	int64_t
+		BlePhy::AssignStreams (int64_t stream)
+		{
+			NS_LOG_FUNCTION (this << stream);
+			m_random->SetStream (stream);
+			m_channelSelector->SetStream (stream + 1);
+			return 2;
+		}
+
 	void
 		BlePhy::EndNoise (Ptr<SpectrumValue> sv)
 		{
 			NS_LOG_FUNCTION(this);
-			UpdateBer();
+			// Nothing is received while the radio is off
+			if (!m_asleep)
+				UpdateBer();
 			*m_receivingPower -= *sv;
 		}
 
@@ -388,15 +867,11 @@ namespace ns3 {
             NS_LOG_INFO ("Receiving stops now");
 			//update BER
 			UpdateBer();
-			int temp = 0;
-			for (auto &it : m_params)
-			{
-				if (it==params)
-				{
-					m_params.erase(m_params.begin()+temp);
-				}
-				temp++;
-			}
+			Unlock (params);
+			uint8_t channel = params->GetChannel();
+			double rssi = GetRssiDbm (*params->psd, channel);
+			m_phyRxEndTrace (params->packet, channel, rssi,
+                params->GetBer()>=1);
 			//decide packet error or not
 			//if(m_random->GetValue()>=per)
 			if(params->GetBer()<1)
@@ -410,6 +885,7 @@ namespace ns3 {
 				m_ReceptionEnd(params->packet, true);
 			}
             this->ChangeState(BlePhy::State::IDLE);
+			SleepIfPending ();
 		}
 
    BlePhy::State
@@ -418,10 +894,78 @@ namespace ns3 {
        return m_currentState;
      }
 
+   bool
+     BlePhy::IsReceiving ()
+     {
+       return ! m_params.empty () || m_linkRx.packet != 0;
+     }
+
+   void
+     BlePhy::Sleep (void)
+     {
+       NS_LOG_FUNCTION (this);
+       if (!m_sleepBetweenEvents || m_asleep)
+         return;
+       NS_ASSERT (m_currentState == IDLE);
+       if (IsReceiving ())
+       {
+         // The packet received still needs the interference on it
+         m_sleepPending = true;
+         return;
+       }
+       TurnOff ();
+     }
+
+   void
+     BlePhy::SleepIfPending (void)
+     {
+       if (m_sleepPending && !IsReceiving ())
+       {
+         m_sleepPending = false;
+         TurnOff ();
+       }
+     }
+
+   void
+     BlePhy::TurnOff (void)
+     {
+       // The signals on the air keep their EndNoise events, the ones that
+       // start from now on do not reach the PHY
+       m_asleep = true;
+       if (m_channel != 0)
+         m_channel->RemoveRx (this);
+     }
+
+   void
+     BlePhy::WakeUp (void)
+     {
+       NS_LOG_FUNCTION (this);
+       m_sleepPending = false;
+       if (!m_asleep)
+         return;
+       m_asleep = false;
+       if (m_channel != 0)
+         m_channel->AddRx (this);
+     }
+
+   bool
+     BlePhy::IsAsleep (void) const
+     {
+       return m_asleep;
+     }
+
+   uint64_t
+     BlePhy::GetRxSignals (void) const
+     {
+       return m_rxSignals;
+     }
+
    void
      BlePhy::ChangeState (BlePhy::State state)
      {
        NS_LOG_FUNCTION (this);
+       if (state != IDLE)
+         WakeUp ();
        switch (m_currentState) {
           case IDLE : 
               NS_ASSERT(state != TX_BUSY);
@@ -464,6 +1008,30 @@ namespace ns3 {
        m_bandWidth = bandwidth;
      }
 
+   void
+     BlePhy::SetPower (double power)
+     {
+       NS_LOG_FUNCTION (this << power);
+       // Watt, the PSD is made from it at every transmission
+       m_power = power;
+     }
+
+   void
+     BlePhy::SetDataRate (double bitrate)
+     {
+       NS_LOG_FUNCTION (this << bitrate);
+       NS_ASSERT (bitrate > 0);
+       m_bitrate = bitrate;
+     }
+
+   Time
+     BlePhy::GetTxDuration (uint32_t size) const
+     {
+       NS_ASSERT (size > 0);
+       // Preamble and access address before the PDU, CRC after it
+       return Seconds ((m_preambleBits + size * 8 + CRC_BITS) / m_bitrate);
+     }
+
    void
      BlePhy::SetChannelIndex (uint8_t channelIndex)
      {
@@ -540,13 +1108,13 @@ namespace ns3 {
 				Ptr<SpectrumValue> noise = m_receivingPower->Copy();
 				*noise -= *i->psd;
 				uint32_t channel = i->GetChannel();
-				double snr = 
-                  (*i->psd)[channel+3]/((*noise)[channel+3]+m_k*m_temperature);
+				double snr = (*i->psd)[channel+3]
+                  / (GetInterference (*noise, channel)+m_k*m_temperature);
 				//getBER
 				long double berEs = m_errorModel->GetBER (snr);
-				int bits = (timeNow - m_lastCheck)*m_bitrate / 4; 
-                // Divided by 4 to compensate for higher bitrate 
-                //  (see other remark at bitrate instantiation)
+				// Bits on the air at the LE 1M symbol rate, whatever
+				// DataRate is used for the air time
+				int bits = (timeNow - m_lastCheck)*LE_1M_BITRATE;
 				for ( int it = 0; it < bits; it++)
 				{
 					if(m_random->GetValue()<berEs)
@@ -561,6 +1129,23 @@ namespace ns3 {
 			m_lastCheck = timeNow;
 		}
 
+	double
+		BlePhy::GetInterference (const SpectrumValue &noise, uint32_t channel)
+		{
+			// Bands 2, 4 and 6 MHz away are attenuated by the receive
+			// filter, there are 3 bands on both sides of the 40 channels.
+			// A BLE signal only keeps its centre band (see StartRx).
+			double acsDb[] = {m_acs1Db, m_acs2Db, m_acs3Db};
+			double interference = noise[channel+3];
+			for (uint32_t offset = 1; offset <= 3; offset++)
+			{
+				double rejection = std::pow (10.0, -acsDb[offset-1]/10);
+				interference += (noise[channel+3-offset]
+                    + noise[channel+3+offset]) * rejection;
+			}
+			return interference;
+		}
+
 		void
 			BlePhy::SetReceiverMode (bool receiver)
 			{
@@ -34,6 +34,7 @@
 #include "ble-spectrum-signal-parameters.h"
 #include <ns3/event-id.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/traced-callback.h>
 namespace ns3 {
 
 const int NB_BANDS = 40;
@@ -52,6 +53,7 @@ class NetDevice;
 struct SpectrumSignalParameters;
 
 class BleBBManager;
+class BleLinkChannel;
 
 /**
  * \ingroup spectrum
@@ -80,6 +82,25 @@ public:
 
   static TypeId GetTypeId (void);
 
+  /**
+   * TracedCallback signature for the start of a transmission.
+   *
+   * @param packet the packet being transmitted
+   * @param channel the channel index it is transmitted on
+   */
+  typedef void (* TxTracedCallback)(Ptr<const Packet> packet, uint8_t channel);
+
+  /**
+   * TracedCallback signature for the end of a reception.
+   *
+   * @param packet the received packet
+   * @param channel the channel index it was received on
+   * @param rssi received signal strength in dBm
+   * @param error true if the packet was received with bit errors
+   */
+  typedef void (* RxTracedCallback)(Ptr<const Packet> packet, uint8_t channel,
+      double rssi, bool error);
+
   /**
    * set the associated NetDevice instance
    *
@@ -117,6 +138,28 @@ public:
   void SetChannel (Ptr<SpectrumChannel> c);
   Ptr<SpectrumChannel> GetChannel();
 
+  /**
+   * Transmit and receive on a link-level abstraction of the medium
+   * instead of the SpectrumChannel: powers per channel and a PER table
+   * instead of power spectral densities and bit sampling. The mobility
+   * model has to be set first.
+   *
+   * @param c the channel
+   */
+  void SetLinkChannel (Ptr<BleLinkChannel> c);
+  Ptr<BleLinkChannel> GetLinkChannel () const;
+
+  /**
+   * A transmission of the BleLinkChannel reaches this PHY
+   *
+   * @param packet the packet, shared with the other receivers
+   * @param channel the channel index it is transmitted on
+   * @param power the received power in W
+   * @param duration the air time
+   */
+  void StartLinkRx (Ptr<const Packet> packet, uint8_t channel, double power,
+      Time duration);
+
   /**
    *
    * @return returns the SpectrumModel that this SpectrumPhy expects to be used
@@ -190,9 +233,48 @@ public:
   void SetChannelIndex(uint8_t channelIndex);
   void SetPower (double power);
   void SetBandwidth (uint32_t bandwidth);
+  // Same as the DataRate attribute, without the attribute lookup
+  void SetDataRate (double bitrate);
+  // Air time of a packet of size bytes (with the MAC header) at DataRate,
+  // with the PreambleBits of preamble and access address and the CRC
+  Time GetTxDuration (uint32_t size) const;
+
+
+  // Packets on the receive channel below the RxSensitivity
+  uint64_t GetSensitivityDrops (void) const;
+  // Packets lost because of a bit error in the access address
+  uint64_t GetPreambleMisses (void) const;
+  // Packets lost because a stronger one captured the receiver
+  uint64_t GetCaptures (void) const;
+
+  /**
+   * Use fixed streams for the bit errors and the channel selection.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Turn the radio off, from IDLE, if SleepBetweenEvents is set; after
+   * the packet being received, if any. Until WakeUp the PHY is removed
+   * from its SpectrumChannel and the BleLinkChannel skips it, so no
+   * signal reaches it and no event is scheduled for it.
+   */
+  void Sleep (void);
+  /**
+   * Turn the radio on, attached to the channel again. A BLE packet that
+   * started meanwhile is ignored, as by a radio that was on but not
+   * receiving; a longer signal of another technology is missed too.
+   */
+  void WakeUp (void);
+  bool IsAsleep (void) const;
+  // Signals the channel delivered to the PHY, see Sleep
+  uint64_t GetRxSignals (void) const;
 
   BlePhy::State GetState ();
+  // True while a signal is being received, in the RX_BUSY state
+  bool IsReceiving ();
   void ChangeState (BlePhy::State state);
 
   // TX states
@@ -218,6 +300,18 @@ private:
  double m_temperature; //noise temperature 噪声温度（Kelvin），用于热噪声计算
  double m_bandWidth; //bandwith 频道带宽（Hz） BANDWIDTH = 2e6（2MHz，BLE标准）
  double m_bitrate; //bitrate 数据比特率（bps），用于计算传输时长和BER
+ // Adjacent channel selectivity (dB) per 2 MHz band of offset
+ double m_acs1Db;
+ double m_acs2Db;
+ double m_acs3Db;
+ double m_rxSensitivityDbm;
+ double m_interferenceFloorDbm;
+ double m_captureThresholdDb;
+ uint32_t m_preambleBits;
+ EventId m_preambleEvent; // End of the access address of the packet received
+ uint64_t m_sensitivityDrops;
+ uint64_t m_preambleMisses;
+ uint64_t m_captures;
  double m_power; //power of transmission 发射功率（W），定义信号强度
  uint8_t m_channelIndex; //channel to transmit on
  double m_bitErrors[40]; //biterrors collected  存储每个频道的累积比特错误计数（未实际使用）
@@ -236,9 +330,34 @@ private:
  Callback<void> m_ReceptionStart;
  Callback<void> m_ReceptionError;
  Callback<void, Ptr<Packet>, bool > m_ReceptionEnd;
+ TracedCallback<Ptr<const Packet>, uint8_t> m_phyTxBeginTrace;
+ TracedCallback<Ptr<const Packet>, uint8_t, double, bool> m_phyRxEndTrace;
 
  BlePhy::State m_currentState;
 
+ // Link-level abstraction, only used with a BleLinkChannel
+ Ptr<BleLinkChannel> m_linkChannel;
+ uint32_t m_linkIndex; // Index of this PHY on m_linkChannel
+ double m_linkPower[NB_BANDS]; // Received power (W) per channel
+ // Part of the power on a channel that interferes with a packet received
+ // 0 to 3 channels away, after the receive filter
+ double m_linkCoupling[4];
+ struct LinkRx
+ {
+   Ptr<const Packet> packet; // 0 if no packet is received
+   uint8_t channel;
+   double power;
+   double success; // Probability that no bit was lost until m_linkLastCheck
+   EventId event;
+ };
+ LinkRx m_linkRx;
+ Time m_linkLastCheck;
+
+ // Radio off between the events of the device, see Sleep
+ bool m_sleepBetweenEvents;
+ bool m_asleep;
+ bool m_sleepPending; // Asleep once the packet received ends
+ uint64_t m_rxSignals;
 
 
   /**
@@ -251,10 +370,66 @@ private:
   */
   void CreateTxPowerSpectralDensity (uint32_t channeloffset, double power);
 
+  /**
+   * Start and stop receiving a packet, one at a time
+   */
+  void Lock (Ptr<BleSpectrumSignalParameters> params);
+  void Unlock (Ptr<BleSpectrumSignalParameters> params);
+
+  /**
+   * End of the preamble and access address of the packet received, the
+   * receiver only synchronises if they arrived without bit errors
+   */
+  void EndPreamble (Ptr<BleSpectrumSignalParameters> params);
+
+  // Power of psd in the centre band of channel
+  double GetRssiDbm (const SpectrumValue &psd, uint8_t channel) const;
+  // Power of the strongest band of psd
+  double GetMaxRxPowerDbm (const SpectrumValue &psd) const;
+
+  // Link-level counterparts of EndNoise, Lock, Unlock, EndPreamble, EndRx
+  void EndLinkNoise (uint8_t channel, double power);
+  void LockLink (Ptr<const Packet> packet, uint8_t channel, double power,
+      Time duration);
+  void UnlockLink (void);
+  void EndLinkPreamble (void);
+  void EndLinkRx (void);
+  /**
+   * Lower the success probability of the packet received with the PER
+   * of the bits since the last check, at the SINR of the current powers
+   */
+  void UpdateLinkPer (void);
+  // Interference power (W) on channel of all powers but the one received
+  double GetLinkInterference (uint8_t channel) const;
+  // Sleep, out of the fan-out of the channels
+  void TurnOff (void);
+  // Refresh m_linkCoupling after a change of the adjacent channel selectivity
+  void UpdateLinkCoupling (void);
+  void SetAdjacentChannelSelectivity1 (double db);
+  void SetAdjacentChannelSelectivity2 (double db);
+  void SetAdjacentChannelSelectivity3 (double db);
+  double GetAdjacentChannelSelectivity1 (void) const;
+  double GetAdjacentChannelSelectivity2 (void) const;
+  double GetAdjacentChannelSelectivity3 (void) const;
+  // Turn the radio off if Sleep waited for the end of a reception
+  void SleepIfPending (void);
+
   /**
    * Update the BER for all receiving transmissions based on latest information 
    */
   void UpdateBer (void);
+
+  /**
+   * Interference on a channel after the receive filter: the co-channel
+   * power plus the power of the 3 bands on both sides, each attenuated
+   * by its adjacent channel selectivity
+   *
+   * @param noise the received power spectral density without the signal
+   * @param channel the receive channel
+   *
+   * @return the interference power spectral density in W/Hz
+   */
+  double GetInterference (const SpectrumValue &noise, uint32_t channel);
 };
 
 
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-remote-link-channel.h"
+#include "ble-phy.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+#include <ns3/packet.h>
+#include <ns3/node.h>
+#include <ns3/net-device.h>
+#include <ns3/mpi-interface.h>
+#include <ns3/mpi-receiver.h>
+#include <cstring>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleRemoteLinkChannel");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleLinkTxHeader);
+  NS_OBJECT_ENSURE_REGISTERED (BleRemoteLinkChannel);
+
+  BleLinkTxHeader::BleLinkTxHeader ()
+    : m_channel (0),
+      m_power (0)
+  {
+  }
+
+  BleLinkTxHeader::~BleLinkTxHeader ()
+  {
+  }
+
+  uint8_t
+    BleLinkTxHeader::GetChannel (void) const
+    {
+      return m_channel;
+    }
+
+  double
+    BleLinkTxHeader::GetPower (void) const
+    {
+      return m_power;
+    }
+
+  Time
+    BleLinkTxHeader::GetDuration (void) const
+    {
+      return m_duration;
+    }
+
+  void
+    BleLinkTxHeader::SetChannel (uint8_t channel)
+    {
+      m_channel = channel;
+    }
+
+  void
+    BleLinkTxHeader::SetPower (double power)
+    {
+      m_power = power;
+    }
+
+  void
+    BleLinkTxHeader::SetDuration (Time duration)
+    {
+      m_duration = duration;
+    }
+
+  std::string
+    BleLinkTxHeader::GetName (void) const
+    {
+      return "BleLinkTxHeader";
+    }
+
+  TypeId
+    BleLinkTxHeader::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleLinkTxHeader")
+        .SetParent<Header> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleLinkTxHeader> ()
+        ;
+      return tid;
+    }
+
+  TypeId
+    BleLinkTxHeader::GetInstanceTypeId (void) const
+    {
+      return GetTypeId ();
+    }
+
+  void
+    BleLinkTxHeader::Print (std::ostream &os) const
+    {
+      os << "Channel = " << (int) m_channel
+        << ", Power = " << m_power
+        << ", Duration = " << m_duration;
+    }
+
+  uint32_t
+    BleLinkTxHeader::GetSerializedSize (void) const
+    {
+      return 1+8+8;
+    }
+
+  void
+    BleLinkTxHeader::Serialize (Buffer::Iterator start) const
+    {
+      Buffer::Iterator i = start;
+      i.WriteU8 (m_channel);
+      uint64_t power;
+      std::memcpy (&power, &m_power, sizeof (power));
+      i.WriteHtonU64 (power);
+      i.WriteHtonU64 (m_duration.GetTimeStep ());
+    }
+
+  uint32_t
+    BleLinkTxHeader::Deserialize (Buffer::Iterator start)
+    {
+      Buffer::Iterator i = start;
+      m_channel = i.ReadU8 ();
+      uint64_t power = i.ReadNtohU64 ();
+      std::memcpy (&m_power, &power, sizeof (power));
+      m_duration = TimeStep (i.ReadNtohU64 ());
+      return GetSerializedSize ();
+    }
+
+  TypeId
+    BleRemoteLinkChannel::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleRemoteLinkChannel")
+        .SetParent<BleLinkChannel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleRemoteLinkChannel> ()
+        ;
+      return tid;
+    }
+
+  BleRemoteLinkChannel::BleRemoteLinkChannel ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleRemoteLinkChannel::~BleRemoteLinkChannel ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  uint32_t
+    BleRemoteLinkChannel::Add (Ptr<BlePhy> phy)
+    {
+      NS_LOG_FUNCTION (this << phy);
+      uint32_t index = BleLinkChannel::Add (phy);
+      // The device is not on its node yet, so every device gets a
+      // receiver, only the ones of this rank will use it
+      Ptr<NetDevice> device = phy->GetDevice ();
+      NS_ASSERT_MSG (device != 0, "Set the device of the PHY first");
+      if (device->GetObject<MpiReceiver> () == 0)
+        {
+          Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+          receiver->SetReceiveCallback (
+              MakeCallback (&BleRemoteLinkChannel::ReceiveRemote, this)
+              .Bind (phy));
+          device->AggregateObject (receiver);
+        }
+      return index;
+    }
+
+  bool
+    BleRemoteLinkChannel::IsLocal (Ptr<BlePhy> phy) const
+    {
+      return phy->GetDevice ()->GetNode ()->GetSystemId ()
+        == MpiInterface::GetSystemId ();
+    }
+
+  void
+    BleRemoteLinkChannel::StartTx (uint32_t txIndex, Ptr<const Packet> packet,
+        uint8_t channel, double power, Time duration)
+    {
+      NS_LOG_FUNCTION (this << txIndex << packet << (int) channel << power);
+      if (!IsLocal (GetPhy (txIndex)))
+        {
+          // Simulated by the rank of the node
+          return;
+        }
+      Ptr<const Packet> copy = packet->Copy ();
+      uint32_t systemId = MpiInterface::GetSystemId ();
+      for (const Neighbour &neighbour : GetNeighbours (txIndex))
+        {
+          if (neighbour.systemId == systemId)
+            {
+              Deliver (neighbour, copy, channel, power, duration);
+              continue;
+            }
+          BleLinkTxHeader header;
+          header.SetChannel (channel);
+          header.SetPower (power * neighbour.gain);
+          header.SetDuration (duration);
+          Ptr<Packet> remote = packet->Copy ();
+          remote->AddHeader (header);
+          // Nodes that came closer than the lookahead since BoundLookAhead
+          // receive the signal a little late
+          Time delay = neighbour.delay;
+          std::map<uint32_t, Time>::const_iterator lookAhead =
+            m_lookAhead.find (neighbour.systemId);
+          if (lookAhead != m_lookAhead.end ())
+            {
+              delay = Max (delay, lookAhead->second);
+            }
+          Simulator::ScheduleNow (&BleRemoteLinkChannel::SendRemote, this,
+              remote, Simulator::Now () + delay,
+              neighbour.nodeId,
+              GetPhy (neighbour.index)->GetDevice ()->GetIfIndex ());
+        }
+    }
+
+  void
+    BleRemoteLinkChannel::SendRemote (Ptr<Packet> packet, Time rxTime,
+        uint32_t nodeId, uint32_t ifIndex)
+    {
+      NS_LOG_FUNCTION (this << packet << rxTime << nodeId << ifIndex);
+      MpiInterface::SendPacket (packet, rxTime, nodeId, ifIndex);
+    }
+
+  void
+    BleRemoteLinkChannel::ReceiveRemote (Ptr<BlePhy> phy, Ptr<Packet> packet)
+    {
+      NS_LOG_FUNCTION (this << phy << packet);
+      BleLinkTxHeader header;
+      packet->RemoveHeader (header);
+      phy->StartLinkRx (packet, header.GetChannel (), header.GetPower (),
+          header.GetDuration ());
+    }
+
+  Time
+    BleRemoteLinkChannel::BoundLookAhead (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_lookAhead = GetLookAhead (MpiInterface::GetSystemId ());
+      Time smallest = Time::Max ();
+      for (const auto &rank : m_lookAhead)
+        {
+          NS_ABORT_MSG_IF (rank.second.IsZero (), "No delay to rank "
+              << rank.first << ", set a PropagationDelayModel and keep the "
+              "nodes of different ranks apart");
+          MpiInterface::AddRemoteChannel (this, rank.first, rank.second);
+          smallest = Min (smallest, rank.second);
+        }
+      NS_LOG_INFO ("Lookahead " << smallest << " to " << m_lookAhead.size ()
+          << " ranks");
+      return smallest;
+    }
+
+}
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_REMOTE_LINK_CHANNEL_H
+#define BLE_REMOTE_LINK_CHANNEL_H
+
+// Includes
+#include <ns3/ble-link-channel.h>
+#include <ns3/header.h>
+
+namespace ns3 {
+
+/*
+ * \ingroup ble
+ * Represent a transmission of a BleRemoteLinkChannel to another rank
+ *
+ * Added in front of the packet sent with MpiInterface::SendPacket: the
+ * channel index, the received power (W) and the air time.
+ * */
+class BleLinkTxHeader : public Header
+{
+
+public:
+
+  BleLinkTxHeader (void);
+
+  ~BleLinkTxHeader (void);
+
+  uint8_t GetChannel (void) const;
+  double GetPower (void) const;
+  Time GetDuration (void) const;
+
+  void SetChannel (uint8_t channel);
+  void SetPower (double power);
+  void SetDuration (Time duration);
+
+  std::string GetName (void) const;
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  void Print (std::ostream &os) const;
+  uint32_t GetSerializedSize (void) const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_channel;
+  double m_power;
+  Time m_duration;
+}; //BleLinkTxHeader
+
+/**
+ * \ingroup ble
+ * \brief BleLinkChannel of a distributed (MPI) simulation
+ *
+ * Every rank builds all nodes and devices and simulates the PHYs of its
+ * own nodes (Node::GetSystemId). A transmission of such a PHY reaches
+ * the receivers of the same rank as on a BleLinkChannel. For a receiver
+ * of another rank it is sent with MpiInterface::SendPacket to the
+ * MpiReceiver of the device, which hands it to the receiving PHY after
+ * the propagation delay. The PHYs of the other ranks do not transmit.
+ *
+ * The propagation delays to the nodes of every other rank bound the
+ * lookahead of the simulators: BoundLookAhead declares them per rank,
+ * in range or not, so nodes that move into range later still have a
+ * channel to each other. Once the simulator runs the lookahead cannot
+ * be lowered; a node that comes closer to another rank than the
+ * closest one was receives its signals after that smallest delay.
+ *
+ * The null message simulator promises, with every packet to another
+ * rank, that nothing follows earlier than its next event plus the
+ * lookahead. Every packet to another rank is therefore sent in an event
+ * of its own, when the next ones of the transmission are still due now.
+ */
+  class BleRemoteLinkChannel : public BleLinkChannel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleRemoteLinkChannel ();
+      virtual ~BleRemoteLinkChannel ();
+
+      virtual uint32_t Add (Ptr<BlePhy> phy);
+      virtual void StartTx (uint32_t txIndex, Ptr<const Packet> packet,
+          uint8_t channel, double power, Time duration);
+
+      /*
+       * Bound the lookahead of the distributed simulator with the
+       * propagation delays to the other ranks
+       * (MpiInterface::AddRemoteChannel), after all devices are
+       * installed and before Simulator::Run. Returns the smallest one,
+       * Time::Max () if no other rank has a PHY on the channel.
+       */
+      Time BoundLookAhead (void);
+
+    private:
+      bool IsLocal (Ptr<BlePhy> phy) const;
+      // Hand a transmission of another rank to phy
+      void ReceiveRemote (Ptr<BlePhy> phy, Ptr<Packet> packet);
+      void SendRemote (Ptr<Packet> packet, Time rxTime, uint32_t nodeId,
+          uint32_t ifIndex);
+
+      // Smallest delay to every other rank, set by BoundLookAhead
+      std::map<uint32_t, Time> m_lookAhead;
+  };
+
+}
+
+#endif /* BLE_REMOTE_LINK_CHANNEL_H */
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-ring-queue.h"
+#include <ns3/log.h>
+#include <ns3/uinteger.h>
+#include <ns3/constants.h>
+#include <algorithm>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleRingQueue");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleRingQueue);
+
+  TypeId
+    BleRingQueue::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleRingQueue")
+        .SetParent<Object> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleRingQueue> ()
+        .AddAttribute ("Capacity",
+            "Maximum number of items in the queue",
+            UintegerValue (QUEUE_SIZE_PACKETS),
+            MakeUintegerAccessor (&BleRingQueue::SetCapacity,
+              &BleRingQueue::GetCapacity),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddTraceSource ("Enqueue", "Enqueue a packet in the queue.",
+            MakeTraceSourceAccessor (&BleRingQueue::m_traceEnqueue),
+            "ns3::QueueItem::TracedCallback")
+        .AddTraceSource ("Dequeue", "Dequeue a packet from the queue.",
+            MakeTraceSourceAccessor (&BleRingQueue::m_traceDequeue),
+            "ns3::QueueItem::TracedCallback")
+        .AddTraceSource ("Drop", "Drop a packet because the queue is full, "
+            "for a more urgent one or because its deadline passed.",
+            MakeTraceSourceAccessor (&BleRingQueue::m_traceDrop),
+            "ns3::QueueItem::TracedCallback")
+        ;
+      return tid;
+    }
+
+  BleRingQueue::BleRingQueue ()
+    : m_capacity (QUEUE_SIZE_PACKETS),
+      m_head (0),
+      m_size (0),
+      m_nBytes (0),
+      m_nDropped (0)
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleRingQueue::~BleRingQueue ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleRingQueue::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_items.clear ();
+      m_head = 0;
+      m_size = 0;
+      m_nBytes = 0;
+      Object::DoDispose ();
+    }
+
+  void
+    BleRingQueue::SetCapacity (uint32_t capacity)
+    {
+      NS_LOG_FUNCTION (this << capacity);
+      NS_ASSERT_MSG (capacity > 0, "A queue needs room for one item");
+      NS_ASSERT_MSG (m_size == 0, "Capacity changed of a queue in use");
+      m_capacity = capacity;
+      std::vector<Ptr<QueueItem> > ().swap (m_items);
+      m_head = 0;
+    }
+
+  uint32_t
+    BleRingQueue::GetCapacity (void) const
+    {
+      return m_capacity;
+    }
+
+  bool
+    BleRingQueue::Reserve (void)
+    {
+      if (m_size < m_items.size ())
+        return true;
+      if (m_size == m_capacity)
+        return false;
+      // Unroll the ring into a buffer twice as large
+      std::vector<Ptr<QueueItem> > items (
+          std::min<uint32_t> (m_capacity, std::max<uint32_t> (4, 2 * m_size)));
+      for (uint32_t i = 0; i < m_size; i++)
+        items[i] = m_items[(m_head + i) % m_items.size ()];
+      m_items.swap (items);
+      m_head = 0;
+      return true;
+    }
+
+  bool
+    BleRingQueue::Enqueue (Ptr<QueueItem> item)
+    {
+      NS_LOG_FUNCTION (this << item);
+      NS_ASSERT (item);
+      if (! Reserve ())
+        {
+          NS_LOG_LOGIC ("Queue full -- dropping pkt");
+          m_nDropped++;
+          m_traceDrop (item);
+          return false;
+        }
+      m_items[(m_head + m_size) % m_items.size ()] = item;
+      m_size++;
+      m_nBytes += item->GetSize ();
+      m_traceEnqueue (item);
+      return true;
+    }
+
+  Ptr<QueueItem>
+    BleRingQueue::Dequeue (void)
+    {
+      NS_LOG_FUNCTION (this);
+      if (m_size == 0)
+        return 0;
+      Ptr<QueueItem> item = m_items[m_head];
+      m_items[m_head] = 0;
+      m_head = (m_head + 1) % m_items.size ();
+      m_size--;
+      m_nBytes -= item->GetSize ();
+      m_traceDequeue (item);
+      return item;
+    }
+
+  Ptr<const QueueItem>
+    BleRingQueue::Peek (void) const
+    {
+      if (m_size == 0)
+        return 0;
+      return m_items[m_head];
+    }
+
+  Ptr<const QueueItem>
+    BleRingQueue::Peek (uint32_t index) const
+    {
+      if (index >= m_size)
+        return 0;
+      return m_items[(m_head + index) % m_items.size ()];
+    }
+
+  Ptr<QueueItem>
+    BleRingQueue::Unlink (uint32_t index)
+    {
+      uint32_t n = m_items.size ();
+      Ptr<QueueItem> item = m_items[(m_head + index) % n];
+      for (uint32_t i = index; i + 1 < m_size; i++)
+        m_items[(m_head + i) % n] = m_items[(m_head + i + 1) % n];
+      m_items[(m_head + m_size - 1) % n] = 0;
+      m_size--;
+      m_nBytes -= item->GetSize ();
+      return item;
+    }
+
+  Ptr<QueueItem>
+    BleRingQueue::Remove (uint32_t index)
+    {
+      NS_LOG_FUNCTION (this << index);
+      if (index >= m_size)
+        return 0;
+      if (index == 0)
+        return Dequeue ();
+      Ptr<QueueItem> item = Unlink (index);
+      m_traceDequeue (item);
+      return item;
+    }
+
+  void
+    BleRingQueue::Drop (uint32_t index)
+    {
+      NS_LOG_FUNCTION (this << index);
+      NS_ASSERT (index < m_size);
+      Ptr<QueueItem> item = Unlink (index);
+      m_nDropped++;
+      m_traceDrop (item);
+    }
+
+  bool
+    BleRingQueue::MoveFrontTo (Ptr<BleRingQueue> queue)
+    {
+      NS_LOG_FUNCTION (this << queue);
+      NS_ASSERT (queue && queue != this);
+      if (m_size == 0)
+        return false;
+      return queue->Enqueue (Dequeue ());
+    }
+
+  bool
+    BleRingQueue::IsEmpty (void) const
+    {
+      return m_size == 0;
+    }
+
+  uint32_t
+    BleRingQueue::GetNPackets (void) const
+    {
+      return m_size;
+    }
+
+  uint32_t
+    BleRingQueue::GetNBytes (void) const
+    {
+      return m_nBytes;
+    }
+
+  uint64_t
+    BleRingQueue::GetTotalDroppedPackets (void) const
+    {
+      return m_nDropped;
+    }
+
+}
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_RING_QUEUE_H
+#define BLE_RING_QUEUE_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/ptr.h>
+#include <ns3/queue-item.h>
+#include <ns3/traced-callback.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ble
+ * \brief FIFO of at most Capacity items in one contiguous buffer
+ *
+ * Used for the packets waiting in a BleNetDevice and in every
+ * BleLinkManager, instead of a DropTailQueue that allocates a list node
+ * per packet. The buffer is a ring that grows by doubling up to
+ * Capacity, so the queue of a link that never sends does not take
+ * memory and a busy one stops allocating once it is large enough.
+ *
+ * An item that does not fit is dropped, as are the items the owner
+ * discards with Drop. The Enqueue, Dequeue and Drop trace sources have
+ * the signature of those of Queue<QueueItem>.
+ */
+  class BleRingQueue : public Object
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleRingQueue ();
+      virtual ~BleRingQueue ();
+
+      /*
+       * Only while the queue is empty, the buffer is released and
+       * grows again up to the new capacity.
+       */
+      void SetCapacity (uint32_t capacity);
+      uint32_t GetCapacity (void) const;
+
+      // False (and the Drop trace) if the queue is full
+      bool Enqueue (Ptr<QueueItem> item);
+      // 0 if the queue is empty
+      Ptr<QueueItem> Dequeue (void);
+      Ptr<const QueueItem> Peek (void) const;
+      // The index-th oldest item, 0 is the one Peek returns
+      Ptr<const QueueItem> Peek (uint32_t index) const;
+      /*
+       * Take the index-th oldest item out of the queue (Dequeue trace),
+       * the items behind it move up. 0 if there is no such item.
+       */
+      Ptr<QueueItem> Remove (uint32_t index);
+      // Same, but the item is dropped (Drop trace, counted as dropped)
+      void Drop (uint32_t index);
+
+      /*
+       * Hand the oldest item over to the end of queue, the item itself
+       * and not a copy of it. Fires the Dequeue trace of this queue and
+       * the Enqueue (or Drop) trace of queue. Returns false if this
+       * queue is empty or queue is full.
+       */
+      bool MoveFrontTo (Ptr<BleRingQueue> queue);
+
+      bool IsEmpty (void) const;
+      uint32_t GetNPackets (void) const;
+      uint32_t GetNBytes (void) const;
+      uint64_t GetTotalDroppedPackets (void) const;
+
+    protected:
+      virtual void DoDispose (void);
+
+    private:
+      // Make room for one more item, false if the capacity is reached
+      bool Reserve (void);
+      // Take the index-th oldest item out, without traces
+      Ptr<QueueItem> Unlink (uint32_t index);
+
+      uint32_t m_capacity;
+      std::vector<Ptr<QueueItem> > m_items;
+      uint32_t m_head; // Index of the oldest item
+      uint32_t m_size;
+      uint32_t m_nBytes;
+      uint64_t m_nDropped;
+
+      TracedCallback<Ptr<const QueueItem> > m_traceEnqueue;
+      TracedCallback<Ptr<const QueueItem> > m_traceDequeue;
+      TracedCallback<Ptr<const QueueItem> > m_traceDrop;
+  };
+
+}
+
+#endif /* BLE_RING_QUEUE_H */
@@ -0,0 +1,512 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#include "ble-stats-collector.h"
+#include "ble-mac-header.h"
+#include "ble-phy.h"
+#include <ns3/ble-net-device.h>
+#include <ns3/node.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <algorithm>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleStatsCollector");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleStatsCollector);
+
+  static uint16_t
+  ToU16 (Mac16Address address)
+  {
+    uint8_t buffer[2];
+    address.CopyTo (buffer);
+    return (buffer[0] << 8) | buffer[1];
+  }
+
+  // LLID of data PDUs carrying upper layer data
+  static const uint8_t LLID_DATA = 0b10;
+  static const uint16_t BROADCAST_ADDRESS = 0xffff;
+
+  /***********************
+   * BleLatencyHistogram *
+   ***********************/
+
+  BleLatencyHistogram::BleLatencyHistogram ()
+    : m_count (0)
+  {
+  }
+
+  void
+    BleLatencyHistogram::SetBins (Time binWidth, uint32_t nbBins)
+    {
+      NS_ASSERT (binWidth.IsStrictlyPositive () && nbBins > 0);
+      m_binWidth = binWidth;
+      m_bins.assign (nbBins, 0);
+    }
+
+  void
+    BleLatencyHistogram::Add (Time latency)
+    {
+      NS_ASSERT (!m_bins.empty ());
+      uint64_t bin = latency.GetTimeStep () / m_binWidth.GetTimeStep ();
+      if (bin >= m_bins.size ())
+        bin = m_bins.size () - 1;
+      m_bins[bin]++;
+      m_count++;
+      m_sum += latency;
+      if (latency > m_max)
+        m_max = latency;
+    }
+
+  void
+    BleLatencyHistogram::Reset (void)
+    {
+      std::fill (m_bins.begin (), m_bins.end (), 0);
+      m_count = 0;
+      m_sum = Time ();
+      m_max = Time ();
+    }
+
+  uint64_t
+    BleLatencyHistogram::GetCount (void) const
+    {
+      return m_count;
+    }
+
+  Time
+    BleLatencyHistogram::GetMean (void) const
+    {
+      if (m_count == 0)
+        return Time ();
+      return TimeStep (m_sum.GetTimeStep () / m_count);
+    }
+
+  Time
+    BleLatencyHistogram::GetMax (void) const
+    {
+      return m_max;
+    }
+
+  Time
+    BleLatencyHistogram::GetBinWidth (void) const
+    {
+      return m_binWidth;
+    }
+
+  const std::vector<uint64_t> &
+    BleLatencyHistogram::GetBins (void) const
+    {
+      return m_bins;
+    }
+
+  BleNodeStats::BleNodeStats ()
+    : tx (0), phyTx (0), retransmissions (0), rx (0), promiscRx (0),
+      rxBroadcast (0), rxError (0), txWindowsSkipped (0)
+  {
+  }
+
+  BleLinkStats::BleLinkStats ()
+    : tx (0), phyTx (0), retransmissions (0), rx (0)
+  {
+  }
+
+  BleChannelStats::BleChannelStats ()
+    : phyTx (0), phyRx (0), phyRxError (0)
+  {
+  }
+
+  /*********************
+   * BleStatsCollector *
+   *********************/
+
+  TypeId
+    BleStatsCollector::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleStatsCollector")
+        .SetParent<Object> ()
+        .AddConstructor<BleStatsCollector> ()
+        .AddAttribute ("LatencyBinWidth",
+            "Width of a bin of the latency histograms",
+            TimeValue (MilliSeconds (10)),
+            MakeTimeAccessor (&BleStatsCollector::m_binWidth),
+            MakeTimeChecker ())
+        .AddAttribute ("LatencyBins",
+            "Number of bins of the latency histograms, "
+            "the last one also holds all larger latencies",
+            UintegerValue (500),
+            MakeUintegerAccessor (&BleStatsCollector::m_nbBins),
+            MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("LatencyTimeout",
+            "A packet that is not received this long after MacTx is "
+            "forgotten (lost or dropped), its latency is not recorded",
+            TimeValue (Seconds (60)),
+            MakeTimeAccessor (&BleStatsCollector::m_latencyTimeout),
+            MakeTimeChecker ())
+        ;
+      return tid;
+    }
+
+  BleStatsCollector::BleStatsCollector ()
+    : m_binWidth (MilliSeconds (10)),
+      m_nbBins (500),
+      m_latencyTimeout (Seconds (60)),
+      m_channels (NB_CHANNELS)
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleStatsCollector::~BleStatsCollector ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleStatsCollector::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      m_snapshotEvent.Cancel ();
+      m_snapshotStream = 0;
+      Object::DoDispose ();
+    }
+
+  void
+    BleStatsCollector::Connect (Ptr<BleNetDevice> device)
+    {
+      NS_LOG_FUNCTION (this << device);
+      uint32_t nodeId = device->GetNode ()->GetId ();
+      GetNode (nodeId);
+      device->TraceConnectWithoutContext ("MacTx",
+          MakeCallback (&BleStatsCollector::MacTx, this).Bind (nodeId));
+      device->TraceConnectWithoutContext ("MacRx",
+          MakeCallback (&BleStatsCollector::MacRx, this).Bind (nodeId));
+      device->TraceConnectWithoutContext ("MacPromiscRx",
+          MakeCallback (&BleStatsCollector::MacPromiscRx, this)
+          .Bind (nodeId));
+      device->TraceConnectWithoutContext ("MacRxBroadcast",
+          MakeCallback (&BleStatsCollector::MacRxBroadcast, this)
+          .Bind (nodeId));
+      device->TraceConnectWithoutContext ("MacRxError",
+          MakeCallback (&BleStatsCollector::MacRxError, this).Bind (nodeId));
+      device->TraceConnectWithoutContext ("TXWindowSkipped",
+          MakeCallback (&BleStatsCollector::TxWindowSkipped, this)
+          .Bind (nodeId));
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin",
+          MakeCallback (&BleStatsCollector::PhyTxBegin, this).Bind (nodeId));
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd",
+          MakeCallback (&BleStatsCollector::PhyRxEnd, this));
+    }
+
+  BleNodeStats &
+    BleStatsCollector::GetNode (uint32_t nodeId)
+    {
+      std::map<uint32_t, BleNodeStats>::iterator it = m_nodes.find (nodeId);
+      if (it == m_nodes.end ())
+      {
+        it = m_nodes.insert (std::make_pair (nodeId, BleNodeStats ())).first;
+        it->second.latency.SetBins (m_binWidth, m_nbBins);
+      }
+      return it->second;
+    }
+
+  BleLinkStats &
+    BleStatsCollector::GetLink (uint16_t src, uint16_t dst)
+    {
+      LinkKey key (src, dst);
+      std::map<LinkKey, BleLinkStats>::iterator it = m_links.find (key);
+      if (it == m_links.end ())
+      {
+        it = m_links.insert (std::make_pair (key, BleLinkStats ())).first;
+        it->second.latency.SetBins (m_binWidth, m_nbBins);
+      }
+      return it->second;
+    }
+
+  void
+    BleStatsCollector::MacTx (uint32_t nodeId, Ptr<const Packet> packet)
+    {
+      BleMacHeader header;
+      packet->PeekHeader (header);
+      GetNode (nodeId).tx++;
+      GetLink (ToU16 (header.GetSrcAddr ()),
+          ToU16 (header.GetDestAddr ())).tx++;
+      m_txTimes[packet->GetUid ()] = Simulator::Now ();
+      m_txOrder.push_back (std::make_pair (Simulator::Now (),
+            packet->GetUid ()));
+      PruneTxTimes ();
+    }
+
+  void
+    BleStatsCollector::PruneTxTimes (void)
+    {
+      // MacTx times only grow, the expired entries are at the front. A
+      // packet that was received already is no longer in m_txTimes.
+      Time limit = Simulator::Now () - m_latencyTimeout;
+      while (!m_txOrder.empty () && m_txOrder.front ().first < limit)
+      {
+        std::unordered_map<uint64_t, Time>::iterator it =
+          m_txTimes.find (m_txOrder.front ().second);
+        if (it != m_txTimes.end () && it->second == m_txOrder.front ().first)
+          m_txTimes.erase (it);
+        m_txOrder.pop_front ();
+      }
+    }
+
+  void
+    BleStatsCollector::RecordLatency (BleNodeStats &node,
+        Ptr<const Packet> packet, uint16_t src, uint16_t dst)
+    {
+      std::unordered_map<uint64_t, Time>::iterator it =
+        m_txTimes.find (packet->GetUid ());
+      if (it == m_txTimes.end ())
+        return; // Sent before the collector was connected, or already seen
+      Time latency = Simulator::Now () - it->second;
+      node.latency.Add (latency);
+      GetLink (src, dst).latency.Add (latency);
+      m_txTimes.erase (it);
+    }
+
+  void
+    BleStatsCollector::MacRx (uint32_t nodeId, Ptr<const Packet> packet)
+    {
+      BleMacHeader header;
+      packet->PeekHeader (header);
+      uint16_t src = ToU16 (header.GetSrcAddr ());
+      uint16_t dst = ToU16 (header.GetDestAddr ());
+      BleNodeStats &node = GetNode (nodeId);
+      node.rx++;
+      GetLink (src, dst).rx++;
+      RecordLatency (node, packet, src, dst);
+    }
+
+  void
+    BleStatsCollector::MacPromiscRx (uint32_t nodeId, Ptr<const Packet> packet)
+    {
+      GetNode (nodeId).promiscRx++;
+    }
+
+  void
+    BleStatsCollector::MacRxBroadcast (uint32_t nodeId,
+        Ptr<const Packet> packet, Ptr<const BleNetDevice> device)
+    {
+      BleMacHeader header;
+      packet->PeekHeader (header);
+      BleNodeStats &node = GetNode (nodeId);
+      node.rxBroadcast++;
+      RecordLatency (node, packet, ToU16 (header.GetSrcAddr ()),
+          BROADCAST_ADDRESS);
+    }
+
+  void
+    BleStatsCollector::MacRxError (uint32_t nodeId, Ptr<const Packet> packet)
+    {
+      GetNode (nodeId).rxError++;
+    }
+
+  void
+    BleStatsCollector::TxWindowSkipped (uint32_t nodeId,
+        Ptr<const BleNetDevice> device)
+    {
+      GetNode (nodeId).txWindowsSkipped++;
+    }
+
+  void
+    BleStatsCollector::PhyTxBegin (uint32_t nodeId, Ptr<const Packet> packet,
+        uint8_t channel)
+    {
+      BleNodeStats &node = GetNode (nodeId);
+      node.phyTx++;
+      if (channel < NB_CHANNELS)
+        m_channels[channel].phyTx++;
+
+      BleMacHeader header;
+      packet->PeekHeader (header);
+      uint16_t dst = ToU16 (header.GetDestAddr ());
+      if (header.GetLLID () != LLID_DATA || dst == BROADCAST_ADDRESS)
+        return; // Empty packets and advertisements are never retransmitted
+      uint16_t src = ToU16 (header.GetSrcAddr ());
+      BleLinkStats &link = GetLink (src, dst);
+      link.phyTx++;
+      // A retransmission is a copy of the current packet, with the same uid
+      LinkKey key (src, dst);
+      std::map<LinkKey, uint64_t>::iterator it = m_lastDataUid.find (key);
+      if (it != m_lastDataUid.end () && it->second == packet->GetUid ())
+      {
+        node.retransmissions++;
+        link.retransmissions++;
+      }
+      else
+        m_lastDataUid[key] = packet->GetUid ();
+    }
+
+  void
+    BleStatsCollector::PhyRxEnd (Ptr<const Packet> packet, uint8_t channel,
+        double rssi, bool error)
+    {
+      if (channel >= NB_CHANNELS)
+        return;
+      if (error)
+        m_channels[channel].phyRxError++;
+      else
+        m_channels[channel].phyRx++;
+    }
+
+  BleNodeStats
+    BleStatsCollector::GetNodeStats (uint32_t nodeId) const
+    {
+      std::map<uint32_t, BleNodeStats>::const_iterator it =
+        m_nodes.find (nodeId);
+      return it == m_nodes.end () ? BleNodeStats () : it->second;
+    }
+
+  BleLinkStats
+    BleStatsCollector::GetLinkStats (uint16_t src, uint16_t dst) const
+    {
+      std::map<LinkKey, BleLinkStats>::const_iterator it =
+        m_links.find (LinkKey (src, dst));
+      return it == m_links.end () ? BleLinkStats () : it->second;
+    }
+
+  const BleChannelStats &
+    BleStatsCollector::GetChannelStats (uint8_t channel) const
+    {
+      NS_ASSERT (channel < NB_CHANNELS);
+      return m_channels[channel];
+    }
+
+  const std::map<uint32_t, BleNodeStats> &
+    BleStatsCollector::GetAllNodeStats (void) const
+    {
+      return m_nodes;
+    }
+
+  const std::map<BleStatsCollector::LinkKey, BleLinkStats> &
+    BleStatsCollector::GetAllLinkStats (void) const
+    {
+      return m_links;
+    }
+
+  BleNodeStats
+    BleStatsCollector::GetTotal (void) const
+    {
+      BleNodeStats total;
+      for (const auto &it : m_nodes)
+      {
+        total.tx += it.second.tx;
+        total.phyTx += it.second.phyTx;
+        total.retransmissions += it.second.retransmissions;
+        total.rx += it.second.rx;
+        total.promiscRx += it.second.promiscRx;
+        total.rxBroadcast += it.second.rxBroadcast;
+        total.rxError += it.second.rxError;
+        total.txWindowsSkipped += it.second.txWindowsSkipped;
+      }
+      return total;
+    }
+
+  void
+    BleStatsCollector::Reset (void)
+    {
+      NS_LOG_FUNCTION (this);
+      for (auto &it : m_nodes)
+      {
+        BleLatencyHistogram latency = it.second.latency;
+        latency.Reset ();
+        it.second = BleNodeStats ();
+        it.second.latency = latency;
+      }
+      m_links.clear ();
+      m_channels.assign (NB_CHANNELS, BleChannelStats ());
+      m_txTimes.clear ();
+      m_txOrder.clear ();
+      m_lastDataUid.clear ();
+    }
+
+  void
+    BleStatsCollector::EnableSnapshots (Ptr<OutputStreamWrapper> stream,
+        Time interval)
+    {
+      NS_LOG_FUNCTION (this << interval);
+      NS_ASSERT (interval.IsStrictlyPositive ());
+      m_snapshotStream = stream;
+      m_snapshotInterval = interval;
+      *stream->GetStream () << "time,node,tx,phyTx,retransmissions,rx,"
+        "promiscRx,rxBroadcast,rxError,txWindowsSkipped,latencyMeanMs,latencyMaxMs"
+        << std::endl;
+      m_snapshotEvent.Cancel ();
+      m_snapshotEvent = Simulator::Schedule (interval,
+          &BleStatsCollector::Snapshot, this);
+    }
+
+  void
+    BleStatsCollector::Snapshot (void)
+    {
+      WriteSnapshot (*m_snapshotStream->GetStream ());
+      m_snapshotEvent = Simulator::Schedule (m_snapshotInterval,
+          &BleStatsCollector::Snapshot, this);
+    }
+
+  void
+    BleStatsCollector::WriteSnapshot (std::ostream &os) const
+    {
+      double now = Simulator::Now ().GetSeconds ();
+      for (const auto &it : m_nodes)
+      {
+        const BleNodeStats &s = it.second;
+        os << now << "," << it.first << "," << s.tx << "," << s.phyTx << ","
+          << s.retransmissions << "," << s.rx << "," << s.promiscRx << ","
+          << s.rxBroadcast << ","
+          << s.rxError << "," << s.txWindowsSkipped << ","
+          << s.latency.GetMean ().GetSeconds () * 1000 << ","
+          << s.latency.GetMax ().GetSeconds () * 1000 << std::endl;
+      }
+    }
+
+  void
+    BleStatsCollector::Print (std::ostream &os) const
+    {
+      os << "Nodes: time node tx phyTx retransmissions rx promiscRx "
+        "rxBroadcast rxError txWindowsSkipped latencyMeanMs latencyMaxMs" << std::endl;
+      WriteSnapshot (os);
+      os << "Links: src dst tx phyTx retransmissions rx latencyMeanMs "
+        "latencyMaxMs" << std::endl;
+      for (const auto &it : m_links)
+      {
+        const BleLinkStats &s = it.second;
+        os << it.first.first << "," << it.first.second << "," << s.tx << ","
+          << s.phyTx << "," << s.retransmissions << "," << s.rx << ","
+          << s.latency.GetMean ().GetSeconds () * 1000 << ","
+          << s.latency.GetMax ().GetSeconds () * 1000 << std::endl;
+      }
+      os << "Channels: channel phyTx phyRx phyRxError" << std::endl;
+      for (uint8_t channel = 0; channel < NB_CHANNELS; channel++)
+      {
+        const BleChannelStats &s = m_channels[channel];
+        if (s.phyTx + s.phyRx + s.phyRxError == 0)
+          continue;
+        os << (int) channel << "," << s.phyTx << "," << s.phyRx << ","
+          << s.phyRxError << std::endl;
+      }
+    }
+
+}
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_STATS_COLLECTOR_H
+#define BLE_STATS_COLLECTOR_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <ns3/output-stream-wrapper.h>
+#include <map>
+#include <deque>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+  // Classes
+
+  class BleNetDevice;
+
+/**
+ * \ingroup ble
+ * \brief Fixed bin latency histogram, the last bin collects the overflow
+ */
+  class BleLatencyHistogram
+  {
+    public:
+      BleLatencyHistogram ();
+
+      void SetBins (Time binWidth, uint32_t nbBins);
+      void Add (Time latency);
+      void Reset (void);
+
+      uint64_t GetCount (void) const;
+      Time GetMean (void) const;
+      Time GetMax (void) const;
+      Time GetBinWidth (void) const;
+      const std::vector<uint64_t> &GetBins (void) const;
+
+    private:
+      Time m_binWidth;
+      std::vector<uint64_t> m_bins;
+      uint64_t m_count;
+      Time m_sum;
+      Time m_max;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Counters of one node
+ *
+ * Receptions and errors count at the node that received them, also the
+ * errored packets it overheard for another destination.
+ */
+  struct BleNodeStats
+  {
+    BleNodeStats ();
+
+    uint64_t tx; // Packets accepted by the device (MacTx)
+    uint64_t phyTx; // Transmissions started by the PHY, incl. empty packets
+    uint64_t retransmissions; // Data packets sent again after a NACK
+    uint64_t rx; // Unicast packets received (MacRx)
+    uint64_t promiscRx; // Packets passed up in promiscuous mode (MacPromiscRx)
+    uint64_t rxBroadcast; // Broadcast packets received (MacRxBroadcast)
+    uint64_t rxError; // Packets received with bit errors (MacRxError)
+    uint64_t txWindowsSkipped; // TX windows lost to another link manager
+    BleLatencyHistogram latency; // Of the packets received by this node
+  };
+
+/**
+ * \ingroup ble
+ * \brief Counters of one direction of a link, keyed by link layer addresses
+ */
+  struct BleLinkStats
+  {
+    BleLinkStats ();
+
+    uint64_t tx; // Packets accepted by the source device
+    uint64_t phyTx; // Data packet transmissions, incl. retransmissions
+    uint64_t retransmissions;
+    uint64_t rx; // Received by the destination
+    BleLatencyHistogram latency;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Counters of one channel index
+ */
+  struct BleChannelStats
+  {
+    BleChannelStats ();
+
+    uint64_t phyTx;
+    uint64_t phyRx; // Receptions without bit errors, on any node
+    uint64_t phyRxError;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Built-in statistics of BLE devices
+ *
+ * Connects to the device and PHY traces and keeps per node, per link and
+ * per channel counters, so examples do not need their own trace sinks.
+ * Packets are never copied: the MAC header is only peeked. The latency of
+ * a packet runs from MacTx at the source to its first MacRx or
+ * MacRxBroadcast; retransmissions are data packets with the same uid sent
+ * again on the same link.
+ */
+  class BleStatsCollector : public Object
+  {
+    public:
+      typedef std::pair<uint16_t, uint16_t> LinkKey; // (source, destination)
+
+      static const uint8_t NB_CHANNELS = 40;
+
+      BleStatsCollector ();
+      ~BleStatsCollector ();
+
+      static TypeId GetTypeId (void);
+
+      // Collect the statistics of this device
+      void Connect (Ptr<BleNetDevice> device);
+
+      // Empty statistics if nothing was recorded yet
+      BleNodeStats GetNodeStats (uint32_t nodeId) const;
+      BleLinkStats GetLinkStats (uint16_t src, uint16_t dst) const;
+      const BleChannelStats &GetChannelStats (uint8_t channel) const;
+      const std::map<uint32_t, BleNodeStats> &GetAllNodeStats (void) const;
+      const std::map<LinkKey, BleLinkStats> &GetAllLinkStats (void) const;
+
+      // Sum of the counters of all nodes
+      BleNodeStats GetTotal (void) const;
+
+      void Reset (void);
+
+      /**
+       * \brief Write the per node counters to the stream every interval
+       *
+       * Lines are cumulative, as CSV with the time in seconds first.
+       */
+      void EnableSnapshots (Ptr<OutputStreamWrapper> stream, Time interval);
+      void WriteSnapshot (std::ostream &os) const;
+
+      // Human readable node, link and channel tables
+      void Print (std::ostream &os) const;
+
+    protected:
+      virtual void DoDispose (void);
+
+    private:
+      void MacTx (uint32_t nodeId, Ptr<const Packet> packet);
+      void MacRx (uint32_t nodeId, Ptr<const Packet> packet);
+      void MacPromiscRx (uint32_t nodeId, Ptr<const Packet> packet);
+      void MacRxBroadcast (uint32_t nodeId, Ptr<const Packet> packet,
+          Ptr<const BleNetDevice> device);
+      void MacRxError (uint32_t nodeId, Ptr<const Packet> packet);
+      void TxWindowSkipped (uint32_t nodeId, Ptr<const BleNetDevice> device);
+      void PhyTxBegin (uint32_t nodeId, Ptr<const Packet> packet,
+          uint8_t channel);
+      void PhyRxEnd (Ptr<const Packet> packet, uint8_t channel, double rssi,
+          bool error);
+
+      BleNodeStats &GetNode (uint32_t nodeId);
+      BleLinkStats &GetLink (uint16_t src, uint16_t dst);
+      void RecordLatency (BleNodeStats &node, Ptr<const Packet> packet,
+          uint16_t src, uint16_t dst);
+      void Snapshot (void);
+      // Forget the packets sent more than m_latencyTimeout ago
+      void PruneTxTimes (void);
+
+      Time m_binWidth;
+      uint32_t m_nbBins;
+      Time m_latencyTimeout;
+
+      std::map<uint32_t, BleNodeStats> m_nodes;
+      std::map<LinkKey, BleLinkStats> m_links;
+      std::vector<BleChannelStats> m_channels;
+      // Packet uid -> time of MacTx, until the packet is received or
+      // m_latencyTimeout expires
+      std::unordered_map<uint64_t, Time> m_txTimes;
+      // The uids of m_txTimes in the order they were sent
+      std::deque<std::pair<Time, uint64_t> > m_txOrder;
+      // Uid of the last data packet sent on a link
+      std::map<LinkKey, uint64_t> m_lastDataUid;
+
+      Ptr<OutputStreamWrapper> m_snapshotStream;
+      Time m_snapshotInterval;
+      EventId m_snapshotEvent;
+  };
+
+}
+
+#endif /* BLE_STATS_COLLECTOR_H */
@@ -0,0 +1,454 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#include "ble-trace-sink.h"
+#include "ble-mac-header.h"
+#include "ble-phy.h"
+#include <ns3/ble-net-device.h>
+#include <ns3/node.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/pcap-file.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleTraceSink");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleTraceSink);
+
+  // Little endian helpers, so traces can be moved between machines
+  static void
+  PutU16 (uint8_t *p, uint16_t v)
+  {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+  }
+
+  static void
+  PutU32 (uint8_t *p, uint32_t v)
+  {
+    PutU16 (p, v & 0xffff);
+    PutU16 (p + 2, v >> 16);
+  }
+
+  static void
+  PutU64 (uint8_t *p, uint64_t v)
+  {
+    PutU32 (p, v & 0xffffffff);
+    PutU32 (p + 4, v >> 32);
+  }
+
+  static uint16_t
+  GetU16 (const uint8_t *p)
+  {
+    return p[0] | (p[1] << 8);
+  }
+
+  static uint32_t
+  GetU32 (const uint8_t *p)
+  {
+    return GetU16 (p) | ((uint32_t) GetU16 (p + 2) << 16);
+  }
+
+  static uint64_t
+  GetU64 (const uint8_t *p)
+  {
+    return GetU32 (p) | ((uint64_t) GetU32 (p + 4) << 32);
+  }
+
+  // Converter constants, see WritePcap
+  static const uint32_t DLT_BLUETOOTH_LE_LL_WITH_PHDR = 256;
+  static const uint32_t ADVERTISING_ACCESS_ADDRESS = 0x8E89BED6;
+  // Empty packets carry no destination, so all links share one address
+  static const uint32_t DATA_ACCESS_ADDRESS = 0x71764129;
+  static const uint8_t FIRST_ADVERTISING_CHANNEL = 37;
+  static const uint32_t MAC_HEADER_SIZE = 8; // Serialized BleMacHeader
+
+  // Flags of the pseudo header
+  static const uint16_t PHDR_DEWHITENED = 0x0001;
+  static const uint16_t PHDR_SIGNAL_VALID = 0x0002;
+  static const uint16_t PHDR_REF_AA_VALID = 0x0010;
+  static const uint16_t PHDR_CRC_CHECKED = 0x0400;
+  static const uint16_t PHDR_CRC_VALID = 0x0800;
+
+  static uint16_t
+  ToU16 (Mac16Address address)
+  {
+    uint8_t buffer[2];
+    address.CopyTo (buffer);
+    return (buffer[0] << 8) | buffer[1];
+  }
+
+  TypeId
+    BleTraceSink::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleTraceSink")
+        .SetParent<Object> ()
+        .AddConstructor<BleTraceSink> ()
+        .AddAttribute ("BufferSize",
+            "Number of bytes collected before they are written to the file",
+            UintegerValue (1 << 16),
+            MakeUintegerAccessor (&BleTraceSink::m_bufferSize),
+            MakeUintegerChecker<uint32_t> (RECORD_SIZE))
+        ;
+      return tid;
+    }
+
+  BleTraceSink::BleTraceSink ()
+    : m_bufferSize (1 << 16),
+      m_nbRecords (0)
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleTraceSink::~BleTraceSink ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleTraceSink::DoDispose (void)
+    {
+      NS_LOG_FUNCTION (this);
+      Close ();
+      Object::DoDispose ();
+    }
+
+  void
+    BleTraceSink::Open (std::string filename)
+    {
+      NS_LOG_FUNCTION (this << filename);
+      Close ();
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary
+          | std::ios::trunc);
+      NS_ABORT_MSG_UNLESS (m_file.is_open (),
+          "Cannot open BLE trace file " << filename);
+      uint8_t header[12];
+      header[0] = 'B';
+      header[1] = 'L';
+      header[2] = 'E';
+      header[3] = 'T';
+      PutU32 (header + 4, VERSION);
+      PutU32 (header + 8, RECORD_SIZE);
+      m_file.write (reinterpret_cast<const char *> (header), sizeof (header));
+      m_buffer.reserve (m_bufferSize + RECORD_SIZE);
+    }
+
+  void
+    BleTraceSink::Flush (void)
+    {
+      NS_LOG_FUNCTION (this);
+      if (m_file.is_open () && !m_buffer.empty ())
+      {
+        m_file.write (reinterpret_cast<const char *> (m_buffer.data ()),
+            m_buffer.size ());
+        m_file.flush ();
+      }
+      m_buffer.clear ();
+    }
+
+  void
+    BleTraceSink::Close (void)
+    {
+      NS_LOG_FUNCTION (this);
+      if (m_file.is_open ())
+      {
+        Flush ();
+        m_file.close ();
+      }
+    }
+
+  void
+    BleTraceSink::Connect (Ptr<BleNetDevice> device)
+    {
+      NS_LOG_FUNCTION (this << device);
+      uint32_t nodeId = device->GetNode ()->GetId ();
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin",
+          MakeCallback (&BleTraceSink::PhyTxBegin, this).Bind (nodeId));
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd",
+          MakeCallback (&BleTraceSink::PhyRxEnd, this).Bind (nodeId));
+      device->TraceConnectWithoutContext ("TXWindowSkipped",
+          MakeCallback (&BleTraceSink::TxWindowSkipped, this));
+    }
+
+  uint64_t
+    BleTraceSink::GetRecordCount (void) const
+    {
+      return m_nbRecords;
+    }
+
+  void
+    BleTraceSink::Record (const BleTraceRecord &record)
+    {
+      size_t offset = m_buffer.size ();
+      m_buffer.resize (offset + RECORD_SIZE);
+      uint8_t *p = &m_buffer[offset];
+      PutU64 (p, record.timeNs);
+      PutU32 (p + 8, record.nodeId);
+      PutU16 (p + 12, record.src);
+      PutU16 (p + 14, record.dst);
+      PutU16 (p + 16, record.size);
+      p[18] = record.type;
+      p[19] = record.channel;
+      p[20] = (uint8_t) record.rssi;
+      p[21] = (record.llid & 0x03) | (record.nesn << 2) | (record.sn << 3)
+        | (record.md << 4);
+      PutU16 (p + 22, 0);
+      m_nbRecords++;
+      if (m_buffer.size () >= m_bufferSize)
+        Flush ();
+    }
+
+  void
+    BleTraceSink::RecordPacket (uint8_t type, uint32_t nodeId,
+        Ptr<const Packet> packet, uint8_t channel, double rssi)
+    {
+      BleTraceRecord record;
+      record.timeNs = Simulator::Now ().GetNanoSeconds ();
+      record.nodeId = nodeId;
+      record.type = type;
+      record.channel = channel;
+      record.size = packet->GetSize ();
+      rssi = std::round (rssi);
+      record.rssi = rssi < -128 ? -128 : (rssi > 127 ? 127 : (int8_t) rssi);
+      BleMacHeader header;
+      if (packet->GetSize () >= header.GetSerializedSize ())
+      {
+        packet->PeekHeader (header);
+        record.src = ToU16 (header.GetSrcAddr ());
+        record.dst = ToU16 (header.GetDestAddr ());
+        record.llid = header.GetLLID ();
+        record.sn = header.GetSN ();
+        record.nesn = header.GetNESN ();
+        record.md = header.GetMD ();
+      }
+      else
+      {
+        record.src = record.dst = 0;
+        record.llid = 0;
+        record.sn = record.nesn = record.md = false;
+      }
+      Record (record);
+    }
+
+  void
+    BleTraceSink::PhyTxBegin (uint32_t nodeId, Ptr<const Packet> packet,
+        uint8_t channel)
+    {
+      RecordPacket (BleTraceRecord::TX, nodeId, packet, channel, -128);
+    }
+
+  void
+    BleTraceSink::PhyRxEnd (uint32_t nodeId, Ptr<const Packet> packet,
+        uint8_t channel, double rssi, bool error)
+    {
+      RecordPacket (error ? BleTraceRecord::RX_ERROR : BleTraceRecord::RX,
+          nodeId, packet, channel, rssi);
+    }
+
+  void
+    BleTraceSink::TxWindowSkipped (Ptr<const BleNetDevice> device)
+    {
+      BleTraceRecord record;
+      record.timeNs = Simulator::Now ().GetNanoSeconds ();
+      record.nodeId = device->GetNode ()->GetId ();
+      record.src = ToU16 (device->GetAddress16 ());
+      record.dst = 0;
+      record.size = 0;
+      record.type = BleTraceRecord::TX_WINDOW_SKIPPED;
+      record.channel = BleTraceRecord::NO_CHANNEL;
+      record.rssi = -128;
+      record.llid = 0;
+      record.sn = record.nesn = record.md = false;
+      Record (record);
+    }
+
+  bool
+    BleTraceSink::ReadHeader (std::istream &is)
+    {
+      uint8_t header[12];
+      if (!is.read (reinterpret_cast<char *> (header), sizeof (header)))
+        return false;
+      return header[0] == 'B' && header[1] == 'L' && header[2] == 'E'
+        && header[3] == 'T' && GetU32 (header + 4) == VERSION
+        && GetU32 (header + 8) == RECORD_SIZE;
+    }
+
+  bool
+    BleTraceSink::ReadRecord (std::istream &is, BleTraceRecord &record)
+    {
+      uint8_t p[RECORD_SIZE];
+      if (!is.read (reinterpret_cast<char *> (p), RECORD_SIZE))
+        return false;
+      record.timeNs = (int64_t) GetU64 (p);
+      record.nodeId = GetU32 (p + 8);
+      record.src = GetU16 (p + 12);
+      record.dst = GetU16 (p + 14);
+      record.size = GetU16 (p + 16);
+      record.type = p[18];
+      record.channel = p[19];
+      record.rssi = (int8_t) p[20];
+      record.llid = p[21] & 0x03;
+      record.nesn = (p[21] >> 2) & 1;
+      record.sn = (p[21] >> 3) & 1;
+      record.md = (p[21] >> 4) & 1;
+      return true;
+    }
+
+  static const char *
+  TypeName (uint8_t type)
+  {
+    switch (type)
+    {
+      case BleTraceRecord::TX:
+        return "TX";
+      case BleTraceRecord::RX:
+        return "RX";
+      case BleTraceRecord::RX_ERROR:
+        return "RX_ERROR";
+      case BleTraceRecord::TX_WINDOW_SKIPPED:
+        return "TX_WINDOW_SKIPPED";
+      default:
+        return "UNKNOWN";
+    }
+  }
+
+  // Channel index (0-36 data, 37-39 advertising) to RF channel
+  static uint8_t
+  RfChannel (uint8_t channel)
+  {
+    if (channel == 37)
+      return 0;
+    if (channel == 38)
+      return 12;
+    if (channel == 39)
+      return 39;
+    return channel < 11 ? channel + 1 : channel + 2;
+  }
+
+  static void
+  AppendU16 (std::vector<uint8_t> &v, uint16_t x)
+  {
+    v.push_back (x & 0xff);
+    v.push_back (x >> 8);
+  }
+
+  static void
+  AppendU32 (std::vector<uint8_t> &v, uint32_t x)
+  {
+    AppendU16 (v, x & 0xffff);
+    AppendU16 (v, x >> 16);
+  }
+
+  uint64_t
+    BleTraceSink::WriteCsv (std::istream &is, std::ostream &os)
+    {
+      os << "timeNs,node,type,channel,rssi,src,dst,size,llid,sn,nesn,md"
+        << std::endl;
+      BleTraceRecord r;
+      uint64_t nbRecords = 0;
+      while (ReadRecord (is, r))
+      {
+        os << r.timeNs << "," << r.nodeId << "," << TypeName (r.type) << ",";
+        if (r.channel != BleTraceRecord::NO_CHANNEL)
+          os << (int) r.channel;
+        os << ",";
+        if (r.type == BleTraceRecord::RX || r.type == BleTraceRecord::RX_ERROR)
+          os << (int) r.rssi;
+        os << "," << r.src << "," << r.dst << "," << r.size << ","
+          << (int) r.llid << "," << r.sn << "," << r.nesn << "," << r.md
+          << std::endl;
+        nbRecords++;
+      }
+      return nbRecords;
+    }
+
+  uint64_t
+    BleTraceSink::WritePcap (std::istream &is, std::string filename)
+    {
+      PcapFile pcap;
+      pcap.Open (filename, std::ios::out);
+      pcap.Init (DLT_BLUETOOTH_LE_LL_WITH_PHDR);
+      BleTraceRecord r;
+      uint64_t nbRecords = 0;
+      while (ReadRecord (is, r))
+      {
+        nbRecords++;
+        if (r.type == BleTraceRecord::TX_WINDOW_SKIPPED)
+          continue;
+        bool advertising = (r.channel >= FIRST_ADVERTISING_CHANNEL);
+        uint32_t accessAddress =
+          advertising ? ADVERTISING_ACCESS_ADDRESS : DATA_ACCESS_ADDRESS;
+        uint32_t payload =
+          r.size > MAC_HEADER_SIZE ? r.size - MAC_HEADER_SIZE : 0;
+
+        std::vector<uint8_t> frame;
+        // Pseudo header
+        frame.push_back (RfChannel (r.channel));
+        frame.push_back ((uint8_t) r.rssi);
+        frame.push_back ((uint8_t) -128); // noise power, not valid
+        frame.push_back (0); // access address offenses
+        AppendU32 (frame, accessAddress);
+        uint16_t flags = PHDR_DEWHITENED | PHDR_REF_AA_VALID;
+        if (r.type != BleTraceRecord::TX)
+        {
+          flags |= PHDR_SIGNAL_VALID | PHDR_CRC_CHECKED;
+          if (r.type == BleTraceRecord::RX)
+            flags |= PHDR_CRC_VALID;
+        }
+        AppendU16 (frame, flags);
+
+        // Link layer packet, payload bytes are not part of the trace
+        AppendU32 (frame, accessAddress);
+        if (advertising)
+        {
+          // ADV_NONCONN_IND carrying the source as AdvA
+          payload = std::min (payload, (uint32_t) 31);
+          frame.push_back (0x02);
+          frame.push_back (6 + payload);
+          frame.push_back (r.src & 0xff);
+          frame.push_back (r.src >> 8);
+          for (int i = 0; i < 4; i++)
+            frame.push_back (0);
+        }
+        else
+        {
+          payload = std::min (payload, (uint32_t) 251);
+          frame.push_back ((r.llid & 0x03) | (r.nesn << 2) | (r.sn << 3)
+              | (r.md << 4));
+          frame.push_back (payload);
+        }
+        frame.insert (frame.end (), payload, 0);
+        // CRC, validity is given by the pseudo header flags
+        frame.insert (frame.end (), 3, 0);
+
+        uint64_t us = r.timeNs / 1000;
+        pcap.Write (us / 1000000, us % 1000000, frame.data (), frame.size ());
+      }
+      pcap.Close ();
+      return nbRecords;
+    }
+
+}
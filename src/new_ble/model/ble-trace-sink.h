@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_TRACE_SINK_H
+#define BLE_TRACE_SINK_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/ptr.h>
+#include <ns3/packet.h>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+  // Classes
+
+  class BleNetDevice;
+
+/**
+ * \ingroup ble
+ * \brief One event of a binary BLE trace
+ *
+ * Records are stored little endian with a fixed size of
+ * BleTraceSink::RECORD_SIZE bytes, after a header holding the magic
+ * "BLET" and the format version.
+ */
+  struct BleTraceRecord
+  {
+    enum Type
+    {
+      TX = 0, // PHY starts a transmission
+      RX = 1, // PHY received a packet without bit errors
+      RX_ERROR = 2, // PHY received a packet with bit errors
+      TX_WINDOW_SKIPPED = 3 // A link manager skipped its TX window
+    };
+
+    int64_t timeNs; // Simulation time
+    uint32_t nodeId; // Node of the tracing device
+    uint16_t src; // Link layer source address
+    uint16_t dst; // Link layer destination address
+    uint16_t size; // Packet size, including the MAC header
+    uint8_t type; // BleTraceRecord::Type
+    uint8_t channel; // Channel index, NO_CHANNEL if unknown
+    int8_t rssi; // dBm, only valid for RX and RX_ERROR
+    uint8_t llid;
+    bool sn;
+    bool nesn;
+    bool md;
+
+    static const uint8_t NO_CHANNEL = 0xff;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Buffered binary trace of BLE PHY/MAC events
+ *
+ * Connects to the PhyTxBegin and PhyRxEnd traces of the PHY and the
+ * TXWindowSkipped trace of the net device, and appends a fixed size
+ * record per event to an in-memory buffer that is written out whenever
+ * it is full and when the sink is disposed. Packets are never copied or
+ * printed; the MAC header is only peeked. Use the ble-trace-convert
+ * program to turn a trace into CSV or PCAP.
+ */
+  class BleTraceSink : public Object
+  {
+    public:
+
+      static const uint32_t RECORD_SIZE = 24;
+      static const uint32_t VERSION = 1;
+
+      BleTraceSink ();
+      ~BleTraceSink ();
+
+      static TypeId GetTypeId (void);
+
+      // Create (truncate) the trace file and write the file header
+      void Open (std::string filename);
+      // Write the buffered records to the file
+      void Flush (void);
+      void Close (void);
+
+      // Trace all events of this device
+      void Connect (Ptr<BleNetDevice> device);
+
+      void Record (const BleTraceRecord &record);
+      uint64_t GetRecordCount (void) const;
+
+      // Read the header of a trace file; false if it is not a BLE trace
+      static bool ReadHeader (std::istream &is);
+      // Read the next record; false at the end of the trace
+      static bool ReadRecord (std::istream &is, BleTraceRecord &record);
+
+      /*
+       * Write the records left in is (after ReadHeader) as CSV, with a
+       * header line. Returns the number of records.
+       */
+      static uint64_t WriteCsv (std::istream &is, std::ostream &os);
+      /*
+       * Same to a PCAP file with DLT_BLUETOOTH_LE_LL_WITH_PHDR, see
+       * ble-trace-convert. TX_WINDOW_SKIPPED records are counted but
+       * not written.
+       */
+      static uint64_t WritePcap (std::istream &is, std::string filename);
+
+    protected:
+      virtual void DoDispose (void);
+
+    private:
+      void PhyTxBegin (uint32_t nodeId, Ptr<const Packet> packet,
+          uint8_t channel);
+      void PhyRxEnd (uint32_t nodeId, Ptr<const Packet> packet,
+          uint8_t channel, double rssi, bool error);
+      void TxWindowSkipped (Ptr<const BleNetDevice> device);
+
+      void RecordPacket (uint8_t type, uint32_t nodeId,
+          Ptr<const Packet> packet, uint8_t channel, double rssi);
+
+      std::ofstream m_file;
+      std::vector<uint8_t> m_buffer; // Records not yet written
+      uint32_t m_bufferSize; // Flush threshold, in bytes
+      uint64_t m_nbRecords;
+  };
+
+}
+
+#endif /* BLE_TRACE_SINK_H */
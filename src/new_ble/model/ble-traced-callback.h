@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_TRACED_CALLBACK_H
+#define BLE_TRACED_CALLBACK_H
+
+// Includes
+#include <ns3/traced-callback.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup ble
+ * \brief A TracedCallback that knows whether a sink was ever connected
+ *
+ * For the trace sources whose argument costs something to build, such as
+ * the MAC PDU of a queued packet: the owner only builds it when
+ * IsConnected (). MakeTraceSourceAccessor and Config reach the Connect
+ * methods below, they hide the ones of TracedCallback.
+ */
+  template <typename... Ts>
+  class BleTracedCallback : public TracedCallback<Ts...>
+  {
+    public:
+      BleTracedCallback ()
+        : m_connected (false)
+      {
+      }
+
+      void ConnectWithoutContext (const CallbackBase &callback)
+      {
+        m_connected = true;
+        TracedCallback<Ts...>::ConnectWithoutContext (callback);
+      }
+
+      void Connect (const CallbackBase &callback, std::string path)
+      {
+        m_connected = true;
+        TracedCallback<Ts...>::Connect (callback, path);
+      }
+
+      /*
+       * True once a sink was connected. A Disconnect does not reset it, as
+       * it does not tell whether a sink was removed: the argument is then
+       * built for nothing, but no sink misses a call.
+       */
+      bool IsConnected (void) const
+      {
+        return m_connected;
+      }
+
+    private:
+      bool m_connected;
+  };
+
+}
+
+#endif /* BLE_TRACED_CALLBACK_H */
@@ -0,0 +1,447 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "ble-traffic-model.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/string.h>
+#include <ns3/pointer.h>
+#include <ns3/boolean.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+  NS_LOG_COMPONENT_DEFINE ("BleTrafficModel");
+
+  NS_OBJECT_ENSURE_REGISTERED (BleTrafficModel);
+  NS_OBJECT_ENSURE_REGISTERED (BlePeriodicTraffic);
+  NS_OBJECT_ENSURE_REGISTERED (BlePoissonTraffic);
+  NS_OBJECT_ENSURE_REGISTERED (BleOnOffTraffic);
+  NS_OBJECT_ENSURE_REGISTERED (BleTraceTraffic);
+
+  TypeId
+    BleTrafficModel::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleTrafficModel")
+        .SetParent<Object> ()
+        .SetGroupName("Ble")
+        ;
+      return tid;
+    }
+
+  BleTrafficModel::BleTrafficModel ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleTrafficModel::~BleTrafficModel ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  static bool
+    EarlierArrival (const BleArrival &a, const BleArrival &b)
+    {
+      return a.time < b.time;
+    }
+
+  std::vector<BleArrival>
+    BleTrafficModel::GetArrivals (Time start, Time stop)
+    {
+      NS_LOG_FUNCTION (this << start << stop);
+      std::vector<BleArrival> arrivals;
+      if (start < stop)
+      {
+        DoGetArrivals (start, stop, arrivals);
+      }
+      // A jitter larger than the interval swaps packets
+      if (!std::is_sorted (arrivals.begin (), arrivals.end (), EarlierArrival))
+      {
+        std::stable_sort (arrivals.begin (), arrivals.end (), EarlierArrival);
+      }
+      NS_LOG_INFO (arrivals.size () << " arrivals");
+      return arrivals;
+    }
+
+  int64_t
+    BleTrafficModel::AssignStreams (int64_t stream)
+    {
+      return 0;
+    }
+
+  /*******************
+   * PERIODIC TRAFFIC *
+   *******************/
+
+  TypeId
+    BlePeriodicTraffic::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BlePeriodicTraffic")
+        .SetParent<BleTrafficModel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BlePeriodicTraffic> ()
+        .AddAttribute ("Interval", "Time between two packets",
+            TimeValue (Seconds (1)),
+            MakeTimeAccessor (&BlePeriodicTraffic::m_interval),
+            MakeTimeChecker ())
+        .AddAttribute ("Jitter",
+            "Every packet is delayed by a uniform time up to Jitter, "
+            "without moving the next ones",
+            TimeValue (Seconds (0)),
+            MakeTimeAccessor (&BlePeriodicTraffic::m_jitter),
+            MakeTimeChecker ())
+        ;
+      return tid;
+    }
+
+  BlePeriodicTraffic::BlePeriodicTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+    m_jitterVariable = CreateObject<UniformRandomVariable> ();
+  }
+
+  BlePeriodicTraffic::~BlePeriodicTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BlePeriodicTraffic::DoDispose (void)
+    {
+      m_jitterVariable = 0;
+      BleTrafficModel::DoDispose ();
+    }
+
+  int64_t
+    BlePeriodicTraffic::AssignStreams (int64_t stream)
+    {
+      m_jitterVariable->SetStream (stream);
+      return 1;
+    }
+
+  void
+    BlePeriodicTraffic::DoGetArrivals (Time start, Time stop,
+        std::vector<BleArrival> &arrivals)
+    {
+      NS_ABORT_MSG_UNLESS (m_interval.IsStrictlyPositive (),
+          "The interval must be positive");
+      arrivals.reserve ((stop - start).GetSeconds () / m_interval.GetSeconds ()
+          + 1);
+      for (Time t = start; t < stop; t += m_interval)
+      {
+        Time arrival = t;
+        if (m_jitter.IsStrictlyPositive ())
+        {
+          arrival += Seconds (
+              m_jitterVariable->GetValue (0, m_jitter.GetSeconds ()));
+        }
+        if (arrival < stop)
+        {
+          arrivals.push_back (BleArrival {arrival, 0});
+        }
+      }
+    }
+
+  /******************
+   * POISSON TRAFFIC *
+   ******************/
+
+  TypeId
+    BlePoissonTraffic::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BlePoissonTraffic")
+        .SetParent<BleTrafficModel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BlePoissonTraffic> ()
+        .AddAttribute ("Rate", "Mean number of packets per second",
+            DoubleValue (1),
+            MakeDoubleAccessor (&BlePoissonTraffic::m_rate),
+            MakeDoubleChecker<double> (0))
+        ;
+      return tid;
+    }
+
+  BlePoissonTraffic::BlePoissonTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+    m_interval = CreateObject<ExponentialRandomVariable> ();
+  }
+
+  BlePoissonTraffic::~BlePoissonTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BlePoissonTraffic::DoDispose (void)
+    {
+      m_interval = 0;
+      BleTrafficModel::DoDispose ();
+    }
+
+  int64_t
+    BlePoissonTraffic::AssignStreams (int64_t stream)
+    {
+      m_interval->SetStream (stream);
+      return 1;
+    }
+
+  void
+    BlePoissonTraffic::DoGetArrivals (Time start, Time stop,
+        std::vector<BleArrival> &arrivals)
+    {
+      if (m_rate <= 0)
+        return;
+      double mean = 1 / m_rate;
+      arrivals.reserve ((stop - start).GetSeconds () * m_rate * 1.1 + 1);
+      // No upper bound on the exponential times
+      Time t = start + Seconds (m_interval->GetValue (mean, 0));
+      while (t < stop)
+      {
+        arrivals.push_back (BleArrival {t, 0});
+        t += Seconds (m_interval->GetValue (mean, 0));
+      }
+    }
+
+  /*****************
+   * ON OFF TRAFFIC *
+   *****************/
+
+  TypeId
+    BleOnOffTraffic::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleOnOffTraffic")
+        .SetParent<BleTrafficModel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleOnOffTraffic> ()
+        .AddAttribute ("Interval", "Time between two packets of a burst",
+            TimeValue (MilliSeconds (100)),
+            MakeTimeAccessor (&BleOnOffTraffic::m_interval),
+            MakeTimeChecker ())
+        .AddAttribute ("OnTime",
+            "A random variable for the length of a burst in seconds",
+            StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+            MakePointerAccessor (&BleOnOffTraffic::m_onTime),
+            MakePointerChecker <RandomVariableStream> ())
+        .AddAttribute ("OffTime",
+            "A random variable for the silence after a burst in seconds",
+            StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+            MakePointerAccessor (&BleOnOffTraffic::m_offTime),
+            MakePointerChecker <RandomVariableStream> ())
+        ;
+      return tid;
+    }
+
+  BleOnOffTraffic::BleOnOffTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleOnOffTraffic::~BleOnOffTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleOnOffTraffic::DoDispose (void)
+    {
+      m_onTime = 0;
+      m_offTime = 0;
+      BleTrafficModel::DoDispose ();
+    }
+
+  int64_t
+    BleOnOffTraffic::AssignStreams (int64_t stream)
+    {
+      m_onTime->SetStream (stream);
+      m_offTime->SetStream (stream + 1);
+      return 2;
+    }
+
+  void
+    BleOnOffTraffic::DoGetArrivals (Time start, Time stop,
+        std::vector<BleArrival> &arrivals)
+    {
+      NS_ABORT_MSG_UNLESS (m_interval.IsStrictlyPositive (),
+          "The interval must be positive");
+      Time t = start;
+      while (t < stop)
+      {
+        Time onTime = Seconds (m_onTime->GetValue ());
+        Time offTime = Seconds (m_offTime->GetValue ());
+        NS_ABORT_MSG_UNLESS ((onTime + offTime).IsStrictlyPositive (),
+            "OnTime plus OffTime must be positive");
+        Time burstEnd = t + onTime;
+        for (; t < burstEnd && t < stop; t += m_interval)
+        {
+          arrivals.push_back (BleArrival {t, 0});
+        }
+        // The last packet of the burst may end after the off time
+        t = std::max (t, burstEnd + offTime);
+      }
+    }
+
+  /****************
+   * TRACE TRAFFIC *
+   ****************/
+
+  TypeId
+    BleTraceTraffic::GetTypeId (void)
+    {
+      static TypeId tid = TypeId ("ns3::BleTraceTraffic")
+        .SetParent<BleTrafficModel> ()
+        .SetGroupName("Ble")
+        .AddConstructor<BleTraceTraffic> ()
+        .AddAttribute ("FileName",
+            "CSV file with a \"time[,size]\" line per packet",
+            StringValue (""),
+            MakeStringAccessor (&BleTraceTraffic::m_filename),
+            MakeStringChecker ())
+        .AddAttribute ("Loop", "Replay the file until the application stops",
+            BooleanValue (false),
+            MakeBooleanAccessor (&BleTraceTraffic::m_loop),
+            MakeBooleanChecker ())
+        ;
+      return tid;
+    }
+
+  BleTraceTraffic::BleTraceTraffic ()
+    : m_loop (false)
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  BleTraceTraffic::~BleTraceTraffic ()
+  {
+    NS_LOG_FUNCTION (this);
+  }
+
+  void
+    BleTraceTraffic::DoDispose (void)
+    {
+      ReleaseLog ();
+      BleTrafficModel::DoDispose ();
+    }
+
+  std::map<std::string, Ptr<BleTraceTraffic::Log> > &
+    BleTraceTraffic::GetLogs (void)
+    {
+      static std::map<std::string, Ptr<Log> > logs;
+      return logs;
+    }
+
+  void
+    BleTraceTraffic::ReleaseLog (void)
+    {
+      if (m_log == 0)
+        return;
+      std::string filename = m_log->filename;
+      m_log = 0;
+      std::map<std::string, Ptr<Log> > &logs = GetLogs ();
+      std::map<std::string, Ptr<Log> >::iterator it = logs.find (filename);
+      // Only the map still holds it
+      if (it != logs.end () && it->second->GetReferenceCount () == 1)
+        logs.erase (it);
+    }
+
+  Ptr<BleTraceTraffic::Log>
+    BleTraceTraffic::GetLog (std::string filename)
+    {
+      std::map<std::string, Ptr<Log> > &logs = GetLogs ();
+      std::map<std::string, Ptr<Log> >::iterator it = logs.find (filename);
+      if (it != logs.end ())
+        return it->second;
+
+      std::ifstream file (filename.c_str ());
+      NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open " << filename);
+      Ptr<Log> parsed = Create<Log> ();
+      parsed->filename = filename;
+      logs[filename] = parsed;
+      std::vector<BleArrival> &log = parsed->arrivals;
+      std::string line;
+      uint32_t lineNumber = 0;
+      double first = 0;
+      double previous = 0;
+      while (std::getline (file, line))
+      {
+        lineNumber++;
+        if (line.empty () || line[0] == '#' || line[0] == '\r')
+          continue;
+        std::replace (line.begin (), line.end (), ',', ' ');
+        std::istringstream fields (line);
+        double time;
+        if (! (fields >> time))
+        {
+          NS_ABORT_MSG_UNLESS (log.empty (), filename << ":" << lineNumber
+              << ": expected \"time[,size]\"");
+          continue; // Header
+        }
+        uint32_t size = 0;
+        fields >> size;
+        if (log.empty ())
+          first = time;
+        NS_ABORT_MSG_IF (time < previous, filename << ":" << lineNumber
+            << ": the times must increase");
+        previous = time;
+        log.push_back (BleArrival {Seconds (time - first), size});
+      }
+      NS_LOG_INFO ("Read " << log.size () << " packets from " << filename);
+      return parsed;
+    }
+
+  void
+    BleTraceTraffic::DoGetArrivals (Time start, Time stop,
+        std::vector<BleArrival> &arrivals)
+    {
+      if (m_log == 0 || m_log->filename != m_filename)
+      {
+        ReleaseLog ();
+        m_log = GetLog (m_filename);
+      }
+      const std::vector<BleArrival> &log = m_log->arrivals;
+      if (log.empty ())
+        return;
+      Time period;
+      if (m_loop)
+      {
+        NS_ABORT_MSG_IF (log.size () < 2,
+            "Cannot loop a log with less than 2 packets");
+        period = log.back ().time + log[1].time;
+        NS_ABORT_MSG_UNLESS (period.IsStrictlyPositive (),
+            "Cannot loop a log without time between its packets");
+      }
+      for (Time offset = start; offset < stop; offset += period)
+      {
+        for (const BleArrival &arrival : log)
+        {
+          if (offset + arrival.time >= stop)
+            return;
+          arrivals.push_back (BleArrival {offset + arrival.time,
+              arrival.size});
+        }
+        if (! m_loop)
+          return;
+      }
+    }
+
+} // namespace ns3
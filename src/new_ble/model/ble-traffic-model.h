@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef BLE_TRAFFIC_MODEL_H
+#define BLE_TRAFFIC_MODEL_H
+
+// Includes
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/random-variable-stream.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+  // Classes
+
+/**
+ * \ingroup ble
+ * \brief One packet of a traffic model
+ */
+  struct BleArrival
+  {
+    Time time; // Absolute time at which the packet is handed to the device
+    uint32_t size; // 0 to use the DataSize of the application
+  };
+
+/**
+ * \ingroup ble
+ * \brief Arrival process of a BleApplication
+ *
+ * The application asks for all arrivals of its lifetime at once when it
+ * starts, so the random variables are drawn in one go and the traffic
+ * of a node does not depend on the order in which the events of other
+ * nodes consume random numbers. Subclasses only implement
+ * DoGetArrivals.
+ */
+  class BleTrafficModel : public Object
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleTrafficModel ();
+      virtual ~BleTrafficModel ();
+
+      /**
+       * \param start the time of the first possible arrival
+       * \param stop no arrivals at or after this time
+       * \returns the arrivals in increasing order of time
+       */
+      std::vector<BleArrival> GetArrivals (Time start, Time stop);
+
+      /**
+       * Assign fixed random variable stream numbers to the random
+       * variables of the model
+       *
+       * \param stream first stream index to use
+       * \returns the number of stream indices assigned
+       */
+      virtual int64_t AssignStreams (int64_t stream);
+
+    protected:
+      virtual void DoGetArrivals (Time start, Time stop,
+          std::vector<BleArrival> &arrivals) = 0;
+  };
+
+/**
+ * \ingroup ble
+ * \brief A packet every Interval, optionally with a uniform jitter
+ */
+  class BlePeriodicTraffic : public BleTrafficModel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BlePeriodicTraffic ();
+      virtual ~BlePeriodicTraffic ();
+      virtual int64_t AssignStreams (int64_t stream);
+
+    protected:
+      virtual void DoDispose (void);
+      virtual void DoGetArrivals (Time start, Time stop,
+          std::vector<BleArrival> &arrivals);
+
+    private:
+      Time m_interval;
+      Time m_jitter; // Every arrival moves up to m_jitter later
+      Ptr<UniformRandomVariable> m_jitterVariable;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Poisson arrivals: exponential times between the packets
+ */
+  class BlePoissonTraffic : public BleTrafficModel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BlePoissonTraffic ();
+      virtual ~BlePoissonTraffic ();
+      virtual int64_t AssignStreams (int64_t stream);
+
+    protected:
+      virtual void DoDispose (void);
+      virtual void DoGetArrivals (Time start, Time stop,
+          std::vector<BleArrival> &arrivals);
+
+    private:
+      double m_rate; // Packets per second
+      Ptr<ExponentialRandomVariable> m_interval;
+  };
+
+/**
+ * \ingroup ble
+ * \brief Bursts of periodic packets separated by silent periods
+ *
+ * The application alternates between an on period, in which it sends a
+ * packet every Interval, and an off period, as the OnOffApplication of
+ * the applications module. The lengths of both periods are drawn from
+ * OnTime and OffTime.
+ */
+  class BleOnOffTraffic : public BleTrafficModel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleOnOffTraffic ();
+      virtual ~BleOnOffTraffic ();
+      virtual int64_t AssignStreams (int64_t stream);
+
+    protected:
+      virtual void DoDispose (void);
+      virtual void DoGetArrivals (Time start, Time stop,
+          std::vector<BleArrival> &arrivals);
+
+    private:
+      Time m_interval;
+      Ptr<RandomVariableStream> m_onTime; // Seconds
+      Ptr<RandomVariableStream> m_offTime; // Seconds
+  };
+
+/**
+ * \ingroup ble
+ * \brief Replays the timestamps of a log file
+ *
+ * Every line of FileName holds "time[,size]", with the time in seconds
+ * and the size in bytes; empty lines, lines starting with # and a header
+ * line are skipped. The times are relative to the first line, so logs
+ * with absolute timestamps can be replayed as they are. With Loop the
+ * log starts again after its last line (plus the time between its first
+ * two lines) until the application stops. Every file is parsed only
+ * once, all applications replaying it share the parsed log. The log is
+ * freed when the last of them is disposed, so a file written again
+ * between two simulations is read again.
+ */
+  class BleTraceTraffic : public BleTrafficModel
+  {
+    public:
+      static TypeId GetTypeId (void);
+
+      BleTraceTraffic ();
+      virtual ~BleTraceTraffic ();
+
+    protected:
+      virtual void DoDispose (void);
+      virtual void DoGetArrivals (Time start, Time stop,
+          std::vector<BleArrival> &arrivals);
+
+    private:
+      struct Log : public SimpleRefCount<Log>
+      {
+        std::string filename;
+        std::vector<BleArrival> arrivals; // Times relative to line one
+      };
+
+      // The parsed logs, shared by the models replaying the same file
+      static std::map<std::string, Ptr<Log> > &GetLogs (void);
+      static Ptr<Log> GetLog (std::string filename);
+      // Drop m_log, and the parsed file when no other model uses it
+      void ReleaseLog (void);
+
+      std::string m_filename;
+      bool m_loop;
+      Ptr<Log> m_log;
+  };
+
+} // namespace ns3
+
+#endif /* BLE_TRAFFIC_MODEL_H */
@@ -23,10 +23,23 @@
 #define BLE_CONSTANTS_H
 
 #include <ns3/nstime.h>
+#include <ns3/log.h>
 
 #define BLE_CONST_TIME_UNIT Time::Unit::US
-#define QUEUE_SIZE_PACKETS "100p" // Max number of packets in the queue
+#define QUEUE_SIZE_PACKETS 100 // Max number of packets in a queue
 #define T_IFS 150 // microseconds
 #define PRECISION 100 // In NanoSeconds
+#define LE_1M_BITRATE 1000000 // bps, symbol rate of the LE 1M PHY
+#define CRC_BITS 24 // Link layer CRC after the PDU
+
+// Function-entry logging for accessors on the per-packet path.
+// Configuring with --enable-ble-fast-path defines NS3_BLE_FAST_PATH,
+// which compiles these out even in debug builds, so a debug build can
+// be profiled without paying for NS_LOG_FUNCTION in every getter.
+#ifdef NS3_BLE_FAST_PATH
+#define BLE_LOG_FUNCTION(parameters)
+#else
+#define BLE_LOG_FUNCTION(parameters) NS_LOG_FUNCTION (parameters)
+#endif
 
 #endif // BLE_CONSTANTS_H
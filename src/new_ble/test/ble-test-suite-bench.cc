@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: agent <agent@local>
+ */
+
+
+#include <ns3/log.h>
+#include <ns3/core-module.h>
+#include <ns3/ble-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/system-wall-clock-ms.h>
+#include <ns3/trace-helper.h>
+#include <fstream>
+#include <sstream>
+
+#include "ns3/test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ble-test-bench");
+
+// Scalability test case: builds one topology, runs it and appends the
+// simulator cost to ble-bench.csv in the temporary directory of the test
+// run. The examples/ble-bench program sweeps the same parameters from the
+// command line, also for the networks of thousands of nodes that are too
+// slow for a test suite.
+class BleBenchTestCase : public TestCase
+{
+public:
+  BleBenchTestCase (std::string topology, uint32_t nNodes,
+      uint32_t nbConnInterval, double interval, double duration);
+  virtual ~BleBenchTestCase ();
+
+  void Received (const Ptr<const Packet> packet);
+  void ReceivedBroadcast (
+      const Ptr<const Packet> packet, const Ptr<const BleNetDevice> netdevice);
+
+private:
+  virtual void DoRun (void);
+
+  std::string m_topology;
+  uint32_t m_nNodes;
+  uint32_t m_nbConnInterval;
+  double m_interval;
+  double m_duration;
+  uint64_t m_nbRx;
+};
+
+static std::string
+BenchName (std::string topology, uint32_t nNodes, uint32_t nbConnInterval)
+{
+  std::ostringstream oss;
+  oss << "Ble bench " << topology << " " << nNodes << " nodes, "
+    << "conn interval " << nbConnInterval;
+  return oss.str ();
+}
+
+BleBenchTestCase::BleBenchTestCase (std::string topology, uint32_t nNodes,
+    uint32_t nbConnInterval, double interval, double duration)
+  : TestCase (BenchName (topology, nNodes, nbConnInterval)),
+    m_topology (topology),
+    m_nNodes (nNodes),
+    m_nbConnInterval (nbConnInterval),
+    m_interval (interval),
+    m_duration (duration),
+    m_nbRx (0)
+{
+}
+
+BleBenchTestCase::~BleBenchTestCase ()
+{
+}
+
+void
+BleBenchTestCase::Received (const Ptr<const Packet> packet)
+{
+  m_nbRx++;
+}
+
+void
+BleBenchTestCase::ReceivedBroadcast (const Ptr<const Packet> packet,
+    const Ptr<const BleNetDevice> netdevice)
+{
+  m_nbRx++;
+}
+
+void
+BleBenchTestCase::DoRun (void)
+{
+  m_nbRx = 0;
+  SystemWallClockMs clock;
+
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (m_nNodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+      "DeltaX", DoubleValue (1.0), "DeltaY", DoubleValue (1.0),
+      "GridWidth", UintegerValue (30), "Z", DoubleValue (1.0));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (bleDeviceNodes);
+
+  NetDeviceContainer bleNetDevices = helper.Install (bleDeviceNodes);
+  for (uint32_t nodeI = 0; nodeI < m_nNodes; nodeI++)
+    {
+      uint8_t buffer[2];
+      buffer[0] = ((nodeI + 1) >> 8) & 0xff;
+      buffer[1] = (nodeI + 1) & 0xff;
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      Ptr<BleNetDevice> nd =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI));
+      nd->SetAddress (address);
+      nd->TraceConnectWithoutContext ("MacRx", MakeCallback (
+            &BleBenchTestCase::Received, this));
+      nd->TraceConnectWithoutContext ("MacRxBroadcast", MakeCallback (
+            &BleBenchTestCase::ReceivedBroadcast, this));
+    }
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (m_interval));
+  if (m_topology == "mesh")
+    {
+      helper.CreateAllLinks (bleNetDevices, true, m_nbConnInterval);
+      helper.GenerateTraffic (
+          randT, bleDeviceNodes, 20, 0, m_duration, m_interval);
+    }
+  else if (m_topology == "broadcast")
+    {
+      helper.CreateBroadcastLink (bleNetDevices, true, m_nbConnInterval, true);
+      helper.GenerateBroadcastTraffic (
+          randT, bleDeviceNodes, 20, 0, m_duration, m_interval);
+    }
+  else
+    {
+      Ptr<BleBBManager> hub = DynamicCast<BleNetDevice> (
+          bleNetDevices.Get (0))->GetBBManager ();
+      for (uint32_t nodeI = 1; nodeI < m_nNodes; nodeI++)
+        {
+          DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+            ->GetBBManager ()->CreateLinkScheduled (hub,
+                BleLinkManager::Role::MASTER_ROLE, true, nodeI - 1,
+                m_nbConnInterval);
+          helper.GenerateTraffic (randT, bleDeviceNodes.Get (nodeI), 20, 0,
+              m_duration, m_interval, bleDeviceNodes.Get (0));
+        }
+    }
+
+  clock.Start ();
+  Simulator::Stop (Seconds (m_duration));
+  Simulator::Run ();
+  int64_t runMs = clock.End ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (events, 0u, "No events were executed");
+  NS_TEST_ASSERT_MSG_GT (m_nbRx, 0u, "No packets were received");
+
+  // One file per test run, every case of the suite adds its row
+  std::string filename = CreateTempDirFilename ("ble-bench.csv");
+  bool exists = std::ifstream (filename.c_str ()).good ();
+  AsciiTraceHelper ascii;
+  Ptr<OutputStreamWrapper> stream =
+    ascii.CreateFileStream (filename, std::ios::app);
+  if (!exists)
+    {
+      *stream->GetStream () << "topology,nodes,connInterval,interval,"
+        "duration,runMs,events,eventsPerWallSecond,eventsPerSimSecond,rx"
+        << std::endl;
+    }
+  *stream->GetStream () << m_topology << "," << m_nNodes << ","
+    << m_nbConnInterval << "," << m_interval << "," << m_duration << ","
+    << runMs << "," << events << ","
+    << (runMs > 0 ? events * 1000.0 / runMs : 0) << ","
+    << events / m_duration << "," << m_nbRx << std::endl;
+}
+
+
+// Each size class is registered with a duration so that the quick test
+// run only pays for the small networks.
+class BleTestSuiteBench : public TestSuite
+{
+public:
+  BleTestSuiteBench ();
+};
+
+BleTestSuiteBench::BleTestSuiteBench ()
+  : TestSuite ("ble-bench", PERFORMANCE)
+{
+  // With scheduled windows every link on a node takes 6 slots of the
+  // connection interval, so the interval grows with the node degree.
+  // The broadcast link starts after n(n+1)/2 offsets and lets one node
+  // advertise per interval, so it needs short intervals and longer runs.
+  AddTestCase (new BleBenchTestCase ("star", 10, 800, 1, 10),
+      TestCase::QUICK);
+  AddTestCase (new BleBenchTestCase ("mesh", 10, 800, 1, 10),
+      TestCase::QUICK);
+  AddTestCase (new BleBenchTestCase ("broadcast", 10, 800, 1, 10),
+      TestCase::QUICK);
+  AddTestCase (new BleBenchTestCase ("star", 100, 3200, 4, 10),
+      TestCase::EXTENSIVE);
+  AddTestCase (new BleBenchTestCase ("mesh", 30, 3200, 4, 10),
+      TestCase::EXTENSIVE);
+  AddTestCase (new BleBenchTestCase ("broadcast", 100, 80, 1, 60),
+      TestCase::EXTENSIVE);
+  AddTestCase (new BleBenchTestCase ("star", 500, 3200, 4, 10),
+      TestCase::TAKES_FOREVER);
+  AddTestCase (new BleBenchTestCase ("broadcast", 300, 80, 1, 400),
+      TestCase::TAKES_FOREVER);
+}
+
+static BleTestSuiteBench bleTestSuiteBench;
@@ -365,6 +365,143 @@ BleTestCaseBC::DoRun (void)
 
 
 
+
+// Floods mesh PDUs over a line of nodes that only hear their direct
+// neighbours, so the destination can only be reached through relays.
+class BleTestCaseMesh : public TestCase
+{
+public:
+  BleTestCaseMesh ();
+  virtual ~BleTestCaseMesh ();
+
+  void MeshRx (const Ptr<const Packet> packet);
+  void MeshRelay (const Ptr<const Packet> packet);
+  void MeshDuplicate (const Ptr<const Packet> packet);
+  void ReceivedBroadcast (
+      const Ptr<const Packet> packet, const Ptr<const BleNetDevice> netdevice);
+private:
+  virtual void DoRun (void);
+
+  Mac16Address m_source;
+  Mac16Address m_destination;
+  uint32_t m_nbRx;
+  uint32_t m_nbRelay;
+  uint32_t m_nbDuplicate;
+  uint32_t m_nbDirect; // Frames of the source heard by the destination
+};
+
+BleTestCaseMesh::BleTestCaseMesh ()
+  : TestCase ("Ble mesh managed flooding over relays"),
+    m_nbRx (0),
+    m_nbRelay (0),
+    m_nbDuplicate (0),
+    m_nbDirect (0)
+{
+}
+
+BleTestCaseMesh::~BleTestCaseMesh ()
+{
+}
+
+void
+BleTestCaseMesh::MeshRx (const Ptr<const Packet> packet)
+{
+  BleMeshHeader header;
+  packet->PeekHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (header.GetSrcAddr (), m_source, "Unexpected source");
+  m_nbRx++;
+}
+
+void
+BleTestCaseMesh::MeshRelay (const Ptr<const Packet> packet)
+{
+  m_nbRelay++;
+}
+
+void
+BleTestCaseMesh::MeshDuplicate (const Ptr<const Packet> packet)
+{
+  m_nbDuplicate++;
+}
+
+void
+BleTestCaseMesh::ReceivedBroadcast (const Ptr<const Packet> packet,
+    const Ptr<const BleNetDevice> netdevice)
+{
+  BleMacHeader header;
+  packet->PeekHeader (header);
+  if (netdevice->GetAddress16 () == m_destination
+      && header.GetSrcAddr () == m_source)
+    m_nbDirect++;
+}
+
+void
+BleTestCaseMesh::DoRun (void)
+{
+  uint32_t nNodes = 5;
+  double spacing = 70;
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> nodePositionList =
+    CreateObject<ListPositionAllocator> ();
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    nodePositionList->Add (Vector (nodeI * spacing, 0, 1.0));
+  mobility.SetPositionAllocator (nodePositionList);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (bleDeviceNodes);
+
+  NetDeviceContainer bleNetDevices = helper.Install (bleDeviceNodes);
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      uint8_t buffer[2] = {0, (uint8_t) (nodeI + 1)};
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      bleNetDevices.Get (nodeI)->SetAddress (address);
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacRxBroadcast",
+          MakeCallback (&BleTestCaseMesh::ReceivedBroadcast, this));
+    }
+  m_source = DynamicCast<BleNetDevice> (bleNetDevices.Get (0))
+    ->GetAddress16 ();
+  m_destination = DynamicCast<BleNetDevice> (bleNetDevices.Get (nNodes - 1))
+    ->GetAddress16 ();
+
+  helper.CreateBroadcastLink (bleNetDevices, true, 80, true);
+  helper.SetMeshAttribute ("RelayRetransmitCount", UintegerValue (1));
+  helper.InstallMesh (bleNetDevices);
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<BleMeshNetwork> mesh =
+        bleDeviceNodes.Get (nodeI)->GetObject<BleMeshNetwork> ();
+      NS_TEST_ASSERT_MSG_NE (mesh, 0, "No mesh layer installed");
+      mesh->TraceConnectWithoutContext ("Relay",
+          MakeCallback (&BleTestCaseMesh::MeshRelay, this));
+      mesh->TraceConnectWithoutContext ("Duplicate",
+          MakeCallback (&BleTestCaseMesh::MeshDuplicate, this));
+    }
+  bleDeviceNodes.Get (nNodes - 1)->GetObject<BleMeshNetwork> ()
+    ->TraceConnectWithoutContext ("Rx",
+        MakeCallback (&BleTestCaseMesh::MeshRx, this));
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (1));
+  helper.GenerateMeshTraffic (randT, bleDeviceNodes.Get (0), 20, 0, 10, 2,
+      m_destination);
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nbDirect, 0u,
+      "The destination hears the source, no relay needed");
+  NS_TEST_ASSERT_MSG_GT (m_nbRx, 0u, "No PDU reached the destination");
+  NS_TEST_ASSERT_MSG_GT (m_nbRelay, 0u, "No PDU relayed");
+  NS_TEST_ASSERT_MSG_GT (m_nbDuplicate, 0u, "No duplicate suppressed");
+
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -380,6 +517,7 @@ BleTestSuiteBroadcast::BleTestSuiteBroadcast ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new BleTestCaseBC, TestCase::QUICK);
+  AddTestCase (new BleTestCaseMesh, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -39,13 +39,17 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/spectrum-analyzer.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <ns3/isotropic-antenna-model.h>
 #include <ns3/trace-helper.h>
+#include <ns3/pcap-file.h>
 #include <ns3/drop-tail-queue.h>
 #include <unordered_map>
 #include "ns3/network-module.h"
 #include "ns3/csma-module.h"
 #include "ns3/internet-module.h"
+#include "ns3/sixlowpan-module.h"
 
 
 #include <ns3/okumura-hata-propagation-loss-model.h>
@@ -696,7 +700,1992 @@ BleTestCase4::DoRun (void)
   }
 }
 
+// Places the nodes at the given positions, without mobility, and installs
+// a BLE device on every node
+static NetDeviceContainer
+InstallAt (BleHelper &helper, NodeContainer nodes,
+           const std::vector<Vector> &positions)
+{
+  NS_ASSERT (nodes.GetN () == positions.size ());
+  Ptr<ListPositionAllocator> positionList =
+    CreateObject<ListPositionAllocator> ();
+  for (const Vector &position : positions)
+    positionList->Add (position);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (positionList);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+  return helper.Install (nodes);
+}
+
+// The positions of a GridPositionAllocator, row by row, 1 m above the
+// ground
+static std::vector<Vector>
+GridPositions (uint32_t n, double deltaX, double deltaY = 1.0,
+               uint32_t width = 10)
+{
+  std::vector<Vector> positions;
+  for (uint32_t i = 0; i < n; i++)
+    positions.push_back (Vector ((i % width) * deltaX, (i / width) * deltaY,
+                                 1.0));
+  return positions;
+}
+
+// Checks that the statistics collector attached by the helper agrees with
+// itself: node, link and channel counters cover the same events.
+class BleTestCaseStats : public TestCase
+{
+public:
+  BleTestCaseStats ();
+  virtual ~BleTestCaseStats ();
+
+  void Transmitted (const Ptr<const Packet> packet);
+  void ReceivedPromisc (const Ptr<const Packet> packet);
+private:
+  virtual void DoRun (void);
+
+  uint64_t m_nbTx;
+  uint64_t m_nbPromiscRx;
+};
+
+BleTestCaseStats::BleTestCaseStats ()
+  : TestCase ("Ble statistics collector counts per node, link and channel"),
+    m_nbTx (0),
+    m_nbPromiscRx (0)
+{
+}
+
+BleTestCaseStats::~BleTestCaseStats ()
+{
+}
+
+void
+BleTestCaseStats::Transmitted (const Ptr<const Packet> packet)
+{
+  m_nbTx++;
+}
+
+void
+BleTestCaseStats::ReceivedPromisc (const Ptr<const Packet> packet)
+{
+  m_nbPromiscRx++;
+}
+
+void
+BleTestCaseStats::DoRun (void)
+{
+  uint32_t nNodes = 5;
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, bleDeviceNodes, GridPositions (nNodes, 2.0));
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      uint8_t buffer[2] = {0, (uint8_t) (nodeI + 1)};
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      bleNetDevices.Get (nodeI)->SetAddress (address);
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacTx",
+          MakeCallback (&BleTestCaseStats::Transmitted, this));
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacPromiscRx",
+          MakeCallback (&BleTestCaseStats::ReceivedPromisc, this));
+    }
+  Ptr<BleStatsCollector> stats = helper.EnableStatistics (bleNetDevices);
+  helper.CreateAllLinks (bleNetDevices, true, 800);
+  randT->SetAttribute ("Max", DoubleValue (1));
+  helper.GenerateTraffic (randT, bleDeviceNodes, 20, 0, 10, 1);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  BleNodeStats total = stats->GetTotal ();
+  NS_TEST_ASSERT_MSG_EQ (total.tx, m_nbTx, "MacTx events lost");
+  NS_TEST_ASSERT_MSG_GT (total.rx, 0u, "No packets received");
+  NS_TEST_ASSERT_MSG_EQ (total.promiscRx, m_nbPromiscRx,
+      "MacPromiscRx events lost");
+  NS_TEST_ASSERT_MSG_GT (total.phyTx, total.tx, "Empty packets not counted");
+
+  uint64_t linkTx = 0, linkRx = 0, latencies = 0;
+  for (const auto &it : stats->GetAllLinkStats ())
+    {
+      linkTx += it.second.tx;
+      linkRx += it.second.rx;
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (it.second.retransmissions,
+          it.second.phyTx, "More retransmissions than transmissions");
+    }
+  for (const auto &it : stats->GetAllNodeStats ())
+    latencies += it.second.latency.GetCount ();
+  NS_TEST_ASSERT_MSG_EQ (linkTx, total.tx, "Link and node TX differ");
+  NS_TEST_ASSERT_MSG_EQ (linkRx, total.rx, "Link and node RX differ");
+  NS_TEST_ASSERT_MSG_GT (latencies, 0u, "No latency recorded");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (latencies, total.rx + total.rxBroadcast,
+      "Latency recorded twice for a packet");
+
+  uint64_t channelTx = 0;
+  for (uint8_t channel = 0; channel < BleStatsCollector::NB_CHANNELS;
+      channel++)
+    channelTx += stats->GetChannelStats (channel).phyTx;
+  NS_TEST_ASSERT_MSG_EQ (channelTx, total.phyTx, "Channel and node TX differ");
+
+  Simulator::Destroy ();
+}
+
+// Checks that lazily created neighbour links are only set up once they
+// are used, and that packets still get delivered over them.
+class BleTestCaseTopology : public TestCase
+{
+public:
+  BleTestCaseTopology ();
+  virtual ~BleTestCaseTopology ();
+
+  void Received (const Ptr<const Packet> packet);
+private:
+  virtual void DoRun (void);
+
+  uint64_t m_nbRx;
+};
+
+BleTestCaseTopology::BleTestCaseTopology ()
+  : TestCase ("Ble lazy links to the nearest devices"),
+    m_nbRx (0)
+{
+}
+
+BleTestCaseTopology::~BleTestCaseTopology ()
+{
+}
+
+void
+BleTestCaseTopology::Received (const Ptr<const Packet> packet)
+{
+  m_nbRx++;
+}
+
+void
+BleTestCaseTopology::DoRun (void)
+{
+  uint32_t nNodes = 8;
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, bleDeviceNodes, GridPositions (nNodes, 2.0));
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      uint8_t buffer[2] = {0, (uint8_t) (nodeI + 1)};
+      Mac16Address address;
+      address.CopyFrom (buffer);
+      bleNetDevices.Get (nodeI)->SetAddress (address);
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacRx",
+          MakeCallback (&BleTestCaseTopology::Received, this));
+    }
+  // On a line every device has a direct neighbour as nearest device
+  helper.CreateLinksToNearest (bleNetDevices, 1, true, 800, true);
+
+  uint32_t potentialLinks = 0, links = 0;
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<BleBBManager> bbManager =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+        ->GetBBManager ();
+      potentialLinks += bbManager->CountPotentialLinks ();
+      links += bbManager->CountLinks ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (links, 0u, "Lazy links created before use");
+  NS_TEST_ASSERT_MSG_EQ (potentialLinks, 2 * (nNodes - 1),
+      "Not linked to the nearest devices only");
+
+  // Node i sends to node i + 1 only, so node i becomes the master
+  randT->SetAttribute ("Max", DoubleValue (1));
+  helper.GenerateTraffic (randT, bleDeviceNodes, 20, 0, 10, 1);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  potentialLinks = 0;
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    potentialLinks += DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI))
+      ->GetBBManager ()->CountPotentialLinks ();
+  NS_TEST_ASSERT_MSG_EQ (potentialLinks, 0u, "Used links were not set up");
+  NS_TEST_ASSERT_MSG_GT (m_nbRx, 0u, "No packets received");
+
+  // An unused potential link does not keep its devices alive
+  Ptr<BleBBManager> a = CreateObject<BleBBManager> ();
+  Ptr<BleBBManager> b = CreateObject<BleBBManager> ();
+  Ptr<BleBBManager> c = CreateObject<BleBBManager> ();
+  a->AddPotentialLink (b, true, 0, 800);
+  a->AddPotentialLink (c, true, 0, 800);
+  NS_TEST_ASSERT_MSG_EQ (b->CountPotentialLinks (), 1u,
+      "Potential link not registered on both devices");
+  b->Dispose ();
+  NS_TEST_ASSERT_MSG_EQ (a->CountPotentialLinks (), 1u,
+      "Potential link of a disposed device kept");
+  NS_TEST_ASSERT_MSG_EQ (a->GetReferenceCount (), 1u,
+      "Potential link holds a reference");
+  a = 0;
+  NS_TEST_ASSERT_MSG_EQ (c->CountPotentialLinks (), 0u,
+      "Potential link of a destroyed device kept");
+
+  Simulator::Destroy ();
+}
+// Checks that UDP over IPv6 works in both directions of a connection
+// with 6LoWPAN on the BLE devices, and that the headers are compressed.
+class BleTestCaseSixLowPan : public TestCase
+{
+public:
+  BleTestCaseSixLowPan ();
+  virtual ~BleTestCaseSixLowPan ();
+
+  void MacTx (const Ptr<const Packet> packet);
+  void Received (Ptr<Socket> socket);
+  static void Send (Ptr<Socket> socket, uint32_t size);
+private:
+  virtual void DoRun (void);
+
+  uint64_t m_nbRx;
+  uint32_t m_maxUnicastSize; // Largest unicast packet on the link
+};
+
+BleTestCaseSixLowPan::BleTestCaseSixLowPan ()
+  : TestCase ("Ble IPv6 with 6LoWPAN header compression"),
+    m_nbRx (0),
+    m_maxUnicastSize (0)
+{
+}
+
+BleTestCaseSixLowPan::~BleTestCaseSixLowPan ()
+{
+}
+
+void
+BleTestCaseSixLowPan::MacTx (const Ptr<const Packet> packet)
+{
+  BleMacHeader header;
+  packet->PeekHeader (header);
+  if (header.GetDestAddr () != Mac16Address ("FF:FF"))
+    m_maxUnicastSize = std::max (m_maxUnicastSize,
+        packet->GetSize () - header.GetSerializedSize ());
+}
+
+void
+BleTestCaseSixLowPan::Received (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    m_nbRx++;
+}
+
+void
+BleTestCaseSixLowPan::Send (Ptr<Socket> socket, uint32_t size)
+{
+  socket->Send (Create<Packet> (size));
+}
+
+void
+BleTestCaseSixLowPan::DoRun (void)
+{
+  uint32_t nNodes = 2;
+  uint32_t payload = 20;
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (nNodes);
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, bleDeviceNodes, GridPositions (nNodes, 5.0));
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<BleNetDevice> device =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (nodeI));
+      device->GetPhy ()->SetAttribute ("DataRate",
+          DoubleValue (LE_1M_BITRATE));
+      device->TraceConnectWithoutContext ("MacTx",
+          MakeCallback (&BleTestCaseSixLowPan::MacTx, this));
+    }
+  helper.CreateAllLinks (bleNetDevices, true, 80);
+  helper.CreateBroadcastLink (bleNetDevices, true, 80, true);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (bleDeviceNodes);
+  NetDeviceContainer devices = helper.InstallSixLowPan (bleNetDevices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (devices);
+  SixLowPanHelper sixLowPan;
+  sixLowPan.AddContext (devices, 0, Ipv6Prefix ("2001:db8::", 64),
+      Seconds (10));
+  helper.PopulateNeighbourCaches (devices);
+
+  // Node 0 is the master of the connection, send 3 packets each way
+  // once Duplicate Address Detection is done
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  for (uint32_t nodeI = 0; nodeI < nNodes; nodeI++)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (bleDeviceNodes.Get (nodeI), tid);
+      sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+      sink->SetRecvCallback (
+          MakeCallback (&BleTestCaseSixLowPan::Received, this));
+      Ptr<Socket> source = Socket::CreateSocket (
+          bleDeviceNodes.Get (nodeI), tid);
+      source->Connect (Inet6SocketAddress (
+            interfaces.GetAddress (nNodes - 1 - nodeI, 1), 9));
+      for (uint32_t i = 0; i < 3; i++)
+        Simulator::Schedule (Seconds (2 + i),
+            &BleTestCaseSixLowPan::Send, source, payload);
+    }
+
+  Simulator::Stop (Seconds (6));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nbRx, 6u, "UDP packets lost");
+  // 48 bytes of IPv6 and UDP headers without compression
+  NS_TEST_ASSERT_MSG_GT (m_maxUnicastSize, payload, "No unicast packets");
+  NS_TEST_ASSERT_MSG_LT (m_maxUnicastSize, payload + 16,
+      "IPv6 and UDP headers not compressed");
+
+  Simulator::Destroy ();
+}
+
+// Checks that the samples of a sensor reach the collector in every GATT
+// mode, coalesced into fewer PDUs, after the MTU exchange.
+class BleTestCaseGatt : public TestCase
+{
+public:
+  BleTestCaseGatt ();
+  virtual ~BleTestCaseGatt ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BleTestCaseGatt::BleTestCaseGatt ()
+  : TestCase ("Ble GATT notifications, indications and write commands")
+{
+}
+
+BleTestCaseGatt::~BleTestCaseGatt ()
+{
+}
+
+void
+BleTestCaseGatt::DoRun (void)
+{
+  std::string modes[] = {"Notify", "Indicate", "WriteWithoutResponse"};
+  for (std::string mode : modes)
+    {
+      BleHelper helper;
+      NodeContainer bleDeviceNodes;
+      bleDeviceNodes.Create (2);
+      NetDeviceContainer bleNetDevices =
+        InstallAt (helper, bleDeviceNodes, GridPositions (2, 5.0));
+      helper.CreateAllLinks (bleNetDevices, true, 40);
+
+      // Node 1 is the sensor, 4 samples per PDU
+      helper.SetGattAttribute ("Mode", StringValue (mode));
+      helper.SetGattAttribute ("Mtu", UintegerValue (100));
+      helper.SetGattAttribute ("CoalesceSamples", UintegerValue (4));
+      Ptr<UniformRandomVariable> randT =
+        CreateObject<UniformRandomVariable> ();
+      randT->SetAttribute ("Max", DoubleValue (0));
+      ApplicationContainer apps = helper.GenerateGattTraffic (randT,
+          bleDeviceNodes.Get (1), bleDeviceNodes.Get (0), 8, 0, 5, 0.1);
+      Ptr<BleGattApplication> sensor =
+        DynamicCast<BleGattApplication> (apps.Get (0));
+      Ptr<BleGattApplication> collector =
+        DynamicCast<BleGattApplication> (apps.Get (1));
+
+      Simulator::Stop (Seconds (7));
+      Simulator::Run ();
+
+      NS_TEST_ASSERT_MSG_EQ (sensor->GetMtu (), 100, "MTU not exchanged");
+      NS_TEST_ASSERT_MSG_EQ (collector->GetMtu (), 100, "MTU not exchanged");
+      NS_TEST_ASSERT_MSG_GT (sensor->GetTxSamples (), 40u, "Too few samples");
+      // At most 3 samples wait for a full PDU when the sensor stops
+      NS_TEST_ASSERT_MSG_GT (collector->GetRxSamples () + 4,
+          sensor->GetTxSamples (), mode << " samples lost");
+      NS_TEST_ASSERT_MSG_EQ (collector->GetRxSamples (),
+          4 * sensor->GetTxPdus (), mode << " samples not coalesced");
+      NS_TEST_ASSERT_MSG_EQ (collector->GetRxBytes (),
+          8 * collector->GetRxSamples (), "Wrong attribute value size");
+
+      Simulator::Destroy ();
+    }
+}
+
+class BleTestCaseIso : public TestCase
+{
+public:
+  BleTestCaseIso ();
+  virtual ~BleTestCaseIso ();
+
+private:
+  virtual void DoRun (void);
+  void Acked (Ptr<const Packet> packet, Time delay);
+  void ReceivedBroadcast (Ptr<const Packet> packet,
+      Ptr<const BleNetDevice> netdevice);
+
+  Time m_maxDelay;
+  uint32_t m_rxBroadcast;
+};
+
+BleTestCaseIso::BleTestCaseIso ()
+  : TestCase ("Ble connected and broadcast isochronous streams")
+{
+}
+
+BleTestCaseIso::~BleTestCaseIso ()
+{
+}
+
+void
+BleTestCaseIso::Acked (Ptr<const Packet> packet, Time delay)
+{
+  m_maxDelay = Max (m_maxDelay, delay);
+}
+
+void
+BleTestCaseIso::ReceivedBroadcast (Ptr<const Packet> packet,
+    Ptr<const BleNetDevice> netdevice)
+{
+  m_rxBroadcast++;
+}
+
+void
+BleTestCaseIso::DoRun (void)
+{
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0));
+
+  // CIS in both directions, 10 ms ISO interval. Out of range every
+  // payload is flushed after the flush timeout.
+  double distances[] = {3.0, 3000.0};
+  for (double distance : distances)
+    {
+      BleHelper helper;
+      NodeContainer bleDeviceNodes;
+      bleDeviceNodes.Create (2);
+      NetDeviceContainer bleNetDevices =
+        InstallAt (helper, bleDeviceNodes, GridPositions (2, distance));
+      helper.CreateAllLinks (bleNetDevices, true, 8);
+      helper.SetIsoAttribute ("SubEvents", UintegerValue (3));
+      helper.SetIsoAttribute ("FlushTimeout", UintegerValue (2));
+      helper.EnableCis (bleNetDevices.Get (0), bleNetDevices.Get (1));
+      Ptr<BleNetDevice> nd0 = DynamicCast<BleNetDevice> (bleNetDevices.Get (0));
+      Ptr<BleNetDevice> nd1 = DynamicCast<BleNetDevice> (bleNetDevices.Get (1));
+      Ptr<BleIsoStream> master =
+        helper.GetIsoStream (nd0, nd1->GetAddress16 ());
+      Ptr<BleIsoStream> slave =
+        helper.GetIsoStream (nd1, nd0->GetAddress16 ());
+      NS_TEST_ASSERT_MSG_NE (master, 0, "No stream on the master");
+      NS_TEST_ASSERT_MSG_NE (slave, 0, "No stream on the slave");
+      m_maxDelay = Seconds (0);
+      master->TraceConnectWithoutContext ("Ack",
+          MakeCallback (&BleTestCaseIso::Acked, this));
+      slave->TraceConnectWithoutContext ("Ack",
+          MakeCallback (&BleTestCaseIso::Acked, this));
+
+      helper.GenerateTraffic (randT, bleDeviceNodes.Get (0), 20, 0, 2, 0.02,
+          bleDeviceNodes.Get (1));
+      helper.GenerateTraffic (randT, bleDeviceNodes.Get (1), 20, 0, 2, 0.02,
+          bleDeviceNodes.Get (0));
+
+      Simulator::Stop (Seconds (3));
+      Simulator::Run ();
+
+      Ptr<BleIsoStream> streams[] = {master, slave};
+      for (Ptr<BleIsoStream> tx : streams)
+        {
+          Ptr<BleIsoStream> rx = tx == master ? slave : master;
+          NS_TEST_ASSERT_MSG_GT (tx->GetTxPayloads (), 90u,
+              "Too few payloads");
+          NS_TEST_ASSERT_MSG_EQ (tx->GetAckedPayloads ()
+              + tx->GetFlushedPayloads (), tx->GetTxPayloads (),
+              "Payload neither acknowledged nor flushed");
+          if (distance < 1000)
+            {
+              NS_TEST_ASSERT_MSG_EQ (tx->GetFlushedPayloads (), 0,
+                  "Payload flushed in range");
+              NS_TEST_ASSERT_MSG_EQ (rx->GetRxPayloads (),
+                  tx->GetAckedPayloads (), "Payload lost");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (rx->GetRxPayloads (), 0,
+                  "Payload received out of range");
+            }
+        }
+      // Delivered within the flush timeout of 2 ISO intervals
+      NS_TEST_ASSERT_MSG_LT (m_maxDelay, MilliSeconds (20),
+          "Payload acknowledged after its flush point");
+
+      Simulator::Destroy ();
+    }
+
+  // BIS from node 0, every payload sent twice and received once
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (3);
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, bleDeviceNodes, GridPositions (3, 3.0, 3.0, 2));
+  helper.CreateBroadcastLink (bleNetDevices, true, 8, false);
+  helper.SetIsoAttribute ("SubEvents", UintegerValue (2));
+  helper.EnableBis (bleNetDevices);
+  m_rxBroadcast = 0;
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      bleNetDevices.Get (i)->TraceConnectWithoutContext ("MacRxBroadcast",
+          MakeCallback (&BleTestCaseIso::ReceivedBroadcast, this));
+    }
+  helper.GenerateBroadcastTraffic (randT, bleDeviceNodes.Get (0), 20, 0, 2,
+      0.02, 0);
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  Ptr<BleIsoStream> source =
+    helper.GetIsoStream (bleNetDevices.Get (0), Mac16Address ("FF:FF"));
+  NS_TEST_ASSERT_MSG_GT (source->GetTxPayloads (), 90u, "Too few payloads");
+  NS_TEST_ASSERT_MSG_EQ (source->GetTransmissions (),
+      2 * source->GetTxPayloads (), "Payloads not repeated");
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (helper.GetIsoStream (bleNetDevices.Get (i),
+            Mac16Address ("FF:FF"))->GetRxPayloads (),
+          source->GetTxPayloads (), "BIS payload lost");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_rxBroadcast, 2 * source->GetTxPayloads (),
+      "Duplicate BIS payload delivered");
+
+  Simulator::Destroy ();
+}
+
+/*
+ * Reception of a connection next to a 2.4 GHz Wi-Fi transmitter. The
+ * Wi-Fi signal is no BLE packet, but it must raise the bit error rate of
+ * every channel it covers, also when it starts before the BLE packet.
+ */
+class BleTestCaseCoexistence : public TestCase
+{
+public:
+  BleTestCaseCoexistence ();
+  virtual ~BleTestCaseCoexistence ();
+
+private:
+  virtual void DoRun (void);
+  void PhyRxEnd (Ptr<const Packet> packet, uint8_t channel, double rssi,
+      bool error);
+  uint32_t Run (bool wifi, double acsDb);
+
+  uint32_t m_rx;
+  uint32_t m_errors;
+};
+
+BleTestCaseCoexistence::BleTestCaseCoexistence ()
+  : TestCase ("BLE reception with Wi-Fi interferers")
+{
+}
+
+BleTestCaseCoexistence::~BleTestCaseCoexistence ()
+{
+}
+
+void
+BleTestCaseCoexistence::PhyRxEnd (Ptr<const Packet> packet, uint8_t channel,
+    double rssi, bool error)
+{
+  m_rx++;
+  if (error)
+    {
+      m_errors++;
+    }
+}
+
+uint32_t
+BleTestCaseCoexistence::Run (bool wifi, double acsDb)
+{
+  Config::SetDefault ("ns3::BlePhy::AdjacentChannelSelectivity1",
+      DoubleValue (acsDb));
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0));
+  BleHelper helper;
+  NodeContainer bleDeviceNodes;
+  bleDeviceNodes.Create (2);
+  NodeContainer wifiNodes;
+  wifiNodes.Create (1);
+  Ptr<ConstantPositionMobilityModel> wifiPosition =
+    CreateObject<ConstantPositionMobilityModel> ();
+  wifiPosition->SetPosition (Vector (2.5, 1.0, 1.0));
+  wifiNodes.Get (0)->AggregateObject (wifiPosition);
+
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, bleDeviceNodes, GridPositions (2, 5.0));
+  // The same channel maps and interferer phase in every run
+  helper.AssignStreams (bleNetDevices, 300);
+  helper.CreateAllLinks (bleNetDevices, true, 8);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      DynamicCast<BleNetDevice> (bleNetDevices.Get (i))->GetPhy ()
+        ->TraceConnectWithoutContext ("PhyRxEnd",
+            MakeCallback (&BleTestCaseCoexistence::PhyRxEnd, this));
+    }
+  if (wifi)
+    {
+      // Continuous, so every packet on channel 6 is hit
+      NetDeviceContainer interferers =
+        helper.AddWifiInterferers (wifiNodes, 6, 0, 1.0);
+      NS_TEST_EXPECT_MSG_EQ (interferers.GetN (), 1, "No interferer");
+    }
+  helper.GenerateTraffic (randT, bleDeviceNodes.Get (0), 20, 0, 2, 0.01,
+      bleDeviceNodes.Get (1));
+
+  m_rx = 0;
+  m_errors = 0;
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  // Interference next to the receive channel mostly breaks the access
+  // address, those packets never reach PhyRxEnd
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_errors += DynamicCast<BleNetDevice> (bleNetDevices.Get (i))->GetPhy ()
+        ->GetPreambleMisses ();
+    }
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_GT (m_rx, 100u, "Too few packets");
+  return m_errors;
+}
+
+void
+BleTestCaseCoexistence::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (Run (false, 38), 0, "Errors without interference");
+  // 0 dBm at 2.7 m drowns the packets inside the Wi-Fi channel, about a
+  // quarter of the data channels
+  uint32_t errors = Run (true, 38);
+  NS_TEST_ASSERT_MSG_GT (errors, 0u, "Wi-Fi interference ignored");
+  NS_TEST_ASSERT_MSG_LT (errors, m_rx / 2, "Wi-Fi hits too many channels");
+  // A worse receive filter also loses the channels next to it
+  uint32_t errorsNoAcs = Run (true, 0);
+  NS_TEST_ASSERT_MSG_GT (errorsNoAcs, errors,
+      "Adjacent channel selectivity ignored");
+  Config::SetDefault ("ns3::BlePhy::AdjacentChannelSelectivity1",
+      DoubleValue (38));
+}
+
+
+// Checks the arrival processes of the traffic models and the
+// destinations of the traffic patterns of the helper
+class BleTestCaseTraffic : public TestCase
+{
+public:
+  BleTestCaseTraffic ();
+  virtual ~BleTestCaseTraffic ();
+
+private:
+  virtual void DoRun (void);
+  void Received (uint32_t nodeId, Ptr<const Packet> packet);
+
+  std::vector<uint32_t> m_nbRx;
+};
+
+BleTestCaseTraffic::BleTestCaseTraffic ()
+  : TestCase ("Ble traffic models and traffic patterns")
+{
+}
+
+BleTestCaseTraffic::~BleTestCaseTraffic ()
+{
+}
+
+void
+BleTestCaseTraffic::Received (uint32_t nodeId, Ptr<const Packet> packet)
+{
+  m_nbRx[nodeId]++;
+}
+
+void
+BleTestCaseTraffic::DoRun (void)
+{
+  Ptr<BlePoissonTraffic> poisson = CreateObject<BlePoissonTraffic> ();
+  poisson->SetAttribute ("Rate", DoubleValue (100));
+  poisson->AssignStreams (1);
+  std::vector<BleArrival> arrivals =
+    poisson->GetArrivals (Seconds (1), Seconds (11));
+  NS_TEST_ASSERT_MSG_GT (arrivals.size (), 900u, "Poisson rate too low");
+  NS_TEST_ASSERT_MSG_LT (arrivals.size (), 1100u, "Poisson rate too high");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (arrivals.front ().time, Seconds (1),
+      "Arrival before the start");
+  for (uint32_t i = 1; i < arrivals.size (); i++)
+    NS_TEST_ASSERT_MSG_GT_OR_EQ (arrivals[i].time, arrivals[i - 1].time,
+        "Arrivals not in order");
+
+  // 5 bursts of 1 s with a packet every 100 ms
+  Ptr<BleOnOffTraffic> onOff = CreateObject<BleOnOffTraffic> ();
+  onOff->SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+  arrivals = onOff->GetArrivals (Seconds (0), Seconds (10));
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 50u, "Wrong on/off arrivals");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[10].time, Seconds (2),
+      "Off period ignored");
+  // The last packet of a burst ends after the short off period
+  onOff->SetAttribute ("OnTime",
+      StringValue ("ns3::ConstantRandomVariable[Constant=0.15]"));
+  onOff->SetAttribute ("OffTime",
+      StringValue ("ns3::ConstantRandomVariable[Constant=0.02]"));
+  arrivals = onOff->GetArrivals (Seconds (0), Seconds (1));
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 10u, "Wrong overlapping bursts");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[2].time, Seconds (0.2),
+      "Packets of a burst overlap");
+
+  // A jitter of several intervals still gives the arrivals in order
+  Ptr<BlePeriodicTraffic> periodic = CreateObject<BlePeriodicTraffic> ();
+  periodic->SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+  periodic->SetAttribute ("Jitter", TimeValue (MilliSeconds (50)));
+  periodic->AssignStreams (2);
+  arrivals = periodic->GetArrivals (Seconds (0), Seconds (1));
+  for (uint32_t i = 1; i < arrivals.size (); i++)
+    NS_TEST_ASSERT_MSG_GT_OR_EQ (arrivals[i].time, arrivals[i - 1].time,
+        "Jittered arrivals not in order");
+
+  // A log with absolute timestamps, replayed from 1 s
+  std::string filename = CreateTempDirFilename ("ble-traffic.csv");
+  std::ofstream log (filename.c_str ());
+  log << "time,size" << std::endl << "1000.0,10" << std::endl
+    << "1000.5" << std::endl << "1002.0,30" << std::endl;
+  log.close ();
+  Ptr<BleTraceTraffic> trace = CreateObject<BleTraceTraffic> ();
+  trace->SetAttribute ("FileName", StringValue (filename));
+  arrivals = trace->GetArrivals (Seconds (1), Seconds (10));
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 3u, "Wrong log replay");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[1].time, Seconds (1.5), "Wrong log time");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[1].size, 0u, "Wrong default size");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[2].size, 30u, "Wrong log size");
+  // Looped every 2.5 s: at 1, 3.5, 6 and 8.5 s
+  trace->SetAttribute ("Loop", BooleanValue (true));
+  arrivals = trace->GetArrivals (Seconds (1), Seconds (10));
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 11u, "Wrong looped replay");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[3].time, Seconds (3.5),
+      "Wrong loop period");
+  // Read again once the last model replaying it is gone
+  log.open (filename.c_str ());
+  log << "5.0,20" << std::endl;
+  log.close ();
+  trace->Dispose ();
+  trace = CreateObject<BleTraceTraffic> ();
+  trace->SetAttribute ("FileName", StringValue (filename));
+  arrivals = trace->GetArrivals (Seconds (1), Seconds (10));
+  NS_TEST_ASSERT_MSG_EQ (arrivals.size (), 1u, "Stale log replayed");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[0].size, 20u, "Stale log size");
+  trace->Dispose ();
+
+  // Number of flows of every pattern, with 20 packets per flow
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  BleHelper::TrafficPattern patterns[] = {BleHelper::CHAIN_PATTERN,
+    BleHelper::STAR_PATTERN, BleHelper::MANY_TO_ONE_PATTERN,
+    BleHelper::RANDOM_PATTERN};
+  uint32_t flows[] = {3, 6, 3, 4};
+  for (uint32_t p = 0; p < 4; p++)
+    {
+      BleHelper helper;
+      NodeContainer bleDeviceNodes;
+      bleDeviceNodes.Create (4);
+      NetDeviceContainer bleNetDevices = InstallAt (helper, bleDeviceNodes,
+          GridPositions (4, 2.0, 1.0, 2));
+      helper.CreateAllLinks (bleNetDevices, true, 40);
+      m_nbRx.assign (4, 0);
+      for (uint32_t nodeI = 0; nodeI < 4; nodeI++)
+        {
+          bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacRx",
+              MakeCallback (&BleTestCaseTraffic::Received, this)
+              .Bind (nodeI));
+        }
+      helper.SetTrafficModelAttribute ("Interval",
+          TimeValue (MilliSeconds (100)));
+      ApplicationContainer apps =
+        helper.GenerateTraffic (randT, bleDeviceNodes, patterns[p], 20, 0, 2);
+      NS_TEST_ASSERT_MSG_EQ (apps.GetN (), flows[p], "Wrong number of flows");
+
+      Simulator::Stop (Seconds (3));
+      Simulator::Run ();
+      uint32_t total = 0;
+      for (uint32_t nodeI = 0; nodeI < 4; nodeI++)
+        total += m_nbRx[nodeI];
+      NS_TEST_ASSERT_MSG_EQ (total, 20 * flows[p], "Packets lost");
+      if (patterns[p] == BleHelper::MANY_TO_ONE_PATTERN)
+        NS_TEST_ASSERT_MSG_EQ (m_nbRx[0], total, "Not all to node 0");
+      Simulator::Destroy ();
+    }
+}
+
+// Checks that a relay that is slave of one connection and master of
+// another serves both when their transmit windows always coincide.
+class BleTestCaseScatternet : public TestCase
+{
+public:
+  BleTestCaseScatternet ();
+  virtual ~BleTestCaseScatternet ();
+
+private:
+  virtual void DoRun (void);
+  void Received (uint32_t nodeId, Ptr<const Packet> packet);
+
+  std::vector<uint32_t> m_nbRx;
+};
+
+BleTestCaseScatternet::BleTestCaseScatternet ()
+  : TestCase ("Ble radio arbiter of a scatternet relay")
+{
+}
+
+BleTestCaseScatternet::~BleTestCaseScatternet ()
+{
+}
+
+void
+BleTestCaseScatternet::Received (uint32_t nodeId, Ptr<const Packet> packet)
+{
+  m_nbRx[nodeId]++;
+}
+
+void
+BleTestCaseScatternet::DoRun (void)
+{
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0));
+
+  // Node 0 -> relay 1 -> node 2, both connections with a 10 ms interval
+  // and the same anchor point, 30 packets per connection
+  bool edfs[] = {true, false};
+  for (bool edf : edfs)
+    {
+      BleHelper helper;
+      NodeContainer bleDeviceNodes;
+      bleDeviceNodes.Create (3);
+      NetDeviceContainer bleNetDevices =
+        InstallAt (helper, bleDeviceNodes, GridPositions (3, 2.0));
+      std::vector<Ptr<BleBBManager> > bbManagers;
+      m_nbRx.assign (3, 0);
+      for (uint32_t nodeI = 0; nodeI < 3; nodeI++)
+        {
+          bbManagers.push_back (DynamicCast<BleNetDevice> (
+                bleNetDevices.Get (nodeI))->GetBBManager ());
+          bbManagers[nodeI]->SetAttribute ("EarliestDeadlineFirst",
+              BooleanValue (edf));
+          bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacRx",
+              MakeCallback (&BleTestCaseScatternet::Received, this)
+              .Bind (nodeI));
+        }
+      bbManagers[0]->CreateLinkScheduled (bbManagers[1],
+          BleLinkManager::Role::MASTER_ROLE, true, 0, 8);
+      bbManagers[1]->CreateLinkScheduled (bbManagers[2],
+          BleLinkManager::Role::MASTER_ROLE, true, 0, 8);
+      helper.GenerateTraffic (randT, bleDeviceNodes.Get (0), 20, 0, 3, 0.1,
+          bleDeviceNodes.Get (1));
+      helper.GenerateTraffic (randT, bleDeviceNodes.Get (1), 20, 0, 3, 0.1,
+          bleDeviceNodes.Get (2));
+
+      Simulator::Stop (Seconds (4));
+      Simulator::Run ();
+
+      if (edf)
+        {
+          // The connections take turns
+          NS_TEST_ASSERT_MSG_EQ (m_nbRx[1], 30u, "Relay starved as slave");
+          NS_TEST_ASSERT_MSG_EQ (m_nbRx[2], 30u, "Relay starved as master");
+          NS_TEST_ASSERT_MSG_EQ (bbManagers[1]->GetDeadlineMisses (), 0u,
+              "Deadline missed");
+        }
+      else
+        {
+          // The connection set up first always gets the radio
+          NS_TEST_ASSERT_MSG_EQ (m_nbRx[2], 0u,
+              "Second connection served without arbitration");
+          NS_TEST_ASSERT_MSG_GT (bbManagers[1]->GetDeadlineMisses (), 0u,
+              "Starved connection not counted");
+        }
+      Simulator::Destroy ();
+    }
+}
+
+// Checks that a scenario file is built into positioned devices with
+// their links, data rate and traffic.
+class BleTestCaseScenario : public TestCase
+{
+public:
+  BleTestCaseScenario ();
+  virtual ~BleTestCaseScenario ();
+
+private:
+  virtual void DoRun (void);
+  void Received (uint32_t nodeId, Ptr<const Packet> packet);
+
+  std::vector<uint32_t> m_nbRx;
+};
+
+BleTestCaseScenario::BleTestCaseScenario ()
+  : TestCase ("Ble scenario file")
+{
+}
+
+BleTestCaseScenario::~BleTestCaseScenario ()
+{
+}
+
+void
+BleTestCaseScenario::Received (uint32_t nodeId, Ptr<const Packet> packet)
+{
+  m_nbRx[nodeId]++;
+}
+
+void
+BleTestCaseScenario::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("ble-scenario.csv");
+  std::ofstream file (filename.c_str ());
+  file << "# type,fields" << std::endl
+    << "conn,40,0" << std::endl
+    << "phy,1000000" << std::endl
+    << "node,0,0,1" << std::endl
+    << "node,2,0,1,4" << std::endl
+    << "node,0,2,1" << std::endl
+    << "link,0,1" << std::endl
+    << "link,0,2" << std::endl
+    << "traffic,1,0,20,0,2,0.1" << std::endl
+    << "traffic,2,0,20,0,1,0.1" << std::endl;
+  file.close ();
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.LoadScenario (filename, randT);
+  NS_TEST_ASSERT_MSG_EQ (bleNetDevices.GetN (), 3u, "Wrong number of devices");
+  Vector position = bleNetDevices.Get (1)->GetNode ()
+    ->GetObject<MobilityModel> ()->GetPosition ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (position.x, 2.0, 1e-9, "Wrong position");
+  NS_TEST_ASSERT_MSG_EQ_TOL (position.z, 1.0, 1e-9, "Wrong position");
+  DoubleValue dataRate;
+  DynamicCast<BleNetDevice> (bleNetDevices.Get (2))->GetPhy ()
+    ->GetAttribute ("DataRate", dataRate);
+  NS_TEST_ASSERT_MSG_EQ_TOL (dataRate.Get (), 1e6, 1e-9, "Wrong data rate");
+
+  m_nbRx.assign (3, 0);
+  for (uint32_t nodeI = 0; nodeI < 3; nodeI++)
+    {
+      bleNetDevices.Get (nodeI)->TraceConnectWithoutContext ("MacRx",
+          MakeCallback (&BleTestCaseScenario::Received, this).Bind (nodeI));
+    }
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_nbRx[0], 30u, "Traffic of the file not delivered");
+  Simulator::Destroy ();
+}
+
+// Checks the order, capacity, drops and hand-off of a BleRingQueue while
+// its ring wraps around and grows.
+class BleTestCaseRingQueue : public TestCase
+{
+public:
+  BleTestCaseRingQueue ();
+  virtual ~BleTestCaseRingQueue ();
+
+private:
+  virtual void DoRun (void);
+  void Traced (uint32_t *counter, Ptr<const QueueItem> item);
+};
+
+BleTestCaseRingQueue::BleTestCaseRingQueue ()
+  : TestCase ("Ble ring queue")
+{
+}
+
+BleTestCaseRingQueue::~BleTestCaseRingQueue ()
+{
+}
+
+void
+BleTestCaseRingQueue::Traced (uint32_t *counter, Ptr<const QueueItem> item)
+{
+  (*counter)++;
+}
+
+void
+BleTestCaseRingQueue::DoRun (void)
+{
+  Ptr<BleRingQueue> queue = CreateObject<BleRingQueue> ();
+  queue->SetAttribute ("Capacity", UintegerValue (10));
+  uint32_t enqueued = 0;
+  uint32_t dequeued = 0;
+  uint32_t dropped = 0;
+  queue->TraceConnectWithoutContext ("Enqueue",
+      MakeCallback (&BleTestCaseRingQueue::Traced, this).Bind (&enqueued));
+  queue->TraceConnectWithoutContext ("Dequeue",
+      MakeCallback (&BleTestCaseRingQueue::Traced, this).Bind (&dequeued));
+  queue->TraceConnectWithoutContext ("Drop",
+      MakeCallback (&BleTestCaseRingQueue::Traced, this).Bind (&dropped));
+  NS_TEST_ASSERT_MSG_EQ (queue->Dequeue (), 0, "Item of an empty queue");
+
+  // Packets of size 1, 2, ... so the order can be checked by size
+  uint32_t next = 1;
+  uint32_t expected = 1;
+  for (uint32_t round = 0; round < 5; round++)
+    {
+      for (uint32_t i = 0; i < 3 + round; i++)
+        queue->Enqueue (Create<QueueItem> (Create<Packet> (next++)));
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          Ptr<QueueItem> item = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (item->GetSize (), expected++, "Out of order");
+        }
+    }
+  // Full in the last two rounds: 25 offered, 7 dropped, 10 dequeued
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), 8u, "Capacity ignored");
+  NS_TEST_ASSERT_MSG_EQ (dropped, 7u, "Drops of a full queue not traced");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetTotalDroppedPackets (), 7u,
+      "Drops not counted");
+  NS_TEST_ASSERT_MSG_EQ (enqueued + dropped, 25u, "Enqueue not traced");
+  NS_TEST_ASSERT_MSG_EQ (dequeued, 10u, "Dequeue not traced");
+  NS_TEST_ASSERT_MSG_EQ (queue->Peek ()->GetSize (), expected,
+      "Wrong head after the wrap-around");
+
+  // Out of the middle of the wrapped ring
+  Ptr<const QueueItem> second = queue->Peek (2);
+  Ptr<const QueueItem> third = queue->Peek (3);
+  Ptr<const QueueItem> last = queue->Peek (7);
+  NS_TEST_ASSERT_MSG_EQ (queue->Remove (2), second, "Wrong item removed");
+  NS_TEST_ASSERT_MSG_EQ (queue->Peek (2), third, "Gap left by the removal");
+  queue->Drop (5);
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), 6u, "Items not taken out");
+  NS_TEST_ASSERT_MSG_EQ (queue->Peek (5), last, "Wrong item dropped");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetTotalDroppedPackets (), 8u,
+      "Drop not counted");
+  NS_TEST_ASSERT_MSG_EQ (queue->Peek (6), 0, "Item past the end");
+
+  Ptr<BleRingQueue> other = CreateObject<BleRingQueue> ();
+  Ptr<const QueueItem> head = queue->Peek ();
+  uint32_t bytes = queue->GetNBytes ();
+  NS_TEST_ASSERT_MSG_EQ (queue->MoveFrontTo (other), true, "Not moved");
+  NS_TEST_ASSERT_MSG_EQ (other->Peek (), head, "Item copied");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes () + other->GetNBytes (), bytes,
+      "Bytes lost in the hand-off");
+  while (queue->MoveFrontTo (other))
+    ;
+  NS_TEST_ASSERT_MSG_EQ (other->GetNPackets (), 6u, "Hand-off lost items");
+  NS_TEST_ASSERT_MSG_EQ (queue->IsEmpty (), true, "Hand-off left items");
+}
+
+// Checks that a queued packet keeps its MAC header parsed next to it and
+// that the header is serialized unchanged for transmission.
+class BleTestCaseMacQueueItem : public TestCase
+{
+public:
+  BleTestCaseMacQueueItem ();
+  virtual ~BleTestCaseMacQueueItem ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BleTestCaseMacQueueItem::BleTestCaseMacQueueItem ()
+  : TestCase ("Ble MAC header next to a queued packet")
+{
+}
+
+BleTestCaseMacQueueItem::~BleTestCaseMacQueueItem ()
+{
+}
+
+void
+BleTestCaseMacQueueItem::DoRun (void)
+{
+  BleMacHeader header;
+  header.SetSrcAddr (Mac16Address ("00:02"));
+  header.SetDestAddr (Mac16Address ("00:05"));
+  header.SetProtocol (0x86DD);
+  NS_TEST_ASSERT_MSG_EQ (header.IsBroadcast (), false, "Unicast broadcast");
+  Ptr<Packet> packet = Create<Packet> (20);
+  Ptr<BleMacQueueItem> item = Create<BleMacQueueItem> (packet, header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 20u, "Header added to the SDU");
+  NS_TEST_ASSERT_MSG_EQ (item->GetSize (), 20 + header.GetSerializedSize (),
+      "Header not counted in the queue");
+
+  Ptr<Packet> pdu = item->GetProtocolDataUnit ();
+  NS_TEST_ASSERT_MSG_EQ (pdu->GetUid (), packet->GetUid (),
+      "The PDU is another packet");
+  BleMacHeader parsed;
+  pdu->RemoveHeader (parsed);
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetDestAddr (), Mac16Address ("00:05"),
+      "Wrong destination");
+  NS_TEST_ASSERT_MSG_EQ (parsed.GetProtocol (), 0x86DD, "Wrong protocol");
+  NS_TEST_ASSERT_MSG_EQ (pdu->GetSize (), 20u, "Wrong payload");
+
+  header.SetDestAddr (BleMacHeader::GetBroadcastAddress ());
+  NS_TEST_ASSERT_MSG_EQ (header.IsBroadcast (), true, "Broadcast unicast");
+  NS_TEST_ASSERT_MSG_EQ (BleMacHeader::GetBroadcastAddress (),
+      Mac16Address ("FF:FF"), "Wrong broadcast address");
+}
+
+// A node far away is below the sensitivity of the receivers: the packets
+// between it and the master are counted as sensitivity drops and never
+// received, those of the nearby node are.
+class BleTestCaseSensitivity : public TestCase
+{
+public:
+  BleTestCaseSensitivity ();
+  virtual ~BleTestCaseSensitivity ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<const Packet> packet);
+
+  uint32_t m_nbRx;
+};
+
+BleTestCaseSensitivity::BleTestCaseSensitivity ()
+  : TestCase ("Ble receiver sensitivity"),
+  m_nbRx (0)
+{
+}
+
+BleTestCaseSensitivity::~BleTestCaseSensitivity ()
+{
+}
+
+void
+BleTestCaseSensitivity::Received (Ptr<const Packet> packet)
+{
+  m_nbRx++;
+}
+
+void
+BleTestCaseSensitivity::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("ble-sensitivity.csv");
+  std::ofstream file (filename.c_str ());
+  file << "conn,40" << std::endl
+    << "node,0,0,1" << std::endl
+    << "node,5,0,1" << std::endl
+    << "node,300,0,1" << std::endl
+    << "link,0,1" << std::endl
+    << "link,0,2" << std::endl
+    << "traffic,1,0,20,0,2,0.1" << std::endl
+    << "traffic,2,0,20,0,2,0.1" << std::endl;
+  file.close ();
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices = helper.LoadScenario (filename, randT);
+  bleNetDevices.Get (0)->TraceConnectWithoutContext ("MacRx",
+      MakeCallback (&BleTestCaseSensitivity::Received, this));
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  // The far node does not even hear the master of its link
+  Ptr<BlePhy> phy = DynamicCast<BleNetDevice> (bleNetDevices.Get (2))
+    ->GetPhy ();
+  NS_TEST_ASSERT_MSG_GT (phy->GetSensitivityDrops (), 0u,
+      "The far node hears the master");
+  NS_TEST_ASSERT_MSG_EQ (m_nbRx, 20u,
+      "Only the packets of the nearby node are received");
+  Simulator::Destroy ();
+}
+
+// The link-level abstraction runs the same stack: the nearby node is
+// received, the far one is below the sensitivity, and the PER table goes
+// from no errors at a high SINR to a lost packet at a low one.
+class BleTestCaseLinkAbstraction : public TestCase
+{
+public:
+  BleTestCaseLinkAbstraction ();
+  virtual ~BleTestCaseLinkAbstraction ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<const Packet> packet);
+
+  uint32_t m_nbRx;
+};
+
+BleTestCaseLinkAbstraction::BleTestCaseLinkAbstraction ()
+  : TestCase ("Ble link-level abstraction"),
+  m_nbRx (0)
+{
+}
+
+BleTestCaseLinkAbstraction::~BleTestCaseLinkAbstraction ()
+{
+}
+
+void
+BleTestCaseLinkAbstraction::Received (Ptr<const Packet> packet)
+{
+  m_nbRx++;
+}
+
+void
+BleTestCaseLinkAbstraction::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("ble-abstraction.csv");
+  std::ofstream file (filename.c_str ());
+  file << "conn,40" << std::endl
+    << "node,0,0,1" << std::endl
+    << "node,5,0,1" << std::endl
+    << "node,300,0,1" << std::endl
+    << "link,0,1" << std::endl
+    << "link,0,2" << std::endl
+    << "traffic,1,0,20,0,2,0.1" << std::endl
+    << "traffic,2,0,20,0,2,0.1" << std::endl;
+  file.close ();
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  BleHelper helper;
+  helper.SetLinkAbstraction (true);
+  NetDeviceContainer bleNetDevices = helper.LoadScenario (filename, randT);
+  Ptr<BleLinkChannel> channel = helper.GetLinkChannel ();
+  NS_TEST_ASSERT_MSG_EQ (bleNetDevices.Get (0)->GetChannel (), channel,
+      "Device not on the link channel");
+  NS_TEST_ASSERT_MSG_EQ (channel->GetNDevices (), 3u, "Wrong number of PHYs");
+  NS_TEST_ASSERT_MSG_EQ (channel->GetPer (1000, 1000), 0,
+      "Bit errors at 30 dB");
+  NS_TEST_ASSERT_MSG_GT (channel->GetPer (0.1, 100), 0.99,
+      "No bit errors at -10 dB");
+
+  bleNetDevices.Get (0)->TraceConnectWithoutContext ("MacRx",
+      MakeCallback (&BleTestCaseLinkAbstraction::Received, this));
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  Ptr<BlePhy> phy = DynamicCast<BleNetDevice> (bleNetDevices.Get (2))
+    ->GetPhy ();
+  NS_TEST_ASSERT_MSG_GT (phy->GetSensitivityDrops (), 0u,
+      "The far node hears the master");
+  NS_TEST_ASSERT_MSG_EQ (m_nbRx, 20u,
+      "Only the packets of the nearby node are received");
+  Simulator::Destroy ();
+}
+
+// Two links on channels next to each other, each receiver 3 m from a
+// transmitter of the other link and 5 m from its own, about 10 dB weaker.
+// The adjacent channel selectivity rejects the whole signal of the other
+// link, on the spectrum channel and on the link channel: with the default
+// 38 dB the links do not disturb each other, without it they do.
+class BleTestCaseAdjacentChannel : public TestCase
+{
+public:
+  BleTestCaseAdjacentChannel ();
+  virtual ~BleTestCaseAdjacentChannel ();
+
+private:
+  virtual void DoRun (void);
+  void PhyRxEnd (Ptr<const Packet> packet, uint8_t channel, double rssi,
+      bool error);
+  uint64_t Run (bool linkAbstraction, double acsDb);
+
+  uint32_t m_rx;
+};
+
+BleTestCaseAdjacentChannel::BleTestCaseAdjacentChannel ()
+  : TestCase ("Ble adjacent channel selectivity"),
+  m_rx (0)
+{
+}
+
+BleTestCaseAdjacentChannel::~BleTestCaseAdjacentChannel ()
+{
+}
+
+void
+BleTestCaseAdjacentChannel::PhyRxEnd (Ptr<const Packet> packet,
+    uint8_t channel, double rssi, bool error)
+{
+  m_rx++;
+}
+
+uint64_t
+BleTestCaseAdjacentChannel::Run (bool linkAbstraction, double acsDb)
+{
+  std::string filename = CreateTempDirFilename ("ble-adjacent.csv");
+  std::ofstream file (filename.c_str ());
+  file << "conn,8" << std::endl
+    << "node,0,0,1" << std::endl
+    << "node,5,0,1" << std::endl
+    << "node,0,3,1" << std::endl
+    << "node,5,3,1" << std::endl
+    << "link,0,1" << std::endl
+    << "link,3,2" << std::endl
+    << "traffic,0,1,20,0.1,2,0.01" << std::endl
+    << "traffic,1,0,20,0.1,2,0.01" << std::endl
+    << "traffic,2,3,20,0.1,2,0.01" << std::endl
+    << "traffic,3,2,20,0.1,2,0.01" << std::endl;
+  file.close ();
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.01));
+  randT->SetStream (400);
+  BleHelper helper;
+  helper.SetLinkAbstraction (linkAbstraction);
+  NetDeviceContainer bleNetDevices = helper.LoadScenario (filename, randT);
+  helper.AssignStreams (bleNetDevices, 401);
+  m_rx = 0;
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    {
+      Ptr<BleNetDevice> device =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (i));
+      device->GetPhy ()->SetAttribute ("AdjacentChannelSelectivity1",
+          DoubleValue (acsDb));
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd",
+          MakeCallback (&BleTestCaseAdjacentChannel::PhyRxEnd, this));
+      // Every event of a link on the same channel, next to the other one
+      Ptr<BleNetDevice> peer =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (i ^ 1));
+      device->GetBBManager ()->GetLinkManager (peer->GetAddress16 ())
+        ->SetUsedChannels (std::vector<uint8_t> (1, i < 2 ? 10 : 11));
+    }
+  Simulator::Stop (Seconds (2.5));
+  Simulator::Run ();
+  uint64_t errors = 0;
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    {
+      Ptr<BlePhy> phy =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (i))->GetPhy ();
+      errors += phy->GetPreambleMisses ();
+    }
+  Simulator::Destroy ();
+  return errors;
+}
+
+void
+BleTestCaseAdjacentChannel::DoRun (void)
+{
+  for (bool linkAbstraction : {false, true})
+    {
+      uint64_t errors = Run (linkAbstraction, 38);
+      NS_TEST_ASSERT_MSG_GT (m_rx, 100u, "Too few packets");
+      uint64_t errorsNoAcs = Run (linkAbstraction, 0);
+      NS_TEST_ASSERT_MSG_EQ (errors, 0u, "The adjacent link interferes");
+      NS_TEST_ASSERT_MSG_GT (errorsNoAcs, 0u,
+          "Adjacent channel selectivity ignored");
+    }
+}
+
+// The lookahead of a rank of a distributed simulation, computed without
+// MPI: the smallest delay to a node of every other system, out of range
+// too, below one bit as well, and again after the nodes moved.
+class BleTestCaseLookAhead : public TestCase
+{
+public:
+  BleTestCaseLookAhead ();
+  virtual ~BleTestCaseLookAhead ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BleTestCaseLookAhead::BleTestCaseLookAhead ()
+  : TestCase ("Ble lookahead between systems")
+{
+}
+
+BleTestCaseLookAhead::~BleTestCaseLookAhead ()
+{
+}
+
+void
+BleTestCaseLookAhead::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2, 0);
+  nodes.Create (1, 1);
+  BleHelper helper;
+  helper.SetLinkAbstraction (true);
+  InstallAt (helper, nodes, {Vector (0, 0, 1.0), Vector (3.0, 0, 1.0),
+                             Vector (200.0, 0, 1.0)});
+  Ptr<BleLinkChannel> channel = helper.GetLinkChannel ();
+  double speed = 299792458.0;
+  std::map<uint32_t, Time> lookAhead = channel->GetLookAhead (0);
+  NS_TEST_ASSERT_MSG_EQ (lookAhead.size (), 1, "Not one other system");
+  NS_TEST_ASSERT_MSG_EQ_TOL (lookAhead[1].GetSeconds (), 197.0 / speed,
+      1e-9, "Not the delay to the closest node");
+  lookAhead = channel->GetLookAhead (1);
+  NS_TEST_ASSERT_MSG_EQ_TOL (lookAhead[0].GetSeconds (), 197.0 / speed,
+      1e-9, "Lookahead not symmetric");
+
+  Ptr<MobilityModel> remote = nodes.Get (2)->GetObject<MobilityModel> ();
+  remote->SetPosition (Vector (2000.0, 0, 1.0));
+  lookAhead = channel->GetLookAhead (0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (lookAhead[1].GetSeconds (), 1997.0 / speed,
+      1e-9, "No lookahead to a system out of range");
+
+  // 10 ns away, less than a bit at 4 Mbps
+  remote->SetPosition (Vector (6.0, 0, 1.0));
+  lookAhead = channel->GetLookAhead (0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (lookAhead[1].GetSeconds (), 3.0 / speed,
+      1e-9, "Lookahead not the propagation delay");
+  Simulator::Destroy ();
+}
+
+// With fixed streams a scenario gives the same receptions, even when other
+// random variables were created before it and shifted the automatic
+// stream numbers (as in a process that builds a different part of it).
+class BleTestCaseStreams : public TestCase
+{
+public:
+  BleTestCaseStreams ();
+  virtual ~BleTestCaseStreams ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<const Packet> packet);
+  std::vector<Time> RunScenario (uint32_t nbOtherVariables);
+
+  std::vector<Time> m_rxTimes;
+};
+
+BleTestCaseStreams::BleTestCaseStreams ()
+  : TestCase ("Ble random stream assignment")
+{
+}
+
+BleTestCaseStreams::~BleTestCaseStreams ()
+{
+}
+
+void
+BleTestCaseStreams::Received (Ptr<const Packet> packet)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+std::vector<Time>
+BleTestCaseStreams::RunScenario (uint32_t nbOtherVariables)
+{
+  std::vector<Ptr<UniformRandomVariable> > others;
+  for (uint32_t i = 0; i < nbOtherVariables; i++)
+    {
+      others.push_back (CreateObject<UniformRandomVariable> ());
+      others.back ()->GetValue ();
+    }
+
+  NodeContainer nodes;
+  nodes.Create (4);
+  BleHelper helper;
+  helper.SetTrafficModel ("ns3::BlePoissonTraffic");
+  helper.SetTrafficModelAttribute ("Rate", DoubleValue (20));
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, nodes, GridPositions (4, 12.0));
+  int64_t stream = 100;
+  stream += helper.AssignStreams (bleNetDevices, stream);
+  // Random TX window offsets
+  helper.CreateAllLinks (bleNetDevices, false, 40);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  randT->SetStream (stream++);
+  // Random destinations too
+  ApplicationContainer apps = helper.GenerateTraffic (randT, nodes,
+      BleHelper::RANDOM_PATTERN, 20, 0.5, 1.5);
+  helper.AssignStreams (apps, stream);
+
+  m_rxTimes.clear ();
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    bleNetDevices.Get (i)->TraceConnectWithoutContext ("MacRx",
+        MakeCallback (&BleTestCaseStreams::Received, this));
+  Simulator::Stop (Seconds (2.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_rxTimes;
+}
+
+void
+BleTestCaseStreams::DoRun (void)
+{
+  std::vector<Time> first = RunScenario (0);
+  std::vector<Time> second = RunScenario (5);
+  NS_TEST_ASSERT_MSG_GT (first.size (), 0u, "Nothing received");
+  NS_TEST_ASSERT_MSG_EQ (first.size (), second.size (),
+      "Different number of packets received");
+  for (uint32_t i = 0; i < first.size () && i < second.size (); i++)
+    NS_TEST_ASSERT_MSG_EQ (first[i], second[i], "Different reception times");
+}
+
+// Alarms sent next to a bulk upload that the link cannot keep up with
+// skip the backlog, and the bulk packets that wait past their deadline
+// are flushed instead of being sent late.
+class BleTestCasePriority : public TestCase
+{
+public:
+  BleTestCasePriority ();
+  virtual ~BleTestCasePriority ();
+
+private:
+  virtual void DoRun (void);
+  void Sent (Ptr<const Packet> packet);
+  void Received (Ptr<const Packet> packet);
+
+  static const uint32_t ALARM_SIZE = 5;
+  std::vector<Time> m_alarmTx;
+  std::vector<Time> m_alarmRx;
+  uint32_t m_bulkRx;
+};
+
+BleTestCasePriority::BleTestCasePriority ()
+  : TestCase ("Ble priority classes and deadlines of queued packets"),
+  m_bulkRx (0)
+{
+}
+
+BleTestCasePriority::~BleTestCasePriority ()
+{
+}
+
+void
+BleTestCasePriority::Sent (Ptr<const Packet> packet)
+{
+  BleMacHeader header;
+  if (packet->GetSize () == ALARM_SIZE + header.GetSerializedSize ())
+    m_alarmTx.push_back (Simulator::Now ());
+}
+
+void
+BleTestCasePriority::Received (Ptr<const Packet> packet)
+{
+  BleMacHeader header;
+  if (packet->GetSize () == ALARM_SIZE + header.GetSerializedSize ())
+    m_alarmRx.push_back (Simulator::Now ());
+  else
+    m_bulkRx++;
+}
+
+void
+BleTestCasePriority::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, nodes, GridPositions (2, 5.0));
+  helper.CreateAllLinks (bleNetDevices, true, 40); // 50 ms
+
+  // A packet every 2 ms, far more than the link carries
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.001));
+  Ptr<Application> bulk = helper.GenerateTraffic (randT, nodes.Get (1), 20,
+      1, 2, 0.002, nodes.Get (0));
+  bulk->SetAttribute ("Deadline", TimeValue (MilliSeconds (200)));
+  Ptr<Application> alarm = helper.GenerateTraffic (randT, nodes.Get (1),
+      ALARM_SIZE, 1, 2, 0.1, nodes.Get (0));
+  alarm->SetAttribute ("Priority", StringValue ("Alarm"));
+
+  bleNetDevices.Get (1)->TraceConnectWithoutContext ("MacTx",
+      MakeCallback (&BleTestCasePriority::Sent, this));
+  bleNetDevices.Get (0)->TraceConnectWithoutContext ("MacRx",
+      MakeCallback (&BleTestCasePriority::Received, this));
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_alarmTx.size (), 0u, "No alarms sent");
+  NS_TEST_ASSERT_MSG_EQ (m_alarmRx.size (), m_alarmTx.size (),
+      "Alarms lost");
+  Time maxDelay;
+  for (uint32_t i = 0; i < m_alarmTx.size () && i < m_alarmRx.size (); i++)
+    maxDelay = Max (maxDelay, m_alarmRx[i] - m_alarmTx[i]);
+  NS_TEST_ASSERT_MSG_LT (maxDelay, MilliSeconds (100),
+      "Alarms waited behind the bulk packets");
+  NS_TEST_ASSERT_MSG_GT (m_bulkRx, 0u, "No bulk packets received");
+  Ptr<BleBBManager> bbManager = DynamicCast<BleNetDevice> (
+      bleNetDevices.Get (1))->GetBBManager ();
+  NS_TEST_ASSERT_MSG_GT (bbManager->GetExpiredPackets (), 0u,
+      "No bulk packets flushed at their deadline");
+  // Flushed packets are dropped, not dequeued as if they were sent
+  Ptr<BleRingQueue> queue = bbManager->GetLinkManager (
+      DynamicCast<BleNetDevice> (bleNetDevices.Get (0))->GetAddress16 ())
+    ->GetQueue ();
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (queue->GetTotalDroppedPackets (),
+      bbManager->GetExpiredPackets (), "Flushed packets not dropped");
+  Simulator::Destroy ();
+}
+
+// A saturated link with packets of 4 ms air time at 500 kbps, so a data
+// packet and a data reply do not fit in the 5 ms transmit window: every
+// transmission, the empty replies included, ends inside the window.
+class BleTestCaseAirTime : public TestCase
+{
+public:
+  BleTestCaseAirTime ();
+  virtual ~BleTestCaseAirTime ();
+
+private:
+  virtual void DoRun (void);
+  void TxBegin (Ptr<BleNetDevice> device, Ptr<const Packet> packet,
+      uint8_t channel);
+  void Received (Ptr<const Packet> packet);
+  void PhyRxEnd (Ptr<const Packet> packet, uint8_t channel, double rssi,
+      bool error);
+
+  uint32_t m_tx;
+  uint32_t m_overruns;
+  uint32_t m_rx;
+  Time m_txStart; // Of the last packet of a link
+  Time m_txDuration;
+  uint32_t m_phyRx; // Receptions of the second device
+  uint32_t m_wrongAirTime;
+};
+
+BleTestCaseAirTime::BleTestCaseAirTime ()
+  : TestCase ("Ble connection events fit in the transmit window"),
+  m_tx (0), m_overruns (0), m_rx (0), m_phyRx (0), m_wrongAirTime (0)
+{
+}
+
+BleTestCaseAirTime::~BleTestCaseAirTime ()
+{
+}
+
+void
+BleTestCaseAirTime::TxBegin (Ptr<BleNetDevice> device,
+    Ptr<const Packet> packet, uint8_t channel)
+{
+  Ptr<BleLinkManager> linkManager =
+    device->GetBBManager ()->GetActiveLinkManager ();
+  if (linkManager == 0)
+    return; // Advertising
+  m_tx++;
+  Time end = Simulator::Now ()
+    + device->GetPhy ()->GetTxDuration (packet->GetSize ());
+  m_txStart = Simulator::Now ();
+  m_txDuration = end - m_txStart;
+  if (end > linkManager->GetLastTransmitWindowTime ()
+      + linkManager->GetTransmitWindowSize ())
+    m_overruns++;
+}
+
+void
+BleTestCaseAirTime::Received (Ptr<const Packet> packet)
+{
+  m_rx++;
+}
+
+void
+BleTestCaseAirTime::PhyRxEnd (Ptr<const Packet> packet, uint8_t channel,
+    double rssi, bool error)
+{
+  if (m_txStart.IsZero ())
+    return; // Advertising
+  m_phyRx++;
+  // 5 m, some 17 ns of propagation
+  Time airTime = Simulator::Now () - m_txStart;
+  if (airTime < m_txDuration || airTime > m_txDuration + NanoSeconds (100))
+    m_wrongAirTime++;
+}
+
+void
+BleTestCaseAirTime::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  BleHelper helper;
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, nodes, GridPositions (2, 5.0));
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    {
+      Ptr<BleNetDevice> device =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (i));
+      device->GetPhy ()->SetDataRate (500000);
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin",
+          MakeCallback (&BleTestCaseAirTime::TxBegin, this).Bind (device));
+    }
+  // 40 bits of preamble and access address, the header, 24 bits of CRC
+  Ptr<BlePhy> phy = DynamicCast<BleNetDevice> (bleNetDevices.Get (0))
+    ->GetPhy ();
+  NS_TEST_ASSERT_MSG_EQ (phy->GetTxDuration (8), MicroSeconds (256),
+      "Air time of an empty PDU");
+  // The air time follows the PreambleBits attribute, on both ends
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    DynamicCast<BleNetDevice> (bleNetDevices.Get (i))->GetPhy ()
+      ->SetAttribute ("PreambleBits", UintegerValue (16));
+  NS_TEST_ASSERT_MSG_EQ (phy->GetTxDuration (8), MicroSeconds (208),
+      "Air time of an empty PDU with a 16 bit preamble");
+  DynamicCast<BleNetDevice> (bleNetDevices.Get (1))->GetPhy ()
+    ->TraceConnectWithoutContext ("PhyRxEnd",
+        MakeCallback (&BleTestCaseAirTime::PhyRxEnd, this));
+  helper.CreateAllLinks (bleNetDevices, true, 40); // 50 ms
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.001));
+  helper.GenerateTraffic (randT, nodes.Get (0), 240, 1, 2, 0.005,
+      nodes.Get (1));
+  helper.GenerateTraffic (randT, nodes.Get (1), 240, 1, 2, 0.005,
+      nodes.Get (0));
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    bleNetDevices.Get (i)->TraceConnectWithoutContext ("MacRx",
+        MakeCallback (&BleTestCaseAirTime::Received, this));
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_tx, 0u, "Nothing sent in a connection event");
+  NS_TEST_ASSERT_MSG_GT (m_rx, 0u, "Nothing received");
+  NS_TEST_ASSERT_MSG_EQ (m_overruns, 0u,
+      "Transmissions ran past the transmit window");
+  NS_TEST_ASSERT_MSG_GT (m_phyRx, 0u, "Nothing received by the PHY");
+  NS_TEST_ASSERT_MSG_EQ (m_wrongAirTime, 0u,
+      "Signals on the air for another time than GetTxDuration");
+  Simulator::Destroy ();
+}
+
+// Radios that are off between the connection events get fewer signals
+// from the channel, but the receptions and the packets lost to
+// interference are the same as with the radios always on, on the spectrum
+// channel and on the link channel.
+class BleTestCaseSleep : public TestCase
+{
+public:
+  BleTestCaseSleep ();
+  virtual ~BleTestCaseSleep ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<const Packet> packet);
+  void PhyRxEnd (Ptr<const Packet> packet, uint8_t channel, double rssi,
+      bool error);
+  std::vector<Time> RunScenario (bool linkAbstraction, bool sleep);
+
+  std::vector<Time> m_rxTimes;
+  uint32_t m_errors;
+  uint64_t m_rxSignals;
+};
+
+BleTestCaseSleep::BleTestCaseSleep ()
+  : TestCase ("Ble radios off between connection events"),
+  m_errors (0),
+  m_rxSignals (0)
+{
+}
+
+BleTestCaseSleep::~BleTestCaseSleep ()
+{
+}
+
+void
+BleTestCaseSleep::Received (Ptr<const Packet> packet)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+void
+BleTestCaseSleep::PhyRxEnd (Ptr<const Packet> packet, uint8_t channel,
+    double rssi, bool error)
+{
+  if (error)
+    m_errors++;
+}
+
+std::vector<Time>
+BleTestCaseSleep::RunScenario (bool linkAbstraction, bool sleep)
+{
+  NodeContainer nodes;
+  nodes.Create (6);
+  BleHelper helper;
+  helper.SetLinkAbstraction (linkAbstraction);
+  NetDeviceContainer bleNetDevices =
+    InstallAt (helper, nodes, GridPositions (6, 2.0, 2.0, 3));
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    {
+      Ptr<BlePhy> phy =
+        DynamicCast<BleNetDevice> (bleNetDevices.Get (i))->GetPhy ();
+      phy->SetAttribute ("SleepBetweenEvents", BooleanValue (sleep));
+      // A poor receive filter, so that the BLE links also interfere with
+      // each other on the channels next to theirs
+      phy->SetAttribute ("AdjacentChannelSelectivity1", DoubleValue (0));
+      phy->SetAttribute ("AdjacentChannelSelectivity2", DoubleValue (0));
+      phy->TraceConnectWithoutContext ("PhyRxEnd",
+          MakeCallback (&BleTestCaseSleep::PhyRxEnd, this));
+    }
+  int64_t stream = 200;
+  stream += helper.AssignStreams (bleNetDevices, stream);
+  // Random TX window offsets, so the events of the links overlap
+  helper.CreateAllLinks (bleNetDevices, false, 8);
+
+  Ptr<UniformRandomVariable> randT = CreateObject<UniformRandomVariable> ();
+  randT->SetAttribute ("Max", DoubleValue (0.1));
+  randT->SetStream (stream++);
+  helper.GenerateTraffic (randT, nodes, BleHelper::MANY_TO_ONE_PATTERN, 20,
+      0.5, 1.5);
+
+  m_rxTimes.clear ();
+  m_errors = 0;
+  bleNetDevices.Get (0)->TraceConnectWithoutContext ("MacRx",
+      MakeCallback (&BleTestCaseSleep::Received, this));
+  Simulator::Stop (Seconds (2.5));
+  Simulator::Run ();
+  m_rxSignals = 0;
+  for (uint32_t i = 0; i < bleNetDevices.GetN (); i++)
+    m_rxSignals += DynamicCast<BleNetDevice> (bleNetDevices.Get (i))
+      ->GetPhy ()->GetRxSignals ();
+  Simulator::Destroy ();
+  return m_rxTimes;
+}
+
+void
+BleTestCaseSleep::DoRun (void)
+{
+  for (bool linkAbstraction : {false, true})
+    {
+      std::vector<Time> awake = RunScenario (linkAbstraction, false);
+      uint32_t awakeErrors = m_errors;
+      uint64_t awakeSignals = m_rxSignals;
+      std::vector<Time> asleep = RunScenario (linkAbstraction, true);
+      NS_TEST_ASSERT_MSG_LT (m_rxSignals, awakeSignals, "Signals delivered "
+          "to the radios that were off");
+      NS_TEST_ASSERT_MSG_EQ (m_errors, awakeErrors,
+          "Different number of packets lost");
+      NS_TEST_ASSERT_MSG_GT (awake.size (), 0u, "Nothing received");
+      NS_TEST_ASSERT_MSG_EQ (awake.size (), asleep.size (),
+          "Different number of packets received");
+      for (uint32_t i = 0; i < awake.size () && i < asleep.size (); i++)
+        NS_TEST_ASSERT_MSG_EQ (awake[i], asleep[i],
+            "Different reception times");
+    }
+}
+
+// A binary trace read back, converted to CSV and to PCAP gives the
+// records that were written, also across buffer flushes.
+class BleTestCaseTraceConvert : public TestCase
+{
+public:
+  BleTestCaseTraceConvert ();
+  virtual ~BleTestCaseTraceConvert ();
+
+private:
+  virtual void DoRun (void);
+};
 
+BleTestCaseTraceConvert::BleTestCaseTraceConvert ()
+  : TestCase ("Ble binary trace round trip")
+{
+}
+
+BleTestCaseTraceConvert::~BleTestCaseTraceConvert ()
+{
+}
+
+void
+BleTestCaseTraceConvert::DoRun (void)
+{
+  std::vector<BleTraceRecord> records;
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      BleTraceRecord r;
+      r.timeNs = 1234567890123ll + i * 1000000;
+      r.nodeId = 70000 + i;
+      r.src = 0xA0B0 + i;
+      r.dst = 0xFFFF - i;
+      r.size = 8 + 30 * i;
+      r.type = i % 4;
+      r.channel = (i == 3) ? BleTraceRecord::NO_CHANNEL : 5 * i + 7;
+      r.rssi = -90 + 3 * i;
+      r.llid = i % 4;
+      r.sn = i & 1;
+      r.nesn = (i >> 1) & 1;
+      r.md = (i >> 2) & 1;
+      records.push_back (r);
+    }
+
+  std::string filename = CreateTempDirFilename ("ble-trace.bin");
+  Ptr<BleTraceSink> sink = CreateObject<BleTraceSink> ();
+  // Flushed every two records
+  sink->SetAttribute ("BufferSize",
+      UintegerValue (2 * BleTraceSink::RECORD_SIZE));
+  sink->Open (filename);
+  for (const BleTraceRecord &r : records)
+    sink->Record (r);
+  sink->Dispose ();
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  NS_TEST_ASSERT_MSG_EQ (BleTraceSink::ReadHeader (is), true,
+      "Header not read back");
+  std::ostringstream csv;
+  NS_TEST_ASSERT_MSG_EQ (BleTraceSink::WriteCsv (is, csv), records.size (),
+      "Records lost");
+
+  const char *types[] = {"TX", "RX", "RX_ERROR", "TX_WINDOW_SKIPPED"};
+  std::istringstream lines (csv.str ());
+  std::string line;
+  std::getline (lines, line);
+  NS_TEST_ASSERT_MSG_EQ (line,
+      "timeNs,node,type,channel,rssi,src,dst,size,llid,sn,nesn,md",
+      "Wrong CSV header");
+  for (const BleTraceRecord &r : records)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((bool) std::getline (lines, line), true,
+          "CSV line missing");
+      std::vector<std::string> fields;
+      std::istringstream fieldStream (line);
+      std::string field;
+      while (std::getline (fieldStream, field, ','))
+        fields.push_back (field);
+      if (line.back () == ',')
+        fields.push_back ("");
+      NS_TEST_ASSERT_MSG_EQ (fields.size (), 12u, "Wrong number of fields");
+      NS_TEST_EXPECT_MSG_EQ (std::stoll (fields[0]), r.timeNs, "Time");
+      NS_TEST_EXPECT_MSG_EQ (std::stoul (fields[1]), r.nodeId, "Node");
+      NS_TEST_EXPECT_MSG_EQ (fields[2], types[r.type], "Type");
+      if (r.channel == BleTraceRecord::NO_CHANNEL)
+        NS_TEST_EXPECT_MSG_EQ (fields[3], "", "Channel of no channel");
+      else
+        NS_TEST_EXPECT_MSG_EQ (std::stoi (fields[3]), r.channel, "Channel");
+      if (r.type == BleTraceRecord::RX || r.type == BleTraceRecord::RX_ERROR)
+        NS_TEST_EXPECT_MSG_EQ (std::stoi (fields[4]), r.rssi, "RSSI");
+      else
+        NS_TEST_EXPECT_MSG_EQ (fields[4], "", "RSSI of a transmission");
+      NS_TEST_EXPECT_MSG_EQ (std::stoul (fields[5]), r.src, "Source");
+      NS_TEST_EXPECT_MSG_EQ (std::stoul (fields[6]), r.dst, "Destination");
+      NS_TEST_EXPECT_MSG_EQ (std::stoul (fields[7]), r.size, "Size");
+      NS_TEST_EXPECT_MSG_EQ (std::stoi (fields[8]), r.llid, "LLID");
+      NS_TEST_EXPECT_MSG_EQ ((fields[9] == "1"), r.sn, "SN");
+      NS_TEST_EXPECT_MSG_EQ ((fields[10] == "1"), r.nesn, "NESN");
+      NS_TEST_EXPECT_MSG_EQ ((fields[11] == "1"), r.md, "MD");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((bool) std::getline (lines, line), false,
+      "Extra CSV lines");
+
+  // PCAP: one frame per packet record, with its time, RSSI and CRC flag
+  std::string pcapName = CreateTempDirFilename ("ble-trace.pcap");
+  is.clear ();
+  is.seekg (0);
+  BleTraceSink::ReadHeader (is);
+  BleTraceSink::WritePcap (is, pcapName);
+  PcapFile pcap;
+  pcap.Open (pcapName, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (pcap.GetDataLinkType (), 256u, "Wrong link type");
+  uint8_t data[512];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (const BleTraceRecord &r : records)
+    {
+      if (r.type == BleTraceRecord::TX_WINDOW_SKIPPED)
+        continue;
+      pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen,
+          readLen);
+      NS_TEST_ASSERT_MSG_EQ (pcap.Fail (), false, "PCAP frame missing");
+      NS_TEST_EXPECT_MSG_EQ (tsSec * 1000000ull + tsUsec,
+          (uint64_t) r.timeNs / 1000, "PCAP time");
+      NS_TEST_EXPECT_MSG_EQ ((int8_t) data[1], r.rssi, "PCAP RSSI");
+      bool crcValid = (data[9] & 0x08) != 0;
+      NS_TEST_EXPECT_MSG_EQ (crcValid, (r.type == BleTraceRecord::RX),
+          "PCAP CRC flag");
+      // Pseudo header, access address, PDU header, payload and CRC
+      uint32_t payload = std::min (r.size - 8u,
+          r.channel >= 37 ? 31u : 251u);
+      uint32_t header = r.channel >= 37 ? 8 : 2;
+      NS_TEST_EXPECT_MSG_EQ (inclLen, 10 + 4 + header + payload + 3,
+          "PCAP frame length");
+    }
+  pcap.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (pcap.Eof (), true, "Extra PCAP frames");
+  pcap.Close ();
+}
 
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
@@ -716,6 +2705,26 @@ BleTestSuite::BleTestSuite ()
   AddTestCase (new BleTestCase2, TestCase::QUICK);
   AddTestCase (new BleTestCase3, TestCase::QUICK);
   AddTestCase (new BleTestCase4, TestCase::QUICK);
+  AddTestCase (new BleTestCaseStats, TestCase::QUICK);
+  AddTestCase (new BleTestCaseTopology, TestCase::QUICK);
+  AddTestCase (new BleTestCaseSixLowPan, TestCase::QUICK);
+  AddTestCase (new BleTestCaseGatt, TestCase::QUICK);
+  AddTestCase (new BleTestCaseIso, TestCase::QUICK);
+  AddTestCase (new BleTestCaseCoexistence, TestCase::QUICK);
+  AddTestCase (new BleTestCaseTraffic, TestCase::QUICK);
+  AddTestCase (new BleTestCaseScatternet, TestCase::QUICK);
+  AddTestCase (new BleTestCaseScenario, TestCase::QUICK);
+  AddTestCase (new BleTestCaseRingQueue, TestCase::QUICK);
+  AddTestCase (new BleTestCaseMacQueueItem, TestCase::QUICK);
+  AddTestCase (new BleTestCaseSensitivity, TestCase::QUICK);
+  AddTestCase (new BleTestCaseLinkAbstraction, TestCase::QUICK);
+  AddTestCase (new BleTestCaseAdjacentChannel, TestCase::QUICK);
+  AddTestCase (new BleTestCaseLookAhead, TestCase::QUICK);
+  AddTestCase (new BleTestCaseStreams, TestCase::QUICK);
+  AddTestCase (new BleTestCasePriority, TestCase::QUICK);
+  AddTestCase (new BleTestCaseAirTime, TestCase::QUICK);
+  AddTestCase (new BleTestCaseSleep, TestCase::QUICK);
+  AddTestCase (new BleTestCaseTraceConvert, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -117,21 +117,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
   // remove a previous entry of this phy if it exists
-  // we need to scan for all rxSpectrumModel values since we don't
-  // know which spectrum model the phy had when it was previously added
-  // (it's probably different than the current one)
-  for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
-       rxInfoIterator !=  m_rxSpectrumModelInfoMap.end ();
-       ++rxInfoIterator)
-    {
-      auto phyIt = std::find (rxInfoIterator->second.m_rxPhys.begin(), rxInfoIterator->second.m_rxPhys.end(), phy);
-      if (phyIt != rxInfoIterator->second.m_rxPhys.end ())
-        {
-          rxInfoIterator->second.m_rxPhys.erase (phyIt);
-          --m_numDevices;
-          break; // there should be at most one entry
-        }       
-    }
+  RemoveRx (phy);
 
   ++m_numDevices;
 
@@ -213,6 +199,29 @@ MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const Spectr
   return txInfoIterator;
 }
 
+
+void
+MultiModelSpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+
+  // we need to scan for all rxSpectrumModel values since we don't
+  // know which spectrum model the phy had when it was previously added
+  // (it's probably different than the current one)
+  for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator !=  m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      auto phyIt = std::find (rxInfoIterator->second.m_rxPhys.begin(), rxInfoIterator->second.m_rxPhys.end(), phy);
+      if (phyIt != rxInfoIterator->second.m_rxPhys.end ())
+        {
+          rxInfoIterator->second.m_rxPhys.erase (phyIt);
+          --m_numDevices;
+          break; // there should be at most one entry
+        }       
+    }
+}
+
 void
 MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 {
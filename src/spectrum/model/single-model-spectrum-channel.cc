@@ -18,6 +18,7 @@
  * Author: Nicola Baldo <nbaldo@cttc.es>
  */
 
+#include <algorithm>
 #include <ns3/object.h>
 #include <ns3/simulator.h>
 #include <ns3/log.h>
@@ -78,6 +79,17 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   m_phyList.push_back (phy);
 }
 
+void
+SingleModelSpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  PhyList::iterator it = std::find (m_phyList.begin (), m_phyList.end (), phy);
+  if (it != m_phyList.end ())
+    {
+      m_phyList.erase (it);
+    }
+}
+
 
 void
 SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
@@ -125,6 +125,21 @@ public:
    */
   virtual void AddRx (Ptr<SpectrumPhy> phy) = 0;
 
+  /**
+   * \brief Remove a SpectrumPhy from a channel
+   *
+   * This method is used to detach a SpectrumPhy instance from a
+   * SpectrumChannel instance, so that the SpectrumPhy does not receive
+   * packets sent on that channel, e.g. while its radio is off.
+   *
+   * This method is to be implemented by all classes inheriting from
+   * SpectrumChannel.
+   *
+   * \param phy the SpectrumPhy instance to be removed from the channel as
+   * a receiver.
+   */
+  virtual void RemoveRx (Ptr<SpectrumPhy> phy) = 0;
+
   /**
    * TracedCallback signature for path loss calculation events.
    *